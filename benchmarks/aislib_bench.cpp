@@ -0,0 +1,813 @@
+/**
+ * @file aislib_bench.cpp
+ * @brief Micro-benchmarks for the aislib decode and encode paths
+ *
+ * Every benchmark processes one message per iteration, so the reported
+ * time is the cost per message. The "allocs/msg" counter is the number of
+ * heap allocations per message measured by aislib_alloc_accounting.
+ * Where perf_event_open is available, cycles, instructions, branch misses
+ * and L1d/LLC read misses per message are reported as well.
+ */
+
+ #include "bench_corpus.h"
+ #include "perf_counters.h"
+ #include "aislib/ais_parser.h"
+ #include "aislib/allocation_counter.h"
+ #include "aislib/anomaly_detector.h"
+ #include "aislib/bit_vector.h"
+ #include "aislib/class_b_static_cache.h"
+ #include "aislib/decode_cache.h"
+ #include "aislib/density_grid.h"
+ #include "aislib/filter_dispatcher.h"
+ #include "aislib/geofence.h"
+ #include "aislib/message_factory.h"
+ #include "aislib/metrics.h"
+ #include "aislib/multipart_message_manager.h"
+ #include "aislib/nmea_utils.h"
+ #include "aislib/position_throttle.h"
+ #include "aislib/shm_ring.h"
+ #include "aislib/static_and_voyage_data.h"
+ #include "aislib/stream_merger.h"
+ #include "aislib/string_pool.h"
+ #include "aislib/time_reconstruction.h"
+ #include "aislib/track_store.h"
+ #include "aislib/vdl_load.h"
+ #include "aislib/vessel_table.h"
+ #include <benchmark/benchmark.h>
+ #include <algorithm>
+ #include <cmath>
+ #include <memory>
+ #include <random>
+ #include <string>
+ #include <vector>
+
+ #include <unistd.h>
+
+ using namespace aislib;
+ using namespace aislib::alloc;
+ using namespace aislib::bench;
+
+ namespace {
+
+ // Allocations and hardware counters over a benchmark loop, reported per message
+ class MessageCounters {
+ public:
+     MessageCounters()
+         : allocations_(allocation_count()), perf_(PerfCounters::instance().read()) {}
+
+     // One message per iteration
+     void report(benchmark::State& state) const {
+         report(state, static_cast<int64_t>(state.iterations()));
+     }
+
+     void report(benchmark::State& state, int64_t messages) const {
+         PerfCounters::Values perf = PerfCounters::instance().read();
+         double allocations = static_cast<double>(allocation_count() - allocations_);
+         double scale = messages > 0 ? 1.0 / static_cast<double>(messages) : 0.0;
+
+         state.SetItemsProcessed(messages);
+         state.counters["allocs/msg"] = benchmark::Counter(allocations * scale);
+         for (size_t i = 0; i < perf.size(); ++i) {
+             if (perf[i] >= 0.0 && perf_[i] >= 0.0) {
+                 auto event = static_cast<PerfCounters::Event>(i);
+                 state.counters[PerfCounters::counter_name(event)] = benchmark::Counter((perf[i] - perf_[i]) * scale);
+             }
+         }
+     }
+
+ private:
+     uint64_t allocations_;
+     PerfCounters::Values perf_;
+ };
+
+ // Payloads of all single-sentence messages
+ const std::vector<std::string>& single_part_payloads() {
+     static const std::vector<std::string> payloads = [] {
+         std::vector<std::string> result;
+         for (const auto& entry : corpus().messages_by_type) {
+             for (const auto& message : entry.second) {
+                 if (message.size() == 1) {
+                     result.push_back(payload_of(message.front()));
+                 }
+             }
+         }
+         return result;
+     }();
+     return payloads;
+ }
+
+ // Reassembled bits of every message of one type
+ std::vector<BitVector> bits_of_type(int type) {
+     std::vector<BitVector> result;
+     auto it = corpus().messages_by_type.find(type);
+     if (it == corpus().messages_by_type.end()) {
+         return result;
+     }
+
+     MultipartMessageManager manager;
+     for (const auto& message : it->second) {
+         if (message.size() == 1) {
+             AISParser parser;
+             auto decoded = parser.parse(message.front());
+             if (decoded) {
+                 BitVector bits;
+                 decoded->to_bits(bits);
+                 result.push_back(bits);
+             }
+             continue;
+         }
+         for (const auto& sentence : message) {
+             std::vector<std::string> fields = NMEAUtils::parse_fields(sentence);
+             auto combined = manager.add_fragment(
+                 static_cast<uint8_t>(std::stoi(fields[2])),
+                 static_cast<uint8_t>(std::stoi(fields[1])),
+                 fields[3], fields[4][0], fields[5],
+                 static_cast<uint8_t>(std::stoi(fields[6])));
+             if (combined) {
+                 result.push_back(*combined);
+             }
+         }
+     }
+     return result;
+ }
+
+ void BM_BitVectorFromPayload(benchmark::State& state) {
+     const auto& payloads = single_part_payloads();
+     size_t i = 0;
+     MessageCounters counters;
+     for (auto _ : state) {
+         BitVector bits(payloads[i]);
+         benchmark::DoNotOptimize(bits);
+         if (++i == payloads.size()) i = 0;
+     }
+     counters.report(state);
+ }
+
+ // Extracts every field of a Class A position report
+ void BM_BitVectorGetUint(benchmark::State& state) {
+     const std::vector<BitVector> messages = bits_of_type(1);
+     static const size_t kFields[][2] = {
+         {0, 6}, {6, 2}, {8, 30}, {38, 4}, {42, 8}, {50, 10}, {60, 1}, {61, 28},
+         {89, 27}, {116, 12}, {128, 9}, {137, 6}, {143, 2}, {145, 3}, {148, 1}, {149, 19}
+     };
+     size_t i = 0;
+     MessageCounters counters;
+     for (auto _ : state) {
+         const BitVector& bits = messages[i];
+         uint64_t sum = 0;
+         for (const auto& field : kFields) {
+             sum += bits.get_uint(field[0], field[1]);
+         }
+         benchmark::DoNotOptimize(sum);
+         if (++i == messages.size()) i = 0;
+     }
+     counters.report(state);
+ }
+
+ // Extracts call sign, vessel name and destination of a type 5 message
+ void BM_BitVectorGetString(benchmark::State& state) {
+     const std::vector<BitVector> messages = bits_of_type(5);
+     size_t i = 0;
+     MessageCounters counters;
+     for (auto _ : state) {
+         const BitVector& bits = messages[i];
+         CallSign call_sign;
+         ShipName name;
+         ShipName destination;
+         bits.get_string(70, 42, call_sign);
+         bits.get_string(112, 120, name);
+         bits.get_string(302, 120, destination);
+         benchmark::DoNotOptimize(call_sign);
+         benchmark::DoNotOptimize(name);
+         benchmark::DoNotOptimize(destination);
+         if (++i == messages.size()) i = 0;
+     }
+     counters.report(state);
+ }
+
+ void BM_BitVectorToNmeaPayload(benchmark::State& state) {
+     std::vector<BitVector> messages;
+     for (const auto& payload : single_part_payloads()) {
+         messages.emplace_back(payload);
+     }
+     size_t i = 0;
+     MessageCounters counters;
+     for (auto _ : state) {
+         std::string payload = messages[i].to_nmea_payload();
+         benchmark::DoNotOptimize(payload);
+         if (++i == messages.size()) i = 0;
+     }
+     counters.report(state);
+ }
+
+ void BM_NmeaValidateChecksum(benchmark::State& state) {
+     const auto& sentences = corpus().sentences;
+     size_t i = 0;
+     MessageCounters counters;
+     for (auto _ : state) {
+         benchmark::DoNotOptimize(NMEAUtils::validate_checksum(sentences[i]));
+         if (++i == sentences.size()) i = 0;
+     }
+     counters.report(state);
+ }
+
+ void BM_NmeaParseFields(benchmark::State& state) {
+     const auto& sentences = corpus().sentences;
+     size_t i = 0;
+     MessageCounters counters;
+     for (auto _ : state) {
+         std::vector<std::string> fields = NMEAUtils::parse_fields(sentences[i]);
+         benchmark::DoNotOptimize(fields);
+         if (++i == sentences.size()) i = 0;
+     }
+     counters.report(state);
+ }
+
+ // Factory dispatch and decode over the bits of every decodable message, types interleaved
+ void BM_FactoryCreateMix(benchmark::State& state) {
+     std::vector<BitVector> messages;
+     for (const auto& entry : corpus().messages_by_type) {
+         if (MessageFactory::instance().is_message_type_registered(static_cast<uint8_t>(entry.first))) {
+             std::vector<BitVector> bits = bits_of_type(entry.first);
+             messages.insert(messages.end(), bits.begin(), bits.end());
+         }
+     }
+     std::shuffle(messages.begin(), messages.end(), std::mt19937(1));
+
+     size_t i = 0;
+     MessageCounters counters;
+     for (auto _ : state) {
+         auto message = MessageFactory::instance().create_message(messages[i]);
+         benchmark::DoNotOptimize(message);
+         if (++i == messages.size()) i = 0;
+     }
+     counters.report(state);
+ }
+
+ // Full parse of one message of the given type, all of its fragments included
+ void BM_ParserParse(benchmark::State& state, int type) {
+     const auto& messages = corpus().messages_by_type.at(type);
+     AISParser parser;
+     size_t i = 0;
+     MessageCounters counters;
+     for (auto _ : state) {
+         for (const auto& sentence : messages[i]) {
+             auto message = parser.parse(sentence);
+             benchmark::DoNotOptimize(message);
+         }
+         if (++i == messages.size()) i = 0;
+     }
+     counters.report(state);
+ }
+
+ // Full parse over the realistic type mix, sentence by sentence
+ void run_parse_mix(benchmark::State& state, const AISParser::ParserConfig& config) {
+     const auto& sentences = corpus().sentences;
+     AISParser parser(config);
+     size_t i = 0;
+     int64_t messages = 0;
+     MessageCounters counters;
+     for (auto _ : state) {
+         auto message = parser.parse(sentences[i]);
+         messages += message ? 1 : 0;
+         benchmark::DoNotOptimize(message);
+         if (++i == sentences.size()) i = 0;
+     }
+     counters.report(state, messages);
+ }
+
+ void BM_ParserParseMix(benchmark::State& state) {
+     run_parse_mix(state, AISParser::ParserConfig());
+ }
+
+ // Same workload with a metrics registry attached; the difference to BM_ParserParseMix is the metrics overhead
+ void BM_ParserParseMixWithMetrics(benchmark::State& state) {
+     AISParser::ParserConfig config;
+     config.metrics = std::make_shared<MetricsRegistry>();
+     run_parse_mix(state, config);
+ }
+
+ // Type 5 reports replayed as receivers would re-hear them; range(0) = 1 uses a decode cache
+ void BM_ParserParseStaticShared(benchmark::State& state) {
+     const auto& messages = corpus().messages_by_type.at(5);
+     AISParser::ParserConfig config;
+     if (state.range(0) != 0) {
+         config.decode_cache = std::make_shared<DecodeCache>();
+     }
+     AISParser parser(config);
+     size_t i = 0;
+     int64_t decoded = 0;
+     MessageCounters counters;
+     for (auto _ : state) {
+         std::shared_ptr<const AISMessage> message;
+         for (const auto& sentence : messages[i]) {
+             message = parser.parse_shared(sentence);
+         }
+         decoded += message ? 1 : 0;
+         benchmark::DoNotOptimize(message);
+         if (++i == messages.size()) i = 0;
+     }
+     counters.report(state, decoded);
+     if (config.decode_cache) {
+         state.counters["hit_rate"] = config.decode_cache->get_stats().hit_rate();
+     }
+ }
+
+ // Reassembly of a two-part message while the table is full of orphaned first fragments
+ void BM_MultipartOrphanPressure(benchmark::State& state) {
+     const size_t max_messages = static_cast<size_t>(state.range(0));
+     const auto& messages = corpus().messages_by_type.at(5);
+
+     std::vector<std::vector<std::string>> fragments;
+     for (const auto& sentence : messages.front()) {
+         fragments.push_back(NMEAUtils::parse_fields(sentence));
+     }
+
+     // Enough distinct keys that a reused key has always been evicted already
+     std::vector<std::string> ids;
+     for (size_t n = 0; n < max_messages * 4; ++n) {
+         ids.push_back("o" + std::to_string(n));
+     }
+
+     MultipartMessageManager manager(std::chrono::seconds(60), max_messages);
+     size_t next_id = 0;
+     auto add_orphan = [&] {
+         manager.add_fragment(1, 2, ids[next_id], 'A', fragments[0][5], 0);
+         if (++next_id == ids.size()) next_id = 0;
+     };
+     for (size_t n = 0; n < max_messages; ++n) {
+         add_orphan();
+     }
+
+     MessageCounters counters;
+     for (auto _ : state) {
+         add_orphan();
+         const std::string& id = ids[next_id];
+         if (++next_id == ids.size()) next_id = 0;
+         for (const auto& fields : fragments) {
+             auto combined = manager.add_fragment(
+                 static_cast<uint8_t>(std::stoi(fields[2])),
+                 static_cast<uint8_t>(std::stoi(fields[1])),
+                 id, 'B', fields[5],
+                 static_cast<uint8_t>(std::stoi(fields[6])));
+             benchmark::DoNotOptimize(combined);
+         }
+     }
+     counters.report(state);
+ }
+
+ // Encodes one decoded message of the given type back to NMEA sentences
+ void BM_Encode(benchmark::State& state, int type) {
+     std::vector<std::unique_ptr<AISMessage>> messages;
+     for (const auto& bits : bits_of_type(type)) {
+         messages.push_back(MessageFactory::instance().create_message(bits));
+     }
+     size_t i = 0;
+     MessageCounters counters;
+     for (auto _ : state) {
+         std::vector<std::string> sentences = messages[i]->to_nmea();
+         benchmark::DoNotOptimize(sentences);
+         if (++i == messages.size()) i = 0;
+     }
+     counters.report(state);
+ }
+
+ // Interns the same three fields; after the first pass every lookup is a hit
+ void BM_StringPoolIntern(benchmark::State& state) {
+     const std::vector<BitVector> messages = bits_of_type(5);
+     StringPool pool;
+     size_t i = 0;
+     MessageCounters counters;
+     for (auto _ : state) {
+         const BitVector& bits = messages[i];
+         benchmark::DoNotOptimize(pool.intern(bits, 70, 42));
+         benchmark::DoNotOptimize(pool.intern(bits, 112, 120));
+         benchmark::DoNotOptimize(pool.intern(bits, 302, 120));
+         if (++i == messages.size()) i = 0;
+     }
+     counters.report(state);
+     state.counters["pool_strings"] = static_cast<double>(pool.size());
+ }
+
+ // Merges the corpus type 24 parts; every vessel stays in the cache
+ void BM_ClassBStaticCacheUpdate(benchmark::State& state) {
+     std::vector<StaticDataReport> reports;
+     for (const BitVector& bits : bits_of_type(24)) {
+         reports.emplace_back(bits);
+     }
+     ClassBStaticCache cache;
+     auto now = ClassBStaticCache::Clock::now();
+     size_t i = 0;
+     MessageCounters counters;
+     for (auto _ : state) {
+         benchmark::DoNotOptimize(&cache.update(reports[i], now));
+         if (++i == reports.size()) i = 0;
+     }
+     counters.report(state);
+     state.counters["vessels"] = static_cast<double>(cache.size());
+ }
+
+ // Reconstructs the times of a 4096-row batch from four receivers, one row in 20 a base station report
+ void BM_TimeReconstruct(benchmark::State& state) {
+     const size_t rows = 4096;
+     TimeBatch batch;
+     for (size_t i = 0; i < rows; ++i) {
+         double time = 1717243200.0 + 0.02 * static_cast<double>(i);
+         double reference = (i % 20 == 0) ? std::floor(time) : std::nan("");
+         batch.append(static_cast<uint32_t>(i % 4), time + 0.4, static_cast<uint8_t>(static_cast<int64_t>(time) % 60), reference);
+     }
+     TimeReconstructor reconstructor;
+     MessageCounters counters;
+     for (auto _ : state) {
+         reconstructor.reconstruct(batch);
+         benchmark::DoNotOptimize(batch.time.data());
+     }
+     counters.report(state, static_cast<int64_t>(state.iterations() * rows));
+ }
+
+ void BM_VdlLoadAdd(benchmark::State& state) {
+     std::vector<CommunicationState> states(1024);
+     for (size_t i = 0; i < states.size(); ++i) {
+         uint32_t timeout = static_cast<uint32_t>(i % 8);
+         states[i] = CommunicationState::sotdma((timeout << 14) | static_cast<uint32_t>(i % 2250));
+     }
+     VdlLoadMonitor monitor;
+     size_t i = 0;
+     double time = 1717243200.0;
+     MessageCounters counters;
+     for (auto _ : state) {
+         benchmark::DoNotOptimize(monitor.add(static_cast<uint32_t>(i % 4), (i & 1) ? 'A' : 'B', time, states[i % states.size()]));
+         time += 0.01;
+         ++i;
+     }
+     counters.report(state);
+ }
+
+ void BM_GeofenceUpdate(benchmark::State& state) {
+     // 5000 fences of 0.5 to 5 km over the North Sea, positions of 10000 vessels
+     std::mt19937 rng(11);
+     std::uniform_real_distribution<double> latitude(50.0, 56.0);
+     std::uniform_real_distribution<double> longitude(-1.0, 8.0);
+     std::uniform_real_distribution<double> size(500.0, 5000.0);
+     GeofenceEngine engine;
+     for (uint32_t id = 0; id < 5000; ++id) {
+         double lat = latitude(rng);
+         double lon = longitude(rng);
+         double extent = size(rng) / 111120.0;
+         if (id % 2 == 0) {
+             engine.add_circle(id, lat, lon, size(rng));
+         } else {
+             engine.add_polygon(id, {{lat, lon}, {lat, lon + 2 * extent}, {lat + extent, lon + extent}});
+         }
+     }
+     std::vector<std::pair<double, double>> positions(10000);
+     for (auto& position : positions) {
+         position = std::make_pair(latitude(rng), longitude(rng));
+     }
+
+     std::vector<GeofenceEvent> events;
+     events.reserve(64);
+     size_t i = 0;
+     double time = 1717243200.0;
+     MessageCounters counters;
+     for (auto _ : state) {
+         const auto& position = positions[i];
+         benchmark::DoNotOptimize(engine.update(static_cast<uint32_t>(i), position.first, position.second, time, events));
+         events.clear();
+         if (++i == positions.size()) {
+             i = 0;
+             time += 1.0;
+         }
+     }
+     counters.report(state);
+ }
+
+ void BM_AnomalyDetectorBatch(benchmark::State& state) {
+     // 10000 vessels at 12 knots, batches of 1024 reports
+     const size_t vessels = 10000;
+     const size_t rows = 1024;
+     std::mt19937 rng(13);
+     std::uniform_real_distribution<double> latitude(-60.0, 60.0);
+     std::uniform_real_distribution<double> longitude(-180.0, 180.0);
+     std::vector<std::pair<double, double>> positions(vessels);
+     for (auto& position : positions) {
+         position = std::make_pair(latitude(rng), longitude(rng));
+     }
+
+     AnomalyDetector detector;
+     PositionBatch batch;
+     batch.reserve(rows);
+     size_t next = 0;
+     double time = 1717243200.0;
+     MessageCounters counters;
+     for (auto _ : state) {
+         state.PauseTiming();
+         batch.clear();
+         for (size_t i = 0; i < rows; ++i) {
+             auto& position = positions[next];
+             position.first += 12.0 / 3600.0 / 60.0;
+             batch.append(244000000u + static_cast<uint32_t>(next), time, position.first, position.second, 12.0f, 0);
+             if (++next == vessels) {
+                 next = 0;
+                 time += 10.0;
+             }
+         }
+         state.ResumeTiming();
+         detector.check(batch);
+         benchmark::DoNotOptimize(batch.anomalies.data());
+     }
+     counters.report(state, static_cast<int64_t>(state.iterations() * rows));
+ }
+
+ void BM_TrackStoreProject(benchmark::State& state) {
+     // 200000 vessels, one in ten turning, projected 30 seconds ahead
+     const size_t vessels = 200000;
+     std::mt19937 rng(17);
+     std::uniform_real_distribution<double> latitude(-60.0, 60.0);
+     std::uniform_real_distribution<double> longitude(-180.0, 180.0);
+     std::uniform_real_distribution<float> course(0.0f, 359.9f);
+     const double now = 1717243200.0;
+     TrackStore store;
+     for (size_t i = 0; i < vessels; ++i) {
+         float turn = i % 10 == 0 ? 5.0f : 0.0f;
+         store.update(200000000u + static_cast<uint32_t>(i), now - 10.0, latitude(rng), longitude(rng),
+                      12.0f, course(rng), turn);
+     }
+
+     ProjectedPositions positions;
+     MessageCounters counters;
+     for (auto _ : state) {
+         size_t count = store.project(now + 30.0, -90.0, -180.0, 90.0, 180.0, positions);
+         benchmark::DoNotOptimize(count);
+     }
+     counters.report(state, static_cast<int64_t>(state.iterations() * vessels));
+ }
+
+ void BM_DensityAggregate(benchmark::State& state) {
+     // 65536 reports from 5000 vessels in a 1 x 1.5 degree area, 4 levels of 0.01 degree cells
+     const size_t rows = 65536;
+     std::mt19937 rng(19);
+     std::uniform_int_distribution<uint32_t> vessel(0, 4999);
+     std::uniform_real_distribution<double> latitude(50.5, 51.5);
+     std::uniform_real_distribution<double> longitude(0.0, 1.5);
+     PositionBatch batch;
+     batch.reserve(rows);
+     for (size_t i = 0; i < rows; ++i) {
+         batch.append(244000000u + vessel(rng), 0.0, latitude(rng), longitude(rng), 10.0f, 0);
+     }
+
+     DensityAggregator::Config config;
+     config.threads = static_cast<unsigned>(state.range(0));
+     DensityAggregator aggregator(config);
+     MessageCounters counters;
+     for (auto _ : state) {
+         benchmark::DoNotOptimize(aggregator.add(batch));
+     }
+     counters.report(state, static_cast<int64_t>(state.iterations() * rows));
+     benchmark::DoNotOptimize(aggregator.result().cell_count());
+ }
+
+ void BM_StreamMerge(benchmark::State& state) {
+     // 40 receivers with up to 1 second of jitter, a third of transmissions heard twice
+     const size_t sources = 40;
+     const size_t records = 65536;
+     std::mt19937 rng(23);
+     std::uniform_real_distribution<double> jitter(0.0, 1.0);
+     std::vector<std::string> sentences;
+     std::vector<std::pair<uint16_t, double>> arrivals;
+     for (size_t i = 0; i < records; ++i) {
+         sentences.push_back("!AIVDM,1,1,,A,13u?etPv2;0n:dDPwUM1U1Cb" + std::to_string(i / 3 * 2 + (i % 3 == 2)) + ",0*00");
+         arrivals.emplace_back(static_cast<uint16_t>(rng() % sources), i * 0.001 + jitter(rng));
+     }
+
+     StreamMerger::Config config;
+     config.max_delay = 1.0;
+     // Views are consumed before the next push()
+     std::vector<MergedView> merged;
+     merged.reserve(records);
+     StreamMerger merger(sources, config);
+     double offset = 0.0;
+     MessageCounters counters;
+     for (auto _ : state) {
+         for (size_t i = 0; i < records; ++i) {
+             merger.push(arrivals[i].first, offset + arrivals[i].second, sentences[i]);
+             if (i % 64 == 63) {
+                 merger.pop(merged);
+                 benchmark::DoNotOptimize(merged.data());
+                 merged.clear();
+             }
+         }
+         merger.flush(merged);
+         benchmark::DoNotOptimize(merged.data());
+         merged.clear();
+         offset += 100.0;
+     }
+     counters.report(state, static_cast<int64_t>(state.iterations() * records));
+ }
+
+ void BM_ShmRingPublish(benchmark::State& state) {
+     // Publish decoded records with their sentences; Arg(n) readers drain every 1024 records
+     const size_t readers = static_cast<size_t>(state.range(0));
+     std::vector<std::string> sentences;
+     for (size_t i = 0; i < 1024; ++i) {
+         sentences.push_back("!AIVDM,1,1,,A,13u?etPv2;0n:dDPwUM1U1Cb" + std::to_string(i) + ",0*00");
+     }
+     ShmRingPublisher publisher("");
+     std::vector<std::unique_ptr<ShmRingSubscriber>> subscribers;
+     for (size_t i = 0; i < readers; ++i) {
+         subscribers.push_back(std::make_unique<ShmRingSubscriber>(publisher.fd()));
+     }
+
+     ShmRecord record;
+     record.latitude = 37.8;
+     record.longitude = -122.4;
+     record.message_type = 1;
+     std::string side;
+     size_t bytes = 0;
+     MessageCounters counters;
+     for (auto _ : state) {
+         for (size_t i = 0; i < sentences.size(); ++i) {
+             record.mmsi = static_cast<uint32_t>(366000000 + i);
+             record.time += 0.001;
+             publisher.publish(record, sentences[i].data(), sentences[i].size());
+             bytes += sentences[i].size();
+         }
+         for (auto& subscriber : subscribers) {
+             ShmRecord read;
+             while (subscriber->read(read, side)) {
+                 benchmark::DoNotOptimize(read.mmsi);
+             }
+         }
+     }
+     counters.report(state, static_cast<int64_t>(state.iterations() * sentences.size()));
+     state.SetBytesProcessed(static_cast<int64_t>(bytes + state.iterations() * sentences.size() * sizeof(ShmRecord)));
+ }
+
+ void BM_FilterDispatch(benchmark::State& state) {
+     // Arg(n) subscribers, each following a few vessels or a 2 by 3 degree area
+     const size_t subscriptions = static_cast<size_t>(state.range(0));
+     std::mt19937 rng(29);
+     std::uniform_real_distribution<double> latitude(30.0, 60.0);
+     std::uniform_real_distribution<double> longitude(-20.0, 30.0);
+     FilterDispatcher dispatcher;
+     for (size_t i = 0; i < subscriptions; ++i) {
+         SubscriptionFilter filter;
+         if (i % 2 == 0) {
+             filter.message_types = {1, 2, 3, 18};
+         }
+         if (i % 5 == 0) {
+             filter.mmsis = {static_cast<uint32_t>(rng() % 100000), static_cast<uint32_t>(rng() % 100000)};
+         } else {
+             SubscriptionFilter::Box box;
+             box.min_lat = latitude(rng);
+             box.min_lon = longitude(rng);
+             box.max_lat = box.min_lat + 2.0;
+             box.max_lon = box.min_lon + 3.0;
+             filter.boxes.push_back(box);
+         }
+         if (i % 7 == 0) {
+             filter.ship_types = {70, 80};
+         }
+         dispatcher.subscribe(filter);
+     }
+     for (uint32_t mmsi = 0; mmsi < 100000; mmsi += 3) {
+         dispatcher.set_ship_type(mmsi, static_cast<uint8_t>(70 + mmsi % 20));
+     }
+
+     const size_t messages = 4096;
+     std::vector<uint32_t> mmsis;
+     std::vector<double> lats;
+     std::vector<double> lons;
+     for (size_t i = 0; i < messages; ++i) {
+         mmsis.push_back(static_cast<uint32_t>(rng() % 100000));
+         lats.push_back(latitude(rng));
+         lons.push_back(longitude(rng));
+     }
+     std::vector<uint32_t> subscribers;
+     subscribers.reserve(subscriptions);
+     dispatcher.compile();
+     size_t routed = 0;
+     MessageCounters counters;
+     for (auto _ : state) {
+         for (size_t i = 0; i < messages; ++i) {
+             routed += dispatcher.route(1, mmsis[i], lats[i], lons[i], subscribers);
+         }
+     }
+     counters.report(state, static_cast<int64_t>(state.iterations() * messages));
+     benchmark::DoNotOptimize(routed);
+     state.counters["matches"] = static_cast<double>(routed) / static_cast<double>(state.iterations() * messages);
+ }
+
+ void BM_PositionThrottle(benchmark::State& state) {
+     // 20k vessels reporting every 6 seconds on average, throttled to one report per 30 seconds or a turn
+     const uint32_t vessels = 20000;
+     const size_t reports = 1 << 16;
+     std::mt19937 rng(31);
+     std::uniform_real_distribution<float> wobble(-10.0f, 10.0f);
+     std::vector<uint32_t> mmsis;
+     std::vector<float> courses;
+     for (size_t i = 0; i < reports; ++i) {
+         mmsis.push_back(200000000 + static_cast<uint32_t>(rng() % vessels) * 13);
+         courses.push_back(180.0f + wobble(rng));
+     }
+
+     PositionThrottle throttle;
+     const double step = 6.0 / vessels;
+     double time = 1717243200.0;
+     size_t passed = 0;
+     MessageCounters counters;
+     for (auto _ : state) {
+         for (size_t i = 0; i < reports; ++i) {
+             time += step;
+             passed += throttle.accept(mmsis[i], time, 37.8, -122.4, 12.0f, courses[i], 0);
+         }
+     }
+     counters.report(state, static_cast<int64_t>(state.iterations() * reports));
+     benchmark::DoNotOptimize(passed);
+     state.counters["passed"] = static_cast<double>(passed) / static_cast<double>(state.iterations() * reports);
+ }
+
+ void BM_VesselTableLoad(benchmark::State& state) {
+     // Restore 300k vessels with tracks and type 5 data, a sixth of them also with type 24 data
+     const uint32_t vessels = 300000;
+     auto now = VesselTable::Clock::now();
+     VesselTable table;
+     for (uint32_t i = 0; i < vessels; ++i) {
+         uint32_t mmsi = 200000000 + i * 3;
+         table.tracks().update(mmsi, 1717243200.0 + i % 600, 30.0 + i % 3000 * 0.01, -20.0 + i / 3000 * 0.1,
+                               12.0f, static_cast<float>(i % 360), 0.0f);
+         StaticAndVoyageData voyage(mmsi, 0);
+         voyage.set_vessel_name("VESSEL " + std::to_string(i));
+         voyage.set_call_sign("C" + std::to_string(i));
+         voyage.set_destination("PORT " + std::to_string(i % 500));
+         voyage.set_ship_type(StaticAndVoyageData::ShipType::CARGO);
+         table.update(1717243200.0, voyage, now);
+         if (i % 6 == 0) {
+             StaticDataReport part(mmsi, 0, StaticDataReport::Part::A);
+             part.set_vessel_name("CRAFT " + std::to_string(i));
+             table.update(1717243200.0, part, now);
+         }
+     }
+     // Per process, so that concurrent runs do not overwrite each other's snapshot
+     const std::string path = "/tmp/aislib-bench-vessels-" + std::to_string(::getpid()) + ".snapshot";
+     size_t bytes = table.save(path);
+
+     VesselTable restored;
+     MessageCounters counters;
+     for (auto _ : state) {
+         restored.load(path, now);
+         benchmark::DoNotOptimize(restored.get_stats().tracks);
+     }
+     counters.report(state, static_cast<int64_t>(state.iterations() * vessels));
+     ::unlink(path.c_str());
+     state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * bytes));
+     state.counters["strings"] = static_cast<double>(restored.get_stats().strings);
+ }
+
+ } // anonymous namespace
+
+ BENCHMARK(BM_BitVectorFromPayload);
+ BENCHMARK(BM_BitVectorGetUint);
+ BENCHMARK(BM_BitVectorGetString);
+ BENCHMARK(BM_BitVectorToNmeaPayload);
+ BENCHMARK(BM_NmeaValidateChecksum);
+ BENCHMARK(BM_NmeaParseFields);
+ BENCHMARK(BM_FactoryCreateMix);
+ BENCHMARK(BM_ParserParseMix);
+ BENCHMARK(BM_ParserParseMixWithMetrics);
+ BENCHMARK(BM_ParserParseStaticShared)->Arg(0)->Arg(1);
+ BENCHMARK(BM_MultipartOrphanPressure)->Arg(100)->Arg(1000);
+ BENCHMARK(BM_StringPoolIntern);
+ BENCHMARK(BM_ClassBStaticCacheUpdate);
+ BENCHMARK(BM_TimeReconstruct);
+ BENCHMARK(BM_VdlLoadAdd);
+ BENCHMARK(BM_GeofenceUpdate);
+ BENCHMARK(BM_AnomalyDetectorBatch);
+ BENCHMARK(BM_TrackStoreProject);
+ BENCHMARK(BM_DensityAggregate)->Arg(1)->Arg(4);
+ BENCHMARK(BM_StreamMerge);
+ BENCHMARK(BM_ShmRingPublish)->Arg(0)->Arg(2);
+ BENCHMARK(BM_FilterDispatch)->Arg(16)->Arg(256)->Arg(1024);
+ BENCHMARK(BM_PositionThrottle);
+ BENCHMARK(BM_VesselTableLoad)->Unit(benchmark::kMillisecond);
+
+ int main(int argc, char** argv) {
+     // Per-type benchmarks cover every type in the corpus the factory can decode
+     for (const auto& entry : corpus().messages_by_type) {
+         int type = entry.first;
+         if (!MessageFactory::instance().is_message_type_registered(static_cast<uint8_t>(type))) {
+             continue;
+         }
+         std::string suffix = "/type:" + std::to_string(type);
+         benchmark::RegisterBenchmark(("BM_ParserParse" + suffix).c_str(), BM_ParserParse, type);
+         benchmark::RegisterBenchmark(("BM_Encode" + suffix).c_str(), BM_Encode, type);
+     }
+
+     benchmark::Initialize(&argc, argv);
+     if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+         return 1;
+     }
+     benchmark::RunSpecifiedBenchmarks();
+     benchmark::Shutdown();
+     return 0;
+ }
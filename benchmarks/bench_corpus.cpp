@@ -0,0 +1,81 @@
+/**
+ * @file bench_corpus.cpp
+ * @brief Implementation of benchmark corpus loading
+ */
+
+ #include "bench_corpus.h"
+ #include "aislib/nmea_utils.h"
+ #include <cstdlib>
+ #include <fstream>
+ #include <stdexcept>
+ 
+ namespace aislib {
+ namespace bench {
+ 
+ namespace {
+ 
+ Corpus load_corpus() {
+     const char* path = std::getenv("AISLIB_BENCH_CORPUS");
+     if (path == nullptr || *path == '\0') {
+         path = AISLIB_BENCH_CORPUS_PATH;
+     }
+     
+     std::ifstream in(path);
+     if (!in) {
+         throw std::runtime_error(std::string("Cannot open benchmark corpus: ") + path);
+     }
+     
+     Corpus result;
+     std::vector<std::string> pending;
+     std::string line;
+     
+     while (std::getline(in, line)) {
+         if (!line.empty() && line.back() == '\r') {
+             line.pop_back();
+         }
+         if (line.empty() || line[0] == '#') {
+             continue;
+         }
+         
+         result.sentences.push_back(line);
+         
+         std::vector<std::string> fields = NMEAUtils::parse_fields(line);
+         if (fields.size() < 7 || fields[5].empty()) {
+             continue;
+         }
+         
+         int fragment_count = std::atoi(fields[1].c_str());
+         int fragment_number = std::atoi(fields[2].c_str());
+         if (fragment_number == 1) {
+             pending.clear();
+         }
+         pending.push_back(line);
+         
+         if (fragment_number == fragment_count) {
+             // The message type is the first payload character of the first fragment
+             std::string first_payload = payload_of(pending.front());
+             char c = first_payload[0];
+             int type = (c >= '`') ? c - '`' + 40 : c - '0';
+             result.messages_by_type[type].push_back(pending);
+             ++result.message_count;
+             pending.clear();
+         }
+     }
+     
+     return result;
+ }
+ 
+ } // anonymous namespace
+ 
+ const Corpus& corpus() {
+     static const Corpus instance = load_corpus();
+     return instance;
+ }
+ 
+ std::string payload_of(const std::string& sentence) {
+     std::vector<std::string> fields = NMEAUtils::parse_fields(sentence);
+     return fields.size() > 5 ? fields[5] : std::string();
+ }
+ 
+ } // namespace bench
+ } // namespace aislib
@@ -0,0 +1,54 @@
+/**
+ * @file bench_corpus.h
+ * @brief Benchmark corpus loading
+ * 
+ * Loads the committed NMEA corpus and groups its sentences by AIS message
+ * type so benchmarks can run over a realistic mix or a single type.
+ */
+
+ #ifndef AISLIB_BENCH_CORPUS_H
+ #define AISLIB_BENCH_CORPUS_H
+ 
+ #include <map>
+ #include <string>
+ #include <vector>
+ 
+ namespace aislib {
+ namespace bench {
+ 
+ /**
+  * @struct Corpus
+  * @brief Sentences of the benchmark corpus
+  */
+ struct Corpus {
+     // All sentences in file order
+     std::vector<std::string> sentences;
+     
+     // Complete messages (one or more sentences each) keyed by message type
+     std::map<int, std::vector<std::vector<std::string>>> messages_by_type;
+     
+     // Number of complete messages in the corpus
+     size_t message_count = 0;
+ };
+ 
+ /**
+  * @brief Get the shared benchmark corpus
+  * @return Reference to the corpus, loaded on first use
+  * @throws std::runtime_error if the corpus file cannot be read
+  * 
+  * The corpus path defaults to the committed synthetic corpus and can be
+  * overridden with the AISLIB_BENCH_CORPUS environment variable.
+  */
+ const Corpus& corpus();
+ 
+ /**
+  * @brief Extract the payload field of an AIVDM sentence
+  * @param sentence NMEA sentence
+  * @return Payload (6th field)
+  */
+ std::string payload_of(const std::string& sentence);
+ 
+ } // namespace bench
+ } // namespace aislib
+ 
+ #endif // AISLIB_BENCH_CORPUS_H
@@ -0,0 +1,144 @@
+/**
+ * @file perf_counters.cpp
+ * @brief perf_event_open based hardware counters
+ */
+
+ #include "perf_counters.h"
+ #include <cstdlib>
+ #include <cstring>
+ #include <iostream>
+ #include <mutex>
+
+ #ifdef __linux__
+ #include <cerrno>
+ #include <linux/perf_event.h>
+ #include <sys/ioctl.h>
+ #include <sys/syscall.h>
+ #include <unistd.h>
+ #endif
+
+ namespace aislib {
+ namespace bench {
+
+ namespace {
+
+ #ifdef __linux__
+ // Records errno of the first failure in error, before anything else can overwrite it
+ int open_event(uint32_t type, uint64_t config, int& error) {
+     perf_event_attr attr;
+     std::memset(&attr, 0, sizeof(attr));
+     attr.size = sizeof(attr);
+     attr.type = type;
+     attr.config = config;
+     attr.exclude_kernel = 1;
+     attr.exclude_hv = 1;
+     attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+     // Calling thread, any CPU, no group
+     int fd = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+     if (fd < 0 && error == 0) {
+         error = errno;
+     }
+     return fd;
+ }
+
+ uint64_t cache_miss(uint64_t cache) {
+     return cache | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+ }
+ #endif
+
+ // Counters are per thread; the notice that they are unavailable is printed once per process
+ std::once_flag unavailable_notice;
+
+ } // anonymous namespace
+
+ PerfCounters& PerfCounters::instance() {
+     thread_local PerfCounters counters;
+     return counters;
+ }
+
+ PerfCounters::PerfCounters() {
+     fds_.fill(-1);
+
+     const char* setting = std::getenv("AISLIB_BENCH_PERF");
+     if (setting != nullptr && std::strcmp(setting, "0") == 0) {
+         return;
+     }
+
+ #ifdef __linux__
+     int error = 0;
+     fds_[CYCLES] = open_event(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES, error);
+     fds_[INSTRUCTIONS] = open_event(PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS, error);
+     fds_[BRANCH_MISSES] = open_event(PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES, error);
+     fds_[L1D_MISSES] = open_event(PERF_TYPE_HW_CACHE, cache_miss(PERF_COUNT_HW_CACHE_L1D), error);
+     fds_[LLC_MISSES] = open_event(PERF_TYPE_HW_CACHE, cache_miss(PERF_COUNT_HW_CACHE_LL), error);
+
+     if (!available()) {
+         std::call_once(unavailable_notice, [error]() {
+             std::cerr << "Hardware counters unavailable (perf_event_open: " << std::strerror(error)
+                       << "); reporting wall time only" << std::endl;
+         });
+     }
+ #else
+     std::call_once(unavailable_notice, []() {
+         std::cerr << "Hardware counters are only supported on Linux; reporting wall time only" << std::endl;
+     });
+ #endif
+ }
+
+ PerfCounters::~PerfCounters() {
+ #ifdef __linux__
+     for (int fd : fds_) {
+         if (fd >= 0) {
+             close(fd);
+         }
+     }
+ #endif
+ }
+
+ bool PerfCounters::available() const {
+     for (int fd : fds_) {
+         if (fd >= 0) {
+             return true;
+         }
+     }
+     return false;
+ }
+
+ PerfCounters::Values PerfCounters::read() const {
+     Values values;
+     values.fill(-1.0);
+
+ #ifdef __linux__
+     for (size_t i = 0; i < fds_.size(); ++i) {
+         if (fds_[i] < 0) {
+             continue;
+         }
+
+         // value, time enabled, time running
+         uint64_t data[3] = {0, 0, 0};
+         if (::read(fds_[i], data, sizeof(data)) != static_cast<ssize_t>(sizeof(data)) || data[2] == 0) {
+             continue;
+         }
+
+         // Scale up when the kernel multiplexed the counter
+         values[i] = static_cast<double>(data[0]) * static_cast<double>(data[1]) / static_cast<double>(data[2]);
+     }
+ #endif
+
+     return values;
+ }
+
+ const char* PerfCounters::counter_name(Event event) {
+     switch (event) {
+         case CYCLES: return "cycles/msg";
+         case INSTRUCTIONS: return "instr/msg";
+         case BRANCH_MISSES: return "br-miss/msg";
+         case L1D_MISSES: return "L1d-miss/msg";
+         case LLC_MISSES: return "LLC-miss/msg";
+         default: return "unknown";
+     }
+ }
+
+ } // namespace bench
+ } // namespace aislib
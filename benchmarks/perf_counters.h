@@ -0,0 +1,80 @@
+/**
+ * @file perf_counters.h
+ * @brief Hardware performance counters for benchmarks
+ *
+ * On Linux the counters are read through perf_event_open for the calling
+ * thread, user space only. Where the syscall is missing or not permitted
+ * (other platforms, containers, perf_event_paranoid) the counters are
+ * simply not reported.
+ */
+
+ #ifndef AISLIB_BENCH_PERF_COUNTERS_H
+ #define AISLIB_BENCH_PERF_COUNTERS_H
+
+ #include <array>
+ #include <cstdint>
+ #include <string>
+
+ namespace aislib {
+ namespace bench {
+
+ /**
+  * @class PerfCounters
+  * @brief Free-running hardware counters of the calling thread
+  */
+ class PerfCounters {
+ public:
+     /// Counted events
+     enum Event {
+         CYCLES,
+         INSTRUCTIONS,
+         BRANCH_MISSES,
+         L1D_MISSES,
+         LLC_MISSES,
+         EVENT_COUNT
+     };
+
+     /// Counter values; a negative value means the event is unavailable
+     using Values = std::array<double, EVENT_COUNT>;
+
+     /**
+      * @brief Get the counters of the calling thread, opening them on first use
+      * @return Counters (possibly with no available events)
+      *
+      * Set AISLIB_BENCH_PERF=0 to skip opening the counters.
+      */
+     static PerfCounters& instance();
+
+     PerfCounters(const PerfCounters&) = delete;
+     PerfCounters& operator=(const PerfCounters&) = delete;
+     ~PerfCounters();
+
+     /**
+      * @brief Check whether any event could be opened
+      * @return True if at least one counter is available
+      */
+     bool available() const;
+
+     /**
+      * @brief Read the current counter values
+      * @return Values, scaled for multiplexing
+      */
+     Values read() const;
+
+     /**
+      * @brief Get the benchmark counter name of an event
+      * @param event Event
+      * @return Name, e.g. "cycles/msg"
+      */
+     static const char* counter_name(Event event);
+
+ private:
+     PerfCounters();
+
+     std::array<int, EVENT_COUNT> fds_;
+ };
+
+ } // namespace bench
+ } // namespace aislib
+
+ #endif // AISLIB_BENCH_PERF_COUNTERS_H
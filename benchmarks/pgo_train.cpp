@@ -0,0 +1,53 @@
+/**
+ * @file pgo_train.cpp
+ * @brief Training workload for profile-guided optimization
+ *
+ * Runs the benchmark corpus through the decode and encode paths so that an
+ * instrumented library records a representative profile. Built only when
+ * AISLIB_PGO_MODE is GENERATE or USE; driven by the aislib_pgo target.
+ */
+
+ #include "bench_corpus.h"
+ #include "aislib/ais_parser.h"
+ #include "aislib/ais_message.h"
+ #include <cstdlib>
+ #include <iostream>
+ #include <string>
+ #include <vector>
+
+ using namespace aislib;
+ using namespace aislib::bench;
+
+ int main(int argc, char* argv[]) {
+     size_t passes = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 20;
+
+     try {
+         const auto& sentences = corpus().sentences;
+         AISParser parser;
+         size_t decoded = 0;
+         size_t encoded = 0;
+
+         for (size_t pass = 0; pass < passes; ++pass) {
+             for (const auto& sentence : sentences) {
+                 auto message = parser.parse(sentence);
+                 if (!message) {
+                     continue;
+                 }
+                 ++decoded;
+
+                 // Encoding is part of the library's hot paths too
+                 if (pass % 4 == 0) {
+                     encoded += message->to_nmea().size();
+                 }
+             }
+         }
+
+         std::cout << "Trained on " << passes << " passes: " << decoded << " messages decoded, "
+                   << encoded << " sentences encoded" << std::endl;
+     } catch (const std::exception& e) {
+         std::cerr << "Error: " << e.what() << std::endl;
+         return 1;
+     }
+
+     return 0;
+ }
@@ -0,0 +1,490 @@
+/**
+ * @file scaling_bench.cpp
+ * @brief Multi-core scaling benchmark for parsing and reassembly
+ *
+ * One producer thread feeds the benchmark corpus to 1..N parser threads,
+ * each with its own AISParser. The benchmark reports throughput, end-to-end
+ * latency percentiles (enqueue to parsed) and whether multi-part messages
+ * were still reassembled, for two ways of distributing sentences:
+ *
+ *   sharded  every worker has its own single-producer queue; fragments of
+ *            a multi-part message go to the worker chosen by the hash of
+ *            (sequential message ID, channel), single-part sentences are
+ *            dealt round-robin
+ *   shared   all workers pop from one mutex-protected queue
+ *
+ * Contention is reported as producer stalls (target queue full) and, for
+ * the shared queue, the time workers spend acquiring the queue lock. Time
+ * workers spend waiting on an empty queue is counted as idle; a run where
+ * they are mostly idle is bound by the single producer, not by parsing.
+ *
+ * By default the producer runs flat out, so latency includes queueing
+ * behind a full queue; --rate paces the producer to measure latency at a
+ * given offered load instead.
+ */
+
+ #include "bench_corpus.h"
+ #include "aislib/ais_parser.h"
+ #include "aislib/metrics.h"
+ #include <algorithm>
+ #include <atomic>
+ #include <chrono>
+ #include <condition_variable>
+ #include <cstdio>
+ #include <deque>
+ #include <functional>
+ #include <iostream>
+ #include <memory>
+ #include <mutex>
+ #include <string>
+ #include <string_view>
+ #include <thread>
+ #include <vector>
+
+ using namespace aislib;
+ using namespace aislib::bench;
+ using Clock = std::chrono::steady_clock;
+
+ namespace {
+
+ constexpr size_t kSinglePart = static_cast<size_t>(-1);
+ constexpr size_t kQueueCapacity = 4096;
+
+ // A sentence in flight
+ struct Item {
+     const std::string* sentence;
+     Clock::time_point enqueued;
+ };
+
+ /**
+  * @class SpscQueue
+  * @brief Bounded lock-free single-producer single-consumer ring
+  */
+ class SpscQueue {
+ public:
+     explicit SpscQueue(size_t capacity) : slots_(capacity) {}
+
+     bool try_push(const Item& item) {
+         size_t tail = tail_.load(std::memory_order_relaxed);
+         if (tail - head_.load(std::memory_order_acquire) == slots_.size()) {
+             return false;
+         }
+         slots_[tail % slots_.size()] = item;
+         tail_.store(tail + 1, std::memory_order_release);
+         return true;
+     }
+
+     bool try_pop(Item& item) {
+         size_t head = head_.load(std::memory_order_relaxed);
+         if (head == tail_.load(std::memory_order_acquire)) {
+             return false;
+         }
+         item = slots_[head % slots_.size()];
+         head_.store(head + 1, std::memory_order_release);
+         return true;
+     }
+
+ private:
+     std::vector<Item> slots_;
+     alignas(64) std::atomic<size_t> head_{0};
+     alignas(64) std::atomic<size_t> tail_{0};
+ };
+
+ /**
+  * @class SharedQueue
+  * @brief Bounded multi-consumer queue behind one mutex
+  */
+ class SharedQueue {
+ public:
+     explicit SharedQueue(size_t capacity) : capacity_(capacity), closed_(false) {}
+
+     // Returns true if the producer had to wait for space
+     bool push(const Item& item) {
+         std::unique_lock<std::mutex> lock(mutex_);
+         bool stalled = items_.size() >= capacity_;
+         not_full_.wait(lock, [this] { return items_.size() < capacity_; });
+         items_.push_back(item);
+         lock.unlock();
+         not_empty_.notify_one();
+         return stalled;
+     }
+
+     // Returns false once the queue is closed and drained
+     bool pop(Item& item, Clock::duration& lock_wait, Clock::duration& idle) {
+         auto start = Clock::now();
+         std::unique_lock<std::mutex> lock(mutex_);
+         auto locked = Clock::now();
+         lock_wait += locked - start;
+         if (items_.empty() && !closed_) {
+             not_empty_.wait(lock, [this] { return !items_.empty() || closed_; });
+             idle += Clock::now() - locked;
+         }
+         if (items_.empty()) {
+             return false;
+         }
+         item = items_.front();
+         items_.pop_front();
+         lock.unlock();
+         not_full_.notify_one();
+         return true;
+     }
+
+     void close() {
+         {
+             std::lock_guard<std::mutex> lock(mutex_);
+             closed_ = true;
+         }
+         not_empty_.notify_all();
+     }
+
+ private:
+     std::mutex mutex_;
+     std::condition_variable not_empty_;
+     std::condition_variable not_full_;
+     std::deque<Item> items_;
+     size_t capacity_;
+     bool closed_;
+ };
+
+ // Per-worker results, padded to keep workers off each other's cache lines
+ struct alignas(64) WorkerResult {
+     uint64_t sentences = 0;
+     uint64_t decoded = 0;
+     Clock::duration lock_wait{0};
+     Clock::duration idle{0};   // Waiting on an empty queue
+ };
+
+ struct RunResult {
+     size_t threads = 0;
+     uint64_t sentences = 0;
+     uint64_t decoded = 0;
+     double seconds = 0.0;
+     uint64_t producer_stalls = 0;
+     double lock_wait_seconds = 0.0;
+     double idle_seconds = 0.0;
+     HistogramSnapshot latency;
+
+     double throughput() const {
+         return seconds > 0.0 ? static_cast<double>(sentences) / seconds : 0.0;
+     }
+ };
+
+ // Hash of (message ID, channel) for fragments of multi-part messages, kSinglePart otherwise
+ size_t fragment_key(const std::string& sentence) {
+     size_t commas[5];
+     size_t position = 0;
+     for (size_t& comma : commas) {
+         comma = sentence.find(',', position);
+         if (comma == std::string::npos) {
+             return kSinglePart;
+         }
+         position = comma + 1;
+     }
+
+     std::string_view view(sentence);
+     if (view.substr(commas[0] + 1, commas[1] - commas[0] - 1) == "1") {
+         return kSinglePart;
+     }
+     return std::hash<std::string_view>()(view.substr(commas[2] + 1, commas[4] - commas[2] - 1));
+ }
+
+ /**
+  * @class Pacer
+  * @brief Spaces out the producer to a target rate (0 = unpaced)
+  */
+ class Pacer {
+ public:
+     explicit Pacer(double rate) : interval_(rate > 0.0 ? 1.0 / rate : 0.0), start_(Clock::now()), count_(0) {}
+
+     void wait() {
+         if (interval_ > 0.0) {
+             auto due = start_ + std::chrono::duration_cast<Clock::duration>(
+                 std::chrono::duration<double>(interval_ * static_cast<double>(count_)));
+             while (Clock::now() < due) {
+                 std::this_thread::yield();
+             }
+         }
+         ++count_;
+     }
+
+ private:
+     double interval_;
+     Clock::time_point start_;
+     uint64_t count_;
+ };
+
+ AISParser::ParserConfig worker_config() {
+     AISParser::ParserConfig config;
+     config.max_incomplete_messages = 10000;
+     return config;
+ }
+
+ // Parse one sentence and record its end-to-end latency
+ void process(AISParser& parser, const Item& item, WorkerResult& result, MetricsRegistry& latency) {
+     auto message = parser.parse(*item.sentence);
+     latency.record_parse_latency(Clock::now() - item.enqueued);
+     ++result.sentences;
+     if (message) {
+         ++result.decoded;
+     }
+ }
+
+ RunResult run_sharded(const std::vector<std::string>& sentences, const std::vector<size_t>& keys,
+                       size_t threads, size_t repeat, double rate) {
+     MetricsRegistry latency(threads);
+     std::vector<std::unique_ptr<SpscQueue>> queues;
+     for (size_t t = 0; t < threads; ++t) {
+         queues.push_back(std::make_unique<SpscQueue>(kQueueCapacity));
+     }
+     std::vector<WorkerResult> results(threads);
+     std::atomic<bool> done{false};
+
+     std::vector<std::thread> workers;
+     for (size_t t = 0; t < threads; ++t) {
+         workers.emplace_back([&, t]() {
+             AISParser parser(worker_config());
+             Item item;
+             while (true) {
+                 if (queues[t]->try_pop(item)) {
+                     process(parser, item, results[t], latency);
+                 } else if (done.load(std::memory_order_acquire)) {
+                     // Drain whatever was pushed before the flag was set
+                     while (queues[t]->try_pop(item)) {
+                         process(parser, item, results[t], latency);
+                     }
+                     break;
+                 } else {
+                     auto start = Clock::now();
+                     std::this_thread::yield();
+                     results[t].idle += Clock::now() - start;
+                 }
+             }
+         });
+     }
+
+     RunResult run;
+     size_t next_worker = 0;
+     auto start = Clock::now();
+     Pacer pacer(rate);
+     for (size_t r = 0; r < repeat; ++r) {
+         for (size_t i = 0; i < sentences.size(); ++i) {
+             pacer.wait();
+             size_t worker = keys[i] == kSinglePart ? next_worker++ % threads : keys[i] % threads;
+             Item item{&sentences[i], Clock::now()};
+             if (!queues[worker]->try_push(item)) {
+                 ++run.producer_stalls;
+                 while (!queues[worker]->try_push(item)) {
+                     std::this_thread::yield();
+                 }
+             }
+         }
+     }
+     done.store(true, std::memory_order_release);
+     for (auto& worker : workers) {
+         worker.join();
+     }
+     run.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+     run.threads = threads;
+     for (const auto& result : results) {
+         run.sentences += result.sentences;
+         run.decoded += result.decoded;
+         run.idle_seconds += std::chrono::duration<double>(result.idle).count();
+     }
+     run.latency = latency.snapshot().parse_latency;
+     return run;
+ }
+
+ RunResult run_shared(const std::vector<std::string>& sentences, size_t threads, size_t repeat, double rate) {
+     MetricsRegistry latency(threads);
+     SharedQueue queue(kQueueCapacity);
+     std::vector<WorkerResult> results(threads);
+
+     std::vector<std::thread> workers;
+     for (size_t t = 0; t < threads; ++t) {
+         workers.emplace_back([&, t]() {
+             AISParser parser(worker_config());
+             Item item;
+             while (queue.pop(item, results[t].lock_wait, results[t].idle)) {
+                 process(parser, item, results[t], latency);
+             }
+         });
+     }
+
+     RunResult run;
+     auto start = Clock::now();
+     Pacer pacer(rate);
+     for (size_t r = 0; r < repeat; ++r) {
+         for (const auto& sentence : sentences) {
+             pacer.wait();
+             if (queue.push(Item{&sentence, Clock::now()})) {
+                 ++run.producer_stalls;
+             }
+         }
+     }
+     queue.close();
+     for (auto& worker : workers) {
+         worker.join();
+     }
+     run.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+     run.threads = threads;
+     for (const auto& result : results) {
+         run.sentences += result.sentences;
+         run.decoded += result.decoded;
+         run.lock_wait_seconds += std::chrono::duration<double>(result.lock_wait).count();
+         run.idle_seconds += std::chrono::duration<double>(result.idle).count();
+     }
+     run.latency = latency.snapshot().parse_latency;
+     return run;
+ }
+
+ // Messages a single parser decodes from the same input
+ uint64_t expected_messages(const std::vector<std::string>& sentences, size_t repeat) {
+     AISParser parser(worker_config());
+     uint64_t decoded = 0;
+     for (size_t r = 0; r < repeat; ++r) {
+         for (const auto& sentence : sentences) {
+             if (parser.parse(sentence)) {
+                 ++decoded;
+             }
+         }
+     }
+     return decoded;
+ }
+
+ void print_usage(const char* program_name) {
+     std::cout << "Usage: " << program_name << " [options]" << std::endl;
+     std::cout << "Options:" << std::endl;
+     std::cout << "  -t, --threads <count>   Maximum number of parser threads (default: hardware threads)" << std::endl;
+     std::cout << "  -m, --mode <mode>       sharded, shared or both (default both)" << std::endl;
+     std::cout << "  -r, --repeat <count>    Passes over the corpus per run (default 20)" << std::endl;
+     std::cout << "      --rate <sentences/s> Offered load (default: as fast as the workers take them)" << std::endl;
+     std::cout << "  -h, --help              Display this help message" << std::endl;
+     std::cout << "The corpus can be changed with the AISLIB_BENCH_CORPUS environment variable." << std::endl;
+ }
+
+ void print_series(const char* mode, const std::vector<RunResult>& runs, uint64_t expected, bool paced) {
+     std::printf("\n%s\n", mode);
+     std::printf("%7s %12s %8s %6s %9s %9s %9s %10s %8s\n",
+                 "threads", "sentences/s", "speedup", "eff", "p50 us", "p99 us", "p999 us", "decoded", "stalls");
+
+     double base = runs.front().throughput();
+     for (const auto& run : runs) {
+         double speedup = base > 0.0 ? run.throughput() / base : 0.0;
+         std::printf("%7zu %12.0f %8.2f %5.0f%% %9.1f %9.1f %9.1f %10llu %8llu\n",
+                     run.threads, run.throughput(), speedup,
+                     100.0 * speedup / static_cast<double>(run.threads),
+                     static_cast<double>(run.latency.value_at_quantile(0.5)) / 1000.0,
+                     static_cast<double>(run.latency.value_at_quantile(0.99)) / 1000.0,
+                     static_cast<double>(run.latency.value_at_quantile(0.999)) / 1000.0,
+                     static_cast<unsigned long long>(run.decoded),
+                     static_cast<unsigned long long>(run.producer_stalls));
+     }
+
+     // Flags
+     for (const auto& run : runs) {
+         if (run.decoded != expected) {
+             std::printf("  ! %zu threads: reassembly lost %lld of %llu messages\n", run.threads,
+                         static_cast<long long>(expected) - static_cast<long long>(run.decoded),
+                         static_cast<unsigned long long>(expected));
+         }
+         if (!paced && run.threads > 1 && run.throughput() < 0.5 * base * static_cast<double>(run.threads)) {
+             std::printf("  ! %zu threads: below 50%% scaling efficiency\n", run.threads);
+         }
+         if (run.sentences > 0 && run.producer_stalls * 10 > run.sentences) {
+             std::printf("  ! %zu threads: producer stalled on %.0f%% of sentences (workers saturated)\n",
+                         run.threads, 100.0 * static_cast<double>(run.producer_stalls) /
+                                          static_cast<double>(run.sentences));
+         }
+         if (run.lock_wait_seconds > 0.1 * run.seconds * static_cast<double>(run.threads)) {
+             std::printf("  ! %zu threads: workers spent %.0f%% of their time acquiring the queue lock\n",
+                         run.threads, 100.0 * run.lock_wait_seconds /
+                                          (run.seconds * static_cast<double>(run.threads)));
+         }
+         // Idle workers are expected when the producer is paced
+         if (!paced && run.idle_seconds > 0.5 * run.seconds * static_cast<double>(run.threads)) {
+             std::printf("  ! %zu threads: workers idle %.0f%% of the time on an empty queue (producer-bound)\n",
+                         run.threads, 100.0 * run.idle_seconds /
+                                          (run.seconds * static_cast<double>(run.threads)));
+         }
+     }
+ }
+
+ } // anonymous namespace
+
+ int main(int argc, char* argv[]) {
+     size_t max_threads = std::max(1u, std::thread::hardware_concurrency());
+     std::string mode = "both";
+     size_t repeat = 20;
+     double rate = 0.0;
+
+     try {
+         for (int i = 1; i < argc; ++i) {
+             std::string arg = argv[i];
+             auto value = [&]() -> std::string {
+                 if (i + 1 >= argc) {
+                     throw std::invalid_argument("Missing value after " + arg);
+                 }
+                 return argv[++i];
+             };
+
+             if (arg == "-h" || arg == "--help") {
+                 print_usage(argv[0]);
+                 return 0;
+             } else if (arg == "-t" || arg == "--threads") {
+                 max_threads = std::max<size_t>(1, std::stoul(value()));
+             } else if (arg == "-m" || arg == "--mode") {
+                 mode = value();
+             } else if (arg == "-r" || arg == "--repeat") {
+                 repeat = std::max<size_t>(1, std::stoul(value()));
+             } else if (arg == "--rate") {
+                 rate = std::stod(value());
+             } else {
+                 std::cerr << "Error: Unknown option " << arg << std::endl;
+                 print_usage(argv[0]);
+                 return 1;
+             }
+         }
+         if (mode != "sharded" && mode != "shared" && mode != "both") {
+             throw std::invalid_argument("Unknown mode: " + mode);
+         }
+
+         const std::vector<std::string>& sentences = corpus().sentences;
+         std::vector<size_t> keys;
+         for (const auto& sentence : sentences) {
+             keys.push_back(fragment_key(sentence));
+         }
+
+         // 1, 2, 4, ... up to and including the maximum
+         std::vector<size_t> thread_counts;
+         for (size_t n = 1; n < max_threads; n *= 2) {
+             thread_counts.push_back(n);
+         }
+         thread_counts.push_back(max_threads);
+
+         uint64_t expected = expected_messages(sentences, repeat);
+         std::printf("%zu sentences x %zu passes, %llu messages expected\n", sentences.size(), repeat,
+                     static_cast<unsigned long long>(expected));
+
+         if (mode != "shared") {
+             std::vector<RunResult> runs;
+             for (size_t threads : thread_counts) {
+                 runs.push_back(run_sharded(sentences, keys, threads, repeat, rate));
+             }
+             print_series("sharded (per-worker SPSC queues, routed by message ID and channel)", runs, expected, rate > 0.0);
+         }
+         if (mode != "sharded") {
+             std::vector<RunResult> runs;
+             for (size_t threads : thread_counts) {
+                 runs.push_back(run_shared(sentences, threads, repeat, rate));
+             }
+             print_series("shared (one mutex-protected queue)", runs, expected, rate > 0.0);
+         }
+     } catch (const std::exception& e) {
+         std::cerr << "Error: " << e.what() << std::endl;
+         return 1;
+     }
+
+     return 0;
+ }
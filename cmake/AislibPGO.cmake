@@ -0,0 +1,121 @@
+# Profile-guided optimization for aislib
+#
+# AISLIB_PGO_MODE selects the phase of the current build tree:
+#   OFF       normal build; defines the aislib_pgo target that runs the whole workflow
+#   GENERATE  instrument aislib and build the aislib_pgo_train workload
+#   USE       optimize aislib with the recorded profile and link-time optimization
+#
+# The aislib_pgo target configures a nested tree in <build>/pgo, builds it
+# instrumented, runs the training workload over the benchmark corpus, then
+# reconfigures the same tree with the profile and builds it again. The same
+# tree is reused for both phases because GCC locates .gcda files by object
+# path. Supported with GCC and Clang (llvm-profdata is needed for Clang).
+
+set(AISLIB_PGO_MODE "OFF" CACHE STRING "Profile-guided optimization phase (OFF, GENERATE, USE)")
+set_property(CACHE AISLIB_PGO_MODE PROPERTY STRINGS OFF GENERATE USE)
+set(AISLIB_PGO_PROFILE_DIR "${CMAKE_BINARY_DIR}/pgo-profile" CACHE PATH "Directory for profile data")
+
+set(_aislib_pgo_supported OFF)
+if(CMAKE_CXX_COMPILER_ID STREQUAL "GNU" OR CMAKE_CXX_COMPILER_ID MATCHES "Clang")
+    set(_aislib_pgo_supported ON)
+endif()
+
+if(NOT AISLIB_PGO_MODE STREQUAL "OFF")
+    if(NOT _aislib_pgo_supported)
+        message(FATAL_ERROR "AISLIB_PGO_MODE requires GCC or Clang")
+    endif()
+
+    # Training workload
+    add_executable(
+        aislib_pgo_train
+        benchmarks/pgo_train.cpp
+        benchmarks/bench_corpus.cpp
+    )
+    target_compile_definitions(
+        aislib_pgo_train
+        PRIVATE
+            AISLIB_BENCH_CORPUS_PATH="${CMAKE_CURRENT_SOURCE_DIR}/benchmarks/data/synthetic_mix.nmea"
+    )
+    target_link_libraries(aislib_pgo_train aislib)
+endif()
+
+if(AISLIB_PGO_MODE STREQUAL "GENERATE")
+    if(CMAKE_CXX_COMPILER_ID STREQUAL "GNU")
+        set(_aislib_pgo_flags -fprofile-generate=${AISLIB_PGO_PROFILE_DIR} -fprofile-update=atomic)
+    else()
+        set(_aislib_pgo_flags -fprofile-generate=${AISLIB_PGO_PROFILE_DIR})
+    endif()
+    target_compile_options(aislib PRIVATE ${_aislib_pgo_flags})
+    # Executables linking the instrumented library need the profiling runtime
+    target_link_options(aislib INTERFACE ${_aislib_pgo_flags})
+
+elseif(AISLIB_PGO_MODE STREQUAL "USE")
+    if(CMAKE_CXX_COMPILER_ID STREQUAL "GNU")
+        target_compile_options(aislib PRIVATE
+            -fprofile-use=${AISLIB_PGO_PROFILE_DIR}
+            -fprofile-correction
+            -Wno-missing-profile
+        )
+    else()
+        target_compile_options(aislib PRIVATE
+            -fprofile-use=${AISLIB_PGO_PROFILE_DIR}/aislib.profdata
+            -Wno-profile-instr-unprofiled
+            -Wno-profile-instr-out-of-date
+        )
+    endif()
+
+    include(CheckIPOSupported)
+    check_ipo_supported(RESULT _aislib_ipo_supported OUTPUT _aislib_ipo_output LANGUAGES CXX)
+    if(_aislib_ipo_supported)
+        set_property(TARGET aislib aislib_pgo_train PROPERTY INTERPROCEDURAL_OPTIMIZATION TRUE)
+    else()
+        message(WARNING "LTO is not supported by this toolchain: ${_aislib_ipo_output}")
+    endif()
+
+elseif(NOT AISLIB_PGO_MODE STREQUAL "OFF")
+    message(FATAL_ERROR "Invalid AISLIB_PGO_MODE: ${AISLIB_PGO_MODE}")
+
+elseif(_aislib_pgo_supported)
+    set(_aislib_pgo_dir "${CMAKE_BINARY_DIR}/pgo")
+    set(_aislib_pgo_profile "${_aislib_pgo_dir}/profile")
+    set(_aislib_pgo_args
+        -DCMAKE_BUILD_TYPE=Release
+        -DCMAKE_CXX_COMPILER=${CMAKE_CXX_COMPILER}
+        -DAISLIB_BUILD_TESTS=OFF
+        -DAISLIB_BUILD_EXAMPLES=OFF
+        -DAISLIB_BUILD_TOOLS=OFF
+        -DAISLIB_BUILD_BENCHMARKS=OFF
+        -DAISLIB_BUILD_FUZZERS=OFF
+        -DAISLIB_PGO_PROFILE_DIR=${_aislib_pgo_profile}
+    )
+
+    if(CMAKE_CXX_COMPILER_ID MATCHES "Clang")
+        string(REGEX MATCH "^[0-9]+" _aislib_clang_major "${CMAKE_CXX_COMPILER_VERSION}")
+        get_filename_component(_aislib_compiler_dir "${CMAKE_CXX_COMPILER}" DIRECTORY)
+        find_program(AISLIB_LLVM_PROFDATA
+            NAMES llvm-profdata llvm-profdata-${_aislib_clang_major}
+            HINTS ${_aislib_compiler_dir}
+        )
+    endif()
+
+    add_custom_target(
+        aislib_pgo
+        COMMAND ${CMAKE_COMMAND} -E remove_directory ${_aislib_pgo_profile}
+        COMMAND ${CMAKE_COMMAND} -S ${CMAKE_CURRENT_SOURCE_DIR} -B ${_aislib_pgo_dir}/build
+                ${_aislib_pgo_args} -DAISLIB_PGO_MODE=GENERATE
+        COMMAND ${CMAKE_COMMAND} --build ${_aislib_pgo_dir}/build --target aislib_pgo_train
+        COMMAND ${_aislib_pgo_dir}/build/aislib_pgo_train
+        COMMAND ${CMAKE_COMMAND}
+                -DCOMPILER_ID=${CMAKE_CXX_COMPILER_ID}
+                -DPROFILE_DIR=${_aislib_pgo_profile}
+                -DLLVM_PROFDATA=${AISLIB_LLVM_PROFDATA}
+                -P ${CMAKE_CURRENT_SOURCE_DIR}/cmake/AislibPGOMerge.cmake
+        COMMAND ${CMAKE_COMMAND} -S ${CMAKE_CURRENT_SOURCE_DIR} -B ${_aislib_pgo_dir}/build
+                ${_aislib_pgo_args} -DAISLIB_PGO_MODE=USE
+        COMMAND ${CMAKE_COMMAND} --build ${_aislib_pgo_dir}/build
+        COMMAND ${CMAKE_COMMAND} -E echo "Profile-optimized aislib: ${_aislib_pgo_dir}/build"
+        WORKING_DIRECTORY ${CMAKE_BINARY_DIR}
+        COMMENT "Building aislib with profile-guided optimization"
+        VERBATIM
+    )
+endif()
@@ -0,0 +1,29 @@
+# Check the profile recorded by the aislib_pgo training run and, for Clang,
+# merge the raw profiles into aislib.profdata.
+#
+# Expects COMPILER_ID, PROFILE_DIR and (for Clang) LLVM_PROFDATA.
+
+if(COMPILER_ID STREQUAL "GNU")
+    file(GLOB_RECURSE _profiles "${PROFILE_DIR}/*.gcda")
+    if(NOT _profiles)
+        message(FATAL_ERROR "No .gcda files in ${PROFILE_DIR}; did the training run succeed?")
+    endif()
+    list(LENGTH _profiles _count)
+    message(STATUS "Recorded ${_count} GCC profile files")
+else()
+    file(GLOB _raw_profiles "${PROFILE_DIR}/*.profraw")
+    if(NOT _raw_profiles)
+        message(FATAL_ERROR "No .profraw files in ${PROFILE_DIR}; did the training run succeed?")
+    endif()
+    if(NOT LLVM_PROFDATA)
+        message(FATAL_ERROR "llvm-profdata not found; set AISLIB_LLVM_PROFDATA")
+    endif()
+    execute_process(
+        COMMAND ${LLVM_PROFDATA} merge -output=${PROFILE_DIR}/aislib.profdata ${_raw_profiles}
+        RESULT_VARIABLE _result
+    )
+    if(NOT _result EQUAL 0)
+        message(FATAL_ERROR "llvm-profdata merge failed")
+    endif()
+    message(STATUS "Merged Clang profile into ${PROFILE_DIR}/aislib.profdata")
+endif()
@@ -0,0 +1,296 @@
+/**
+ * @file differential_fuzz.cpp
+ * @brief Differential fuzz target comparing the fast paths with reference implementations
+ *
+ * Every input is run through the reference and the optimized code and the
+ * results must be identical:
+ *  - the checksum, de-armoring and comma kernels of every supported CPU
+ *    level against the scalar kernels
+ *  - BitVector::get_uint/get_int/get_string against a bit-at-a-time reference
+ *  - BitVector::assign_payload against a reference that appends bit by bit
+ *  - message construction from both bit vectors
+ *  - AISParser, sentence by sentence, with each CPU level forced in turn
+ *
+ * A mismatch prints both results and aborts, which libFuzzer and the
+ * standalone driver report as a failure.
+ */
+
+ #include "aislib/ais_parser.h"
+ #include "aislib/ais_message.h"
+ #include "aislib/bit_vector.h"
+ #include "aislib/cpu_dispatch.h"
+ #include "aislib/message_factory.h"
+ #include <algorithm>
+ #include <cstdint>
+ #include <cstdlib>
+ #include <iostream>
+ #include <memory>
+ #include <stdexcept>
+ #include <string>
+ #include <vector>
+
+ using namespace aislib;
+
+ namespace {
+
+ [[noreturn]] void mismatch(const std::string& what, const std::string& expected, const std::string& actual) {
+     std::cerr << "Differential mismatch in " << what << "\n"
+               << "  reference: " << expected << "\n"
+               << "  optimized: " << actual << std::endl;
+     std::abort();
+ }
+
+ void check(bool same, const std::string& what, const std::string& expected, const std::string& actual) {
+     if (!same) {
+         mismatch(what, expected, actual);
+     }
+ }
+
+ // ---- Reference implementations ----
+
+ uint64_t reference_get_uint(const BitVector& bits, size_t start, size_t count) {
+     uint64_t result = 0;
+     for (size_t i = 0; i < count; ++i) {
+         result = (result << 1) | (bits.get_bit(start + i) ? 1 : 0);
+     }
+     return result;
+ }
+
+ int64_t reference_get_int(const BitVector& bits, size_t start, size_t count) {
+     uint64_t value = reference_get_uint(bits, start, count);
+     if (count > 0 && count < 64 && (value >> (count - 1)) & 1) {
+         value |= ~((uint64_t(1) << count) - 1);
+     }
+     return static_cast<int64_t>(value);
+ }
+
+ std::string reference_get_string(const BitVector& bits, size_t start, size_t count) {
+     std::string text;
+     for (size_t i = 0; i + 6 <= count; i += 6) {
+         uint8_t value = static_cast<uint8_t>(reference_get_uint(bits, start + i, 6));
+         text += static_cast<char>(value < 32 ? value + 64 : value);
+     }
+     while (!text.empty() && (text.back() == '@' || text.back() == ' ')) {
+         text.pop_back();
+     }
+     return text;
+ }
+
+ // De-armor the way BitVector did before the dispatched kernels
+ bool reference_assign_payload(BitVector& bits, const std::string& payload) {
+     bits.clear();
+     for (char c : payload) {
+         uint8_t value;
+         if (c >= '0' && c <= 'W') {
+             value = static_cast<uint8_t>(c - '0');
+         } else if (c >= '`' && c <= 'w') {
+             value = static_cast<uint8_t>(c - '`' + 40);
+         } else {
+             return false;
+         }
+         for (int i = 5; i >= 0; --i) {
+             bits.append_bit((value >> i) & 1);
+         }
+     }
+     return true;
+ }
+
+ std::string describe_bits(const BitVector& bits) {
+     std::string text = std::to_string(bits.size()) + " bits ";
+     for (size_t i = 0; i < bits.size(); ++i) {
+         text += bits.get_bit(i) ? '1' : '0';
+     }
+     return text;
+ }
+
+ // Everything observable about a decoded message
+ std::string describe_message(const AISMessage* message) {
+     if (message == nullptr) {
+         return "<none>";
+     }
+     std::string text = message->to_string();
+     try {
+         for (const auto& sentence : message->to_nmea()) {
+             text += "\n" + sentence;
+         }
+     } catch (const std::exception& e) {
+         text += std::string("\nencode threw: ") + e.what();
+     }
+     return text;
+ }
+
+ std::string decode(const BitVector& bits) {
+     try {
+         return describe_message(MessageFactory::instance().create_message(bits).get());
+     } catch (const std::exception& e) {
+         return std::string("threw: ") + e.what();
+     }
+ }
+
+ // ---- Comparisons ----
+
+ void compare_kernels(const char* data, size_t size) {
+     const cpu::Kernels& scalar = cpu::kernels_for(cpu::Level::SCALAR);
+
+     std::vector<uint8_t> expected_values(size);
+     bool expected_valid = scalar.dearmor(data, size, expected_values.data());
+     uint8_t expected_xor = scalar.xor_bytes(data, size);
+     std::vector<uint32_t> expected_commas(size);
+     size_t expected_count = scalar.find_all(data, size, ',', expected_commas.data(), size);
+     expected_commas.resize(expected_count);
+
+     for (cpu::Level level : cpu::supported_levels()) {
+         const cpu::Kernels& kernels = cpu::kernels_for(level);
+         std::string name = cpu::level_name(level);
+
+         uint8_t actual_xor = kernels.xor_bytes(data, size);
+         check(actual_xor == expected_xor, name + " xor_bytes",
+               std::to_string(expected_xor), std::to_string(actual_xor));
+
+         std::vector<uint8_t> values(size);
+         bool valid = kernels.dearmor(data, size, values.data());
+         check(valid == expected_valid, name + " dearmor validity",
+               std::to_string(expected_valid), std::to_string(valid));
+         check(!valid || values == expected_values, name + " dearmor values", "", "");
+
+         std::vector<uint32_t> commas(size);
+         size_t count = kernels.find_all(data, size, ',', commas.data(), size);
+         commas.resize(count);
+         check(commas == expected_commas, name + " find_all",
+               std::to_string(expected_count), std::to_string(count));
+
+         // A short buffer must yield a prefix of the full result
+         uint32_t first[2] = {0, 0};
+         size_t limited = kernels.find_all(data, size, ',', first, 2);
+         check(limited == std::min<size_t>(2, expected_count) &&
+                   (limited < 1 || first[0] == expected_commas[0]) &&
+                   (limited < 2 || first[1] == expected_commas[1]),
+               name + " find_all limit", std::to_string(std::min<size_t>(2, expected_count)), std::to_string(limited));
+     }
+ }
+
+ void compare_bit_reads(const uint8_t* data, size_t size) {
+     BitVector bits;
+     for (size_t i = 0; i < size; ++i) {
+         bits.append_uint(data[i], 8);
+     }
+
+     // Read windows whose start and width come from the input itself
+     for (size_t i = 0; i + 1 < size; i += 2) {
+         size_t start = bits.size() == 0 ? 0 : data[i] % bits.size();
+         size_t count = std::min<size_t>(data[i + 1] % 65, bits.size() - start);
+
+         uint64_t expected = reference_get_uint(bits, start, count);
+         uint64_t actual = bits.get_uint(start, count);
+         check(actual == expected, "get_uint(" + std::to_string(start) + ", " + std::to_string(count) + ")",
+               std::to_string(expected), std::to_string(actual));
+
+         int64_t expected_signed = reference_get_int(bits, start, count);
+         int64_t actual_signed = bits.get_int(start, count);
+         check(actual_signed == expected_signed, "get_int(" + std::to_string(start) + ", " + std::to_string(count) + ")",
+               std::to_string(expected_signed), std::to_string(actual_signed));
+
+         // Text of up to 20 characters, as in names and destinations
+         size_t text_bits = std::min<size_t>(count / 6 * 6, 120);
+         std::string expected_text = reference_get_string(bits, start, text_bits);
+         std::string actual_text = bits.get_string(start, text_bits);
+         check(actual_text == expected_text, "get_string(" + std::to_string(start) + ", " + std::to_string(text_bits) + ")",
+               expected_text, actual_text);
+         ShipName inline_text;
+         bits.get_string(start, text_bits, inline_text);
+         check(inline_text == expected_text, "inline get_string", expected_text, inline_text.str());
+     }
+ }
+
+ void compare_payload(const std::string& payload) {
+     BitVector expected;
+     bool expected_valid = reference_assign_payload(expected, payload);
+
+     for (cpu::Level level : cpu::supported_levels()) {
+         cpu::force_level(level);
+         std::string name = std::string(cpu::level_name(level)) + " assign_payload";
+
+         BitVector actual;
+         bool valid = true;
+         try {
+             actual.assign_payload(payload);
+         } catch (const std::invalid_argument&) {
+             valid = false;
+         }
+         check(valid == expected_valid, name + " validity", std::to_string(expected_valid), std::to_string(valid));
+         if (!valid) {
+             continue;
+         }
+
+         std::string expected_bits = describe_bits(expected);
+         std::string actual_bits = describe_bits(actual);
+         check(actual_bits == expected_bits, name, expected_bits, actual_bits);
+         check(actual.to_nmea_payload() == payload, name + " round trip", payload, actual.to_nmea_payload());
+
+         std::string expected_message = decode(expected);
+         std::string actual_message = decode(actual);
+         check(actual_message == expected_message, name + " decode", expected_message, actual_message);
+     }
+     cpu::reset_level();
+ }
+
+ void compare_parsers(const std::string& text) {
+     auto levels = cpu::supported_levels();
+     std::vector<std::unique_ptr<AISParser>> parsers;
+     for (size_t i = 0; i < levels.size(); ++i) {
+         parsers.push_back(std::make_unique<AISParser>());
+     }
+
+     size_t start = 0;
+     while (start < text.size()) {
+         size_t end = text.find('\n', start);
+         if (end == std::string::npos) {
+             end = text.size();
+         }
+         std::string sentence = text.substr(start, end - start);
+         start = end + 1;
+
+         // The scalar parser is the reference; the others run in lockstep
+         std::string expected;
+         for (size_t i = 0; i < levels.size(); ++i) {
+             cpu::force_level(levels[i]);
+             std::string result;
+             try {
+                 auto message = parsers[i]->parse(sentence);
+                 result = describe_message(message.get());
+             } catch (const std::exception& e) {
+                 result = std::string("threw: ") + e.what();
+             }
+             result += "\nerror " + std::to_string(static_cast<int>(parsers[i]->get_last_error().type));
+
+             if (i == 0) {
+                 expected = result;
+             } else {
+                 check(result == expected, std::string(cpu::level_name(levels[i])) + " parse of \"" + sentence + "\"",
+                       expected, result);
+             }
+         }
+     }
+     cpu::reset_level();
+ }
+
+ } // anonymous namespace
+
+ extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+     const char* text = reinterpret_cast<const char*>(data);
+
+     compare_kernels(text, size);
+     compare_bit_reads(data, size);
+
+     // Payload variant limited to the armoring alphabet, so decoding is reached
+     std::string payload(size, '0');
+     for (size_t i = 0; i < size; ++i) {
+         uint8_t value = data[i] & 0x3F;
+         payload[i] = static_cast<char>(value < 40 ? value + '0' : value - 40 + '`');
+     }
+     compare_payload(payload);
+     compare_payload(std::string(text, size));
+
+     compare_parsers(std::string(text, size));
+     return 0;
+ }
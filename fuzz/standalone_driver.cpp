@@ -0,0 +1,162 @@
+/**
+ * @file standalone_driver.cpp
+ * @brief Bounded-time driver for the fuzz targets when libFuzzer is not available
+ *
+ * Usage: aislib_differential_fuzz [--seconds N] [--seed N] [corpus files...]
+ *
+ * Each corpus file is split into groups of up to four lines, so multi-part
+ * messages stay together, and every group is run as-is. The driver then
+ * mutates random groups (bit flips, byte edits, insertions, deletions,
+ * splices) until the time budget is used up. Deterministic for a given seed
+ * apart from the number of iterations that fit in the budget.
+ */
+
+ #include <algorithm>
+ #include <chrono>
+ #include <cstdint>
+ #include <cstdlib>
+ #include <cstring>
+ #include <fstream>
+ #include <iostream>
+ #include <random>
+ #include <stdexcept>
+ #include <string>
+ #include <vector>
+
+ extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size);
+
+ namespace {
+
+ const size_t kMaxInputSize = 512;
+ const char kInteresting[] = "!$*,0123456789ABCDEFW`aw@ \n\r";
+
+ void run(const std::string& input) {
+     LLVMFuzzerTestOneInput(reinterpret_cast<const uint8_t*>(input.data()), input.size());
+ }
+
+ std::vector<std::string> load_seeds(const char* path) {
+     std::ifstream file(path);
+     if (!file) {
+         throw std::runtime_error(std::string("Cannot open corpus file ") + path);
+     }
+
+     std::vector<std::string> seeds;
+     std::string line;
+     std::string group;
+     size_t lines = 0;
+     while (std::getline(file, line)) {
+         if (line.empty() || line[0] == '#') {
+             continue;
+         }
+         group += line + "\n";
+         if (++lines == 4) {
+             seeds.push_back(group);
+             group.clear();
+             lines = 0;
+         }
+     }
+     if (!group.empty()) {
+         seeds.push_back(group);
+     }
+     return seeds;
+ }
+
+ std::string mutate(std::string input, const std::vector<std::string>& seeds, std::mt19937_64& rng) {
+     auto pick = [&rng](size_t bound) { return bound == 0 ? 0 : static_cast<size_t>(rng() % bound); };
+
+     size_t edits = 1 + pick(4);
+     for (size_t edit = 0; edit < edits; ++edit) {
+         size_t position = pick(input.size() + 1);
+         switch (pick(7)) {
+             case 0:  // Flip a bit
+                 if (!input.empty()) {
+                     input[position % input.size()] ^= static_cast<char>(1 << pick(8));
+                 }
+                 break;
+             case 1:  // Random byte
+                 if (!input.empty()) {
+                     input[position % input.size()] = static_cast<char>(pick(256));
+                 }
+                 break;
+             case 2:  // Byte that matters to the grammar or the payload alphabet
+                 if (!input.empty()) {
+                     input[position % input.size()] = kInteresting[pick(sizeof(kInteresting) - 1)];
+                 }
+                 break;
+             case 3:  // Insert
+                 input.insert(position, 1, kInteresting[pick(sizeof(kInteresting) - 1)]);
+                 break;
+             case 4:  // Erase a range
+                 if (!input.empty()) {
+                     position %= input.size();
+                     input.erase(position, 1 + pick(std::min<size_t>(8, input.size() - position)));
+                 }
+                 break;
+             case 5:  // Duplicate a range
+                 if (!input.empty()) {
+                     position %= input.size();
+                     input.insert(position, input.substr(position, 1 + pick(16)));
+                 }
+                 break;
+             default: {  // Splice with another seed
+                 const std::string& other = seeds[pick(seeds.size())];
+                 size_t from = pick(other.size());
+                 input = input.substr(0, position) + other.substr(from);
+                 break;
+             }
+         }
+     }
+
+     if (input.size() > kMaxInputSize) {
+         input.resize(kMaxInputSize);
+     }
+     return input;
+ }
+
+ } // anonymous namespace
+
+ int main(int argc, char* argv[]) {
+     double seconds = 10.0;
+     uint64_t seed = 1;
+     std::vector<std::string> seeds;
+
+     try {
+         for (int i = 1; i < argc; ++i) {
+             if (std::strcmp(argv[i], "--seconds") == 0 && i + 1 < argc) {
+                 seconds = std::strtod(argv[++i], nullptr);
+             } else if (std::strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+                 seed = std::strtoull(argv[++i], nullptr, 10);
+             } else {
+                 auto loaded = load_seeds(argv[i]);
+                 seeds.insert(seeds.end(), loaded.begin(), loaded.end());
+             }
+         }
+     } catch (const std::exception& e) {
+         std::cerr << "Error: " << e.what() << std::endl;
+         return 1;
+     }
+
+     // Inputs that need no corpus: empty, and every single byte
+     run("");
+     for (int c = 0; c < 256; ++c) {
+         run(std::string(1, static_cast<char>(c)));
+     }
+     for (const auto& input : seeds) {
+         run(input);
+     }
+     if (seeds.empty()) {
+         seeds.push_back("!AIVDM,1,1,,A,15MgK45P3@G?fl0E`JbR0OwT0@MS,0*4E\n");
+     }
+
+     std::mt19937_64 rng(seed);
+     auto deadline = std::chrono::steady_clock::now() + std::chrono::duration<double>(seconds);
+     size_t iterations = 0;
+     while (std::chrono::steady_clock::now() < deadline) {
+         run(mutate(seeds[rng() % seeds.size()], seeds, rng));
+         ++iterations;
+     }
+
+     std::cout << "Ran " << seeds.size() << " seeds and " << iterations << " mutated inputs in "
+               << seconds << " s without differences" << std::endl;
+     return 0;
+ }
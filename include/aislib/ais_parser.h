@@ -16,9 +16,13 @@
  #include <optional>
  #include <memory>
  #include <chrono>
+ #include <vector>
  
  namespace aislib {
  
+ class MetricsRegistry;
+ class DecodeCache;
+ 
  /**
   * @class AISParser
   * @brief Parser for AIS messages with enhanced multi-part message support
@@ -51,11 +55,17 @@
      struct ParserConfig {
          std::chrono::seconds message_timeout;
          size_t max_incomplete_messages;
+         std::shared_ptr<MetricsRegistry> metrics;   ///< Registry to record into (nullptr = no metrics)
+         uint32_t latency_sample_interval;           ///< Time one in N sentences (0 = no latency histogram)
+         std::shared_ptr<DecodeCache> decode_cache;  ///< Cache used by parse_shared (nullptr = no cache)
          
          // Default constructor
          ParserConfig() : 
              message_timeout(std::chrono::seconds(60)), 
-             max_incomplete_messages(100) {}
+             max_incomplete_messages(100),
+             metrics(nullptr),
+             latency_sample_interval(64),
+             decode_cache(nullptr) {}
      };
      
      /**
@@ -75,6 +85,17 @@
       */
      std::unique_ptr<AISMessage> parse(const std::string& nmea_sentence);
      
+     /**
+      * @brief Parse a complete NMEA sentence into a shared, immutable message
+      * @param nmea_sentence NMEA sentence
+      * @return Shared message if successful, nullptr otherwise
+      * 
+      * Same as parse(), but with a decode cache configured, messages of
+      * cached types whose bits were seen before are returned from the cache
+      * instead of being decoded again.
+      */
+     std::shared_ptr<const AISMessage> parse_shared(const std::string& nmea_sentence);
+     
      /**
       * @brief Add a fragment of a multipart message
       * @param nmea_sentence NMEA sentence containing the fragment
@@ -121,6 +142,12 @@
       */
      void clear_incomplete_messages();
      
+     /**
+      * @brief Get the metrics registry
+      * @return Registry the parser records into, nullptr if none
+      */
+     std::shared_ptr<MetricsRegistry> get_metrics() const;
+     
  private:
      // Multipart message manager
      MultipartMessageManager multipart_manager_;
@@ -128,8 +155,31 @@
      // Last parse error
      ParseError last_error_;
      
+     // Metrics registry (may be null)
+     std::shared_ptr<MetricsRegistry> metrics_;
+     
+     // Scratch storage reused across sentences so the steady state does not allocate
+     std::vector<std::string> fields_;
+     BitVector bits_;
+     
+     // Decode cache (may be null)
+     std::shared_ptr<DecodeCache> decode_cache_;
+     
+     // Latency sampling interval and sentences since the last sample
+     uint32_t latency_sample_interval_;
+     uint32_t sentences_since_sample_;
+     
+     // Validate a sentence and reassemble fragments; returns the complete message
+     // bits, or nullptr if the sentence was rejected or more fragments are needed.
+     // decode_error is the error type to report if decoding the bits fails.
+     const BitVector* assemble(const std::string& nmea_sentence, ParseError::ErrorType& decode_error);
+     
+     // Run one parse step, recording sentence, message and latency metrics
+     template <typename Message, typename Step>
+     Message record_parse(Step&& step);
+     
      // Set the last error
-     void set_error(ParseError::ErrorType type, const std::string& message);
+     void set_error(ParseError::ErrorType type, const char* message);
      
      // Clear the last error
      void clear_error();
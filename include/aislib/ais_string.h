@@ -0,0 +1,138 @@
+/**
+ * @file ais_string.h
+ * @brief Fixed-capacity inline string for AIS text fields
+ *
+ * AIS text fields have a fixed maximum length (7 characters for call signs,
+ * 20 for names and destinations), so they are stored inline in the message
+ * instead of in a heap-allocated std::string.
+ */
+
+ #ifndef AISLIB_AIS_STRING_H
+ #define AISLIB_AIS_STRING_H
+
+ #include <cstddef>
+ #include <cstdint>
+ #include <cstring>
+ #include <ostream>
+ #include <string>
+ #include <string_view>
+
+ namespace aislib {
+
+ /**
+  * @class AisString
+  * @brief String of at most N characters stored inline
+  * @tparam N Capacity in characters
+  *
+  * Values longer than N are truncated on assignment.
+  */
+ template <size_t N>
+ class AisString {
+ public:
+     static_assert(N > 0 && N < 256, "AisString capacity must fit the 8-bit length");
+
+     /**
+      * @brief Default constructor (empty string)
+      */
+     AisString() : size_(0) {
+         data_[0] = '\0';
+     }
+
+     /**
+      * @brief Construct from a string, truncated to N characters
+      * @param value Value
+      */
+     AisString(std::string_view value) {
+         assign(value);
+     }
+
+     /**
+      * @brief Construct from a C string, truncated to N characters
+      * @param value Null-terminated value
+      */
+     AisString(const char* value) {
+         assign(std::string_view(value));
+     }
+
+     /**
+      * @brief Replace the contents, truncated to N characters
+      * @param value Value
+      */
+     void assign(std::string_view value) {
+         size_ = static_cast<uint8_t>(value.size() < N ? value.size() : N);
+         std::memcpy(data_, value.data(), size_);
+         data_[size_] = '\0';
+     }
+
+     /**
+      * @brief Set the length after writing characters through data()
+      * @param length New length (limited to N)
+      */
+     void resize(size_t length) {
+         size_ = static_cast<uint8_t>(length < N ? length : N);
+         data_[size_] = '\0';
+     }
+
+     /**
+      * @brief Remove all characters
+      */
+     void clear() {
+         resize(0);
+     }
+
+     /**
+      * @brief Get the characters as a view
+      * @return View valid while this string is alive and unchanged
+      */
+     std::string_view view() const {
+         return std::string_view(data_, size_);
+     }
+
+     operator std::string_view() const {
+         return view();
+     }
+
+     /**
+      * @brief Copy the characters into a std::string
+      * @return Copy
+      */
+     std::string str() const {
+         return std::string(data_, size_);
+     }
+
+     const char* c_str() const { return data_; }
+     const char* data() const { return data_; }
+     char* data() { return data_; }
+     size_t size() const { return size_; }
+     bool empty() const { return size_ == 0; }
+     static constexpr size_t capacity() { return N; }
+
+ private:
+     char data_[N + 1];
+     uint8_t size_;
+ };
+
+ template <size_t N>
+ bool operator==(const AisString<N>& lhs, std::string_view rhs) {
+     return lhs.view() == rhs;
+ }
+
+ template <size_t N>
+ bool operator!=(const AisString<N>& lhs, std::string_view rhs) {
+     return lhs.view() != rhs;
+ }
+
+ template <size_t N>
+ std::ostream& operator<<(std::ostream& out, const AisString<N>& value) {
+     return out << value.view();
+ }
+
+ /// Call sign (7 six-bit characters)
+ using CallSign = AisString<7>;
+
+ /// Vessel name or destination (20 six-bit characters)
+ using ShipName = AisString<20>;
+
+ } // namespace aislib
+
+ #endif // AISLIB_AIS_STRING_H
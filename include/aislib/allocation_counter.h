@@ -0,0 +1,49 @@
+/**
+ * @file allocation_counter.h
+ * @brief Heap allocation accounting
+ *
+ * Linking the aislib_alloc_accounting library into an executable replaces
+ * the global operator new with a version that counts allocations per
+ * thread. Tests and benchmarks use it to check how many allocations an API
+ * call makes. The library is built when AISLIB_ALLOCATION_ACCOUNTING is on;
+ * it is not meant to be linked into production binaries.
+ */
+
+ #ifndef AISLIB_ALLOCATION_COUNTER_H
+ #define AISLIB_ALLOCATION_COUNTER_H
+
+ #include <cstdint>
+
+ namespace aislib {
+ namespace alloc {
+
+ /**
+  * @brief Get the number of heap allocations made by the calling thread
+  * @return Allocation count since thread start
+  */
+ uint64_t allocation_count();
+
+ /**
+  * @class AllocationScope
+  * @brief Counts the allocations made by the calling thread while it exists
+  */
+ class AllocationScope {
+ public:
+     AllocationScope() : start_(allocation_count()) {}
+
+     /**
+      * @brief Get the allocations made since construction
+      * @return Allocation count
+      */
+     uint64_t count() const {
+         return allocation_count() - start_;
+     }
+
+ private:
+     uint64_t start_;
+ };
+
+ } // namespace alloc
+ } // namespace aislib
+
+ #endif // AISLIB_ALLOCATION_COUNTER_H
@@ -0,0 +1,262 @@
+/**
+ * @file anomaly_detector.h
+ * @brief Streaming kinematic anomaly and spoofing checks on position reports
+ *
+ * This file defines a batch stage that checks each position report against
+ * the previous reports of the same MMSI: implied speed well above the
+ * reported speed over ground, jumps no vessel could make, two distinct
+ * tracks sharing one MMSI, MMSIs without an allocated Maritime
+ * Identification Digits (MID) prefix, and navigational statuses that
+ * contradict the observed motion or change faster than a vessel could.
+ */
+
+ #ifndef AISLIB_ANOMALY_DETECTOR_H
+ #define AISLIB_ANOMALY_DETECTOR_H
+
+ #include "aislib/ais_message.h"
+ #include <cstdint>
+ #include <unordered_map>
+ #include <vector>
+
+ namespace aislib {
+
+ /**
+  * @struct PositionBatch
+  * @brief Columns of a batch of position reports, one row per report
+  *
+  * Rows should be in time order per MMSI. The input columns are filled with
+  * append(); AnomalyDetector::check() fills the anomalies column.
+  */
+ struct PositionBatch {
+     std::vector<uint32_t> mmsi;               ///< Reporting vessel
+     std::vector<double> time;                 ///< Time of the report (Unix seconds)
+     std::vector<double> latitude;             ///< Latitude in degrees (91 = not available)
+     std::vector<double> longitude;            ///< Longitude in degrees (181 = not available)
+     std::vector<float> speed;                 ///< Speed over ground in knots, NaN if not available
+     std::vector<uint8_t> navigation_status;   ///< Navigational status (15 = not defined or Class B)
+     std::vector<uint32_t> anomalies;          ///< Output: AnomalyDetector flags of the row
+
+     /**
+      * @brief Append a row
+      * @param mmsi_value Reporting vessel
+      * @param time_value Time of the report (Unix seconds)
+      * @param latitude_value Latitude in degrees
+      * @param longitude_value Longitude in degrees
+      * @param speed_value Speed over ground in knots, NaN if not available
+      * @param status_value Navigational status (15 = not defined)
+      */
+     void append(uint32_t mmsi_value, double time_value, double latitude_value, double longitude_value,
+                 float speed_value, uint8_t status_value);
+
+     /**
+      * @brief Append a row for a decoded message
+      * @param time_value Time of the report (Unix seconds)
+      * @param message Decoded message
+      * @return False if the message is not a position report (types 1-3, 18, 19)
+      */
+     bool append(double time_value, const AISMessage& message);
+
+     /**
+      * @brief Get the number of rows
+      * @return Number of rows
+      */
+     size_t size() const;
+
+     /**
+      * @brief Reserve space for rows
+      * @param rows Number of rows
+      */
+     void reserve(size_t rows);
+
+     /**
+      * @brief Remove all rows, keeping the storage
+      */
+     void clear();
+ };
+
+ /**
+  * @class AnomalyDetector
+  * @brief Per-MMSI kinematic and identity checks over batches of position reports
+  *
+  * Each vessel holds a fixed-size state: the last position of its main
+  * track, the last position of a second track (seen when a report jumps
+  * away from the main one), the last position used for the speed check,
+  * and the navigational status of the last report. A batch is checked in
+  * three passes: the vessel states are looked up, the distances from all
+  * three positions are computed with the CPU-dispatched haversine kernel,
+  * and the rows are then evaluated in order.
+  *
+  * A change between a stationary status (at anchor, moored, aground) and
+  * an under-way status is impossible when the vessel moved faster than
+  * transition_speed between the two reports, as when a moored vessel
+  * reports under way a few hundred meters away seconds later. Not
+  * thread-safe.
+  */
+ class AnomalyDetector {
+ public:
+     static const uint32_t SPEED_MISMATCH = 1u << 0;  ///< Implied speed well above the reported speed over ground
+     static const uint32_t TELEPORT = 1u << 1;        ///< Jump faster than max_speed from the previous position
+     static const uint32_t MMSI_COLLISION = 1u << 2;  ///< Reports alternate between two distinct tracks
+     static const uint32_t INVALID_MID = 1u << 3;     ///< MMSI without an allocated MID prefix
+     static const uint32_t NAV_STATUS = 1u << 4;      ///< Status contradicts the motion, the MMSI or the previous status
+
+     /**
+      * @struct Config
+      * @brief Detector configuration
+      */
+     struct Config {
+         double max_speed;          ///< Fastest plausible speed in knots
+         double teleport_distance;  ///< Jumps shorter than this (meters) are never teleports
+         double speed_factor;       ///< Implied speed may exceed the reported speed by this factor...
+         double speed_margin;       ///< ...plus this many knots
+         double min_interval;       ///< Seconds between positions compared for the speed check
+         double stationary_speed;   ///< Knots above which anchored, moored or aground vessels are moving
+         double transition_speed;   ///< Knots above which a change between stationary and under way is impossible
+         double collision_window;   ///< Seconds a second track is remembered after its last report
+         uint32_t collision_switches;  ///< Switches between tracks before MMSI_COLLISION is flagged
+         double max_age;            ///< Seconds without reports after which expire() drops a vessel
+
+         // Default constructor
+         Config()
+             : max_speed(80.0),
+               teleport_distance(1852.0),
+               speed_factor(1.5),
+               speed_margin(5.0),
+               min_interval(10.0),
+               stationary_speed(3.0),
+               transition_speed(10.0),
+               collision_window(600.0),
+               collision_switches(2),
+               max_age(3600.0) {}
+     };
+
+     /**
+      * @struct Stats
+      * @brief Detector counters
+      */
+     struct Stats {
+         uint64_t reports = 0;          ///< Rows checked
+         uint64_t out_of_order = 0;     ///< Rows older than the vessel's track, not checked for motion
+         uint64_t speed_mismatch = 0;   ///< Rows flagged SPEED_MISMATCH
+         uint64_t teleport = 0;         ///< Rows flagged TELEPORT
+         uint64_t mmsi_collision = 0;   ///< Rows flagged MMSI_COLLISION
+         uint64_t invalid_mid = 0;      ///< Rows flagged INVALID_MID
+         uint64_t nav_status = 0;       ///< Rows flagged NAV_STATUS
+         size_t vessels = 0;            ///< Vessels with state
+     };
+
+     /**
+      * @brief Constructor
+      * @param config Detector configuration
+      * @throws std::invalid_argument if max_speed or speed_factor is not positive
+      */
+     explicit AnomalyDetector(const Config& config = Config());
+
+     /**
+      * @brief Check every row of a batch and fill its anomalies column
+      * @param batch Batch to process
+      * @throws std::invalid_argument if the input columns differ in length
+      */
+     void check(PositionBatch& batch);
+
+     /**
+      * @brief Check a single report
+      * @param mmsi Reporting vessel
+      * @param time Time of the report (Unix seconds)
+      * @param latitude Latitude in degrees
+      * @param longitude Longitude in degrees
+      * @param speed Speed over ground in knots, NaN if not available
+      * @param navigation_status Navigational status (15 = not defined)
+      * @return Anomaly flags
+      */
+     uint32_t check(uint32_t mmsi, double time, double latitude, double longitude,
+                    float speed, uint8_t navigation_status);
+
+     /**
+      * @brief Drop vessels without reports for max_age
+      * @param now Current time (Unix seconds)
+      * @return Number of vessels dropped
+      */
+     size_t expire(double now);
+
+     /**
+      * @brief Forget all vessels
+      */
+     void clear();
+
+     /**
+      * @brief Get the detector counters
+      * @return Counters
+      */
+     Stats get_stats() const;
+
+     /**
+      * @brief Check whether an MMSI carries an allocated MID
+      * @param mmsi MMSI number
+      * @return True for ship, coast, group, SAR aircraft, auxiliary craft and aid to
+      *         navigation MMSIs with an allocated MID, and for SART, MOB and EPIRB devices
+      */
+     static bool has_valid_mid(uint32_t mmsi);
+
+ private:
+     static const uint32_t NONE = 0xFFFFFFFF;
+
+     struct Fix {
+         double latitude;
+         double longitude;
+         double time;
+     };
+
+     // Fixed-size state of one vessel
+     struct Vessel {
+         Fix primary;          // Last report of the main track
+         Fix secondary;        // Last report of the other track, valid if has_secondary
+         Fix anchor;           // Position the next speed check measures from
+         float anchor_speed;   // Reported speed at the anchor, NaN if not available
+         uint32_t switches;    // Switches between the two tracks
+         uint32_t batch;       // Last batch the vessel appeared in
+         uint8_t status;       // Navigational status of the last report
+         bool initialized;
+         bool has_secondary;
+     };
+
+     // Distances of a row from the three positions of its vessel
+     struct Distances {
+         double primary;
+         double secondary;
+         double anchor;
+     };
+
+     Config config_;
+     std::vector<Vessel> vessels_;                     // Vessel states; freed slots are reused
+     std::vector<uint32_t> free_slots_;
+     std::unordered_map<uint32_t, uint32_t> index_;    // MMSI to slot
+     uint32_t batch_;                                  // Number of the current batch
+     Stats stats_;
+
+     // Scratch columns of check()
+     std::vector<uint32_t> slots_;
+     std::vector<uint8_t> repeated_;
+     std::vector<double> from_latitude_;
+     std::vector<double> from_longitude_;
+     std::vector<double> distances_;
+
+     // Find or create the slot of a vessel
+     uint32_t slot_for(uint32_t mmsi);
+
+     // Compute the distances of a report from the state of its vessel
+     static Distances distances_from(const Vessel& vessel, double latitude, double longitude);
+
+     // Evaluate one report against its vessel and update the state
+     uint32_t evaluate(Vessel& vessel, uint32_t mmsi, double time, double latitude, double longitude,
+                       float speed, uint8_t navigation_status, const Distances& distances);
+
+     // Flags that need no vessel state
+     uint32_t identity_flags(uint32_t mmsi, float speed, uint8_t navigation_status) const;
+
+     void count(uint32_t flags);
+ };
+
+ } // namespace aislib
+
+ #endif // AISLIB_ANOMALY_DETECTOR_H
@@ -10,6 +10,7 @@
  #define AISLIB_BASE_STATION_REPORT_H
  
  #include "ais_message.h"
+ #include "communication_state.h"
  #include <chrono>
  #include <ctime>
  #include <string>
@@ -133,6 +134,18 @@
       */
      bool get_raim_flag() const;
      
+     /**
+      * @brief Get the radio status
+      * @return Raw 19-bit communication state
+      */
+     uint32_t get_radio_status() const;
+     
+     /**
+      * @brief Get the decoded communication state
+      * @return SOTDMA state
+      */
+     CommunicationState get_communication_state() const;
+     
      /**
       * @brief Set the UTC time components
       * @param year UTC year (1-9999, 0 = not available)
@@ -181,6 +194,12 @@
       */
      void set_raim_flag(bool raim);
      
+     /**
+      * @brief Set the radio status
+      * @param radio_status Raw 19-bit communication state (masked to 19 bits)
+      */
+     void set_radio_status(uint32_t radio_status);
+     
      /**
       * @brief Convert the message to a bit vector
       * @param bits Bit vector to populate
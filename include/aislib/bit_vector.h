@@ -9,6 +9,7 @@
  #ifndef AISLIB_BIT_VECTOR_H
  #define AISLIB_BIT_VECTOR_H
  
+ #include "aislib/ais_string.h"
  #include <vector>
  #include <cstdint>
  #include <string>
@@ -48,6 +49,12 @@
       */
      size_t size() const;
      
+     /**
+      * @brief Get the packed bits, most significant bit of each byte first
+      * @return Pointer to (size() + 7) / 8 bytes
+      */
+     const uint8_t* data() const;
+     
      /**
       * @brief Get the capacity in bits
       * @return Capacity in bits
@@ -65,6 +72,21 @@
       */
      void clear();
      
+     /**
+      * @brief Replace the contents with a 6-bit encoded NMEA payload
+      * @param payload Encoded NMEA payload string
+      * @throws std::invalid_argument if the payload contains an invalid character
+      *
+      * Unlike constructing a new BitVector, this reuses the existing storage.
+      */
+     void assign_payload(const std::string& payload);
+     
+     /**
+      * @brief Drop bits from the end
+      * @param bit_count Number of bits to keep (no effect if not smaller than size())
+      */
+     void truncate(size_t bit_count);
+     
      /**
       * @brief Get a bit value
       * @param index Bit index
@@ -133,6 +155,33 @@
       */
      std::string get_string(size_t start_index, size_t bit_count) const;
      
+     /**
+      * @brief Get a string value (6-bit ASCII) into an inline string
+      * @param start_index Start bit index
+      * @param bit_count Number of bits to read (multiple of 6, at most 6 * N)
+      * @param value String to decode into
+      * @throws std::out_of_range if indices are out of range
+      * @throws std::invalid_argument if bit_count is not multiple of 6 or too large for N
+      */
+     template <size_t N>
+     void get_string(size_t start_index, size_t bit_count, AisString<N>& value) const {
+         if (bit_count / 6 > N) {
+             throw std::invalid_argument("String bit count exceeds the destination capacity");
+         }
+         value.resize(decode_string(start_index, bit_count, value.data()));
+     }
+     
+     /**
+      * @brief Decode 6-bit ASCII characters with trailing '@' and spaces removed
+      * @param start_index Start bit index
+      * @param bit_count Number of bits to read (must be multiple of 6)
+      * @param out Buffer of at least bit_count / 6 characters
+      * @return Length of the trimmed string
+      * @throws std::out_of_range if indices are out of range
+      * @throws std::invalid_argument if bit_count is not multiple of 6
+      */
+     size_t decode_string(size_t start_index, size_t bit_count, char* out) const;
+     
      /**
       * @brief Append a string value (6-bit ASCII)
       * @param value String value
@@ -140,7 +189,7 @@
       * @throws std::invalid_argument if bit_count is not multiple of 6
       * @throws std::invalid_argument if bit_count is not enough for the string
       */
-     void append_string(const std::string& value, size_t bit_count);
+     void append_string(std::string_view value, size_t bit_count);
      
      /**
       * @brief Convert to 6-bit encoded NMEA payload
@@ -0,0 +1,190 @@
+/**
+ * @file class_b_static_cache.h
+ * @brief Per-MMSI pairing of Class B static data report parts
+ *
+ * Class B transponders send their static data as two type 24 messages,
+ * Part A (name) and Part B (ship type, call sign, dimensions), which can
+ * arrive minutes apart. The cache merges both parts into one record per
+ * MMSI.
+ */
+
+ #ifndef AISLIB_CLASS_B_STATIC_CACHE_H
+ #define AISLIB_CLASS_B_STATIC_CACHE_H
+
+ #include "aislib/ais_string.h"
+ #include "aislib/static_data_report.h"
+ #include <chrono>
+ #include <cstdint>
+ #include <unordered_map>
+ #include <vector>
+
+ namespace aislib {
+
+ /**
+  * @struct ClassBStaticRecord
+  * @brief Merged Part A and Part B data of one vessel
+  *
+  * Fields of a part that has not been received yet keep their defaults.
+  */
+ struct ClassBStaticRecord {
+     uint32_t mmsi = 0;                   ///< MMSI number
+     uint32_t mothership_mmsi = 0;        ///< Mothership MMSI (auxiliary craft only)
+     uint32_t serial_number = 0;          ///< Unit serial number
+     uint16_t dimension_to_bow = 0;       ///< Dimension to bow in meters
+     uint16_t dimension_to_stern = 0;     ///< Dimension to stern in meters
+     uint8_t dimension_to_port = 0;       ///< Dimension to port in meters
+     uint8_t dimension_to_starboard = 0;  ///< Dimension to starboard in meters
+     uint8_t ship_type = 0;               ///< Ship type (same values as in message type 5)
+     uint8_t unit_model = 0;              ///< Unit model code
+     bool has_part_a = false;             ///< Part A has been received
+     bool has_part_b = false;             ///< Part B has been received
+     ShipName vessel_name;                ///< Vessel name (Part A)
+     CallSign call_sign;                  ///< Call sign (Part B)
+     AisString<3> vendor_id;              ///< Vendor ID (Part B)
+     std::chrono::steady_clock::time_point part_a_time;  ///< Arrival of the latest Part A
+     std::chrono::steady_clock::time_point part_b_time;  ///< Arrival of the latest Part B
+
+     /**
+      * @brief Check whether both parts have been received
+      * @return True if complete
+      */
+     bool is_complete() const { return has_part_a && has_part_b; }
+ };
+
+ /**
+  * @class ClassBStaticCache
+  * @brief Bounded map from MMSI to merged Class B static data
+  *
+  * Records live in a vector of slots, reached through a hash map from MMSI
+  * to slot index, so lookups and updates are O(1). Freed slots go on a
+  * free list and are reused. A record expires when neither part has been
+  * updated for max_age; when the cache is full, the least recently
+  * updated record is evicted. Not thread-safe.
+  */
+ class ClassBStaticCache {
+ public:
+     using Clock = std::chrono::steady_clock;
+
+     /**
+      * @struct Config
+      * @brief Cache configuration
+      */
+     struct Config {
+         size_t max_vessels;             ///< Records kept before the least recently updated is evicted
+         std::chrono::seconds max_age;   ///< Time without updates after which a record expires
+
+         // Default constructor
+         Config() : max_vessels(65536), max_age(std::chrono::minutes(30)) {}
+     };
+
+     /**
+      * @struct Stats
+      * @brief Cache counters
+      */
+     struct Stats {
+         uint64_t updates = 0;      ///< Parts merged
+         uint64_t evictions = 0;    ///< Records dropped to respect max_vessels
+         uint64_t expirations = 0;  ///< Records dropped after max_age
+         size_t entries = 0;        ///< Records currently held
+         size_t complete = 0;       ///< Records holding both parts
+     };
+
+     /**
+      * @brief Constructor
+      * @param config Cache configuration
+      * @throws std::invalid_argument if max_vessels is 0
+      */
+     explicit ClassBStaticCache(const Config& config = Config());
+
+     /**
+      * @brief Merge a type 24 part into the record of its MMSI
+      * @param report Part A or Part B
+      * @param now Arrival time
+      * @return Merged record, valid until the cache is next modified
+      *
+      * Expired records are dropped first, so a part arriving after max_age
+      * starts a new record instead of pairing with stale data.
+      */
+     const ClassBStaticRecord& update(const StaticDataReport& report, Clock::time_point now = Clock::now());
+
+     /**
+      * @brief Look up the record of a vessel
+      * @param mmsi MMSI number
+      * @param now Current time, used to hide expired records
+      * @return Record valid until the cache is next modified, nullptr if absent or expired
+      */
+     const ClassBStaticRecord* find(uint32_t mmsi, Clock::time_point now = Clock::now()) const;
+
+     /**
+      * @brief Drop records not updated within max_age
+      * @param now Current time
+      * @return Number of records dropped
+      */
+     size_t expire(Clock::time_point now = Clock::now());
+
+     /**
+      * @brief Remove all records
+      */
+     void clear();
+
+     /**
+      * @brief Get every record, least recently updated first
+      * @param records Output vector, cleared first
+      * @return Number of records
+      */
+     size_t records(std::vector<ClassBStaticRecord>& records) const;
+
+     /**
+      * @brief Insert a saved record as the most recently updated
+      * @param record Record; its last update is the later of its part times
+      * @return Stored record, valid until the cache is next modified
+      *
+      * A record of the same MMSI is replaced. Restoring records in the order
+      * records() returned them keeps their update order.
+      */
+     const ClassBStaticRecord& restore(const ClassBStaticRecord& record);
+
+     /**
+      * @brief Get the number of records held, including expired ones not yet dropped
+      * @return Number of records
+      */
+     size_t size() const;
+
+     /**
+      * @brief Get the cache counters
+      * @return Counters
+      */
+     Stats get_stats() const;
+
+ private:
+     static const uint32_t NONE = 0xFFFFFFFF;
+
+     // Record plus its position in the update-order list
+     struct Slot {
+         ClassBStaticRecord record;
+         Clock::time_point last_update;
+         uint32_t newer;
+         uint32_t older;
+     };
+
+     Config config_;
+     std::vector<Slot> slots_;                        // Records; freed slots are reused
+     std::vector<uint32_t> free_slots_;               // Indices of unused slots
+     std::unordered_map<uint32_t, uint32_t> index_;   // MMSI to slot index
+     uint32_t newest_;                                // Most recently updated slot
+     uint32_t oldest_;                                // Least recently updated slot
+     Stats stats_;
+
+     // Unlink a slot from the update-order list
+     void unlink(uint32_t slot);
+
+     // Link a slot as the most recently updated
+     void push_newest(uint32_t slot);
+
+     // Drop a record and free its slot
+     void remove(uint32_t slot);
+ };
+
+ } // namespace aislib
+
+ #endif // AISLIB_CLASS_B_STATIC_CACHE_H
@@ -0,0 +1,126 @@
+/**
+ * @file communication_state.h
+ * @brief SOTDMA and ITDMA communication state
+ *
+ * Position reports (types 1-3 and 18) and base station reports (type 4)
+ * end with a 19-bit communication state describing how the transmitter
+ * uses the TDMA slots of the VHF data link. This file defines its decoded
+ * form.
+ */
+
+ #ifndef AISLIB_COMMUNICATION_STATE_H
+ #define AISLIB_COMMUNICATION_STATE_H
+
+ #include <cstdint>
+ #include <string>
+
+ namespace aislib {
+
+ class AISMessage;
+
+ /**
+  * @struct CommunicationState
+  * @brief Decoded SOTDMA or ITDMA communication state
+  */
+ struct CommunicationState {
+     /**
+      * @enum Access
+      * @brief Access scheme the state belongs to
+      */
+     enum class Access : uint8_t {
+         NONE,    ///< No TDMA state (Class B carrier-sense units)
+         SOTDMA,  ///< Self-organised TDMA (types 1, 2, 4 and 18)
+         ITDMA    ///< Incremental TDMA (type 3 and 18)
+     };
+
+     /**
+      * @enum SyncState
+      * @brief Source of the transmitter's slot synchronisation
+      */
+     enum class SyncState : uint8_t {
+         UTC_DIRECT = 0,     ///< Own UTC receiver
+         UTC_INDIRECT = 1,   ///< Another station with UTC
+         BASE_STATION = 2,   ///< A base station
+         OTHER_STATION = 3   ///< Another station with the most received stations
+     };
+
+     /**
+      * @enum SubMessage
+      * @brief Meaning of the SOTDMA sub message, selected by the slot timeout
+      */
+     enum class SubMessage : uint8_t {
+         NONE,               ///< ITDMA or no TDMA state
+         SLOT_OFFSET,        ///< Slot timeout 0: offset to the slot used next frame
+         UTC_HOUR_MINUTE,    ///< Slot timeout 1: UTC hour and minute
+         SLOT_NUMBER,        ///< Slot timeout 2, 4, 6: slot used for this transmission
+         RECEIVED_STATIONS   ///< Slot timeout 3, 5, 7: number of stations heard
+     };
+
+     Access access = Access::NONE;                 ///< Access scheme
+     SyncState sync_state = SyncState::UTC_DIRECT; ///< Synchronisation state
+
+     // SOTDMA
+     uint8_t slot_timeout = 0;                     ///< Frames left before the slot changes (0-7)
+     uint16_t sub_message = 0;                     ///< Raw 14-bit sub message, see get_sub_message_type()
+
+     // ITDMA
+     uint16_t slot_increment = 0;                  ///< Offset to the next allocated slot (0-8191)
+     uint8_t number_of_slots = 0;                  ///< Slots allocated (code 0-7)
+     bool keep_flag = false;                       ///< Allocation kept for one more frame
+
+     /**
+      * @brief Decode a SOTDMA communication state
+      * @param radio_status 19-bit communication state
+      * @return Decoded state
+      */
+     static CommunicationState sotdma(uint32_t radio_status);
+
+     /**
+      * @brief Decode an ITDMA communication state
+      * @param radio_status 19-bit communication state
+      * @return Decoded state
+      */
+     static CommunicationState itdma(uint32_t radio_status);
+
+     /**
+      * @brief Decode the communication state carried by a message
+      * @param message Message of type 1-4 or 18
+      * @param state Decoded state
+      * @return False if the message type carries no communication state
+      */
+     static bool from_message(const AISMessage& message, CommunicationState& state);
+
+     /**
+      * @brief Encode the state
+      * @return 19-bit communication state (0 for Access::NONE)
+      */
+     uint32_t encode() const;
+
+     /**
+      * @brief Get the meaning of the SOTDMA sub message
+      * @return Sub message type selected by the slot timeout, NONE unless SOTDMA
+      */
+     SubMessage get_sub_message_type() const;
+
+     /**
+      * @brief Get the number of stations heard (SubMessage::RECEIVED_STATIONS)
+      * @return Station count, -1 if not carried by this state
+      */
+     int get_received_stations() const;
+
+     /**
+      * @brief Get the slot of the transmission (SubMessage::SLOT_NUMBER)
+      * @return Slot number (0-2249), -1 if not carried by this state
+      */
+     int get_slot_number() const;
+
+     /**
+      * @brief Get a string representation of the state
+      * @return String representation
+      */
+     std::string to_string() const;
+ };
+
+ } // namespace aislib
+
+ #endif // AISLIB_COMMUNICATION_STATE_H
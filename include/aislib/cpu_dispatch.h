@@ -0,0 +1,155 @@
+/**
+ * @file cpu_dispatch.h
+ * @brief Runtime CPU dispatch for SIMD kernels
+ *
+ * This file defines the kernels used on the sentence hot path (checksum
+ * XOR, de-armoring of the 6-bit payload alphabet and delimiter search), the
+ * batch distance kernel used by the track analytics, and the mechanism
+ * that binds them to the best implementation for the CPU. The instruction
+ * set level is detected once, on first use; it can be lowered with the
+ * AISLIB_CPU_LEVEL environment variable (scalar, sse4.2, avx2, avx512,
+ * neon) or with force_level(), which is meant for tests and benchmarks.
+ */
+
+ #ifndef AISLIB_CPU_DISPATCH_H
+ #define AISLIB_CPU_DISPATCH_H
+
+ #include <atomic>
+ #include <cstddef>
+ #include <cstdint>
+ #include <string>
+ #include <vector>
+
+ namespace aislib {
+ namespace cpu {
+
+ /**
+  * @enum Level
+  * @brief Instruction set levels with dedicated kernels
+  */
+ enum class Level {
+     SCALAR,  ///< Portable C++
+     SSE42,   ///< x86 SSE4.2
+     AVX2,    ///< x86 AVX2
+     AVX512,  ///< x86 AVX-512 (F and BW, with BMI2 for tail masks)
+     NEON     ///< ARM Advanced SIMD
+ };
+
+ /**
+  * @struct Kernels
+  * @brief Table of kernel implementations for one level
+  */
+ struct Kernels {
+     Level level;  ///< Level the kernels were written for
+
+     /**
+      * XOR of all bytes (the NMEA checksum of the range)
+      */
+     uint8_t (*xor_bytes)(const char* data, size_t length);
+
+     /**
+      * Convert 6-bit ASCII armored characters to their values (0-63).
+      * Returns false if a character is outside the payload alphabet, in
+      * which case the contents of values are unspecified.
+      */
+     bool (*dearmor)(const char* payload, size_t length, uint8_t* values);
+
+     /**
+      * Store the offsets of up to max_positions occurrences of a byte.
+      * Returns the number stored; stops scanning once max_positions is reached.
+      */
+     size_t (*find_all)(const char* data, size_t length, char delimiter, uint32_t* positions, size_t max_positions);
+
+     /**
+      * Store the great-circle distances in meters between count pairs of
+      * positions given in degrees (haversine formula on a sphere of radius
+      * geo::EARTH_RADIUS). Accurate to about a millimetre.
+      */
+     void (*haversine)(const double* lat1, const double* lon1, const double* lat2, const double* lon2,
+                       size_t count, double* meters);
+ };
+
+ /**
+  * @brief Get the highest level supported by this CPU
+  * @return Detected level
+  */
+ Level detected_level();
+
+ /**
+  * @brief Check whether the CPU can run the kernels of a level
+  * @param level Level
+  * @return True if supported
+  */
+ bool is_supported(Level level);
+
+ /**
+  * @brief Get all levels supported by this CPU
+  * @return Supported levels, scalar first
+  */
+ std::vector<Level> supported_levels();
+
+ /**
+  * @brief Get the level of the active kernels
+  * @return Active level
+  */
+ Level active_level();
+
+ /**
+  * @brief Bind the kernels of a level
+  * @param level Level
+  * @throws std::invalid_argument if the CPU does not support the level
+  *
+  * Not synchronized with threads that are parsing; call it before starting them.
+  */
+ void force_level(Level level);
+
+ /**
+  * @brief Bind the kernels selected at startup (detected level, limited by AISLIB_CPU_LEVEL)
+  */
+ void reset_level();
+
+ /**
+  * @brief Get the kernels of a specific level
+  * @param level Level
+  * @return Kernel table
+  * @throws std::invalid_argument if the CPU does not support the level
+  */
+ const Kernels& kernels_for(Level level);
+
+ /**
+  * @brief Get the name of a level
+  * @param level Level
+  * @return Name as accepted by parse_level
+  */
+ const char* level_name(Level level);
+
+ /**
+  * @brief Parse a level name
+  * @param name Level name (case-insensitive: scalar, sse4.2, avx2, avx512, neon)
+  * @return Level
+  * @throws std::invalid_argument if the name is unknown
+  */
+ Level parse_level(const std::string& name);
+
+ namespace detail {
+
+ extern std::atomic<const Kernels*> active;
+
+ // Select the startup kernels and bind them
+ const Kernels& initialize();
+
+ } // namespace detail
+
+ /**
+  * @brief Get the active kernels
+  * @return Kernel table, bound on first use
+  */
+ inline const Kernels& kernels() {
+     const Kernels* bound = detail::active.load(std::memory_order_acquire);
+     return bound != nullptr ? *bound : detail::initialize();
+ }
+
+ } // namespace cpu
+ } // namespace aislib
+
+ #endif // AISLIB_CPU_DISPATCH_H
@@ -0,0 +1,139 @@
+/**
+ * @file decode_cache.h
+ * @brief Cache of decoded messages keyed by their payload bits
+ *
+ * Static and voyage data (type 5) and Class B static data (type 24) are
+ * re-sent unchanged every few minutes by every vessel, and each report is
+ * usually heard by several receivers. The cache returns the previously
+ * decoded message when the payload bits are identical, so those repeats
+ * skip decoding. Decoded messages are shared and immutable.
+ */
+
+ #ifndef AISLIB_DECODE_CACHE_H
+ #define AISLIB_DECODE_CACHE_H
+
+ #include "aislib/ais_message.h"
+ #include "aislib/bit_vector.h"
+ #include <atomic>
+ #include <bitset>
+ #include <cstdint>
+ #include <list>
+ #include <memory>
+ #include <mutex>
+ #include <unordered_map>
+ #include <vector>
+
+ namespace aislib {
+
+ /**
+  * @class DecodeCache
+  * @brief Bounded LRU cache from payload bits to decoded messages
+  *
+  * Entries are keyed by a 64-bit hash of the bits and confirmed by comparing
+  * the bits themselves, so a hash collision is a miss and never returns the
+  * wrong message. Thread-safe; one cache can be shared by several parsers.
+  */
+ class DecodeCache {
+ public:
+     /**
+      * @struct Config
+      * @brief Cache configuration
+      */
+     struct Config {
+         size_t max_entries;             ///< Entries kept before the least recently used is evicted
+         std::bitset<64> message_types;  ///< Message types to cache; others are decoded directly
+
+         // Default constructor: static data types only
+         Config() : max_entries(8192), message_types() {
+             message_types.set(5);
+             message_types.set(24);
+         }
+     };
+
+     /**
+      * @struct Stats
+      * @brief Cache counters
+      */
+     struct Stats {
+         uint64_t hits = 0;       ///< Lookups answered from the cache
+         uint64_t misses = 0;     ///< Cacheable messages that had to be decoded
+         uint64_t bypassed = 0;   ///< Messages of types that are not cached
+         uint64_t evictions = 0;  ///< Entries dropped to respect max_entries
+         size_t entries = 0;      ///< Entries currently held
+
+         /**
+          * @brief Get the hit rate of cacheable lookups
+          * @return hits / (hits + misses), 0 if there were none
+          */
+         double hit_rate() const;
+     };
+
+     /**
+      * @brief Constructor
+      * @param config Cache configuration
+      */
+     explicit DecodeCache(const Config& config = Config());
+
+     DecodeCache(const DecodeCache&) = delete;
+     DecodeCache& operator=(const DecodeCache&) = delete;
+
+     /**
+      * @brief Decode a message, reusing the cached result for identical bits
+      * @param bits Complete message bits
+      * @param hit Set to whether the result came from the cache (optional)
+      * @return Decoded message
+      * @throws std::invalid_argument if the message cannot be decoded (not cached)
+      */
+     std::shared_ptr<const AISMessage> decode(const BitVector& bits, bool* hit = nullptr);
+
+     /**
+      * @brief Check whether a message type is cached
+      * @param message_type Message type
+      * @return True if cached
+      */
+     bool is_cacheable(uint8_t message_type) const;
+
+     /**
+      * @brief Get the cache counters
+      * @return Counters and current size
+      */
+     Stats get_stats() const;
+
+     /**
+      * @brief Remove all entries (counters are kept)
+      */
+     void clear();
+
+     /**
+      * @brief Hash the bits of a message
+      * @param bits Bit vector
+      * @return 64-bit hash of the bit count and the bits
+      */
+     static uint64_t hash_bits(const BitVector& bits);
+
+ private:
+     struct Entry {
+         uint64_t hash;
+         size_t bit_count;
+         std::vector<uint8_t> bytes;
+         std::shared_ptr<const AISMessage> message;
+     };
+
+     Config config_;
+
+     // Most recently used first
+     mutable std::mutex mutex_;
+     std::list<Entry> lru_;
+     std::unordered_map<uint64_t, std::list<Entry>::iterator> index_;
+
+     std::atomic<uint64_t> hits_;
+     std::atomic<uint64_t> misses_;
+     std::atomic<uint64_t> bypassed_;
+     std::atomic<uint64_t> evictions_;
+
+     static bool same_bits(const Entry& entry, const BitVector& bits);
+ };
+
+ } // namespace aislib
+
+ #endif // AISLIB_DECODE_CACHE_H
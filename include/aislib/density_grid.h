@@ -0,0 +1,265 @@
+/**
+ * @file density_grid.h
+ * @brief Traffic density aggregation over latitude/longitude or Web Mercator grids
+ *
+ * This file defines a grid that bins position reports into cells at
+ * several resolutions at once, counting reports, distinct MMSIs and the
+ * average speed per cell, and an aggregator that fills partial grids on
+ * worker threads and merges them into one result.
+ */
+
+ #ifndef AISLIB_DENSITY_GRID_H
+ #define AISLIB_DENSITY_GRID_H
+
+ #include "aislib/ais_message.h"
+ #include "aislib/anomaly_detector.h"
+ #include "aislib/hyperloglog.h"
+ #include <bitset>
+ #include <cstdint>
+ #include <unordered_map>
+ #include <vector>
+
+ namespace aislib {
+
+ /**
+  * @enum GridProjection
+  * @brief How positions map to grid cells
+  */
+ enum class GridProjection : uint8_t {
+     LAT_LON,       ///< Square cells of cell_size degrees, x eastward from 180 W, y northward from 90 S
+     WEB_MERCATOR   ///< Slippy map tiles, x eastward from 180 W, y southward from 85.0511 N
+ };
+
+ /**
+  * @struct DensityCell
+  * @brief Aggregates of one grid cell
+  */
+ struct DensityCell {
+     uint32_t level = 0;           ///< Level, 0 being the finest
+     uint32_t x = 0;               ///< Column
+     uint32_t y = 0;               ///< Row
+     uint64_t reports = 0;         ///< Reports in the cell
+     double vessels = 0.0;         ///< Estimated distinct MMSIs
+     double average_speed = 0.0;   ///< Average speed over ground in knots, NaN if no report had one
+ };
+
+ /**
+  * @class DensityGrid
+  * @brief Report counts, distinct vessels and average speed per cell at several levels
+  *
+  * Level 0 is the finest; each further level has cells twice as large in
+  * each direction. For LAT_LON level 0 cells are cell_size degrees; for
+  * WEB_MERCATOR level 0 cells are the tiles of zoom, level 1 the tiles of
+  * zoom - 1, and so on. Every report is added to one cell per level. Only
+  * cells with reports hold state. Grids with the same configuration merge
+  * exactly. Not thread-safe.
+  */
+ class DensityGrid {
+ public:
+     /**
+      * @struct Config
+      * @brief Grid configuration
+      */
+     struct Config {
+         GridProjection projection;  ///< Cell layout
+         double cell_size;           ///< LAT_LON: level 0 cell size in degrees
+         uint32_t zoom;              ///< WEB_MERCATOR: zoom of level 0 (at most 28)
+         uint32_t levels;            ///< Number of levels
+         uint8_t hll_precision;      ///< Precision of the distinct-vessel sketch per cell
+
+         // Default constructor: 0.01 degree cells and 4 levels up to 0.08 degrees
+         Config()
+             : projection(GridProjection::LAT_LON),
+               cell_size(0.01),
+               zoom(12),
+               levels(4),
+               hll_precision(8) {}
+     };
+
+     /**
+      * @brief Constructor
+      * @param config Grid configuration
+      * @throws std::invalid_argument if the configuration is out of range
+      */
+     explicit DensityGrid(const Config& config = Config());
+
+     /**
+      * @brief Add a report
+      * @param mmsi Reporting vessel
+      * @param latitude Latitude in degrees
+      * @param longitude Longitude in degrees
+      * @param speed Speed over ground in knots, NaN if not available
+      * @return False if the position is not available or outside the projection
+      */
+     bool add(uint32_t mmsi, double latitude, double longitude, float speed);
+
+     /**
+      * @brief Add the cells of another grid
+      * @param other Grid with the same configuration
+      * @throws std::invalid_argument if the configurations differ
+      */
+     void merge(const DensityGrid& other);
+
+     /**
+      * @brief Get the cells of a level that hold reports
+      * @param level Level
+      * @return Cells in no particular order
+      */
+     std::vector<DensityCell> get_cells(uint32_t level) const;
+
+     /**
+      * @brief Find the cell containing a position
+      * @param latitude Latitude in degrees
+      * @param longitude Longitude in degrees
+      * @param level Level
+      * @param x Output column
+      * @param y Output row
+      * @return False if the position is outside the projection
+      */
+     bool cell_of(double latitude, double longitude, uint32_t level, uint32_t& x, uint32_t& y) const;
+
+     /**
+      * @brief Get the bounds of a cell
+      * @param level Level
+      * @param x Column
+      * @param y Row
+      * @param min_lat Output southern edge in degrees
+      * @param min_lon Output western edge in degrees
+      * @param max_lat Output northern edge in degrees
+      * @param max_lon Output eastern edge in degrees
+      */
+     void cell_bounds(uint32_t level, uint32_t x, uint32_t y,
+                      double& min_lat, double& min_lon, double& max_lat, double& max_lon) const;
+
+     /**
+      * @brief Get the number of reports added
+      * @return Number of reports
+      */
+     uint64_t get_reports() const;
+
+     /**
+      * @brief Get the number of cells holding reports, over all levels
+      * @return Number of cells
+      */
+     size_t cell_count() const;
+
+     /**
+      * @brief Get the configuration
+      * @return Configuration
+      */
+     const Config& get_config() const;
+
+     /**
+      * @brief Remove all reports
+      */
+     void clear();
+
+ private:
+     struct Cell {
+         uint64_t reports;
+         uint64_t speed_reports;
+         double speed_sum;
+         HyperLogLog vessels;
+
+         explicit Cell(uint8_t precision)
+             : reports(0), speed_reports(0), speed_sum(0.0), vessels(precision) {}
+     };
+
+     Config config_;
+     std::unordered_map<uint64_t, Cell> cells_;  // Key: level, x and y
+     uint64_t reports_;
+
+     static uint64_t key(uint32_t level, uint32_t x, uint32_t y);
+     Cell& cell(uint64_t cell_key);
+ };
+
+ /**
+  * @class DensityAggregator
+  * @brief Parallel density aggregation with ship-type filtering
+  *
+  * add() splits a batch between worker threads. Each worker fills its own
+  * partial grid, so workers share nothing while they run; result() merges
+  * the partial grids. Ship types are learned from static data messages
+  * (types 5, 19 and 24 part B). With a ship-type filter set, reports from
+  * vessels whose ship type is not yet known are skipped. The aggregator
+  * itself is not thread-safe: add() and update_static() must not be called
+  * concurrently.
+  */
+ class DensityAggregator {
+ public:
+     /**
+      * @struct Config
+      * @brief Aggregator configuration
+      */
+     struct Config {
+         DensityGrid::Config grid;        ///< Grid configuration
+         unsigned threads;                ///< Worker threads, 0 for one per hardware thread
+         size_t min_rows_per_thread;      ///< Batches smaller than this per worker use fewer workers
+         std::vector<uint8_t> ship_types; ///< Ship types to include, empty for all vessels
+
+         // Default constructor
+         Config()
+             : threads(0),
+               min_rows_per_thread(16384) {}
+     };
+
+     /**
+      * @brief Constructor
+      * @param config Aggregator configuration
+      * @throws std::invalid_argument if the grid configuration is out of range
+      */
+     explicit DensityAggregator(const Config& config = Config());
+
+     /**
+      * @brief Learn a vessel's ship type from a static data message
+      * @param message Decoded message
+      * @return True if the message carried a ship type
+      */
+     bool update_static(const AISMessage& message);
+
+     /**
+      * @brief Set a vessel's ship type
+      * @param mmsi Vessel
+      * @param ship_type Ship type (same values as in message type 5)
+      */
+     void set_ship_type(uint32_t mmsi, uint8_t ship_type);
+
+     /**
+      * @brief Add the rows of a batch
+      * @param batch Position reports; the anomalies column is not used
+      * @return Number of rows added to the grid
+      */
+     size_t add(const PositionBatch& batch);
+
+     /**
+      * @brief Merge the partial grids and get the result
+      * @return Grid with every report added so far
+      */
+     const DensityGrid& result();
+
+     /**
+      * @brief Get the number of worker threads
+      * @return Number of workers
+      */
+     unsigned get_threads() const;
+
+     /**
+      * @brief Remove all reports, keeping the known ship types
+      */
+     void clear();
+
+ private:
+     Config config_;
+     unsigned threads_;
+     std::bitset<256> accepted_types_;
+     std::unordered_map<uint32_t, uint8_t> ship_types_;
+     std::vector<DensityGrid> partials_;  // One per worker
+     DensityGrid result_;
+
+     // Add rows [begin, end) of a batch to a partial grid
+     size_t add_rows(const PositionBatch& batch, size_t begin, size_t end, DensityGrid& grid) const;
+ };
+
+ } // namespace aislib
+
+ #endif // AISLIB_DENSITY_GRID_H
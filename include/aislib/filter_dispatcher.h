@@ -0,0 +1,193 @@
+/**
+ * @file filter_dispatcher.h
+ * @brief Routing of decoded messages to many filtered subscribers
+ *
+ * This file defines a dispatcher that compiles the filters of all
+ * subscribers into shared indexes, one subscriber bitset per message type,
+ * listed MMSI, ship type and grid cell. A message is routed by combining
+ * the bitsets of its type, MMSI, ship type and cell word by word, so the
+ * cost per message grows with the number of subscriber words, not with
+ * the number of filters evaluated.
+ */
+
+ #ifndef AISLIB_FILTER_DISPATCHER_H
+ #define AISLIB_FILTER_DISPATCHER_H
+
+ #include "aislib/ais_message.h"
+ #include <cstdint>
+ #include <unordered_map>
+ #include <vector>
+
+ namespace aislib {
+
+ /**
+  * @struct SubscriptionFilter
+  * @brief Messages a subscriber receives
+  *
+  * A message matches when it passes every criterion that is not empty;
+  * within a criterion any entry may match. An empty filter matches every
+  * message.
+  */
+ struct SubscriptionFilter {
+     /**
+      * @struct Box
+      * @brief Bounding box in degrees; a box with min_lon above max_lon crosses the 180th meridian
+      */
+     struct Box {
+         double min_lat = -90.0;
+         double min_lon = -180.0;
+         double max_lat = 90.0;
+         double max_lon = 180.0;
+     };
+
+     std::vector<uint8_t> message_types;   ///< Message types (1-63), empty for all
+     std::vector<uint32_t> mmsis;          ///< Source MMSIs, empty for all
+     std::vector<Box> boxes;               ///< Areas; messages without a position do not match, empty for anywhere
+     std::vector<uint8_t> ship_types;      ///< Ship types; vessels of unknown type do not match, empty for all
+ };
+
+ /**
+  * @class FilterDispatcher
+  * @brief Bitset-indexed subscription matching
+  *
+  * Subscriptions are compiled into bitsets with one bit per subscriber:
+  * one per message type, one per listed MMSI plus one for subscribers that
+  * list none, one per ship type, and one per grid cell a box overlaps.
+  * Cells that a box covers only partly mark the subscriber as a candidate
+  * whose boxes are tested exactly, which happens only for subscribers that
+  * passed every other criterion. Boxes overlapping more than
+  * max_cells_per_box cells are tested that way for every positioned
+  * message instead of being indexed.
+  *
+  * Positions are taken from types 1-3, 18 and 19. Ship types are learned
+  * from static data messages (types 5, 19 and 24 part B) or set with
+  * set_ship_type(). Changing the subscriptions marks the indexes stale;
+  * they are rebuilt by the next route() or by compile(). Not thread-safe.
+  */
+ class FilterDispatcher {
+ public:
+     /**
+      * @struct Config
+      * @brief Dispatcher configuration
+      */
+     struct Config {
+         double cell_size;           ///< Grid cell size in degrees
+         size_t max_cells_per_box;   ///< Cells a box may overlap before it is tested for every message
+
+         // Default constructor: 1 degree cells
+         Config()
+             : cell_size(1.0),
+               max_cells_per_box(4096) {}
+     };
+
+     /**
+      * @brief Constructor
+      * @param config Dispatcher configuration
+      * @throws std::invalid_argument if cell_size is not positive
+      */
+     explicit FilterDispatcher(const Config& config = Config());
+
+     /**
+      * @brief Add a subscription
+      * @param filter Messages the subscriber receives
+      * @return Subscriber ID; IDs of removed subscriptions are reused
+      * @throws std::invalid_argument if a message type is above 63 or a box is invalid
+      */
+     uint32_t subscribe(const SubscriptionFilter& filter);
+
+     /**
+      * @brief Remove a subscription
+      * @param subscriber Subscriber ID
+      * @return False if there is no such subscription
+      */
+     bool unsubscribe(uint32_t subscriber);
+
+     /**
+      * @brief Learn a vessel's ship type from a static data message
+      * @param message Decoded message
+      * @return True if the message carried a ship type
+      */
+     bool update_static(const AISMessage& message);
+
+     /**
+      * @brief Set a vessel's ship type
+      * @param mmsi Vessel
+      * @param ship_type Ship type (same values as in message type 5)
+      */
+     void set_ship_type(uint32_t mmsi, uint8_t ship_type);
+
+     /**
+      * @brief Rebuild the indexes after subscriptions changed
+      */
+     void compile();
+
+     /**
+      * @brief Find the subscribers of a message
+      * @param message_type Message type
+      * @param mmsi Source MMSI
+      * @param latitude Latitude in degrees, 91 if the message has no position
+      * @param longitude Longitude in degrees, 181 if the message has no position
+      * @param subscribers Vector the subscriber IDs are written to, in ascending order
+      * @return Number of subscribers
+      */
+     size_t route(uint8_t message_type, uint32_t mmsi, double latitude, double longitude,
+                  std::vector<uint32_t>& subscribers);
+
+     /**
+      * @brief Find the subscribers of a decoded message
+      * @param message Message; static data messages also update the vessel's ship type
+      * @param subscribers Vector the subscriber IDs are written to, in ascending order
+      * @return Number of subscribers
+      */
+     size_t route(const AISMessage& message, std::vector<uint32_t>& subscribers);
+
+     /**
+      * @brief Get the number of subscriptions
+      * @return Subscriptions held
+      */
+     size_t size() const;
+
+ private:
+     struct Subscription {
+         bool active;
+         SubscriptionFilter filter;
+     };
+
+     // Bitsets of one grid cell: boxes covering the whole cell and boxes covering part of it
+     struct Cell {
+         size_t full;      // Offsets into bits_
+         size_t partial;
+     };
+
+     Config config_;
+     std::vector<Subscription> subscriptions_;
+     std::vector<uint32_t> free_ids_;
+     std::unordered_map<uint32_t, uint8_t> ship_types_;
+     bool stale_;
+
+     // Compiled indexes; every bitset is words_ words of bits_
+     size_t words_;
+     std::vector<uint64_t> bits_;
+     size_t type_bits_;       // 64 bitsets, one per message type
+     size_t ship_bits_;       // 256 bitsets, one per ship type
+     size_t any_mmsi_;        // Subscribers without an MMSI list
+     size_t any_ship_;        // Subscribers without a ship-type list
+     size_t any_position_;    // Subscribers without boxes
+     size_t wide_;            // Subscribers with a box too large to index
+     std::unordered_map<uint32_t, size_t> mmsi_bits_;
+     std::unordered_map<uint64_t, Cell> cells_;
+     std::vector<SubscriptionFilter::Box> boxes_;   // Boxes of all subscribers, for the exact tests
+     std::vector<uint32_t> first_box_;              // Per subscriber, plus one past the end
+
+     size_t allocate_bitset();
+     void set_bit(size_t bitset, uint32_t subscriber);
+     void index_box(uint32_t subscriber, double min_lat, double min_lon, double max_lat, double max_lon);
+     bool in_boxes(uint32_t subscriber, double latitude, double longitude) const;
+
+     int64_t cell_coordinate(double degrees) const;
+     static uint64_t cell_key(int64_t row, int64_t column);
+ };
+
+ } // namespace aislib
+
+ #endif // AISLIB_FILTER_DISPATCHER_H
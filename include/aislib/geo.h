@@ -0,0 +1,49 @@
+/**
+ * @file geo.h
+ * @brief Great-circle distances between positions
+ *
+ * This file defines the scalar and batch haversine distance functions used
+ * by the track analytics. The batch form runs the CPU-dispatched kernel
+ * over arrays of coordinates.
+ */
+
+ #ifndef AISLIB_GEO_H
+ #define AISLIB_GEO_H
+
+ #include <cstddef>
+
+ namespace aislib {
+ namespace geo {
+
+ /// Mean Earth radius in meters (IUGG)
+ const double EARTH_RADIUS = 6371008.8;
+
+ /// Meters in one nautical mile
+ const double METERS_PER_NM = 1852.0;
+
+ /**
+  * @brief Great-circle distance between two positions
+  * @param lat1 Latitude of the first position in degrees
+  * @param lon1 Longitude of the first position in degrees
+  * @param lat2 Latitude of the second position in degrees
+  * @param lon2 Longitude of the second position in degrees
+  * @return Distance in meters
+  */
+ double haversine(double lat1, double lon1, double lat2, double lon2);
+
+ /**
+  * @brief Great-circle distances between pairs of positions
+  * @param lat1 Latitudes of the first positions in degrees
+  * @param lon1 Longitudes of the first positions in degrees
+  * @param lat2 Latitudes of the second positions in degrees
+  * @param lon2 Longitudes of the second positions in degrees
+  * @param count Number of pairs
+  * @param meters Output distances in meters (count entries)
+  */
+ void haversine_batch(const double* lat1, const double* lon1, const double* lat2, const double* lon2,
+                      size_t count, double* meters);
+
+ } // namespace geo
+ } // namespace aislib
+
+ #endif // AISLIB_GEO_H
@@ -0,0 +1,262 @@
+/**
+ * @file geofence.h
+ * @brief Streaming geofence enter, exit and dwell events
+ *
+ * This file defines an engine that holds circular and polygonal fences in
+ * a uniform grid index and tests each position report only against the
+ * fences whose grid cells contain it. It keeps, per vessel, the fences the
+ * vessel is inside and reports when it enters, leaves or has stayed in one
+ * for the configured dwell time.
+ */
+
+ #ifndef AISLIB_GEOFENCE_H
+ #define AISLIB_GEOFENCE_H
+
+ #include "aislib/ais_message.h"
+ #include "aislib/application/area_notice.h"
+ #include <cstdint>
+ #include <unordered_map>
+ #include <utility>
+ #include <vector>
+
+ namespace aislib {
+
+ /**
+  * @struct GeofenceEvent
+  * @brief Change of a vessel's presence in a fence
+  */
+ struct GeofenceEvent {
+     /**
+      * @enum Type
+      * @brief Event types
+      */
+     enum class Type : uint8_t {
+         ENTER,  ///< First report inside the fence
+         EXIT,   ///< First report outside the fence, or state expired
+         DWELL   ///< Inside the fence for at least the dwell time
+     };
+
+     Type type = Type::ENTER;   ///< Event type
+     uint32_t mmsi = 0;         ///< Vessel
+     uint32_t fence_id = 0;     ///< Fence
+     double time = 0.0;         ///< Time of the report that caused the event (Unix seconds)
+     double enter_time = 0.0;   ///< Time the vessel entered the fence (Unix seconds)
+ };
+
+ /**
+  * @class GeofenceEngine
+  * @brief Grid-indexed fences with per-vessel presence state
+  *
+  * Fences are indexed in every grid cell their bounding box overlaps;
+  * fences overlapping more than max_cells_per_fence cells are kept in a
+  * list tested for every report instead. Distances are computed on a local
+  * flat-earth approximation, which is accurate for fences up to a few tens
+  * of kilometres across. Fences may cross the 180th meridian: polygon
+  * edges take the shorter way round, and polygons must not encircle a
+  * pole.
+  *
+  * Only vessels inside at least one fence hold state, so memory follows the
+  * number of vessels inside fences, not the number of vessels seen.
+  * Not thread-safe.
+  */
+ class GeofenceEngine {
+ public:
+     /**
+      * @struct Config
+      * @brief Engine configuration
+      */
+     struct Config {
+         double cell_size;              ///< Grid cell size in degrees
+         size_t max_cells_per_fence;    ///< Cells a fence may occupy before it is tested for every report
+         double dwell_time;             ///< Seconds inside a fence before a DWELL event, 0 to disable
+         double state_timeout;          ///< Seconds without reports after which expire() drops a vessel
+
+         // Default constructor: 0.05 degree cells, 10 minute dwell, 30 minute timeout
+         Config()
+             : cell_size(0.05),
+               max_cells_per_fence(4096),
+               dwell_time(600.0),
+               state_timeout(1800.0) {}
+     };
+
+     /**
+      * @struct Stats
+      * @brief Engine counters
+      */
+     struct Stats {
+         uint64_t evaluations = 0;   ///< Position reports evaluated
+         uint64_t candidates = 0;    ///< Fences tested after the grid lookup
+         uint64_t out_of_order = 0;  ///< Reports ignored for being older than the vessel's last report
+         uint64_t events = 0;        ///< Events emitted
+         size_t fences = 0;          ///< Fences held
+         size_t vessels = 0;         ///< Vessels inside at least one fence
+     };
+
+     /**
+      * @brief Constructor
+      * @param config Engine configuration
+      * @throws std::invalid_argument if cell_size is not positive
+      */
+     explicit GeofenceEngine(const Config& config = Config());
+
+     /**
+      * @brief Add a circular fence
+      * @param id Fence ID
+      * @param latitude Centre latitude in degrees
+      * @param longitude Centre longitude in degrees
+      * @param radius Radius in meters
+      * @throws std::invalid_argument if the ID is in use, the centre is invalid or the radius is not positive
+      */
+     void add_circle(uint32_t id, double latitude, double longitude, double radius);
+
+     /**
+      * @brief Add a polygonal fence
+      * @param id Fence ID
+      * @param vertices Vertices as (latitude, longitude) pairs in degrees; the polygon is closed implicitly
+      * @throws std::invalid_argument if the ID is in use, a vertex is invalid, there are fewer than 3 vertices
+      *         or the polygon encircles a pole
+      */
+     void add_polygon(uint32_t id, const std::vector<std::pair<double, double>>& vertices);
+
+     /**
+      * @brief Add the sub-areas of an area notice as fences
+      * @param notice Area notice
+      * @param first_id ID of the first fence; following fences take consecutive IDs
+      * @return Number of fences added
+      * @throws std::invalid_argument if one of the IDs is in use
+      *
+      * Circles become circular fences; rectangles and sectors become
+      * polygons. Consecutive polygon sub-areas form one polygon from their
+      * reference points and points. Text and polyline sub-areas, and shapes
+      * without extent, are skipped.
+      */
+     size_t add_area_notice(const application::AreaNotice& notice, uint32_t first_id);
+
+     /**
+      * @brief Remove a fence
+      * @param id Fence ID
+      * @return False if no fence has this ID
+      *
+      * Vessels inside the fence leave it without an EXIT event.
+      */
+     bool remove_fence(uint32_t id);
+
+     /**
+      * @brief Check whether a position is inside a fence
+      * @param id Fence ID
+      * @param latitude Latitude in degrees
+      * @param longitude Longitude in degrees
+      * @return False if outside or no fence has this ID
+      */
+     bool contains(uint32_t id, double latitude, double longitude) const;
+
+     /**
+      * @brief Evaluate a position report
+      * @param mmsi Vessel
+      * @param latitude Latitude in degrees
+      * @param longitude Longitude in degrees
+      * @param time Time of the report (Unix seconds)
+      * @param events Vector the events are appended to
+      * @return Number of events appended
+      *
+      * Unavailable positions (latitude 91, longitude 181) and reports older
+      * than the vessel's last evaluated report are ignored.
+      */
+     size_t update(uint32_t mmsi, double latitude, double longitude, double time, std::vector<GeofenceEvent>& events);
+
+     /**
+      * @brief Evaluate a decoded message
+      * @param message Message; only position reports (types 1-3, 18 and 19) are evaluated
+      * @param time Time of the report (Unix seconds)
+      * @param events Vector the events are appended to
+      * @return Number of events appended
+      */
+     size_t update(const AISMessage& message, double time, std::vector<GeofenceEvent>& events);
+
+     /**
+      * @brief Drop vessels without reports for state_timeout
+      * @param now Current time (Unix seconds)
+      * @param events Vector the EXIT events of dropped vessels are appended to
+      * @return Number of events appended
+      */
+     size_t expire(double now, std::vector<GeofenceEvent>& events);
+
+     /**
+      * @brief Get the IDs of the fences a vessel is inside
+      * @param mmsi Vessel
+      * @return Fence IDs, in order of entry
+      */
+     std::vector<uint32_t> get_fences(uint32_t mmsi) const;
+
+     /**
+      * @brief Remove all vessel state, keeping the fences
+      */
+     void clear_vessels();
+
+     /**
+      * @brief Remove all fences and vessel state
+      */
+     void clear();
+
+     /**
+      * @brief Get the engine counters
+      * @return Counters
+      */
+     Stats get_stats() const;
+
+ private:
+     enum class Shape : uint8_t { CIRCLE, POLYGON };
+
+     // Fence geometry; polygon vertices live in vertex_lat_/vertex_lon_
+     struct Fence {
+         uint32_t id;
+         Shape shape;
+         bool removed;
+         bool wide;              // Kept in wide_ instead of the grid
+         double min_lat, max_lat, min_lon, max_lon;  // max_lon exceeds 180 across the 180th meridian
+         double center_lat, center_lon;
+         double meters_per_degree_lon;
+         double radius_squared;  // Square of the radius in meters
+         uint32_t first_vertex;
+         uint32_t vertex_count;
+     };
+
+     // Presence of a vessel in one fence
+     struct Membership {
+         uint32_t fence;         // Index into fences_
+         double enter_time;
+         bool dwell_reported;
+     };
+
+     struct Vessel {
+         double last_time;
+         std::vector<Membership> inside;
+     };
+
+     Config config_;
+     std::vector<Fence> fences_;
+     std::vector<double> vertex_lat_;
+     std::vector<double> vertex_lon_;
+     std::unordered_map<uint32_t, uint32_t> fence_index_;              // Fence ID to index
+     std::unordered_map<uint64_t, std::vector<uint32_t>> cells_;       // Grid cell to fence indices
+     std::vector<uint32_t> wide_;                                      // Fences tested for every report
+     std::unordered_map<uint32_t, Vessel> vessels_;
+     std::vector<uint32_t> hits_;                                      // Scratch: fences containing a report
+     Stats stats_;
+
+     // Register a fence whose geometry has been filled in
+     void insert(Fence& fence);
+
+     // Exact containment test, bounding box included
+     bool inside(const Fence& fence, double latitude, double longitude) const;
+
+     // Grid columns of a fence: two ranges if it crosses the 180th meridian
+     size_t column_ranges(const Fence& fence, int64_t columns[2][2]) const;
+
+     int64_t cell_coordinate(double degrees) const;
+     static uint64_t cell_key(int64_t row, int64_t column);
+ };
+
+ } // namespace aislib
+
+ #endif // AISLIB_GEOFENCE_H
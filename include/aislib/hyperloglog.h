@@ -0,0 +1,95 @@
+/**
+ * @file hyperloglog.h
+ * @brief HyperLogLog distinct-count sketch
+ *
+ * This file defines the sketch used to count distinct MMSIs per grid cell.
+ * Sketches of the same precision merge into the sketch of the union of
+ * their inputs, so counts can be built in parallel and combined.
+ */
+
+ #ifndef AISLIB_HYPERLOGLOG_H
+ #define AISLIB_HYPERLOGLOG_H
+
+ #include <cstddef>
+ #include <cstdint>
+ #include <vector>
+
+ namespace aislib {
+
+ /**
+  * @class HyperLogLog
+  * @brief Distinct-count sketch with 2^precision registers
+  *
+  * The relative standard error is about 1.04 / sqrt(2^precision). A sketch
+  * starts sparse, holding only the registers that have been set, and
+  * switches to a dense register array once that is smaller. Small sketches
+  * therefore take a few bytes, which matters when there is one per grid
+  * cell. Not thread-safe.
+  */
+ class HyperLogLog {
+ public:
+     static const uint8_t MIN_PRECISION = 4;   ///< Smallest precision (16 registers)
+     static const uint8_t MAX_PRECISION = 16;  ///< Largest precision (65536 registers)
+
+     /**
+      * @brief Constructor
+      * @param precision Number of index bits
+      * @throws std::invalid_argument if precision is outside MIN_PRECISION..MAX_PRECISION
+      */
+     explicit HyperLogLog(uint8_t precision = 10);
+
+     /**
+      * @brief Add an item
+      * @param hash Well-mixed 64-bit hash of the item
+      */
+     void add(uint64_t hash);
+
+     /**
+      * @brief Add the items of another sketch
+      * @param other Sketch of the same precision
+      * @throws std::invalid_argument if the precisions differ
+      */
+     void merge(const HyperLogLog& other);
+
+     /**
+      * @brief Estimate the number of distinct items added
+      * @return Estimated count
+      */
+     double estimate() const;
+
+     /**
+      * @brief Get the precision
+      * @return Number of index bits
+      */
+     uint8_t get_precision() const;
+
+     /**
+      * @brief Check whether the sketch still holds only the registers that are set
+      * @return True if sparse
+      */
+     bool is_sparse() const;
+
+     /**
+      * @brief Remove all items
+      */
+     void clear();
+
+     /**
+      * @brief Hash a 32-bit key, such as an MMSI, for add()
+      * @param key Key
+      * @return 64-bit hash
+      */
+     static uint64_t hash(uint32_t key);
+
+ private:
+     uint8_t precision_;
+     std::vector<uint32_t> sparse_;    // Register index << 8 | rank, one entry per set register
+     std::vector<uint8_t> registers_;  // Dense registers, empty while sparse
+
+     void set_register(uint32_t index, uint8_t rank);
+     void densify();
+ };
+
+ } // namespace aislib
+
+ #endif // AISLIB_HYPERLOGLOG_H
@@ -0,0 +1,256 @@
+/**
+ * @file metrics.h
+ * @brief Low-overhead parser metrics
+ *
+ * This file defines the MetricsRegistry class, which collects counters and
+ * latency histograms from AISParser and MultipartMessageManager. Recording
+ * goes to one of several cache-line aligned shards selected per thread, so
+ * parsers on different threads can share a registry without contending on
+ * the same counters. Reading is done through snapshots, which sum the shards.
+ */
+
+ #ifndef AISLIB_METRICS_H
+ #define AISLIB_METRICS_H
+
+ #include "ais_parser.h"
+ #include <array>
+ #include <atomic>
+ #include <chrono>
+ #include <cstdint>
+ #include <memory>
+ #include <string>
+ #include <vector>
+
+ namespace aislib {
+
+ /**
+  * @struct HistogramSnapshot
+  * @brief Point-in-time copy of a latency histogram
+  *
+  * Buckets are log-linear in the style of HDR histograms: values up to 16
+  * have exact buckets, and every power of two above is divided into 16
+  * sub-buckets, giving a relative error of at most 1/16. Sub-buckets
+  * include their upper end, so every power of two is the upper bound of
+  * a bucket.
+  */
+ struct HistogramSnapshot {
+     std::vector<uint64_t> counts; ///< Count per bucket
+     uint64_t total_count = 0;     ///< Number of recorded values
+     uint64_t sum = 0;             ///< Sum of recorded values (nanoseconds)
+
+     /**
+      * @brief Get the value at a quantile
+      * @param quantile Quantile (0.0-1.0)
+      * @return Upper bound of the bucket containing the quantile, 0 if empty
+      */
+     uint64_t value_at_quantile(double quantile) const;
+
+     /**
+      * @brief Get the bucket index for a value
+      * @param value Value in nanoseconds
+      * @return Bucket index
+      */
+     static size_t bucket_index(uint64_t value);
+
+     /**
+      * @brief Get the largest value that falls into a bucket
+      * @param index Bucket index
+      * @return Inclusive upper bound of the bucket
+      */
+     static uint64_t bucket_upper_bound(size_t index);
+ };
+
+ /**
+  * @struct MetricsSnapshot
+  * @brief Point-in-time copy of all metrics of a registry
+  */
+ struct MetricsSnapshot {
+     /// Number of error types in AISParser::ParseError::ErrorType
+     static constexpr size_t kErrorTypeCount = static_cast<size_t>(AISParser::ParseError::ErrorType::OTHER) + 1;
+
+     uint64_t sentences = 0;                          ///< Sentences passed to the parser
+     std::array<uint64_t, 64> messages_by_type{};     ///< Decoded messages per AIS message type
+     std::array<uint64_t, kErrorTypeCount> errors{};  ///< Parse failures per error type (index NONE unused)
+     uint64_t multipart_completed = 0;                ///< Multi-part messages reassembled
+     uint64_t multipart_evicted = 0;                  ///< Incomplete messages dropped to respect the limit
+     uint64_t multipart_expired = 0;                  ///< Incomplete messages dropped after the timeout
+     uint64_t decode_cache_hits = 0;                  ///< Messages answered by the decode cache
+     uint64_t decode_cache_misses = 0;                ///< Cacheable messages that had to be decoded
+     HistogramSnapshot parse_latency;                 ///< Time spent in AISParser::parse (ns)
+     HistogramSnapshot reassembly_dwell;              ///< First fragment to completion (ns)
+
+     /**
+      * @brief Get the total number of decoded messages
+      * @return Sum over all message types
+      */
+     uint64_t total_messages() const;
+
+     /**
+      * @brief Get the total number of parse failures
+      * @return Sum over all error types
+      */
+     uint64_t total_errors() const;
+ };
+
+ /**
+  * @class MetricsRegistry
+  * @brief Sharded counters and latency histograms
+  *
+  * All record methods are thread-safe and wait-free; each is a relaxed
+  * atomic increment on the calling thread's shard.
+  */
+ class MetricsRegistry {
+ public:
+     /// Number of histogram buckets; covers values up to 2^40 ns (about 18 minutes)
+     static constexpr size_t kHistogramBuckets = 17 + 36 * 16;
+
+     /**
+      * @brief Constructor
+      * @param shard_count Number of shards (rounded up to a power of two, 0 = one per hardware thread)
+      */
+     explicit MetricsRegistry(size_t shard_count = 0);
+
+     MetricsRegistry(const MetricsRegistry&) = delete;
+     MetricsRegistry& operator=(const MetricsRegistry&) = delete;
+
+     /**
+      * @brief Record a sentence passed to the parser
+      */
+     void record_sentence() {
+         increment(shard().sentences);
+     }
+
+     /**
+      * @brief Record a decoded message
+      * @param message_type AIS message type (0-63)
+      */
+     void record_message(uint8_t message_type) {
+         increment(shard().messages_by_type[message_type & 63]);
+     }
+
+     /**
+      * @brief Record a parse failure
+      * @param type Error type
+      */
+     void record_error(AISParser::ParseError::ErrorType type) {
+         increment(shard().errors[static_cast<size_t>(type) % MetricsSnapshot::kErrorTypeCount]);
+     }
+
+     /**
+      * @brief Record a completed multi-part message
+      * @param dwell Time from the first received fragment to completion
+      */
+     void record_multipart_completed(std::chrono::nanoseconds dwell) {
+         Shard& s = shard();
+         increment(s.multipart_completed);
+         record(s.reassembly_dwell, s.reassembly_dwell_sum, dwell);
+     }
+
+     /**
+      * @brief Record incomplete messages dropped to respect the limit
+      * @param count Number of messages dropped
+      */
+     void record_multipart_evicted(uint64_t count = 1) {
+         shard().multipart_evicted.fetch_add(count, std::memory_order_relaxed);
+     }
+
+     /**
+      * @brief Record incomplete messages dropped after the timeout
+      * @param count Number of messages dropped
+      */
+     void record_multipart_expired(uint64_t count = 1) {
+         shard().multipart_expired.fetch_add(count, std::memory_order_relaxed);
+     }
+
+     /**
+      * @brief Record a decode cache lookup
+      * @param hit True if the message came from the cache
+      */
+     void record_decode_cache(bool hit) {
+         Shard& s = shard();
+         increment(hit ? s.decode_cache_hits : s.decode_cache_misses);
+     }
+
+     /**
+      * @brief Record the time spent parsing one sentence
+      * @param latency Elapsed time
+      */
+     void record_parse_latency(std::chrono::nanoseconds latency) {
+         Shard& s = shard();
+         record(s.parse_latency, s.parse_latency_sum, latency);
+     }
+
+     /**
+      * @brief Take a snapshot of all metrics
+      * @return Sum of all shards
+      *
+      * Counters are read individually, so a snapshot taken while other
+      * threads record is not an atomic cut across counters.
+      */
+     MetricsSnapshot snapshot() const;
+
+     /**
+      * @brief Reset all metrics to zero
+      */
+     void reset();
+
+     /**
+      * @brief Get the number of shards
+      * @return Shard count
+      */
+     size_t get_shard_count() const;
+
+ private:
+     // Counters of one shard, aligned so that shards never share a cache line
+     struct alignas(64) Shard {
+         std::atomic<uint64_t> sentences{0};
+         std::array<std::atomic<uint64_t>, 64> messages_by_type{};
+         std::array<std::atomic<uint64_t>, MetricsSnapshot::kErrorTypeCount> errors{};
+         std::atomic<uint64_t> multipart_completed{0};
+         std::atomic<uint64_t> multipart_evicted{0};
+         std::atomic<uint64_t> multipart_expired{0};
+         std::atomic<uint64_t> decode_cache_hits{0};
+         std::atomic<uint64_t> decode_cache_misses{0};
+         std::atomic<uint64_t> parse_latency_sum{0};
+         std::atomic<uint64_t> reassembly_dwell_sum{0};
+         std::array<std::atomic<uint64_t>, kHistogramBuckets> parse_latency{};
+         std::array<std::atomic<uint64_t>, kHistogramBuckets> reassembly_dwell{};
+     };
+
+     std::unique_ptr<Shard[]> shards_;
+     size_t shard_mask_;
+
+     // Shard of the calling thread
+     Shard& shard() {
+         return shards_[thread_slot() & shard_mask_];
+     }
+
+     // Per-thread slot number, assigned round-robin on first use
+     static size_t thread_slot();
+
+     static void increment(std::atomic<uint64_t>& counter) {
+         counter.fetch_add(1, std::memory_order_relaxed);
+     }
+
+     static void record(std::array<std::atomic<uint64_t>, kHistogramBuckets>& buckets,
+                        std::atomic<uint64_t>& sum, std::chrono::nanoseconds value) {
+         uint64_t ns = value.count() > 0 ? static_cast<uint64_t>(value.count()) : 0;
+         increment(buckets[HistogramSnapshot::bucket_index(ns)]);
+         sum.fetch_add(ns, std::memory_order_relaxed);
+     }
+ };
+
+ /**
+  * @brief Render a snapshot in the Prometheus text exposition format
+  * @param snapshot Metrics snapshot
+  * @param prefix Metric name prefix
+  * @return Prometheus text format (version 0.0.4)
+  *
+  * Histograms are exported with power-of-two bucket boundaries in seconds.
+  * Each `le` bucket counts the samples at or below its boundary.
+  */
+ std::string to_prometheus(const MetricsSnapshot& snapshot, const std::string& prefix = "aislib");
+
+ } // namespace aislib
+
+ #endif // AISLIB_METRICS_H
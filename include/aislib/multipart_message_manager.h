@@ -19,6 +19,8 @@
  
  namespace aislib {
  
+ class MetricsRegistry;
+ 
  /**
   * @class MultipartMessageManager
   * @brief Handles reassembly of multipart AIS messages
@@ -82,6 +84,12 @@
       */
      void set_max_messages(size_t max_messages);
      
+     /**
+      * @brief Set the registry that completions, evictions and timeouts are recorded into
+      * @param metrics Metrics registry (nullptr = no metrics); must outlive the manager
+      */
+     void set_metrics(MetricsRegistry* metrics);
+     
  private:
      // Multipart message key
      struct MessageKey {
@@ -101,6 +109,7 @@
      // Multipart message information
      struct MessageInfo {
          std::vector<Fragment> fragments;
+         std::chrono::steady_clock::time_point first_received;
          std::chrono::steady_clock::time_point last_update;
          uint8_t received_count;
      };
@@ -114,6 +123,9 @@
      // Maximum number of incomplete messages to track
      size_t max_messages_;
      
+     // Metrics registry (may be null)
+     MetricsRegistry* metrics_;
+     
      // Combine fragments into a single bit vector
      BitVector combine_fragments(const std::vector<Fragment>& fragments);
  };
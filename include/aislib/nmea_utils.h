@@ -14,6 +14,15 @@
  
  namespace aislib {
  
+ /**
+  * @struct TagBlock
+  * @brief Fields of an NMEA 4.x tag block ("\\s:station,c:time*hh\\")
+  */
+ struct TagBlock {
+     std::string source;  ///< Source station (s:), empty if absent
+     double time;         ///< Receive time (c:) in Unix seconds, NaN if absent
+ };
+ 
  /**
   * @class NMEAUtils
   * @brief Utility functions for NMEA sentence processing
@@ -41,6 +50,24 @@
       */
      static std::vector<std::string> parse_fields(const std::string& sentence);
      
+     /**
+      * @brief Parse NMEA fields into an existing vector
+      * @param sentence NMEA sentence
+      * @param fields Vector receiving the fields; its storage is reused
+      */
+     static void parse_fields(const std::string& sentence, std::vector<std::string>& fields);
+     
+     /**
+      * @brief Parse the tag block in front of a sentence
+      * @param line Logged line, with or without a tag block
+      * @param tag Tag block fields (reset even if there is no tag block)
+      * @return Offset of the sentence in line (0 if there is no tag block)
+      * @throws std::invalid_argument if the tag block is unterminated or its checksum is wrong
+      *
+      * Times above 10^11 are taken to be in milliseconds, as written by some loggers.
+      */
+     static size_t parse_tag_block(const std::string& line, TagBlock& tag);
+     
      /**
       * @brief Create an AIVDM sentence
       * @param payload AIS message payload
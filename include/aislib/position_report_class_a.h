@@ -9,6 +9,7 @@
  #define AISLIB_POSITION_REPORT_CLASS_A_H
  
  #include "ais_message.h"
+ #include "communication_state.h"
  #include <cmath>
  
  namespace aislib {
@@ -161,6 +162,18 @@
       */
      bool get_raim_flag() const;
  
+     /**
+      * @brief Get the radio status
+      * @return Raw 19-bit communication state
+      */
+     uint32_t get_radio_status() const;
+     
+     /**
+      * @brief Get the decoded communication state
+      * @return ITDMA state for type 3, SOTDMA state otherwise
+      */
+     CommunicationState get_communication_state() const;
+ 
      /**
       * @brief Set the navigation status
       * @param status Navigation status
@@ -233,6 +246,12 @@
       */
      void set_raim_flag(bool raim);
  
+     /**
+      * @brief Set the radio status
+      * @param radio_status Raw 19-bit communication state (masked to 19 bits)
+      */
+     void set_radio_status(uint32_t radio_status);
+ 
      /**
       * @brief Convert the message to a bit vector
       * @param bits Bit vector to populate
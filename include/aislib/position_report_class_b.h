@@ -10,7 +10,10 @@
  #define AISLIB_POSITION_REPORT_CLASS_B_H
  
  #include "ais_message.h"
+ #include "aislib/communication_state.h"
+ #include "aislib/ais_string.h"
  #include <string>
+ #include <string_view>
  #include <cmath>
  
  namespace aislib {
@@ -150,6 +153,13 @@
       */
      uint32_t get_radio_status() const;
  
+     /**
+      * @brief Get the decoded communication state
+      * @return No TDMA state for carrier-sense units (CS flag set), otherwise
+      *         SOTDMA or ITDMA as selected by the top bit of the radio status
+      */
+     CommunicationState get_communication_state() const;
+ 
      /**
       * @brief Set the speed over ground
       * @param sog Speed over ground in knots
@@ -308,9 +318,9 @@
  
      /**
       * @brief Get the vessel name
-      * @return Vessel name
+      * @return Vessel name, valid while the message is alive
       */
-     std::string get_vessel_name() const;
+     std::string_view get_vessel_name() const;
  
      /**
       * @brief Get the ship type
@@ -350,9 +360,9 @@
  
      /**
       * @brief Set the vessel name
-      * @param name Vessel name
+      * @param name Vessel name (truncated to 20 characters)
       */
-     void set_vessel_name(const std::string& name);
+     void set_vessel_name(std::string_view name);
  
      /**
       * @brief Set the ship type
@@ -393,7 +403,7 @@
      std::string to_string() const override;
  
  private:
-     std::string vessel_name_;
+     ShipName vessel_name_;
      uint8_t ship_type_;
      uint16_t dimension_to_bow_;
      uint16_t dimension_to_stern_;
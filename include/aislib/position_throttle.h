@@ -0,0 +1,156 @@
+/**
+ * @file position_throttle.h
+ * @brief Per-vessel downsampling of position reports
+ *
+ * This file defines a stage that decides, per vessel, whether a position
+ * report is worth forwarding. A report passes when enough time has gone by
+ * since the vessel's last forwarded report, or when the vessel has moved,
+ * turned, changed speed or changed navigational status by more than the
+ * configured amounts. Everything else is dropped before it is serialized
+ * for downstream consumers.
+ */
+
+ #ifndef AISLIB_POSITION_THROTTLE_H
+ #define AISLIB_POSITION_THROTTLE_H
+
+ #include "aislib/ais_message.h"
+ #include <cstdint>
+ #include <vector>
+
+ namespace aislib {
+
+ /**
+  * @class PositionThrottle
+  * @brief Time, distance and heading-change policies over a flat per-MMSI table
+  *
+  * Each vessel holds a fixed-size entry with the time, position, course,
+  * speed and status of its last forwarded report, kept in an open-addressing
+  * table keyed by MMSI, so a decision is one probe and a few comparisons.
+  * Reports older than the vessel's last forwarded report are dropped.
+  * Messages other than position reports (types 1-3, 18 and 19) always pass.
+  * Not thread-safe.
+  */
+ class PositionThrottle {
+ public:
+     /**
+      * @struct Config
+      * @brief Throttle configuration; a change threshold of 0 disables that policy
+      */
+     struct Config {
+         double interval;       ///< Seconds after which the next report always passes
+         double min_spacing;    ///< Seconds within which no report passes, whatever changed
+         double distance;       ///< Meters moved that let a report pass early
+         double course_change;  ///< Degrees of course change that let a report pass early
+         double speed_change;   ///< Knots of speed change that let a report pass early
+         bool status_change;    ///< Let a report pass early when the navigational status changes
+         double max_age;        ///< Seconds without a forwarded report after which expire() drops a vessel
+
+         // Default constructor: one report per 30 seconds, sooner on a 15 degree turn or 2 knot change
+         Config()
+             : interval(30.0),
+               min_spacing(2.0),
+               distance(0.0),
+               course_change(15.0),
+               speed_change(2.0),
+               status_change(true),
+               max_age(3600.0) {}
+     };
+
+     /**
+      * @struct Stats
+      * @brief Throttle counters
+      */
+     struct Stats {
+         uint64_t reports = 0;        ///< Position reports decided
+         uint64_t passed = 0;         ///< Reports passed
+         uint64_t dropped = 0;        ///< Reports dropped, including out-of-order ones
+         uint64_t out_of_order = 0;   ///< Reports older than the vessel's last passed report
+         size_t vessels = 0;          ///< Vessels with state
+     };
+
+     /**
+      * @brief Constructor
+      * @param config Throttle configuration
+      * @throws std::invalid_argument if a setting is negative
+      */
+     explicit PositionThrottle(const Config& config = Config());
+
+     /**
+      * @brief Decide on a position report
+      * @param mmsi Reporting vessel
+      * @param time Time of the report (Unix seconds)
+      * @param latitude Latitude in degrees (91 = not available)
+      * @param longitude Longitude in degrees (181 = not available)
+      * @param speed Speed over ground in knots, NaN if not available
+      * @param course Course over ground in degrees, NaN if not available
+      * @param navigation_status Navigational status (15 = not defined or Class B)
+      * @return True if the report should be forwarded
+      */
+     bool accept(uint32_t mmsi, double time, double latitude, double longitude,
+                 float speed, float course, uint8_t navigation_status);
+
+     /**
+      * @brief Decide on a decoded message
+      * @param time Time of the report (Unix seconds)
+      * @param message Message; other types than 1-3, 18 and 19 always pass
+      * @return True if the message should be forwarded
+      */
+     bool accept(double time, const AISMessage& message);
+
+     /**
+      * @brief Check whether any report from a vessel could pass at a time
+      * @param mmsi Vessel
+      * @param time Time of the report (Unix seconds)
+      * @return False if the vessel's last passed report is later than time or less
+      *         than min_spacing before it, so a report can be dropped before its
+      *         position is decoded
+      */
+     bool may_accept(uint32_t mmsi, double time) const;
+
+     /**
+      * @brief Drop vessels without a passed report for max_age
+      * @param now Current time (Unix seconds)
+      * @return Number of vessels dropped
+      */
+     size_t expire(double now);
+
+     /**
+      * @brief Forget all vessels
+      */
+     void clear();
+
+     /**
+      * @brief Get the throttle counters
+      * @return Counters
+      */
+     Stats get_stats() const;
+
+ private:
+     static const uint32_t EMPTY = 0xFFFFFFFF;
+
+     // Last passed report of a vessel; mmsi is EMPTY for a free entry
+     struct Entry {
+         uint32_t mmsi;
+         uint8_t navigation_status;
+         float speed;
+         float course;
+         float latitude;
+         float longitude;
+         double time;
+     };
+
+     Config config_;
+     std::vector<Entry> table_;   // Open addressing with linear probing; size is a power of two
+     size_t count_;
+     Stats stats_;
+
+     // Entry of a vessel, or the free entry where it would go
+     size_t find(uint32_t mmsi) const;
+     void grow();
+     void store(Entry& entry, uint32_t mmsi, double time, double latitude, double longitude,
+                float speed, float course, uint8_t navigation_status);
+ };
+
+ } // namespace aislib
+
+ #endif // AISLIB_POSITION_THROTTLE_H
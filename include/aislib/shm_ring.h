@@ -0,0 +1,217 @@
+/**
+ * @file shm_ring.h
+ * @brief Shared-memory ring of decoded records for consumers in other processes
+ *
+ * This file defines a single-writer, multi-reader ring in a shared memory
+ * segment, either a named file under /dev/shm or an anonymous memfd whose
+ * descriptor is passed to the readers. The publisher parses each sentence
+ * once and writes a fixed-layout record plus variable-length side data,
+ * such as the raw sentence; every reader keeps its own cursor, never
+ * blocks the publisher, and detects when it has been lapped.
+ */
+
+ #ifndef AISLIB_SHM_RING_H
+ #define AISLIB_SHM_RING_H
+
+ #include "aislib/ais_message.h"
+ #include <cstddef>
+ #include <cstdint>
+ #include <string>
+
+ namespace aislib {
+
+ /**
+  * @struct ShmRecord
+  * @brief Fixed-layout decoded record carried by the ring
+  */
+ struct ShmRecord {
+     double time = 0.0;                ///< Receive time (Unix seconds)
+     double latitude = 91.0;           ///< Latitude in degrees (91 = not available)
+     double longitude = 181.0;         ///< Longitude in degrees (181 = not available)
+     uint32_t mmsi = 0;                ///< Source MMSI
+     float speed = 0.0f;               ///< Speed over ground in knots, NaN if not available
+     float course = 0.0f;              ///< Course over ground in degrees, NaN if not available
+     uint16_t heading = 511;           ///< True heading in degrees (511 = not available)
+     uint8_t message_type = 0;         ///< AIS message type
+     uint8_t navigation_status = 15;   ///< Navigational status (15 = not defined or Class B)
+ };
+
+ struct ShmRingHeader;
+ struct ShmRingSlot;
+
+ /**
+  * @class ShmRingPublisher
+  * @brief Creates a ring segment and writes records to it
+  *
+  * The segment holds a header, capacity record slots and a side area of
+  * side_capacity bytes, both used as rings. Each slot carries a sequence
+  * number that is odd while the slot is being written, so a reader can
+  * tell a consistent copy from one the publisher overwrote while it was
+  * reading. Publishing never waits for readers. Only one publisher may
+  * write to a segment. Linux only.
+  */
+ class ShmRingPublisher {
+ public:
+     /**
+      * @struct Config
+      * @brief Segment configuration
+      */
+     struct Config {
+         size_t capacity;        ///< Record slots, a power of two
+         size_t side_capacity;   ///< Bytes of side data, a power of two
+
+         // Default constructor: 65536 records and 4 MiB of side data
+         Config()
+             : capacity(65536),
+               side_capacity(size_t(1) << 22) {}
+     };
+
+     /**
+      * @brief Create a segment
+      * @param name File name under /dev/shm, or empty for an anonymous memfd segment
+      * @param config Segment configuration
+      * @throws std::invalid_argument if the name contains '/' or a capacity is not a power of two
+      * @throws std::runtime_error if the segment cannot be created or mapped
+      *
+      * A named segment replaces any file of the same name and is removed
+      * again by the destructor; readers that have it open keep their mapping.
+      */
+     explicit ShmRingPublisher(const std::string& name, const Config& config = Config());
+
+     /**
+      * @brief Destructor; unmaps the segment and removes its name
+      */
+     ~ShmRingPublisher();
+
+     ShmRingPublisher(const ShmRingPublisher&) = delete;
+     ShmRingPublisher& operator=(const ShmRingPublisher&) = delete;
+
+     /**
+      * @brief Publish a record
+      * @param record Record
+      * @param side Side data, may be null if side_length is 0
+      * @param side_length Bytes of side data
+      * @return Sequence number of the record
+      * @throws std::invalid_argument if side_length exceeds side_capacity
+      */
+     uint64_t publish(const ShmRecord& record, const char* side, size_t side_length);
+
+     /**
+      * @brief Publish a decoded message with its sentence as side data
+      * @param time Receive time (Unix seconds)
+      * @param message Decoded message; position fields are filled for types 1-3, 18 and 19
+      * @param sentence Sentence or sentences the message was decoded from
+      * @return Sequence number of the record
+      */
+     uint64_t publish(double time, const AISMessage& message, const std::string& sentence);
+
+     /**
+      * @brief Get the descriptor of the segment, to pass to readers of an anonymous segment
+      * @return File descriptor
+      */
+     int fd() const;
+
+     /**
+      * @brief Get the number of records published
+      * @return Records published
+      */
+     uint64_t get_published() const;
+
+ private:
+     std::string path_;
+     int fd_;
+     void* memory_;
+     size_t size_;
+     ShmRingHeader* header_;
+     ShmRingSlot* slots_;
+     char* side_;
+     uint64_t capacity_;
+     uint64_t side_capacity_;
+     uint64_t published_;       // Local copies of the shared counters
+     uint64_t side_reserved_;
+ };
+
+ /**
+  * @class ShmRingSubscriber
+  * @brief Reads records from a ring segment with its own cursor
+  *
+  * A subscriber starts at the next record to be published. When the
+  * publisher has lapped it, read() skips to the oldest record still in the
+  * ring and counts the records it missed as lost; records whose slot or
+  * side data were overwritten while being copied are counted the same way.
+  * Linux only. Not thread-safe.
+  */
+ class ShmRingSubscriber {
+ public:
+     /**
+      * @brief Open a named segment
+      * @param name File name under /dev/shm
+      * @throws std::runtime_error if the segment cannot be opened or is not a ring
+      */
+     explicit ShmRingSubscriber(const std::string& name);
+
+     /**
+      * @brief Open a segment from a descriptor, e.g. an inherited memfd
+      * @param fd File descriptor; the caller keeps ownership and may close it
+      * @throws std::runtime_error if the segment cannot be mapped or is not a ring
+      */
+     explicit ShmRingSubscriber(int fd);
+
+     /**
+      * @brief Destructor; unmaps the segment
+      */
+     ~ShmRingSubscriber();
+
+     ShmRingSubscriber(const ShmRingSubscriber&) = delete;
+     ShmRingSubscriber& operator=(const ShmRingSubscriber&) = delete;
+
+     /**
+      * @brief Read the next record
+      * @param record Output record
+      * @param side Output side data; its storage is reused
+      * @return False if no new record has been published
+      */
+     bool read(ShmRecord& record, std::string& side);
+
+     /**
+      * @brief Move the cursor
+      * @param sequence Sequence number of the next record to read; records
+      *        no longer in the ring are skipped by the next read()
+      */
+     void seek(uint64_t sequence);
+
+     /**
+      * @brief Get the sequence number of the next record to read
+      * @return Cursor
+      */
+     uint64_t get_cursor() const;
+
+     /**
+      * @brief Get the number of records published so far
+      * @return Records published
+      */
+     uint64_t get_published() const;
+
+     /**
+      * @brief Get the number of records missed because the publisher lapped this reader
+      * @return Records lost
+      */
+     uint64_t get_lost() const;
+
+ private:
+     void* memory_;
+     size_t size_;
+     const ShmRingHeader* header_;
+     const ShmRingSlot* slots_;
+     const char* side_;
+     uint64_t capacity_;
+     uint64_t side_capacity_;
+     uint64_t cursor_;
+     uint64_t lost_;
+
+     void map(int fd);
+ };
+
+ } // namespace aislib
+
+ #endif // AISLIB_SHM_RING_H
@@ -0,0 +1,219 @@
+/**
+ * @file traffic_generator.h
+ * @brief Synthetic AIS traffic generator
+ *
+ * This file defines the TrafficGenerator class, which simulates a fleet of
+ * vessels and base stations and produces the AIVDM sentences a set of
+ * receivers would log for them. Sentences are built with the library's own
+ * encoders, so anything the generator produces can be decoded by AISParser.
+ *
+ * Besides plain traffic, the generator can reproduce the impairments seen
+ * on real feeds: interleaved multi-sentence messages, duplicate receptions
+ * across stations, lost and reordered fragments, and corrupted checksums.
+ */
+
+ #ifndef AISLIB_SIMULATION_TRAFFIC_GENERATOR_H
+ #define AISLIB_SIMULATION_TRAFFIC_GENERATOR_H
+
+ #include "aislib/bit_vector.h"
+ #include <cstdint>
+ #include <deque>
+ #include <map>
+ #include <random>
+ #include <string>
+ #include <vector>
+
+ namespace aislib {
+ namespace simulation {
+
+ /**
+  * @struct TrafficConfig
+  * @brief Configuration for the traffic generator
+  */
+ struct TrafficConfig {
+     size_t vessel_count;               ///< Number of simulated vessels
+     double class_b_fraction;           ///< Fraction of vessels with Class B transponders
+     size_t base_station_count;         ///< Number of simulated base stations
+     size_t receiver_count;             ///< Number of receiving stations
+     double messages_per_second;        ///< Simulated channel load (messages per simulated second)
+     std::map<uint8_t, double> type_mix; ///< Relative weight of each message type
+
+     double min_latitude;               ///< Southern edge of the simulated area
+     double max_latitude;               ///< Northern edge of the simulated area
+     double min_longitude;              ///< Western edge of the simulated area
+     double max_longitude;              ///< Eastern edge of the simulated area
+
+     size_t max_interleave;             ///< Max other messages emitted between fragments of one message
+     double duplicate_probability;      ///< Probability that another receiver also logs a message
+     double fragment_loss_probability;  ///< Probability that a fragment is lost
+     double reorder_probability;        ///< Probability that the fragments of a message are reversed
+     double corrupt_probability;        ///< Probability that a sentence has a bad checksum
+
+     uint32_t seed;                     ///< Random seed; equal seeds give equal output
+     int64_t start_time;                ///< Simulation start (Unix seconds)
+
+     // Default constructor: 1000 vessels in the Dover Strait, typical coastal mix, no impairments
+     TrafficConfig() :
+         vessel_count(1000),
+         class_b_fraction(0.3),
+         base_station_count(4),
+         receiver_count(1),
+         messages_per_second(50.0),
+         type_mix{{1, 46.0}, {2, 2.0}, {3, 12.0}, {4, 5.0}, {5, 8.0},
+                  {18, 18.0}, {19, 2.0}, {24, 7.0}},
+         min_latitude(50.5),
+         max_latitude(52.0),
+         min_longitude(0.5),
+         max_longitude(3.0),
+         max_interleave(0),
+         duplicate_probability(0.0),
+         fragment_loss_probability(0.0),
+         reorder_probability(0.0),
+         corrupt_probability(0.0),
+         seed(1),
+         start_time(1717243200) {} // 2024-06-01 12:00:00 UTC
+ };
+
+ /**
+  * @struct GeneratedSentence
+  * @brief One sentence as logged by a receiving station
+  */
+ struct GeneratedSentence {
+     std::string sentence;   ///< AIVDM sentence (without tag block)
+     uint16_t receiver_id;   ///< Receiving station (0-based)
+     double time;            ///< Receive time (Unix seconds, fractional)
+     uint8_t message_type;   ///< AIS message type carried by the sentence
+
+     /**
+      * @brief Format the sentence with an NMEA 4.x tag block
+      * @return Sentence prefixed with a tag block carrying the station and receive time
+      */
+     std::string with_tag_block() const;
+ };
+
+ /**
+  * @struct TrafficStatistics
+  * @brief Counts of what the generator has produced
+  */
+ struct TrafficStatistics {
+     size_t messages = 0;            ///< Messages simulated
+     size_t sentences = 0;           ///< Sentences emitted, duplicates included
+     size_t duplicates = 0;          ///< Sentences emitted for a second receiver
+     size_t lost_fragments = 0;      ///< Fragments dropped
+     size_t reordered_messages = 0;  ///< Multi-sentence messages emitted out of order
+     size_t corrupted = 0;           ///< Sentences emitted with a bad checksum
+ };
+
+ /**
+  * @class TrafficGenerator
+  * @brief Generates synthetic AIS traffic from simulated vessels
+  */
+ class TrafficGenerator {
+ public:
+     /**
+      * @brief Constructor
+      * @param config Generator configuration
+      * @throws std::invalid_argument if the configuration is inconsistent
+      */
+     explicit TrafficGenerator(const TrafficConfig& config = TrafficConfig());
+
+     /**
+      * @brief Simulate the next message and append the resulting sentences
+      * @param out Vector receiving the sentences
+      * @return Number of sentences appended (may be zero when fragments are held back or lost)
+      */
+     size_t next(std::vector<GeneratedSentence>& out);
+
+     /**
+      * @brief Simulate a number of messages
+      * @param message_count Number of messages to simulate
+      * @return Generated sentences, including those held back for interleaving
+      */
+     std::vector<GeneratedSentence> generate(size_t message_count);
+
+     /**
+      * @brief Emit all sentences still held back for interleaving
+      * @param out Vector receiving the sentences
+      */
+     void flush(std::vector<GeneratedSentence>& out);
+
+     /**
+      * @brief Get the current simulation time
+      * @return Simulation time (Unix seconds, fractional)
+      */
+     double get_time() const;
+
+     /**
+      * @brief Get the generator statistics
+      * @return Statistics
+      */
+     const TrafficStatistics& get_statistics() const;
+
+     /**
+      * @brief Encode the bits of one message as AIVDM sentences
+      * @param bits Message bits
+      * @param message_id Sequential message ID used when more than one sentence is needed
+      * @param channel AIS channel (A or B)
+      * @return Sentences, split at 60 payload characters
+      */
+     static std::vector<std::string> encode_sentences(const BitVector& bits, uint8_t message_id, char channel);
+
+ private:
+     // Simulated vessel state
+     struct Vessel {
+         uint32_t mmsi;
+         bool class_b;
+         double latitude;
+         double longitude;
+         float speed;        // knots
+         float course;       // degrees
+         float rate_of_turn; // degrees per minute
+         double last_update; // simulation time of the last kinematic update
+         std::string name;
+         std::string call_sign;
+         std::string destination;
+         uint8_t ship_type;
+     };
+
+     // A held-back sentence and the number of messages to simulate before it
+     struct Pending {
+         GeneratedSentence sentence;
+         size_t countdown;
+     };
+
+     TrafficConfig config_;
+     std::mt19937 rng_;
+     std::vector<Vessel> vessels_;
+     std::vector<uint32_t> base_stations_;
+     std::vector<std::pair<uint8_t, double>> cumulative_mix_;
+     std::deque<Pending> pending_;
+     std::vector<uint8_t> next_message_id_; // per receiver
+     double time_;
+     TrafficStatistics statistics_;
+
+     // Pick a message type from the configured mix
+     uint8_t pick_type();
+
+     // Pick a vessel of the given class
+     Vessel& pick_vessel(bool class_b);
+
+     // Advance a vessel to the current simulation time
+     void advance(Vessel& vessel);
+
+     // Build the bits of one message of the given type
+     BitVector build_message(uint8_t type);
+
+     // Deliver one sentence, applying corruption and interleaving
+     void deliver(GeneratedSentence sentence, size_t hold_back, std::vector<GeneratedSentence>& out);
+
+     // Count down held-back sentences and release those that are due
+     void release_pending(std::vector<GeneratedSentence>& out);
+
+     // Random number in [0, 1)
+     double uniform();
+ };
+
+ } // namespace simulation
+ } // namespace aislib
+
+ #endif // AISLIB_SIMULATION_TRAFFIC_GENERATOR_H
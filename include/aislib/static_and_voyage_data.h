@@ -10,7 +10,9 @@
  #define AISLIB_STATIC_AND_VOYAGE_DATA_H
  
  #include "aislib/ais_message.h"
+ #include "aislib/ais_string.h"
  #include <string>
+ #include <string_view>
  #include <chrono>
  
  namespace aislib {
@@ -179,15 +181,15 @@
  
      /**
       * @brief Get the call sign
-      * @return Call sign
+      * @return Call sign, valid while the message is alive
       */
-     std::string get_call_sign() const;
+     std::string_view get_call_sign() const;
  
      /**
       * @brief Get the vessel name
-      * @return Vessel name
+      * @return Vessel name, valid while the message is alive
       */
-     std::string get_vessel_name() const;
+     std::string_view get_vessel_name() const;
  
      /**
       * @brief Get the ship type
@@ -263,9 +265,9 @@
  
      /**
       * @brief Get the destination
-      * @return Destination
+      * @return Destination, valid while the message is alive
       */
-     std::string get_destination() const;
+     std::string_view get_destination() const;
  
      /**
       * @brief Get the DTE flag
@@ -287,15 +289,15 @@
  
      /**
       * @brief Set the call sign
-      * @param call_sign Call sign
+      * @param call_sign Call sign (truncated to 7 characters)
       */
-     void set_call_sign(const std::string& call_sign);
+     void set_call_sign(std::string_view call_sign);
  
      /**
       * @brief Set the vessel name
-      * @param name Vessel name
+      * @param name Vessel name (truncated to 20 characters)
       */
-     void set_vessel_name(const std::string& name);
+     void set_vessel_name(std::string_view name);
  
      /**
       * @brief Set the ship type
@@ -341,9 +343,9 @@
  
      /**
       * @brief Set the destination
-      * @param destination Destination
+      * @param destination Destination (truncated to 20 characters)
       */
-     void set_destination(const std::string& destination);
+     void set_destination(std::string_view destination);
  
      /**
       * @brief Set the DTE flag
@@ -368,8 +370,8 @@
      uint8_t repeat_indicator_;
      uint8_t ais_version_;
      uint32_t imo_number_;
-     std::string call_sign_;
-     std::string vessel_name_;
+     CallSign call_sign_;
+     ShipName vessel_name_;
      ShipType ship_type_;
      uint16_t dimension_to_bow_;
      uint16_t dimension_to_stern_;
@@ -381,7 +383,7 @@
      uint8_t eta_hour_;
      uint8_t eta_minute_;
      uint8_t draught_; // in 0.1 meter steps
-     std::string destination_;
+     ShipName destination_;
      bool dte_flag_;
  };
  
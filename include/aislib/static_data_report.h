@@ -0,0 +1,245 @@
+/**
+ * @file static_data_report.h
+ * @brief Static Data Report (Message Type 24)
+ *
+ * This file defines the static data report message (Type 24) used by
+ * Class B transponders. The report is sent in two independent parts:
+ * Part A carries the vessel name, Part B the ship type, vendor ID,
+ * call sign and dimensions (or the mothership MMSI for auxiliary craft).
+ */
+
+ #ifndef AISLIB_STATIC_DATA_REPORT_H
+ #define AISLIB_STATIC_DATA_REPORT_H
+
+ #include "ais_message.h"
+ #include "ais_string.h"
+ #include <string>
+ #include <string_view>
+
+ namespace aislib {
+
+ /**
+  * @class StaticDataReport
+  * @brief Class for AIS message type 24 (Static Data Report)
+  *
+  * A single object holds either part; the fields of the other part keep
+  * their defaults and are not encoded by to_bits().
+  */
+ class StaticDataReport : public AISMessage {
+ public:
+     /**
+      * @enum Part
+      * @brief Part number of the report
+      */
+     enum class Part : uint8_t {
+         A = 0,  ///< Vessel name
+         B = 1   ///< Ship type, vendor ID, call sign and dimensions
+     };
+
+     /**
+      * @brief Constructor
+      * @param mmsi MMSI number
+      * @param repeat_indicator Repeat indicator
+      * @param part Part number
+      */
+     StaticDataReport(uint32_t mmsi, uint8_t repeat_indicator, Part part);
+
+     /**
+      * @brief Constructor from binary data
+      * @param bits BitVector containing the message data
+      * @throws std::invalid_argument if the bits are not a valid Part A or Part B
+      *
+      * Part A is accepted without its trailing spare bits (160 bits), as sent
+      * by some transponders.
+      */
+     explicit StaticDataReport(const BitVector& bits);
+
+     /**
+      * @brief Destructor
+      */
+     ~StaticDataReport() override = default;
+
+     /**
+      * @brief Get the message type
+      * @return Message type (24)
+      */
+     uint8_t get_message_type() const override;
+
+     /**
+      * @brief Get the MMSI
+      * @return MMSI number
+      */
+     uint32_t get_mmsi() const override;
+
+     /**
+      * @brief Get the repeat indicator
+      * @return Repeat indicator
+      */
+     uint8_t get_repeat_indicator() const override;
+
+     /**
+      * @brief Get the part number
+      * @return Part A or Part B
+      */
+     Part get_part() const;
+
+     /**
+      * @brief Check whether the MMSI belongs to an auxiliary craft (98XXXYYYY)
+      * @return True for auxiliary craft, whose Part B carries a mothership MMSI
+      */
+     bool is_auxiliary_craft() const;
+
+     /**
+      * @brief Get the vessel name (Part A)
+      * @return Vessel name, valid while the message is alive
+      */
+     std::string_view get_vessel_name() const;
+
+     /**
+      * @brief Get the ship type (Part B)
+      * @return Ship type (same values as in message type 5)
+      */
+     uint8_t get_ship_type() const;
+
+     /**
+      * @brief Get the vendor ID (Part B)
+      * @return Manufacturer mnemonic, valid while the message is alive
+      */
+     std::string_view get_vendor_id() const;
+
+     /**
+      * @brief Get the unit model code (Part B)
+      * @return Unit model code (0-15)
+      */
+     uint8_t get_unit_model() const;
+
+     /**
+      * @brief Get the unit serial number (Part B)
+      * @return Serial number (0-1048575)
+      */
+     uint32_t get_serial_number() const;
+
+     /**
+      * @brief Get the call sign (Part B)
+      * @return Call sign, valid while the message is alive
+      */
+     std::string_view get_call_sign() const;
+
+     /**
+      * @brief Get the dimension to bow (Part B)
+      * @return Dimension to bow in meters (0 for auxiliary craft)
+      */
+     uint16_t get_dimension_to_bow() const;
+
+     /**
+      * @brief Get the dimension to stern (Part B)
+      * @return Dimension to stern in meters (0 for auxiliary craft)
+      */
+     uint16_t get_dimension_to_stern() const;
+
+     /**
+      * @brief Get the dimension to port (Part B)
+      * @return Dimension to port in meters (0 for auxiliary craft)
+      */
+     uint8_t get_dimension_to_port() const;
+
+     /**
+      * @brief Get the dimension to starboard (Part B)
+      * @return Dimension to starboard in meters (0 for auxiliary craft)
+      */
+     uint8_t get_dimension_to_starboard() const;
+
+     /**
+      * @brief Get the mothership MMSI (Part B of auxiliary craft)
+      * @return Mothership MMSI, 0 if not an auxiliary craft
+      */
+     uint32_t get_mothership_mmsi() const;
+
+     /**
+      * @brief Set the vessel name (Part A)
+      * @param name Vessel name (truncated to 20 characters)
+      */
+     void set_vessel_name(std::string_view name);
+
+     /**
+      * @brief Set the ship type (Part B)
+      * @param type Ship type (same values as in message type 5)
+      */
+     void set_ship_type(uint8_t type);
+
+     /**
+      * @brief Set the vendor ID (Part B)
+      * @param vendor_id Manufacturer mnemonic (truncated to 3 characters)
+      */
+     void set_vendor_id(std::string_view vendor_id);
+
+     /**
+      * @brief Set the unit model code (Part B)
+      * @param model Unit model code (masked to 4 bits)
+      */
+     void set_unit_model(uint8_t model);
+
+     /**
+      * @brief Set the unit serial number (Part B)
+      * @param serial Serial number (masked to 20 bits)
+      */
+     void set_serial_number(uint32_t serial);
+
+     /**
+      * @brief Set the call sign (Part B)
+      * @param call_sign Call sign (truncated to 7 characters)
+      */
+     void set_call_sign(std::string_view call_sign);
+
+     /**
+      * @brief Set the ship dimensions (Part B)
+      * @param to_bow Dimension to bow in meters
+      * @param to_stern Dimension to stern in meters
+      * @param to_port Dimension to port in meters
+      * @param to_starboard Dimension to starboard in meters
+      */
+     void set_ship_dimensions(
+         uint16_t to_bow,
+         uint16_t to_stern,
+         uint8_t to_port,
+         uint8_t to_starboard
+     );
+
+     /**
+      * @brief Set the mothership MMSI (Part B of auxiliary craft)
+      * @param mmsi Mothership MMSI; encoded in place of the dimensions
+      */
+     void set_mothership_mmsi(uint32_t mmsi);
+
+     /**
+      * @brief Convert the message to a bit vector
+      * @param bits Bit vector to populate
+      */
+     void to_bits(BitVector& bits) const override;
+
+     /**
+      * @brief Get a string representation of the message
+      * @return String representation
+      */
+     std::string to_string() const override;
+
+ private:
+     uint32_t mmsi_;                   // 30 bits: MMSI number
+     uint8_t repeat_indicator_;        // 2 bits: Repeat indicator
+     Part part_;                       // 2 bits: Part number
+     ShipName vessel_name_;            // 120 bits: Vessel name (Part A)
+     uint8_t ship_type_;               // 8 bits: Ship type (Part B)
+     AisString<3> vendor_id_;          // 18 bits: Vendor ID (Part B)
+     uint8_t unit_model_;              // 4 bits: Unit model code (Part B)
+     uint32_t serial_number_;          // 20 bits: Serial number (Part B)
+     CallSign call_sign_;              // 42 bits: Call sign (Part B)
+     uint16_t dimension_to_bow_;       // 9 bits: Dimension to bow (Part B)
+     uint16_t dimension_to_stern_;     // 9 bits: Dimension to stern (Part B)
+     uint8_t dimension_to_port_;       // 6 bits: Dimension to port (Part B)
+     uint8_t dimension_to_starboard_;  // 6 bits: Dimension to starboard (Part B)
+     uint32_t mothership_mmsi_;        // 30 bits: Mothership MMSI, replaces the dimensions (Part B)
+ };
+
+ } // namespace aislib
+
+ #endif // AISLIB_STATIC_DATA_REPORT_H
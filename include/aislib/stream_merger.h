@@ -0,0 +1,231 @@
+/**
+ * @file stream_merger.h
+ * @brief Time-ordered merge of several receiver streams
+ *
+ * This file defines a stage that combines the sentences of several
+ * receivers, each with its own latency, into one stream ordered by time.
+ * Each source has a watermark that trails its newest record by the delay
+ * it may arrive out of order; records are released once every active
+ * source's watermark has passed them. Receptions of one transmission by
+ * several receivers are dropped inside the merge.
+ */
+
+ #ifndef AISLIB_STREAM_MERGER_H
+ #define AISLIB_STREAM_MERGER_H
+
+ #include <cstdint>
+ #include <string>
+ #include <string_view>
+ #include <utility>
+ #include <vector>
+
+ namespace aislib {
+
+ /**
+  * @struct MergedSentence
+  * @brief One sentence released by the merge
+  */
+ struct MergedSentence {
+     std::string sentence;   ///< Sentence as pushed
+     double time = 0.0;      ///< Receive or reconstructed time (Unix seconds)
+     uint16_t source = 0;    ///< Source the sentence was pushed from
+ };
+
+ /**
+  * @struct MergedView
+  * @brief One sentence released by the merge, without a copy
+  */
+ struct MergedView {
+     std::string_view sentence;   ///< Sentence as pushed, valid until the next push()
+     double time = 0.0;           ///< Receive or reconstructed time (Unix seconds)
+     uint16_t source = 0;         ///< Source the sentence was pushed from
+ };
+
+ /**
+  * @class StreamMerger
+  * @brief Heap-based k-way merge with per-source watermarks and duplicate removal
+  *
+  * Each source buffers its records in a min-heap over preallocated slots,
+  * so records may arrive out of order within the source's delay. pop()
+  * computes the global watermark, the lowest watermark of the sources that
+  * are not idle, and merges the source heaps through a heap of their
+  * oldest records up to it. A source is idle when its newest record is
+  * more than idle_timeout behind the newest record of any source, so a
+  * receiver that goes silent does not stall the merge.
+  *
+  * Records are released in time order. A record pushed after the merge has
+  * passed its time is released by the next pop() and counted as late.
+  * Releasing into MergedSentence records copies each sentence; releasing
+  * into MergedView records does not, so a reused view vector keeps the
+  * merge free of allocations.
+  *
+  * Two records whose sentences carry the same fragment numbers, payload
+  * and fill bits within dedup_window seconds of each other are the same
+  * transmission heard twice; only the first is released. Up to twice
+  * buffer_capacity transmissions are remembered, in a fixed table; when
+  * more are released within dedup_window, the oldest are forgotten early.
+  *
+  * Not thread-safe.
+  */
+ class StreamMerger {
+ public:
+     /**
+      * @struct Config
+      * @brief Merge configuration
+      */
+     struct Config {
+         double max_delay;          ///< Seconds a source's records may arrive out of order, unless set per source
+         double idle_timeout;       ///< Seconds behind the newest source after which a source no longer holds back the merge
+         size_t buffer_capacity;    ///< Records buffered per source
+         size_t sentence_capacity;  ///< Characters reserved per buffered record
+         double dedup_window;       ///< Seconds within which a repeated transmission is dropped, 0 to keep all
+
+         // Default constructor
+         Config()
+             : max_delay(2.0),
+               idle_timeout(30.0),
+               buffer_capacity(4096),
+               sentence_capacity(96),
+               dedup_window(5.0) {}
+     };
+
+     /**
+      * @struct Stats
+      * @brief Merge counters
+      */
+     struct Stats {
+         uint64_t pushed = 0;       ///< Records accepted by push()
+         uint64_t released = 0;     ///< Records released by pop() and flush()
+         uint64_t duplicates = 0;   ///< Records dropped as repeated transmissions
+         uint64_t late = 0;         ///< Records pushed after the merge had passed their time
+         uint64_t overflows = 0;    ///< Records refused because their source's buffer was full
+     };
+
+     /**
+      * @brief Constructor
+      * @param sources Number of sources (0 to sources - 1)
+      * @param config Merge configuration
+      * @throws std::invalid_argument if sources is 0 or above 65536, or buffer_capacity is 0
+      */
+     explicit StreamMerger(size_t sources, const Config& config = Config());
+
+     /**
+      * @brief Set how far out of order one source's records may arrive
+      * @param source Source
+      * @param seconds Delay in seconds, e.g. minutes for a satellite feed
+      * @throws std::out_of_range if source is out of range
+      */
+     void set_max_delay(uint16_t source, double seconds);
+
+     /**
+      * @brief Buffer a record
+      * @param source Source
+      * @param time Receive or reconstructed time (Unix seconds)
+      * @param sentence Sentence, with or without a tag block
+      * @return False if the source's buffer is full; the watermark is then
+      *         raised so that the next pop() makes room
+      * @throws std::out_of_range if source is out of range
+      */
+     bool push(uint16_t source, double time, const std::string& sentence);
+
+     /**
+      * @brief Advance a source's watermark without a record
+      * @param source Source
+      * @param time Time the source has delivered everything before, less its delay
+      * @throws std::out_of_range if source is out of range
+      */
+     void advance(uint16_t source, double time);
+
+     /**
+      * @brief Release the records the watermark has passed, in time order
+      * @param out Vector the records are appended to
+      * @return Number of records appended
+      */
+     size_t pop(std::vector<MergedSentence>& out);
+     size_t pop(std::vector<MergedView>& out);
+
+     /**
+      * @brief Release every buffered record, in time order, at the end of the streams
+      * @param out Vector the records are appended to
+      * @return Number of records appended
+      */
+     size_t flush(std::vector<MergedSentence>& out);
+     size_t flush(std::vector<MergedView>& out);
+
+     /**
+      * @brief Get the time up to which records have been released
+      * @return Watermark (Unix seconds), -infinity before the first release
+      */
+     double get_watermark() const;
+
+     /**
+      * @brief Get the number of buffered records
+      * @return Records buffered over all sources
+      */
+     size_t buffered() const;
+
+     /**
+      * @brief Get the merge counters
+      * @return Counters
+      */
+     Stats get_stats() const;
+
+ private:
+     struct Entry {
+         double time;
+         uint64_t sequence;   // Push order, breaks ties between equal times
+         uint32_t slot;
+     };
+
+     struct Source {
+         std::vector<Entry> heap;          // Min-heap on (time, sequence)
+         std::vector<std::string> slots;   // Sentence storage, reused
+         std::vector<uint32_t> free_slots;
+         double newest;                    // Newest record or advance() time
+         double delay;
+         uint64_t fragment_keys[10];       // Key of the last fragment per sequential message ID
+     };
+
+     Config config_;
+     std::vector<Source> sources_;
+     std::vector<uint16_t> merge_heap_;    // Sources ordered by their oldest record
+     uint64_t sequence_;
+     double watermark_;                    // Released up to here
+     double forced_;                       // Raised when a buffer is full
+     Stats stats_;
+
+     // Repeated transmissions inside the dedup window: an open-addressing
+     // table of the latest time per key, and a ring of keys in release order
+     struct Seen {
+         uint64_t key;                     // EMPTY_KEY if unused
+         double time;
+     };
+     std::vector<Seen> seen_;
+     std::vector<std::pair<double, uint64_t>> seen_order_;
+     size_t seen_head_;                    // Oldest entry of seen_order_
+     size_t seen_count_;
+
+     static const uint64_t EMPTY_KEY = 0;
+
+     // Heap order: true if a is released after b
+     static bool later(const Entry& a, const Entry& b);
+
+     Source& source_at(uint16_t source);
+     double compute_watermark() const;
+     template <typename Record>
+     size_t release(double limit, std::vector<Record>& out);
+     bool duplicate(Source& source, const std::string& sentence, double time);
+
+     // Slot of a key in seen_, or the empty slot where it belongs
+     size_t seen_slot(uint64_t key) const;
+
+     // Forget the oldest transmission in seen_order_
+     void forget_oldest();
+
+     // Key of the transmission a sentence carries
+     static uint64_t transmission_key(Source& source, const std::string& sentence);
+ };
+
+ } // namespace aislib
+
+ #endif // AISLIB_STREAM_MERGER_H
@@ -0,0 +1,152 @@
+/**
+ * @file string_pool.h
+ * @brief Interning pool for AIS text fields
+ *
+ * Vessel names, call signs and destinations repeat across every static data
+ * report of a vessel and across vessels. The pool stores each distinct
+ * string once and hands out small integer handles; long-lived state tables
+ * keep handles instead of strings. Strings are keyed by their packed 6-bit
+ * representation, so interning straight from a BitVector never builds a
+ * std::string, and a string that is already in the pool is found without
+ * taking a lock.
+ */
+
+ #ifndef AISLIB_STRING_POOL_H
+ #define AISLIB_STRING_POOL_H
+
+ #include "aislib/bit_vector.h"
+ #include <atomic>
+ #include <cstdint>
+ #include <memory>
+ #include <mutex>
+ #include <string_view>
+ #include <vector>
+
+ namespace aislib {
+
+ /**
+  * @class StringPool
+  * @brief Append-only pool of 6-bit ASCII strings of up to 20 characters
+  *
+  * Strings are normalized like BitVector::get_string: trailing '@' and
+  * spaces are removed. Lookups of strings already in the pool and view()
+  * are lock-free; inserting a new string takes a mutex. Strings are never
+  * removed, so handles and views stay valid for the lifetime of the pool.
+  */
+ class StringPool {
+ public:
+     /// Handle of an interned string
+     using Handle = uint32_t;
+
+     /// Handle of the empty string, valid in every pool
+     static constexpr Handle EMPTY = 0;
+
+     /// Longest string the pool accepts (names and destinations)
+     static constexpr size_t MAX_LENGTH = 20;
+
+     /**
+      * @brief Constructor
+      * @param initial_capacity Expected number of distinct strings
+      */
+     explicit StringPool(size_t initial_capacity = 1024);
+
+     /**
+      * @brief Destructor
+      */
+     ~StringPool();
+
+     StringPool(const StringPool&) = delete;
+     StringPool& operator=(const StringPool&) = delete;
+
+     /**
+      * @brief Intern a 6-bit ASCII string read from a bit vector
+      * @param bits Bit vector
+      * @param start_index Start bit index
+      * @param bit_count Number of bits (multiple of 6, at most 120)
+      * @return Handle of the string
+      * @throws std::out_of_range if the range is out of bounds
+      * @throws std::invalid_argument if bit_count is not a multiple of 6 or too large
+      */
+     Handle intern(const BitVector& bits, size_t start_index, size_t bit_count);
+
+     /**
+      * @brief Intern a string
+      * @param value String (at most 20 characters; characters outside the
+      *              6-bit alphabet become '@', as in BitVector::append_string)
+      * @return Handle of the string
+      * @throws std::invalid_argument if the string is too long
+      */
+     Handle intern(std::string_view value);
+
+     /**
+      * @brief Get the characters of an interned string
+      * @param handle Handle returned by intern()
+      * @return View valid for the lifetime of the pool
+      * @throws std::out_of_range if the handle was not issued by this pool
+      */
+     std::string_view view(Handle handle) const;
+
+     /**
+      * @brief Get the number of distinct strings, including the empty string
+      * @return Number of strings
+      */
+     size_t size() const;
+
+     /**
+      * @brief Get the memory held by the pool
+      * @return Bytes used by entries and the hash index
+      */
+     size_t memory_usage() const;
+
+     /**
+      * @brief Get the process-wide pool
+      * @return Global pool
+      */
+     static StringPool& global();
+
+ private:
+     // 6-bit characters packed ten to a word, with the length
+     struct Key {
+         uint64_t words[2];
+         uint8_t length;
+     };
+
+     struct Entry {
+         Key key;
+         char text[MAX_LENGTH];
+     };
+
+     static constexpr size_t CHUNK_BITS = 12;
+     static constexpr size_t CHUNK_SIZE = size_t(1) << CHUNK_BITS;
+     static constexpr size_t MAX_CHUNKS = size_t(1) << 14;
+
+     struct Chunk {
+         Entry entries[CHUNK_SIZE];
+     };
+
+     // Open-addressing index of handles; 0 marks an empty slot
+     struct Table {
+         size_t mask;
+         std::unique_ptr<std::atomic<Handle>[]> slots;
+     };
+
+     std::unique_ptr<std::atomic<Chunk*>[]> chunks_;
+     std::atomic<size_t> size_;
+     std::atomic<Table*> table_;
+
+     // Serializes inserts; tables replaced by a resize are kept for readers still probing them
+     std::mutex mutex_;
+     std::vector<std::unique_ptr<Table>> tables_;
+
+     static uint64_t hash(const Key& key);
+     static void normalize(Key& key);
+
+     const Entry& entry(Handle handle) const;
+     Handle find(const Table& table, const Key& key, uint64_t hash_value) const;
+     Handle insert(const Key& key);
+     void grow();
+ };
+
+ } // namespace aislib
+
+ #endif // AISLIB_STRING_POOL_H
@@ -0,0 +1,177 @@
+/**
+ * @file time_reconstruction.h
+ * @brief Absolute time reconstruction for decoded messages
+ *
+ * Most AIS reports carry only the UTC second at which they were generated.
+ * This file defines a batch stage that turns it into an absolute time by
+ * combining it with the receive time from the tag block, corrected for the
+ * receiving station's clock skew. The skew is estimated from base station
+ * reports (type 4), which carry the full UTC date and time.
+ */
+
+ #ifndef AISLIB_TIME_RECONSTRUCTION_H
+ #define AISLIB_TIME_RECONSTRUCTION_H
+
+ #include "aislib/ais_message.h"
+ #include <cstdint>
+ #include <unordered_map>
+ #include <vector>
+
+ namespace aislib {
+
+ /**
+  * @enum TimeSource
+  * @brief How the time of a row was obtained
+  */
+ enum class TimeSource : uint8_t {
+     NONE,                 ///< No usable time; the time is NaN
+     RECEIVE_TIME,         ///< Skew-corrected receive time (message has no UTC second)
+     UTC_SECOND,           ///< UTC second placed in the minute of the estimated time
+     BASE_STATION,         ///< Full UTC time carried by a base station report
+     NEAREST_BASE_STATION  ///< Time of the nearest base station report (no receive time or UTC second)
+ };
+
+ /**
+  * @struct TimeBatch
+  * @brief Columns of a batch of decoded messages, one row per message
+  *
+  * Rows should be in receive order. The input columns are filled with
+  * append(); reconstruct() fills the output columns.
+  */
+ struct TimeBatch {
+     std::vector<uint32_t> receiver;      ///< Receiving station
+     std::vector<double> receive_time;    ///< Tag block receive time (Unix seconds), NaN if unknown
+     std::vector<uint8_t> utc_second;     ///< UTC second of the report (0-59; 60 or more = not available)
+     std::vector<double> reference_time;  ///< Full UTC time of base station reports (Unix seconds), NaN otherwise
+     std::vector<double> time;            ///< Output: reconstructed time (Unix seconds), NaN if unknown
+     std::vector<TimeSource> source;      ///< Output: how the time was obtained
+
+     /**
+      * @brief Append a row
+      * @param receiver_id Receiving station
+      * @param receive_time_value Receive time (Unix seconds), NaN if unknown
+      * @param utc_second_value UTC second of the report (60 = not available)
+      * @param reference_time_value Full UTC time for base station reports, NaN otherwise
+      */
+     void append(uint32_t receiver_id, double receive_time_value, uint8_t utc_second_value,
+                 double reference_time_value);
+
+     /**
+      * @brief Append a row for a decoded message
+      * @param receiver_id Receiving station
+      * @param receive_time_value Receive time (Unix seconds), NaN if unknown
+      * @param message Decoded message; position reports (types 1-3, 18, 19) provide the
+      *                UTC second and base station reports (type 4) the full time
+      */
+     void append(uint32_t receiver_id, double receive_time_value, const AISMessage& message);
+
+     /**
+      * @brief Get the number of rows
+      * @return Number of rows
+      */
+     size_t size() const;
+
+     /**
+      * @brief Reserve space for rows
+      * @param rows Number of rows
+      */
+     void reserve(size_t rows);
+
+     /**
+      * @brief Remove all rows, keeping the storage
+      */
+     void clear();
+ };
+
+ /**
+  * @class TimeReconstructor
+  * @brief Assigns absolute times to batches of messages
+  *
+  * The skew of a receiver is the difference between its receive times and
+  * the UTC time in base station reports it receives. Estimates are kept
+  * across batches, so a stream can be processed one batch at a time.
+  * Rows without a receive time are placed relative to the nearest base
+  * station report from the same receiver. A UTC second is placed in the
+  * minute, before or after, that is closest to the estimated time, which
+  * handles minute rollover. Not thread-safe.
+  */
+ class TimeReconstructor {
+ public:
+     /**
+      * @struct Config
+      * @brief Reconstruction configuration
+      */
+     struct Config {
+         double skew_smoothing;     ///< Weight of a new skew sample in the running estimate (0-1]
+         double max_skew;           ///< Skew samples larger than this (seconds) are rejected
+         double outlier_threshold;  ///< Samples this far (seconds) from an established estimate are rejected
+
+         // Default constructor
+         Config() : skew_smoothing(0.1), max_skew(3600.0), outlier_threshold(5.0) {}
+     };
+
+     /**
+      * @brief Constructor
+      * @param config Reconstruction configuration
+      * @throws std::invalid_argument if skew_smoothing is not in (0, 1]
+      */
+     explicit TimeReconstructor(const Config& config = Config());
+
+     /**
+      * @brief Fill the time and source columns of a batch
+      * @param batch Batch to process
+      * @throws std::invalid_argument if the input columns differ in length
+      */
+     void reconstruct(TimeBatch& batch);
+
+     /**
+      * @brief Get the skew estimate of a receiver
+      * @param receiver Receiving station
+      * @return Receive time minus UTC in seconds, NaN if no base station report has been seen
+      */
+     double get_skew(uint32_t receiver) const;
+
+     /**
+      * @brief Get the number of skew samples rejected as outliers
+      * @return Rejected samples
+      */
+     uint64_t get_rejected_samples() const;
+
+     /**
+      * @brief Forget all receiver state
+      */
+     void reset();
+
+ private:
+     // Per-receiver state carried across batches
+     struct ReceiverState {
+         double skew;            // Running skew estimate, NaN if none
+         uint32_t samples;       // Samples accepted into the estimate
+         uint32_t rejected_run;  // Consecutive samples rejected as outliers
+         double last_reference;  // Latest base station time, NaN if none
+     };
+
+     // Nearest base station report of a receiver while scanning a batch
+     struct Neighbour {
+         double skew;
+         double reference;
+         size_t row;
+     };
+
+     Config config_;
+     std::unordered_map<uint32_t, ReceiverState> receivers_;
+     uint64_t rejected_samples_;
+
+     // Scratch columns reused across batches
+     std::vector<double> row_skew_;
+     std::vector<double> row_anchor_;
+     std::vector<size_t> row_anchor_distance_;
+     std::unordered_map<uint32_t, Neighbour> next_;
+
+     // Fold a skew sample into a receiver's estimate
+     void add_sample(ReceiverState& state, double sample);
+ };
+
+ } // namespace aislib
+
+ #endif // AISLIB_TIME_RECONSTRUCTION_H
@@ -0,0 +1,189 @@
+/**
+ * @file tracing.h
+ * @brief Hot-path tracing hooks
+ *
+ * This file defines the AISLIB_TRACE_* macros that mark the stages of
+ * sentence processing (field scan, checksum, de-armoring, factory dispatch,
+ * decode and multi-part reassembly). When the library is built without
+ * AISLIB_ENABLE_TRACING the macros expand to nothing and cost nothing.
+ *
+ * When tracing is compiled in, recording still has to be switched on at run
+ * time with trace::set_enabled(). Each thread then writes timestamped events
+ * to its own ring buffer, which keeps the most recent events, and
+ * trace::write_chrome_trace() dumps all buffers in the Chrome trace event
+ * format (chrome://tracing, Perfetto). A service can therefore ship a traced
+ * build and capture a trace of a slow batch without being rebuilt.
+ */
+
+ #ifndef AISLIB_TRACING_H
+ #define AISLIB_TRACING_H
+
+ #include <atomic>
+ #include <chrono>
+ #include <cstdint>
+ #include <ostream>
+ #include <vector>
+
+ namespace aislib {
+ namespace trace {
+
+ /**
+  * @enum Point
+  * @brief Instrumented stages
+  */
+ enum class Point : uint8_t {
+     PARSE,              ///< AISParser::parse, end to end
+     SENTENCE_SCAN,      ///< Splitting a sentence into fields
+     CHECKSUM,           ///< Checksum validation
+     DEARMOR,            ///< Converting a 6-bit ASCII payload to bits
+     FACTORY_DISPATCH,   ///< Looking up the decoder for a message type
+     DECODE,             ///< Decoding message fields (argument: message type)
+     MULTIPART_ADD,      ///< Adding a fragment to the reassembly table
+     MULTIPART_COMPLETE  ///< Combining the fragments of a complete message
+ };
+
+ /**
+  * @struct Event
+  * @brief One recorded stage
+  */
+ struct Event {
+     uint64_t begin_ns;  ///< Start (steady clock, nanoseconds)
+     uint64_t end_ns;    ///< End (steady clock, nanoseconds)
+     uint32_t thread;    ///< Sequential ID of the recording thread
+     uint32_t arg;       ///< Stage-specific argument
+     Point point;        ///< Stage
+ };
+
+ /**
+  * @brief Check whether the library was built with tracing
+  * @return True if built with AISLIB_ENABLE_TRACING
+  */
+ bool is_compiled_in();
+
+ /**
+  * @brief Switch recording on or off
+  * @param enabled True to record events
+  */
+ void set_enabled(bool enabled);
+
+ /**
+  * @brief Check whether recording is switched on
+  * @return True if events are recorded
+  */
+ bool is_enabled();
+
+ /**
+  * @brief Set the ring buffer size of threads that have not recorded yet
+  * @param events Events kept per thread (rounded up to a power of two)
+  */
+ void set_buffer_capacity(size_t events);
+
+ /**
+  * @brief Discard all recorded events
+  *
+  * Should be called while no thread is recording.
+  */
+ void clear();
+
+ /**
+  * @brief Copy the recorded events of all threads
+  * @return Events sorted by start time
+  *
+  * Events recorded concurrently with the copy may be missing or torn; take
+  * the copy after set_enabled(false) or while the parsers are idle.
+  */
+ std::vector<Event> collect();
+
+ /**
+  * @brief Get the name of a stage
+  * @param point Stage
+  * @return Name used in trace output
+  */
+ const char* point_name(Point point);
+
+ /**
+  * @brief Write events in the Chrome trace event format
+  * @param out Output stream
+  * @param events Events to write
+  */
+ void write_chrome_trace(std::ostream& out, const std::vector<Event>& events);
+
+ /**
+  * @brief Write all recorded events in the Chrome trace event format
+  * @param out Output stream
+  */
+ void write_chrome_trace(std::ostream& out);
+
+ namespace detail {
+
+ extern std::atomic<bool> enabled;
+
+ // Append an event to the calling thread's buffer
+ void record(Point point, uint32_t arg, uint64_t begin_ns, uint64_t end_ns);
+
+ inline uint64_t now_ns() {
+     return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+         std::chrono::steady_clock::now().time_since_epoch()).count());
+ }
+
+ } // namespace detail
+
+ /**
+  * @class Scope
+  * @brief Records an event covering its own lifetime
+  */
+ class Scope {
+ public:
+     /**
+      * @brief Constructor
+      * @param point Stage
+      * @param arg Stage-specific argument
+      */
+     explicit Scope(Point point, uint32_t arg = 0)
+         : begin_ns_(detail::enabled.load(std::memory_order_relaxed) ? detail::now_ns() : 0),
+           arg_(arg),
+           point_(point) {}
+
+     ~Scope() {
+         if (begin_ns_ != 0) {
+             detail::record(point_, arg_, begin_ns_, detail::now_ns());
+         }
+     }
+
+     Scope(const Scope&) = delete;
+     Scope& operator=(const Scope&) = delete;
+
+     /**
+      * @brief Set the argument once it is known
+      * @param arg Stage-specific argument
+      */
+     void set_arg(uint32_t arg) {
+         arg_ = arg;
+     }
+
+ private:
+     uint64_t begin_ns_;
+     uint32_t arg_;
+     Point point_;
+ };
+
+ } // namespace trace
+ } // namespace aislib
+
+ #define AISLIB_TRACE_CONCAT_IMPL(a, b) a##b
+ #define AISLIB_TRACE_CONCAT(a, b) AISLIB_TRACE_CONCAT_IMPL(a, b)
+
+ #ifdef AISLIB_ENABLE_TRACING
+ /// Record the enclosing scope as a stage
+ #define AISLIB_TRACE_SCOPE(point) \
+     ::aislib::trace::Scope AISLIB_TRACE_CONCAT(aislib_trace_scope_, __LINE__)(::aislib::trace::Point::point)
+ /// Record the enclosing scope as a stage with an argument
+ #define AISLIB_TRACE_SCOPE_ARG(point, arg) \
+     ::aislib::trace::Scope AISLIB_TRACE_CONCAT(aislib_trace_scope_, __LINE__)( \
+         ::aislib::trace::Point::point, static_cast<uint32_t>(arg))
+ #else
+ #define AISLIB_TRACE_SCOPE(point) static_cast<void>(0)
+ #define AISLIB_TRACE_SCOPE_ARG(point, arg) static_cast<void>(0)
+ #endif
+
+ #endif // AISLIB_TRACING_H
@@ -0,0 +1,247 @@
+/**
+ * @file track_store.h
+ * @brief Vessel positions at an arbitrary time
+ *
+ * This file defines a store of the last two position reports of each
+ * vessel. It answers where a vessel is at a given time: between the two
+ * reports the position is interpolated, after the last one it is dead
+ * reckoned from the speed, course and rate of turn. A batch query projects
+ * every vessel in a bounding box to one common time.
+ */
+
+ #ifndef AISLIB_TRACK_STORE_H
+ #define AISLIB_TRACK_STORE_H
+
+ #include "aislib/ais_message.h"
+ #include <cstdint>
+ #include <unordered_map>
+ #include <vector>
+
+ namespace aislib {
+
+ /**
+  * @enum ProjectionMethod
+  * @brief How a projected position was obtained
+  */
+ enum class ProjectionMethod : uint8_t {
+     INTERPOLATED,   ///< Between the two stored reports
+     DEAD_RECKONED,  ///< At or after the last report, from its speed, course and rate of turn
+     HELD            ///< Stored position unchanged: no usable motion, or earlier than the stored reports
+ };
+
+ /**
+  * @struct ProjectedPosition
+  * @brief Position of one vessel at the query time
+  */
+ struct ProjectedPosition {
+     double latitude = 0.0;                                    ///< Latitude in degrees
+     double longitude = 0.0;                                   ///< Longitude in degrees
+     ProjectionMethod method = ProjectionMethod::HELD;         ///< How the position was obtained
+ };
+
+ /**
+  * @struct ProjectedPositions
+  * @brief Columns of a batch query result, one row per vessel
+  */
+ struct ProjectedPositions {
+     std::vector<uint32_t> mmsi;                 ///< Vessel
+     std::vector<double> latitude;               ///< Latitude in degrees
+     std::vector<double> longitude;              ///< Longitude in degrees
+     std::vector<ProjectionMethod> method;       ///< How the position was obtained
+
+     /**
+      * @brief Get the number of rows
+      * @return Number of rows
+      */
+     size_t size() const;
+
+     /**
+      * @brief Remove all rows, keeping the storage
+      */
+     void clear();
+ };
+
+ /**
+  * @class TrackStore
+  * @brief Last two position reports per vessel with interpolation and dead reckoning
+  *
+  * The state of each vessel is held in dense columns, so a batch query is
+  * a straight scan: a first pass moves every vessel along its course at its
+  * reported speed, in a loop the compiler vectorizes, and a second pass
+  * recomputes only the vessels that are turning or are queried between
+  * their reports before testing the bounding box. Dead reckoning assumes a
+  * constant speed over ground and rate of turn and stops after
+  * max_extrapolation seconds. Not thread-safe.
+  */
+ class TrackStore {
+ public:
+     /**
+      * @struct Config
+      * @brief Store configuration
+      */
+     struct Config {
+         double max_extrapolation;  ///< Seconds after the last report a position is dead reckoned
+         double max_age;            ///< Seconds without reports after which a vessel is left out of queries
+
+         // Default constructor: 10 minutes of dead reckoning, 30 minute age limit
+         Config()
+             : max_extrapolation(600.0),
+               max_age(1800.0) {}
+     };
+
+     /**
+      * @struct Track
+      * @brief Stored state of one vessel, for saving and restoring a store
+      */
+     struct Track {
+         uint32_t mmsi = 0;                  ///< Vessel
+         double time = 0.0;                  ///< Time of the last report (Unix seconds)
+         double latitude = 0.0;              ///< Position of the last report in degrees
+         double longitude = 0.0;
+         double previous_time = 0.0;         ///< Time of the report before, equal to time if none
+         double previous_latitude = 0.0;     ///< Position of the report before in degrees
+         double previous_longitude = 0.0;
+         double north = 0.0;                 ///< Degrees of latitude per second along the course
+         double east = 0.0;                  ///< Degrees of longitude per second along the course
+         double speed = -1.0;                ///< Meters per second, negative if the motion is not known
+         double course = 0.0;                ///< Radians
+         double turn = 0.0;                  ///< Radians per second
+     };
+
+     /**
+      * @struct Stats
+      * @brief Store counters
+      */
+     struct Stats {
+         uint64_t updates = 0;         ///< Reports stored
+         uint64_t out_of_order = 0;    ///< Reports not newer than the vessel's last report, ignored
+         uint64_t invalid = 0;         ///< Reports without a valid position, ignored
+         size_t vessels = 0;           ///< Vessels with state
+     };
+
+     /**
+      * @brief Constructor
+      * @param config Store configuration
+      * @throws std::invalid_argument if max_extrapolation or max_age is negative
+      */
+     explicit TrackStore(const Config& config = Config());
+
+     /**
+      * @brief Store a position report
+      * @param mmsi Reporting vessel
+      * @param time Time of the report (Unix seconds)
+      * @param latitude Latitude in degrees
+      * @param longitude Longitude in degrees
+      * @param speed Speed over ground in knots, NaN or negative if not available
+      * @param course Course over ground in degrees, NaN or negative if not available
+      * @param rate_of_turn Rate of turn in degrees per minute, NaN or infinite if not available
+      * @return False if the report was ignored
+      */
+     bool update(uint32_t mmsi, double time, double latitude, double longitude,
+                 float speed, float course, float rate_of_turn);
+
+     /**
+      * @brief Store a decoded position report
+      * @param time Time of the report (Unix seconds)
+      * @param message Decoded message
+      * @return False if the message is not a position report (types 1-3, 18, 19) or was ignored
+      */
+     bool update(double time, const AISMessage& message);
+
+     /**
+      * @brief Get the position of a vessel at a time
+      * @param mmsi Vessel
+      * @param time Query time (Unix seconds)
+      * @param position Output position
+      * @return False if the vessel is unknown or its last report is older than max_age
+      */
+     bool position_at(uint32_t mmsi, double time, ProjectedPosition& position) const;
+
+     /**
+      * @brief Get the positions of all vessels inside a bounding box at a time
+      * @param time Query time (Unix seconds)
+      * @param min_lat Southern edge in degrees
+      * @param min_lon Western edge in degrees
+      * @param max_lat Northern edge in degrees
+      * @param max_lon Eastern edge in degrees
+      * @param positions Output columns, cleared first
+      * @return Number of vessels inside the box
+      *
+      * The box is tested against the projected positions. Boxes crossing the
+      * 180th meridian have min_lon greater than max_lon.
+      */
+     size_t project(double time, double min_lat, double min_lon, double max_lat, double max_lon,
+                    ProjectedPositions& positions);
+
+     /**
+      * @brief Drop vessels without reports for max_age
+      * @param now Current time (Unix seconds)
+      * @return Number of vessels dropped
+      */
+     size_t expire(double now);
+
+     /**
+      * @brief Forget all vessels
+      */
+     void clear();
+
+     /**
+      * @brief Get the state of every vessel
+      * @param tracks Output vector, cleared first
+      * @return Number of vessels
+      */
+     size_t tracks(std::vector<Track>& tracks) const;
+
+     /**
+      * @brief Replace the vessels with saved state
+      * @param tracks Tracks returned by tracks(), one per MMSI
+      * @param count Number of tracks
+      * @throws std::invalid_argument if an MMSI appears twice
+      */
+     void restore(const Track* tracks, size_t count);
+
+     /**
+      * @brief Get the number of vessels with state
+      * @return Number of vessels
+      */
+     size_t size() const;
+
+     /**
+      * @brief Get the store counters
+      * @return Counters
+      */
+     Stats get_stats() const;
+
+ private:
+     Config config_;
+     std::unordered_map<uint32_t, uint32_t> index_;  // MMSI to row
+
+     // One row per vessel; removing a vessel moves the last row into its place
+     std::vector<uint32_t> mmsi_;
+     std::vector<double> time_;            // Last report
+     std::vector<double> latitude_;
+     std::vector<double> longitude_;
+     std::vector<double> previous_time_;   // Report before the last, equal to time_ if none
+     std::vector<double> previous_latitude_;
+     std::vector<double> previous_longitude_;
+     std::vector<double> north_;           // Degrees of latitude per second along the course
+     std::vector<double> east_;            // Degrees of longitude per second along the course
+     std::vector<double> speed_;           // Meters per second, 0 if the motion is not known
+     std::vector<double> course_;          // Radians
+     std::vector<double> turn_;            // Radians per second, 0 if not turning or not known
+
+     Stats stats_;
+
+     // Scratch columns of project()
+     std::vector<double> straight_latitude_;
+     std::vector<double> straight_longitude_;
+
+     // Position of a row at a time
+     ProjectedPosition position_of(size_t row, double time) const;
+
+     void remove_row(size_t row);
+ };
+
+ } // namespace aislib
+
+ #endif // AISLIB_TRACK_STORE_H
@@ -0,0 +1,187 @@
+/**
+ * @file vdl_load.h
+ * @brief VHF data link load statistics from communication states
+ *
+ * Each AIS channel is divided into frames of one minute with 2250 slots.
+ * This file defines a streaming aggregator that counts, per receiver and
+ * channel, the transmissions heard and the slots they occupy, and collects
+ * the slot numbers and received-station counts that SOTDMA transmitters
+ * report in their communication state. The counts cover a sliding window
+ * of frames and are kept as per-frame counters, so no message is retained.
+ */
+
+ #ifndef AISLIB_VDL_LOAD_H
+ #define AISLIB_VDL_LOAD_H
+
+ #include "aislib/ais_message.h"
+ #include "aislib/communication_state.h"
+ #include <array>
+ #include <cstdint>
+ #include <unordered_map>
+ #include <vector>
+
+ namespace aislib {
+
+ /**
+  * @struct VdlLoad
+  * @brief Load of one channel as heard by one receiver over the window
+  */
+ struct VdlLoad {
+     /// Buckets of the received-stations histogram: bucket 0 counts reports of
+     /// 0 stations, bucket k reports of 2^(k-1) to 2^k - 1 stations
+     static const size_t STATION_BUCKETS = 15;
+
+     uint32_t receiver = 0;          ///< Receiving station
+     char channel = 'A';             ///< AIS channel ('A' or 'B')
+     int64_t first_frame = 0;        ///< First frame of the window (Unix minutes)
+     uint32_t frames = 0;            ///< Frames in the window
+     uint64_t messages = 0;          ///< Transmissions heard
+     uint64_t slots = 0;             ///< Slots occupied by those transmissions
+     double occupancy = 0.0;         ///< slots / (2250 * frames)
+     uint32_t distinct_slots = 0;    ///< Distinct slot numbers reported in SOTDMA states
+     uint64_t sotdma = 0;            ///< Transmissions with a SOTDMA state
+     uint64_t itdma = 0;             ///< Transmissions with an ITDMA state
+     uint64_t no_tdma = 0;           ///< Transmissions without a TDMA state
+     std::array<uint64_t, 4> sync_states{};  ///< Transmissions per CommunicationState::SyncState
+     std::array<uint64_t, STATION_BUCKETS> received_stations{};  ///< Received-stations histogram
+     uint32_t max_received_stations = 0;     ///< Largest received-stations count reported
+     double mean_received_stations = 0.0;    ///< Mean received-stations count, 0 if none reported
+ };
+
+ /**
+  * @class VdlLoadMonitor
+  * @brief Sliding-window slot occupancy per receiver and channel
+  *
+  * Frames are aligned to UTC minutes. The window of a receiver and channel
+  * ends at the latest frame seen for it, or at the time given to advance().
+  * Transmissions older than the window are counted as late and ignored.
+  * Not thread-safe.
+  */
+ class VdlLoadMonitor {
+ public:
+     /// Slots per channel in one frame (one minute)
+     static const uint32_t SLOTS_PER_FRAME = 2250;
+
+     /**
+      * @struct Config
+      * @brief Monitor configuration
+      */
+     struct Config {
+         uint32_t window_frames;  ///< Frames (minutes) covered by the window
+
+         // Default constructor: ten-minute window
+         Config() : window_frames(10) {}
+     };
+
+     /**
+      * @brief Constructor
+      * @param config Monitor configuration
+      * @throws std::invalid_argument if window_frames is 0
+      */
+     explicit VdlLoadMonitor(const Config& config = Config());
+
+     /**
+      * @brief Count a received message
+      * @param receiver Receiving station
+      * @param channel Channel from the sentence ('A', 'B', '1' or '2')
+      * @param time Time of the transmission (Unix seconds)
+      * @param message Decoded message
+      * @return False if the message was late; messages without a communication
+      *         state are counted as transmissions without a TDMA state
+      */
+     bool add(uint32_t receiver, char channel, double time, const AISMessage& message);
+
+     /**
+      * @brief Count a transmission
+      * @param receiver Receiving station
+      * @param channel Channel from the sentence ('A', 'B', '1' or '2')
+      * @param time Time of the transmission (Unix seconds)
+      * @param state Communication state of the transmission
+      * @param slots Slots occupied by the transmission
+      * @return False if the transmission was late
+      */
+     bool add(uint32_t receiver, char channel, double time, const CommunicationState& state, uint8_t slots = 1);
+
+     /**
+      * @brief Move the window of every receiver and channel forward
+      * @param time Current time (Unix seconds); windows ending later are not moved
+      *
+      * Without it, the window of a channel that falls silent keeps its last counts.
+      */
+     void advance(double time);
+
+     /**
+      * @brief Get the load of one receiver and channel
+      * @param receiver Receiving station
+      * @param channel Channel ('A', 'B', '1' or '2')
+      * @return Load over the window, all zero if nothing was heard
+      */
+     VdlLoad get_load(uint32_t receiver, char channel) const;
+
+     /**
+      * @brief Get the load of every receiver and channel
+      * @return Loads, ordered by receiver and channel
+      */
+     std::vector<VdlLoad> get_loads() const;
+
+     /**
+      * @brief Get the number of transmissions ignored for being older than the window
+      * @return Late transmissions
+      */
+     uint64_t get_late() const;
+
+     /**
+      * @brief Remove all counts
+      */
+     void clear();
+
+     /**
+      * @brief Get the number of slots a message type occupies
+      * @param message_type Message type
+      * @return Slots (2 for types 5 and 19, 1 otherwise)
+      */
+     static uint8_t slots_for_type(uint8_t message_type);
+
+ private:
+     static const size_t SLOT_WORDS = (SLOTS_PER_FRAME + 63) / 64;
+
+     // Counters of one frame
+     struct Frame {
+         int64_t index;  // Unix minute, or -1 if unused
+         uint64_t messages;
+         uint64_t slots;
+         uint64_t sotdma;
+         uint64_t itdma;
+         uint64_t no_tdma;
+         std::array<uint64_t, 4> sync_states;
+         std::array<uint64_t, VdlLoad::STATION_BUCKETS> received_stations;
+         uint64_t station_reports;
+         uint64_t station_sum;
+         uint32_t station_max;
+         std::array<uint64_t, SLOT_WORDS> slot_bits;  // Slot numbers reported
+     };
+
+     // Ring of frames for one receiver and channel
+     struct Cell {
+         int64_t first;   // Earliest frame index seen
+         int64_t latest;  // Latest frame index seen, or set by advance()
+         std::vector<Frame> frames;
+     };
+
+     Config config_;
+     std::unordered_map<uint64_t, Cell> cells_;
+     uint64_t late_;
+
+     // Get the ring slot of a frame, moving the window forward if needed; nullptr if too old
+     Frame* frame_for(Cell& cell, int64_t index);
+
+     // Fill a load from the frames of a cell
+     VdlLoad summarize(uint64_t key, const Cell& cell) const;
+
+     static uint64_t key_for(uint32_t receiver, char channel);
+     static size_t station_bucket(uint32_t stations);
+ };
+
+ } // namespace aislib
+
+ #endif // AISLIB_VDL_LOAD_H
@@ -0,0 +1,201 @@
+/**
+ * @file vessel_table.h
+ * @brief Per-vessel state with binary snapshots for fast restarts
+ *
+ * This file defines a table that keeps what a service knows about each
+ * vessel: its track, its type 5 static and voyage data, and its paired
+ * type 24 parts, with vessel names, call signs and destinations interned.
+ * Static data arrives only every few minutes, so a restarted service
+ * restores the table from a snapshot instead of waiting for it. Snapshots
+ * are one binary file of fixed-size records that is mapped and copied in
+ * bulk on load.
+ */
+
+ #ifndef AISLIB_VESSEL_TABLE_H
+ #define AISLIB_VESSEL_TABLE_H
+
+ #include "aislib/ais_message.h"
+ #include "aislib/class_b_static_cache.h"
+ #include "aislib/string_pool.h"
+ #include "aislib/track_store.h"
+ #include <cstdint>
+ #include <future>
+ #include <memory>
+ #include <string>
+ #include <string_view>
+ #include <unordered_map>
+ #include <vector>
+
+ namespace aislib {
+
+ /**
+  * @struct VesselStatic
+  * @brief Static and voyage data of one vessel, from its latest type 5 message
+  *
+  * Strings are handles into the table's string pool.
+  */
+ struct VesselStatic {
+     uint32_t mmsi = 0;                               ///< MMSI number
+     uint32_t imo_number = 0;                         ///< IMO number, 0 if not available
+     uint16_t dimension_to_bow = 0;                   ///< Dimension to bow in meters
+     uint16_t dimension_to_stern = 0;                 ///< Dimension to stern in meters
+     uint8_t dimension_to_port = 0;                   ///< Dimension to port in meters
+     uint8_t dimension_to_starboard = 0;              ///< Dimension to starboard in meters
+     uint8_t ship_type = 0;                           ///< Ship type
+     uint8_t epfd_type = 0;                           ///< Position fixing device
+     uint8_t eta_month = 0;                           ///< ETA month (0 = not available)
+     uint8_t eta_day = 0;                             ///< ETA day (0 = not available)
+     uint8_t eta_hour = 24;                           ///< ETA hour (24 = not available)
+     uint8_t eta_minute = 60;                         ///< ETA minute (60 = not available)
+     float draught = 0.0f;                            ///< Draught in meters
+     StringPool::Handle vessel_name = StringPool::EMPTY;
+     StringPool::Handle call_sign = StringPool::EMPTY;
+     StringPool::Handle destination = StringPool::EMPTY;
+     double time = 0.0;                               ///< Time of the message (Unix seconds)
+ };
+
+ /**
+  * @class VesselTable
+  * @brief Tracks, static data and Class B static data keyed by MMSI
+  *
+  * Position reports go to a TrackStore, type 5 messages to a table of
+  * VesselStatic records, and type 24 parts to a ClassBStaticCache.
+  *
+  * save() writes the whole table to a snapshot file: a header followed by
+  * one section of fixed-size records each for the strings, the static
+  * records, the tracks and the Class B records. save_async() copies the
+  * records into a buffer in the calling thread, about 60 ms for 300,000
+  * vessels, then writes and syncs the file on another thread, so the
+  * table can be updated while the file is written. The file is written
+  * under a temporary name and renamed, so a crash never leaves a partial
+  * snapshot in place.
+  *
+  * load() maps a snapshot and restores the table from it. The string
+  * pool is rebuilt in handle order, so restored records keep their
+  * handles. Class B part times are stored as ages and moved forward by
+  * the wall-clock time since the snapshot was saved, so records expire as
+  * if the service had kept running. Snapshots are only read back on the
+  * architecture that wrote them. Not thread-safe.
+  */
+ class VesselTable {
+ public:
+     using Clock = ClassBStaticCache::Clock;
+
+     /**
+      * @struct Config
+      * @brief Table configuration
+      */
+     struct Config {
+         TrackStore::Config tracks;          ///< Track store configuration
+         ClassBStaticCache::Config class_b;  ///< Class B static cache configuration
+
+         // Default constructor
+         Config() {}
+     };
+
+     /**
+      * @struct Stats
+      * @brief Table contents
+      */
+     struct Stats {
+         size_t tracks = 0;     ///< Vessels with a track
+         size_t statics = 0;    ///< Vessels with type 5 data
+         size_t class_b = 0;    ///< Vessels with type 24 data
+         size_t strings = 0;    ///< Distinct strings, including the empty string
+     };
+
+     /**
+      * @brief Constructor
+      * @param config Table configuration
+      * @throws std::invalid_argument if the configuration is invalid
+      */
+     explicit VesselTable(const Config& config = Config());
+
+     /**
+      * @brief Update the table from a decoded message
+      * @param time Time of the message (Unix seconds)
+      * @param message Decoded message
+      * @param now Arrival time, for the Class B static cache
+      * @return False if the message carries no vessel state or was ignored
+      */
+     bool update(double time, const AISMessage& message, Clock::time_point now = Clock::now());
+
+     /**
+      * @brief Look up the type 5 data of a vessel
+      * @param mmsi MMSI number
+      * @return Record valid until the table is next modified, nullptr if absent
+      */
+     const VesselStatic* find_static(uint32_t mmsi) const;
+
+     /**
+      * @brief Get an interned string
+      * @param handle Handle from a VesselStatic record
+      * @return Characters, valid for the lifetime of the table's pool
+      */
+     std::string_view text(StringPool::Handle handle) const;
+
+     /**
+      * @brief Get the track store
+      * @return Track store
+      */
+     TrackStore& tracks();
+     const TrackStore& tracks() const;
+
+     /**
+      * @brief Get the Class B static cache
+      * @return Class B static cache
+      */
+     ClassBStaticCache& class_b();
+     const ClassBStaticCache& class_b() const;
+
+     /**
+      * @brief Write a snapshot of the table
+      * @param path Snapshot file
+      * @return Bytes written
+      * @throws std::runtime_error if the file cannot be written
+      */
+     size_t save(const std::string& path) const;
+
+     /**
+      * @brief Copy the table and write the snapshot on another thread
+      * @param path Snapshot file
+      * @return Future holding the bytes written, or the error
+      */
+     std::future<size_t> save_async(const std::string& path) const;
+
+     /**
+      * @brief Replace the table's contents with a snapshot
+      * @param path Snapshot file
+      * @param now Current time, for the Class B static cache
+      * @throws std::runtime_error if the file cannot be read or is not a valid snapshot;
+      *         the table is left empty
+      */
+     void load(const std::string& path, Clock::time_point now = Clock::now());
+
+     /**
+      * @brief Forget all vessels and strings
+      */
+     void clear();
+
+     /**
+      * @brief Get the table contents
+      * @return Counts
+      */
+     Stats get_stats() const;
+
+ private:
+     Config config_;
+     TrackStore tracks_;
+     ClassBStaticCache class_b_;
+     std::unique_ptr<StringPool> strings_;
+     std::vector<VesselStatic> statics_;
+     std::unordered_map<uint32_t, uint32_t> static_index_;   // MMSI to statics_ index
+
+     // Snapshot of the table in file layout
+     std::vector<char> serialize() const;
+     void restore(const char* data, size_t size, Clock::time_point now);
+ };
+
+ } // namespace aislib
+
+ #endif // AISLIB_VESSEL_TABLE_H
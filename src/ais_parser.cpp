@@ -4,17 +4,96 @@
  */
 
  #include "aislib/ais_parser.h"
+ #include "aislib/decode_cache.h"
+ #include "aislib/metrics.h"
  #include "aislib/nmea_utils.h"
+ #include "aislib/tracing.h"
  #include <stdexcept>
  
  namespace aislib {
  
  AISParser::AISParser(const ParserConfig& config)
-     : multipart_manager_(config.message_timeout, config.max_incomplete_messages) {
+     : multipart_manager_(config.message_timeout, config.max_incomplete_messages),
+       metrics_(config.metrics),
+       decode_cache_(config.decode_cache),
+       latency_sample_interval_(config.latency_sample_interval),
+       sentences_since_sample_(0) {
+     multipart_manager_.set_metrics(metrics_.get());
      clear_error();
  }
  
+ template <typename Message, typename Step>
+ Message AISParser::record_parse(Step&& step) {
+     AISLIB_TRACE_SCOPE(PARSE);
+     
+     if (!metrics_) {
+         return step();
+     }
+     
+     metrics_->record_sentence();
+     
+     // Only every N-th sentence is timed; reading the clock costs more than the counters
+     Message message;
+     if (latency_sample_interval_ > 0 && ++sentences_since_sample_ >= latency_sample_interval_) {
+         sentences_since_sample_ = 0;
+         auto start = std::chrono::steady_clock::now();
+         message = step();
+         metrics_->record_parse_latency(std::chrono::steady_clock::now() - start);
+     } else {
+         message = step();
+     }
+     
+     if (message) {
+         metrics_->record_message(message->get_message_type());
+     }
+     
+     return message;
+ }
+ 
  std::unique_ptr<AISMessage> AISParser::parse(const std::string& nmea_sentence) {
+     return record_parse<std::unique_ptr<AISMessage>>([this, &nmea_sentence]() -> std::unique_ptr<AISMessage> {
+         ParseError::ErrorType decode_error;
+         const BitVector* bits = assemble(nmea_sentence, decode_error);
+         if (!bits) {
+             return nullptr;
+         }
+         
+         try {
+             return AISMessage::from_bits(*bits);
+         } catch (const std::exception& e) {
+             set_error(decode_error, e.what());
+             return nullptr;
+         }
+     });
+ }
+ 
+ std::shared_ptr<const AISMessage> AISParser::parse_shared(const std::string& nmea_sentence) {
+     return record_parse<std::shared_ptr<const AISMessage>>([this, &nmea_sentence]() -> std::shared_ptr<const AISMessage> {
+         ParseError::ErrorType decode_error;
+         const BitVector* bits = assemble(nmea_sentence, decode_error);
+         if (!bits) {
+             return nullptr;
+         }
+         
+         try {
+             if (!decode_cache_) {
+                 return AISMessage::from_bits(*bits);
+             }
+             
+             bool hit = false;
+             auto message = decode_cache_->decode(*bits, &hit);
+             if (metrics_ && decode_cache_->is_cacheable(message->get_message_type())) {
+                 metrics_->record_decode_cache(hit);
+             }
+             return message;
+         } catch (const std::exception& e) {
+             set_error(decode_error, e.what());
+             return nullptr;
+         }
+     });
+ }
+ 
+ const BitVector* AISParser::assemble(const std::string& nmea_sentence, ParseError::ErrorType& decode_error) {
      // Clear previous error
      clear_error();
      
@@ -24,8 +103,9 @@
          return nullptr;
      }
      
-     // Parse fields
-     std::vector<std::string> fields = NMEAUtils::parse_fields(nmea_sentence);
+     // Parse fields into the reused field vector
+     std::vector<std::string>& fields = fields_;
+     NMEAUtils::parse_fields(nmea_sentence, fields);
      
      // Check if it's an AIS message (!AIVDM or !AIVDO)
      if (fields.size() < 7 || (fields[0] != "!AIVDM" && fields[0] != "!AIVDO")) {
@@ -52,9 +132,9 @@
      }
      
      // Extract message ID, channel, payload, and fill bits
-     std::string message_id = fields[3];
+     const std::string& message_id = fields[3];
      char channel = fields[4][0];
-     std::string payload = fields[5];
+     const std::string& payload = fields[5];
      uint8_t fill_bits = 0;
      
      try {
@@ -66,43 +146,44 @@
      
      // Handle single-part messages directly
      if (fragment_count == 1) {
+         decode_error = ParseError::ErrorType::INVALID_PAYLOAD;
          try {
-             // Convert payload to bits
-             BitVector bits(payload);
+             // Convert payload to bits, reusing the storage of the previous sentence
+             bits_.assign_payload(payload);
              
-             // Adjust for fill bits
+             // Drop fill bits
              if (fill_bits > 0 && fill_bits <= 5) {
-                 // Create a new BitVector excluding fill bits
-                 BitVector adjusted_bits;
-                 for (size_t i = 0; i < bits.size() - fill_bits; i++) {
-                     adjusted_bits.append_bit(bits.get_bit(i));
+                 if (fill_bits > bits_.size()) {
+                     throw std::out_of_range("Fill bits exceed payload length");
                  }
-                 return AISMessage::from_bits(adjusted_bits);
+                 bits_.truncate(bits_.size() - fill_bits);
              }
              
-             // Create message from bits
-             return AISMessage::from_bits(bits);
+             return &bits_;
          } catch (const std::exception& e) {
-             set_error(ParseError::ErrorType::INVALID_PAYLOAD, e.what());
+             set_error(decode_error, e.what());
              return nullptr;
          }
      } else {
          // This is a multi-part message
+         decode_error = ParseError::ErrorType::OTHER;
          try {
              // Add fragment to MultipartMessageManager
+             AISLIB_TRACE_SCOPE_ARG(MULTIPART_ADD, fragment_number);
              auto result = multipart_manager_.add_fragment(
                  fragment_number, fragment_count, message_id, channel, payload, fill_bits);
              
              // Check if all fragments are received
              if (result) {
-                 // Message is complete, create message from combined bits
-                 return AISMessage::from_bits(*result);
+                 // Message is complete
+                 bits_ = std::move(*result);
+                 return &bits_;
              }
              
              // Not all fragments received yet, return nullptr without setting an error
              return nullptr;
          } catch (const std::exception& e) {
-             set_error(ParseError::ErrorType::OTHER, e.what());
+             set_error(decode_error, e.what());
              return nullptr;
          }
      }
@@ -138,9 +219,17 @@
      multipart_manager_.clear();
  }
  
- void AISParser::set_error(ParseError::ErrorType type, const std::string& message) {
+ std::shared_ptr<MetricsRegistry> AISParser::get_metrics() const {
+     return metrics_;
+ }
+ 
+ void AISParser::set_error(ParseError::ErrorType type, const char* message) {
      last_error_.type = type;
      last_error_.message = message;
+     
+     if (metrics_) {
+         metrics_->record_error(type);
+     }
  }
  
  void AISParser::clear_error() {
@@ -0,0 +1,104 @@
+/**
+ * @file allocation_counter.cpp
+ * @brief Global operator new replacement counting allocations
+ */
+
+ #include "aislib/allocation_counter.h"
+ #include <cstdlib>
+ #include <new>
+
+ namespace {
+
+ thread_local uint64_t tls_allocation_count = 0;
+
+ void* counted_malloc(std::size_t size) {
+     ++tls_allocation_count;
+     void* ptr = std::malloc(size == 0 ? 1 : size);
+     if (ptr == nullptr) {
+         throw std::bad_alloc();
+     }
+     return ptr;
+ }
+
+ void* counted_aligned_malloc(std::size_t size, std::align_val_t alignment) {
+     ++tls_allocation_count;
+     std::size_t align = static_cast<std::size_t>(alignment);
+
+     // aligned_alloc requires the size to be a multiple of the alignment
+     std::size_t rounded = (size + align - 1) / align * align;
+     void* ptr = std::aligned_alloc(align, rounded == 0 ? align : rounded);
+     if (ptr == nullptr) {
+         throw std::bad_alloc();
+     }
+     return ptr;
+ }
+
+ } // anonymous namespace
+
+ namespace aislib {
+ namespace alloc {
+
+ uint64_t allocation_count() {
+     return tls_allocation_count;
+ }
+
+ } // namespace alloc
+ } // namespace aislib
+
+ void* operator new(std::size_t size) {
+     return counted_malloc(size);
+ }
+
+ void* operator new[](std::size_t size) {
+     return counted_malloc(size);
+ }
+
+ void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+     ++tls_allocation_count;
+     return std::malloc(size == 0 ? 1 : size);
+ }
+
+ void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+     ++tls_allocation_count;
+     return std::malloc(size == 0 ? 1 : size);
+ }
+
+ void* operator new(std::size_t size, std::align_val_t alignment) {
+     return counted_aligned_malloc(size, alignment);
+ }
+
+ void* operator new[](std::size_t size, std::align_val_t alignment) {
+     return counted_aligned_malloc(size, alignment);
+ }
+
+ void operator delete(void* ptr) noexcept {
+     std::free(ptr);
+ }
+
+ void operator delete[](void* ptr) noexcept {
+     std::free(ptr);
+ }
+
+ void operator delete(void* ptr, std::size_t) noexcept {
+     std::free(ptr);
+ }
+
+ void operator delete[](void* ptr, std::size_t) noexcept {
+     std::free(ptr);
+ }
+
+ void operator delete(void* ptr, std::align_val_t) noexcept {
+     std::free(ptr);
+ }
+
+ void operator delete[](void* ptr, std::align_val_t) noexcept {
+     std::free(ptr);
+ }
+
+ void operator delete(void* ptr, std::size_t, std::align_val_t) noexcept {
+     std::free(ptr);
+ }
+
+ void operator delete[](void* ptr, std::size_t, std::align_val_t) noexcept {
+     std::free(ptr);
+ }
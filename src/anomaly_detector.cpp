@@ -0,0 +1,416 @@
+/**
+ * @file anomaly_detector.cpp
+ * @brief Implementation of PositionBatch and AnomalyDetector
+ */
+
+ #include "aislib/anomaly_detector.h"
+ #include "aislib/geo.h"
+ #include "aislib/position_report_class_a.h"
+ #include "aislib/position_report_class_b.h"
+ #include <algorithm>
+ #include <cmath>
+ #include <limits>
+ #include <stdexcept>
+
+ namespace aislib {
+
+ namespace {
+
+ const double kMetersPerSecondPerKnot = geo::METERS_PER_NM / 3600.0;
+ const uint8_t kStatusNotDefined = 15;
+
+ // MIDs allocated by the ITU (Appendix 43 to the Radio Regulations)
+ const uint16_t kAllocatedMids[] = {
+     201, 202, 203, 204, 205, 206, 207, 208, 209, 210, 211, 212, 213, 214, 215, 216, 218, 219, 220,
+     224, 225, 226, 227, 228, 229, 230, 231, 232, 233, 234, 235, 236, 237, 238, 239, 240, 241, 242,
+     243, 244, 245, 246, 247, 248, 249, 250, 251, 252, 253, 254, 255, 256, 257, 258, 259, 261, 262,
+     263, 264, 265, 266, 267, 268, 269, 270, 271, 272, 273, 274, 275, 276, 277, 278, 279,
+     301, 303, 304, 305, 306, 307, 308, 309, 310, 311, 312, 314, 316, 319, 321, 323, 325, 327, 329,
+     330, 331, 332, 334, 336, 338, 339, 341, 343, 345, 347, 348, 350, 351, 352, 353, 354, 355, 356,
+     357, 358, 359, 361, 362, 364, 366, 367, 368, 369, 370, 371, 372, 373, 374, 375, 376, 377, 378,
+     379,
+     401, 403, 405, 408, 410, 412, 413, 414, 416, 417, 419, 422, 423, 425, 428, 431, 432, 434, 436,
+     437, 438, 440, 441, 443, 445, 447, 450, 451, 453, 455, 457, 459, 461, 463, 466, 468, 470, 471,
+     472, 473, 475, 477, 478,
+     501, 503, 506, 508, 510, 511, 512, 514, 515, 516, 518, 520, 523, 525, 529, 531, 533, 536, 538,
+     540, 542, 544, 546, 548, 553, 555, 557, 559, 561, 563, 564, 565, 566, 567, 570, 572, 574, 576,
+     577, 578,
+     601, 603, 605, 607, 608, 609, 610, 611, 612, 613, 615, 616, 617, 618, 619, 620, 621, 622, 624,
+     625, 626, 627, 629, 630, 631, 632, 633, 634, 635, 636, 637, 638, 642, 644, 645, 647, 649, 650,
+     654, 655, 656, 657, 659, 660, 661, 662, 663, 664, 665, 666, 667, 668, 669, 670, 671, 672, 674,
+     675, 676, 677, 678, 679,
+     701, 710, 720, 725, 730, 735, 740, 745, 750, 755, 760, 765, 770, 775
+ };
+
+ bool allocated_mid(uint32_t mid) {
+     return std::binary_search(std::begin(kAllocatedMids), std::end(kAllocatedMids), mid);
+ }
+
+ bool valid_position(double latitude, double longitude) {
+     return latitude >= -90.0 && latitude <= 90.0 && longitude >= -180.0 && longitude <= 180.0;
+ }
+
+ bool known_speed(float speed) {
+     // 102.2 knots means 102.2 or more
+     return speed >= 0.0f && speed < 102.2f;
+ }
+
+ bool stationary_status(uint8_t status) {
+     using Status = PositionReportClassA::NavigationStatus;
+     return status == static_cast<uint8_t>(Status::AT_ANCHOR) ||
+            status == static_cast<uint8_t>(Status::MOORED) ||
+            status == static_cast<uint8_t>(Status::AGROUND);
+ }
+
+ bool under_way_status(uint8_t status) {
+     using Status = PositionReportClassA::NavigationStatus;
+     return status == static_cast<uint8_t>(Status::UNDER_WAY_USING_ENGINE) ||
+            status == static_cast<uint8_t>(Status::UNDER_WAY_SAILING);
+ }
+
+ } // anonymous namespace
+
+ // ---- PositionBatch ----
+
+ void PositionBatch::append(uint32_t mmsi_value, double time_value, double latitude_value, double longitude_value,
+                            float speed_value, uint8_t status_value) {
+     mmsi.push_back(mmsi_value);
+     time.push_back(time_value);
+     latitude.push_back(latitude_value);
+     longitude.push_back(longitude_value);
+     speed.push_back(speed_value);
+     navigation_status.push_back(status_value);
+ }
+
+ bool PositionBatch::append(double time_value, const AISMessage& message) {
+     if (auto* class_a = dynamic_cast<const PositionReportClassA*>(&message)) {
+         append(class_a->get_mmsi(), time_value, class_a->get_latitude(), class_a->get_longitude(),
+                class_a->get_speed_over_ground(), static_cast<uint8_t>(class_a->get_navigation_status()));
+         return true;
+     }
+     // Covers type 19, which derives from type 18
+     if (auto* class_b = dynamic_cast<const StandardPositionReportClassB*>(&message)) {
+         float speed = class_b->get_speed_over_ground();
+         append(class_b->get_mmsi(), time_value, class_b->get_latitude(), class_b->get_longitude(),
+                speed < 0.0f ? std::numeric_limits<float>::quiet_NaN() : speed, kStatusNotDefined);
+         return true;
+     }
+     return false;
+ }
+
+ size_t PositionBatch::size() const {
+     return mmsi.size();
+ }
+
+ void PositionBatch::reserve(size_t rows) {
+     mmsi.reserve(rows);
+     time.reserve(rows);
+     latitude.reserve(rows);
+     longitude.reserve(rows);
+     speed.reserve(rows);
+     navigation_status.reserve(rows);
+     anomalies.reserve(rows);
+ }
+
+ void PositionBatch::clear() {
+     mmsi.clear();
+     time.clear();
+     latitude.clear();
+     longitude.clear();
+     speed.clear();
+     navigation_status.clear();
+     anomalies.clear();
+ }
+
+ // ---- AnomalyDetector ----
+
+ const uint32_t AnomalyDetector::SPEED_MISMATCH;
+ const uint32_t AnomalyDetector::TELEPORT;
+ const uint32_t AnomalyDetector::MMSI_COLLISION;
+ const uint32_t AnomalyDetector::INVALID_MID;
+ const uint32_t AnomalyDetector::NAV_STATUS;
+ const uint32_t AnomalyDetector::NONE;
+
+ AnomalyDetector::AnomalyDetector(const Config& config)
+     : config_(config),
+       batch_(0) {
+     if (!(config_.max_speed > 0.0) || !(config_.speed_factor > 0.0)) {
+         throw std::invalid_argument("Anomaly detector speeds must be positive");
+     }
+ }
+
+ void AnomalyDetector::check(PositionBatch& batch) {
+     const size_t rows = batch.size();
+     if (batch.time.size() != rows || batch.latitude.size() != rows || batch.longitude.size() != rows ||
+         batch.speed.size() != rows || batch.navigation_status.size() != rows) {
+         throw std::invalid_argument("Position batch columns differ in length");
+     }
+     batch.anomalies.assign(rows, 0);
+     ++batch_;
+
+     // Pass 1: look up the vessels and gather their primary, secondary and anchor positions
+     slots_.assign(rows, NONE);
+     repeated_.assign(rows, 0);
+     from_latitude_.resize(3 * rows);
+     from_longitude_.resize(3 * rows);
+     distances_.resize(3 * rows);
+     for (size_t i = 0; i < rows; ++i) {
+         if (!valid_position(batch.latitude[i], batch.longitude[i])) {
+             continue;
+         }
+         uint32_t slot = slot_for(batch.mmsi[i]);
+         Vessel& vessel = vessels_[slot];
+         // A vessel seen earlier in the batch has moved on since pass 1
+         repeated_[i] = vessel.batch == batch_;
+         vessel.batch = batch_;
+         slots_[i] = slot;
+
+         from_latitude_[i] = vessel.primary.latitude;
+         from_longitude_[i] = vessel.primary.longitude;
+         from_latitude_[rows + i] = vessel.secondary.latitude;
+         from_longitude_[rows + i] = vessel.secondary.longitude;
+         from_latitude_[2 * rows + i] = vessel.anchor.latitude;
+         from_longitude_[2 * rows + i] = vessel.anchor.longitude;
+     }
+
+     // Pass 2: distances from all three positions
+     for (size_t k = 0; k < 3; ++k) {
+         geo::haversine_batch(from_latitude_.data() + k * rows, from_longitude_.data() + k * rows,
+                              batch.latitude.data(), batch.longitude.data(), rows, distances_.data() + k * rows);
+     }
+
+     // Pass 3: evaluate in order
+     for (size_t i = 0; i < rows; ++i) {
+         if (slots_[i] == NONE) {
+             batch.anomalies[i] = identity_flags(batch.mmsi[i], batch.speed[i], batch.navigation_status[i]);
+             ++stats_.reports;
+             count(batch.anomalies[i]);
+             continue;
+         }
+         Vessel& vessel = vessels_[slots_[i]];
+         Distances distances;
+         if (repeated_[i]) {
+             distances = distances_from(vessel, batch.latitude[i], batch.longitude[i]);
+         } else {
+             distances.primary = distances_[i];
+             distances.secondary = distances_[rows + i];
+             distances.anchor = distances_[2 * rows + i];
+         }
+         batch.anomalies[i] = evaluate(vessel, batch.mmsi[i], batch.time[i], batch.latitude[i], batch.longitude[i],
+                                       batch.speed[i], batch.navigation_status[i], distances);
+     }
+ }
+
+ uint32_t AnomalyDetector::check(uint32_t mmsi, double time, double latitude, double longitude,
+                                 float speed, uint8_t navigation_status) {
+     if (!valid_position(latitude, longitude)) {
+         uint32_t flags = identity_flags(mmsi, speed, navigation_status);
+         ++stats_.reports;
+         count(flags);
+         return flags;
+     }
+     Vessel& vessel = vessels_[slot_for(mmsi)];
+     return evaluate(vessel, mmsi, time, latitude, longitude, speed, navigation_status,
+                     distances_from(vessel, latitude, longitude));
+ }
+
+ size_t AnomalyDetector::expire(double now) {
+     size_t dropped = 0;
+     for (auto it = index_.begin(); it != index_.end();) {
+         const Vessel& vessel = vessels_[it->second];
+         if (vessel.initialized && now - vessel.primary.time < config_.max_age) {
+             ++it;
+             continue;
+         }
+         free_slots_.push_back(it->second);
+         it = index_.erase(it);
+         ++dropped;
+     }
+     return dropped;
+ }
+
+ void AnomalyDetector::clear() {
+     vessels_.clear();
+     free_slots_.clear();
+     index_.clear();
+ }
+
+ AnomalyDetector::Stats AnomalyDetector::get_stats() const {
+     Stats stats = stats_;
+     stats.vessels = index_.size();
+     return stats;
+ }
+
+ bool AnomalyDetector::has_valid_mid(uint32_t mmsi) {
+     if (mmsi >= 1000000000) {
+         return false;
+     }
+     if (mmsi < 10000000) {
+         return allocated_mid(mmsi / 10000);        // 00MIDXXXX: coast station
+     }
+     if (mmsi < 100000000) {
+         return allocated_mid(mmsi / 100000);       // 0MIDXXXXX: group of ships
+     }
+
+     uint32_t prefix = mmsi / 1000000;
+     switch (prefix) {
+         case 970:                                  // AIS-SART
+         case 972:                                  // Man overboard device
+         case 974:                                  // EPIRB-AIS
+             return true;
+         case 111:                                  // 111MIDXXX: SAR aircraft
+             return allocated_mid((mmsi / 1000) % 1000);
+         default:
+             break;
+     }
+     if (prefix / 10 == 98 || prefix / 10 == 99) {
+         return allocated_mid((mmsi / 10000) % 1000);   // 98MIDXXXX craft, 99MIDXXXX aids to navigation
+     }
+     return allocated_mid(prefix);                  // MIDXXXXXX: ship station
+ }
+
+ uint32_t AnomalyDetector::slot_for(uint32_t mmsi) {
+     auto it = index_.find(mmsi);
+     if (it != index_.end()) {
+         return it->second;
+     }
+
+     uint32_t slot;
+     if (!free_slots_.empty()) {
+         slot = free_slots_.back();
+         free_slots_.pop_back();
+     } else {
+         slot = static_cast<uint32_t>(vessels_.size());
+         vessels_.emplace_back();
+     }
+     Vessel& vessel = vessels_[slot];
+     vessel = Vessel();
+     vessel.initialized = false;
+     vessel.has_secondary = false;
+     vessel.batch = 0;
+     index_.emplace(mmsi, slot);
+     return slot;
+ }
+
+ AnomalyDetector::Distances AnomalyDetector::distances_from(const Vessel& vessel, double latitude, double longitude) {
+     const double from_latitude[3] = {vessel.primary.latitude, vessel.secondary.latitude, vessel.anchor.latitude};
+     const double from_longitude[3] = {vessel.primary.longitude, vessel.secondary.longitude, vessel.anchor.longitude};
+     const double to_latitude[3] = {latitude, latitude, latitude};
+     const double to_longitude[3] = {longitude, longitude, longitude};
+     double meters[3];
+     geo::haversine_batch(from_latitude, from_longitude, to_latitude, to_longitude, 3, meters);
+
+     Distances distances;
+     distances.primary = meters[0];
+     distances.secondary = meters[1];
+     distances.anchor = meters[2];
+     return distances;
+ }
+
+ uint32_t AnomalyDetector::evaluate(Vessel& vessel, uint32_t mmsi, double time, double latitude, double longitude,
+                                    float speed, uint8_t navigation_status, const Distances& distances) {
+     ++stats_.reports;
+     uint32_t flags = identity_flags(mmsi, speed, navigation_status);
+     const Fix fix = {latitude, longitude, time};
+
+     if (!vessel.initialized) {
+         vessel.initialized = true;
+         vessel.primary = fix;
+         vessel.anchor = fix;
+         vessel.anchor_speed = speed;
+         vessel.switches = 0;
+         vessel.status = navigation_status;
+         count(flags);
+         return flags;
+     }
+     if (time < vessel.primary.time) {
+         ++stats_.out_of_order;
+         count(flags);
+         return flags;
+     }
+
+     const double max_speed = config_.max_speed * kMetersPerSecondPerKnot;
+     auto consistent = [&](double meters, double since) {
+         return meters <= config_.teleport_distance || meters / std::max(since, 1.0) <= max_speed;
+     };
+
+     if (vessel.has_secondary && time - vessel.secondary.time > config_.collision_window) {
+         vessel.has_secondary = false;
+         vessel.switches = 0;
+     }
+
+     if (consistent(distances.primary, time - vessel.primary.time)) {
+         // A vessel leaving or reaching a berth or anchorage is slow when the status changes
+         bool departs = stationary_status(vessel.status) && under_way_status(navigation_status);
+         bool arrives = under_way_status(vessel.status) && stationary_status(navigation_status);
+         if (departs || arrives) {
+             double since = std::max(time - vessel.primary.time, 1.0);
+             if (distances.primary / since / kMetersPerSecondPerKnot > config_.transition_speed) {
+                 flags |= NAV_STATUS;
+             }
+         }
+         vessel.primary = fix;
+
+         double since_anchor = time - vessel.anchor.time;
+         if (since_anchor >= config_.min_interval) {
+             double implied = distances.anchor / since_anchor / kMetersPerSecondPerKnot;
+             float reported = known_speed(vessel.anchor_speed) && known_speed(speed)
+                                  ? std::max(vessel.anchor_speed, speed)
+                                  : (known_speed(speed) ? speed : vessel.anchor_speed);
+             if (known_speed(reported) && implied > reported * config_.speed_factor + config_.speed_margin) {
+                 flags |= SPEED_MISMATCH;
+             }
+             if (stationary_status(navigation_status) && implied > config_.stationary_speed) {
+                 flags |= NAV_STATUS;
+             }
+             vessel.anchor = fix;
+             vessel.anchor_speed = speed;
+         }
+     } else {
+         if (vessel.has_secondary && consistent(distances.secondary, time - vessel.secondary.time)) {
+             // Back on the other track: the two tracks take turns
+             std::swap(vessel.primary, vessel.secondary);
+             if (++vessel.switches >= config_.collision_switches) {
+                 flags |= MMSI_COLLISION;
+             }
+         } else {
+             flags |= TELEPORT;
+             vessel.secondary = vessel.primary;
+             vessel.has_secondary = true;
+         }
+         // Speeds are measured along one track only
+         vessel.primary = fix;
+         vessel.anchor = fix;
+         vessel.anchor_speed = speed;
+     }
+     vessel.status = navigation_status;
+
+     count(flags);
+     return flags;
+ }
+
+ uint32_t AnomalyDetector::identity_flags(uint32_t mmsi, float speed, uint8_t navigation_status) const {
+     uint32_t flags = 0;
+     if (!has_valid_mid(mmsi)) {
+         flags |= INVALID_MID;
+     }
+     if (stationary_status(navigation_status) && known_speed(speed) && speed > config_.stationary_speed) {
+         flags |= NAV_STATUS;
+     }
+     // Only AIS-SART devices (970XXYYYY) may report the SART status
+     if (navigation_status == static_cast<uint8_t>(PositionReportClassA::NavigationStatus::AIS_SART_ACTIVE) &&
+         mmsi / 1000000 != 970) {
+         flags |= NAV_STATUS;
+     }
+     return flags;
+ }
+
+ void AnomalyDetector::count(uint32_t flags) {
+     stats_.speed_mismatch += (flags & SPEED_MISMATCH) != 0;
+     stats_.teleport += (flags & TELEPORT) != 0;
+     stats_.mmsi_collision += (flags & MMSI_COLLISION) != 0;
+     stats_.invalid_mid += (flags & INVALID_MID) != 0;
+     stats_.nav_status += (flags & NAV_STATUS) != 0;
+ }
+
+ } // namespace aislib
@@ -103,20 +103,17 @@
          return std::chrono::system_clock::time_point();
      }
      
-     // Set up the time components
-     std::tm timeinfo = {};
-     timeinfo.tm_year = utc_year_ - 1900; // Years since 1900
-     timeinfo.tm_mon = utc_month_ - 1;    // Months since January (0-11)
-     timeinfo.tm_mday = utc_day_;         // Day of the month (1-31)
-     timeinfo.tm_hour = utc_hour_;        // Hours (0-23)
-     timeinfo.tm_min = utc_minute_;       // Minutes (0-59)
-     timeinfo.tm_sec = utc_second_;       // Seconds (0-59)
-     
-     // Convert to time_t
-     std::time_t time = std::mktime(&timeinfo);
-     
-     // Convert to system_clock::time_point
-     return std::chrono::system_clock::from_time_t(time);
+     // Days since 1970-01-01 in the proleptic Gregorian calendar; std::mktime
+     // would interpret the fields as local time
+     int64_t year = utc_year_ - (utc_month_ <= 2 ? 1 : 0);
+     int64_t era = (year >= 0 ? year : year - 399) / 400;
+     int64_t year_of_era = year - era * 400;
+     int64_t day_of_year = (153 * (utc_month_ + (utc_month_ > 2 ? -3 : 9)) + 2) / 5 + utc_day_ - 1;
+     int64_t day_of_era = year_of_era * 365 + year_of_era / 4 - year_of_era / 100 + day_of_year;
+     int64_t days = era * 146097 + day_of_era - 719468;
+     
+     int64_t seconds = days * 86400 + utc_hour_ * 3600 + utc_minute_ * 60 + utc_second_;
+     return std::chrono::system_clock::time_point(std::chrono::seconds(seconds));
  }
  
  bool BaseStationReport::get_position_accuracy() const {
@@ -264,6 +261,18 @@
      raim_flag_ = raim;
  }
  
+ uint32_t BaseStationReport::get_radio_status() const {
+     return radio_status_;
+ }
+ 
+ CommunicationState BaseStationReport::get_communication_state() const {
+     return CommunicationState::sotdma(radio_status_);
+ }
+ 
+ void BaseStationReport::set_radio_status(uint32_t radio_status) {
+     radio_status_ = radio_status & 0x7FFFF;
+ }
+ 
  void BaseStationReport::to_bits(BitVector& bits) const {
      // Clear the bit vector
      bits.clear();
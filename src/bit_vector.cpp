@@ -4,6 +4,9 @@
  */
 
  #include "aislib/bit_vector.h"
+ #include "aislib/tracing.h"
+ #include "aislib/cpu_dispatch.h"
+ #include <algorithm>
  #include <sstream>
  #include <iomanip>
  
@@ -17,24 +20,51 @@
  }
  
  BitVector::BitVector(const std::string& payload) : bit_count_(0) {
-     // Each character in the payload represents 6 bits
-     reserve(payload.length() * 6);
+     assign_payload(payload);
+ }
+ 
+ void BitVector::assign_payload(const std::string& payload) {
+     AISLIB_TRACE_SCOPE(DEARMOR);
      
-     for (char c : payload) {
-         // Convert AIS/NMEA ASCII to 6-bit value
-         uint8_t value = 0;
-         
-         if (c >= '0' && c <= 'W') {
-             value = static_cast<uint8_t>(c - '0');
-         } else if (c >= '`' && c <= 'w') {
-             value = static_cast<uint8_t>(c - '`' + 40);
-         } else {
+     // Each character in the payload represents 6 bits; the storage is kept
+     size_t length = payload.length();
+     data_.assign((length * 6 + 7) / 8, 0);
+     bit_count_ = 0;
+     
+     // De-armor a block at a time with the dispatched kernel, then pack four
+     // 6-bit values into three bytes, most significant bit first
+     const cpu::Kernels& kernels = cpu::kernels();
+     uint8_t values[64];
+     uint8_t* out = data_.data();
+     
+     for (size_t offset = 0; offset < length; offset += sizeof(values)) {
+         size_t block = std::min(sizeof(values), length - offset);
+         if (!kernels.dearmor(payload.data() + offset, block, values)) {
+             clear();
              throw std::invalid_argument("Invalid character in NMEA payload");
          }
          
-         // Append the 6 bits
-         for (int i = 5; i >= 0; --i) {
-             append_bit((value & (1 << i)) != 0);
+         size_t i = 0;
+         for (; i + 4 <= block; i += 4) {
+             uint32_t packed = (static_cast<uint32_t>(values[i]) << 18) |
+                               (static_cast<uint32_t>(values[i + 1]) << 12) |
+                               (static_cast<uint32_t>(values[i + 2]) << 6) |
+                               values[i + 3];
+             out[0] = static_cast<uint8_t>(packed >> 16);
+             out[1] = static_cast<uint8_t>(packed >> 8);
+             out[2] = static_cast<uint8_t>(packed);
+             out += 3;
+         }
+         bit_count_ += i * 6;
+         
+         // Only the last block can end with a partial group
+         for (; i < block; ++i) {
+             for (int bit = 5; bit >= 0; --bit) {
+                 if (values[i] & (1 << bit)) {
+                     data_[bit_count_ / 8] |= static_cast<uint8_t>(1 << (7 - bit_count_ % 8));
+                 }
+                 ++bit_count_;
+             }
          }
      }
  }
@@ -43,6 +73,10 @@
      return bit_count_;
  }
  
+ const uint8_t* BitVector::data() const {
+     return data_.data();
+ }
+ 
  size_t BitVector::capacity() const {
      return data_.size() * 8;
  }
@@ -63,6 +97,21 @@
      bit_count_ = 0;
  }
  
+ void BitVector::truncate(size_t bit_count) {
+     if (bit_count >= bit_count_) {
+         return;
+     }
+     
+     data_.resize((bit_count + 7) / 8);
+     
+     // Zero the dropped bits of the last byte so that later appends start clean
+     if (bit_count % 8 != 0) {
+         data_.back() &= static_cast<uint8_t>(0xFF << (8 - bit_count % 8));
+     }
+     
+     bit_count_ = bit_count;
+ }
+ 
  bool BitVector::get_bit(size_t index) const {
      if (index >= bit_count_) {
          throw std::out_of_range("Bit index out of range");
@@ -115,12 +164,18 @@
          throw std::out_of_range("Bit range out of bounds");
      }
      
+     // Take up to a byte at a time instead of single bits
      uint64_t result = 0;
-     for (size_t i = 0; i < bit_count; ++i) {
-         result <<= 1;
-         if (get_bit(start_index + i)) {
-             result |= 1;
-         }
+     size_t bit = start_index;
+     size_t remaining = bit_count;
+     while (remaining > 0) {
+         size_t offset = bit % 8;
+         size_t take = std::min<size_t>(8 - offset, remaining);
+         uint8_t chunk = static_cast<uint8_t>(data_[bit / 8] >> (8 - offset - take)) &
+                         static_cast<uint8_t>((1u << take) - 1);
+         result = (result << take) | chunk;
+         bit += take;
+         remaining -= take;
      }
      
      return result;
@@ -133,8 +188,10 @@
      
      uint64_t value = get_uint(start_index, bit_count);
      
-     // Check if the value is negative (most significant bit is set)
-     bool is_negative = (bit_count > 0 && (value & (static_cast<uint64_t>(1) << (bit_count - 1))));
+     // Check if the value is negative (most significant bit is set); a full
+     // 64-bit read is already sign-extended, and shifting by 64 is undefined
+     bool is_negative = (bit_count > 0 && bit_count < 64 &&
+                         (value & (static_cast<uint64_t>(1) << (bit_count - 1))));
      
      if (is_negative) {
          // Apply sign extension
@@ -167,6 +224,12 @@
  }
  
  std::string BitVector::get_string(size_t start_index, size_t bit_count) const {
+    std::string result(bit_count / 6, '\0');
+    result.resize(decode_string(start_index, bit_count, &result[0]));
+    return result;
+}
+
+size_t BitVector::decode_string(size_t start_index, size_t bit_count, char* out) const {
     if (bit_count % 6 != 0) {
         throw std::invalid_argument("String bit count must be multiple of 6");
     }
@@ -175,27 +238,33 @@
         throw std::out_of_range("Bit range out of bounds");
     }
     
-    std::string result;
-    size_t char_count = bit_count / 6;
+    // AIS 6-bit ASCII, indexed by value
+    static const char kSixBitAscii[65] =
+        "@ABCDEFGHIJKLMNOPQRSTUVWXYZ[\\]^_ !\"#$%&'()*+,-./0123456789:;<=>?";
     
-    // Process all characters
-    for (size_t i = 0; i < char_count; ++i) {
-        uint8_t value = static_cast<uint8_t>(get_uint(start_index + i * 6, 6));
-        
-        char c = decode_ascii(value);
-        if (c != '@' && c != ' ') { // Skip null/@ and trailing spaces
-            result += c;
-        } else if (!result.empty() || c == ' ') {
-            // Only add spaces if they're not trailing or if we've already added other characters
-            result += c;
+    size_t char_count = bit_count / 6;
+    size_t bit = start_index;
+    for (size_t i = 0; i < char_count; ++i, bit += 6) {
+        // A character spans at most two bytes
+        size_t byte = bit / 8;
+        uint32_t window = static_cast<uint32_t>(data_[byte]) << 8;
+        if (byte + 1 < data_.size()) {
+            window |= data_[byte + 1];
         }
+        out[i] = kSixBitAscii[(window >> (10 - bit % 8)) & 0x3F];
     }
     
-    return result;
+    // '@' pads unused characters and spaces are trailing filler
+    size_t length = char_count;
+    while (length > 0 && (out[length - 1] == '@' || out[length - 1] == ' ')) {
+        --length;
+    }
+    
+    return length;
 }
  
 // Modification for BitVector::append_string method in bit_vector.cpp
-void BitVector::append_string(const std::string& value, size_t bit_count) {
+void BitVector::append_string(std::string_view value, size_t bit_count) {
     if (bit_count % 6 != 0) {
         throw std::invalid_argument("String bit count must be multiple of 6");
     }
@@ -204,11 +273,6 @@ void BitVector::append_string(const std::string& value, size_t bit_count) {
     if (value.length() > max_chars) {
         throw std::invalid_argument("String too long for specified bit count");
     }
-
-    std::string actual_value = value;
-    if (value.length() > max_chars) {
-        actual_value = value.substr(0, max_chars);
-    }
     
     // Ensure we have enough capacity
     reserve(bit_count_ + bit_count);
@@ -217,8 +281,8 @@ void BitVector::append_string(const std::string& value, size_t bit_count) {
     for (size_t i = 0; i < max_chars; ++i) {
         uint8_t char_value;
         
-        if (i < actual_value.length()) {
-            char_value = encode_ascii(actual_value[i]);
+        if (i < value.length()) {
+            char_value = encode_ascii(value[i]);
         } else {
             // Pad with space (32 in 6-bit ASCII)
             char_value = 32;  // Space in AIS ASCII is 32, not 0
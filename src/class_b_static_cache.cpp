@@ -0,0 +1,197 @@
+/**
+ * @file class_b_static_cache.cpp
+ * @brief Implementation of ClassBStaticCache class
+ */
+
+ #include "aislib/class_b_static_cache.h"
+ #include <stdexcept>
+
+ namespace aislib {
+
+ ClassBStaticCache::ClassBStaticCache(const Config& config)
+     : config_(config),
+       newest_(NONE),
+       oldest_(NONE) {
+     if (config_.max_vessels == 0) {
+         throw std::invalid_argument("Class B static cache needs room for at least one vessel");
+     }
+     index_.reserve(config_.max_vessels);
+ }
+
+ const ClassBStaticRecord& ClassBStaticCache::update(const StaticDataReport& report, Clock::time_point now) {
+     expire(now);
+
+     uint32_t mmsi = report.get_mmsi();
+     uint32_t slot;
+     auto it = index_.find(mmsi);
+     if (it != index_.end()) {
+         slot = it->second;
+         unlink(slot);
+     } else {
+         if (index_.size() >= config_.max_vessels) {
+             remove(oldest_);
+             ++stats_.evictions;
+         }
+
+         if (!free_slots_.empty()) {
+             slot = free_slots_.back();
+             free_slots_.pop_back();
+         } else {
+             slot = static_cast<uint32_t>(slots_.size());
+             slots_.emplace_back();
+         }
+
+         slots_[slot].record = ClassBStaticRecord();
+         slots_[slot].record.mmsi = mmsi;
+         index_.emplace(mmsi, slot);
+     }
+
+     Slot& entry = slots_[slot];
+     ClassBStaticRecord& record = entry.record;
+     if (report.get_part() == StaticDataReport::Part::A) {
+         record.vessel_name.assign(report.get_vessel_name());
+         record.has_part_a = true;
+         record.part_a_time = now;
+     } else {
+         record.ship_type = report.get_ship_type();
+         record.vendor_id.assign(report.get_vendor_id());
+         record.unit_model = report.get_unit_model();
+         record.serial_number = report.get_serial_number();
+         record.call_sign.assign(report.get_call_sign());
+         record.dimension_to_bow = report.get_dimension_to_bow();
+         record.dimension_to_stern = report.get_dimension_to_stern();
+         record.dimension_to_port = report.get_dimension_to_port();
+         record.dimension_to_starboard = report.get_dimension_to_starboard();
+         record.mothership_mmsi = report.get_mothership_mmsi();
+         record.has_part_b = true;
+         record.part_b_time = now;
+     }
+
+     entry.last_update = now;
+     push_newest(slot);
+     ++stats_.updates;
+
+     return record;
+ }
+
+ const ClassBStaticRecord* ClassBStaticCache::find(uint32_t mmsi, Clock::time_point now) const {
+     auto it = index_.find(mmsi);
+     if (it == index_.end()) {
+         return nullptr;
+     }
+
+     const Slot& entry = slots_[it->second];
+     if (now - entry.last_update > config_.max_age) {
+         return nullptr;
+     }
+     return &entry.record;
+ }
+
+ size_t ClassBStaticCache::expire(Clock::time_point now) {
+     // The list is in update order, so the expired records are all at the old end
+     size_t dropped = 0;
+     while (oldest_ != NONE && now - slots_[oldest_].last_update > config_.max_age) {
+         remove(oldest_);
+         ++dropped;
+     }
+     stats_.expirations += dropped;
+     return dropped;
+ }
+
+ void ClassBStaticCache::clear() {
+     slots_.clear();
+     free_slots_.clear();
+     index_.clear();
+     newest_ = NONE;
+     oldest_ = NONE;
+ }
+
+ size_t ClassBStaticCache::records(std::vector<ClassBStaticRecord>& records) const {
+     records.clear();
+     records.reserve(index_.size());
+     for (uint32_t slot = oldest_; slot != NONE; slot = slots_[slot].newer) {
+         records.push_back(slots_[slot].record);
+     }
+     return records.size();
+ }
+
+ const ClassBStaticRecord& ClassBStaticCache::restore(const ClassBStaticRecord& record) {
+     uint32_t slot;
+     auto it = index_.find(record.mmsi);
+     if (it != index_.end()) {
+         slot = it->second;
+         unlink(slot);
+     } else {
+         if (index_.size() >= config_.max_vessels) {
+             remove(oldest_);
+             ++stats_.evictions;
+         }
+         if (!free_slots_.empty()) {
+             slot = free_slots_.back();
+             free_slots_.pop_back();
+         } else {
+             slot = static_cast<uint32_t>(slots_.size());
+             slots_.emplace_back();
+         }
+         index_.emplace(record.mmsi, slot);
+     }
+
+     Slot& entry = slots_[slot];
+     entry.record = record;
+     entry.last_update = record.has_part_a ? record.part_a_time : record.part_b_time;
+     if (record.has_part_a && record.has_part_b && record.part_b_time > entry.last_update) {
+         entry.last_update = record.part_b_time;
+     }
+     push_newest(slot);
+     return entry.record;
+ }
+
+ size_t ClassBStaticCache::size() const {
+     return index_.size();
+ }
+
+ ClassBStaticCache::Stats ClassBStaticCache::get_stats() const {
+     Stats stats = stats_;
+     stats.entries = index_.size();
+     stats.complete = 0;
+     for (const auto& entry : index_) {
+         if (slots_[entry.second].record.is_complete()) {
+             ++stats.complete;
+         }
+     }
+     return stats;
+ }
+
+ void ClassBStaticCache::unlink(uint32_t slot) {
+     Slot& entry = slots_[slot];
+     if (entry.newer != NONE) {
+         slots_[entry.newer].older = entry.older;
+     } else {
+         newest_ = entry.older;
+     }
+     if (entry.older != NONE) {
+         slots_[entry.older].newer = entry.newer;
+     } else {
+         oldest_ = entry.newer;
+     }
+ }
+
+ void ClassBStaticCache::push_newest(uint32_t slot) {
+     Slot& entry = slots_[slot];
+     entry.newer = NONE;
+     entry.older = newest_;
+     if (newest_ != NONE) {
+         slots_[newest_].newer = slot;
+     } else {
+         oldest_ = slot;
+     }
+     newest_ = slot;
+ }
+
+ void ClassBStaticCache::remove(uint32_t slot) {
+     unlink(slot);
+     index_.erase(slots_[slot].record.mmsi);
+     free_slots_.push_back(slot);
+ }
+
+ } // namespace aislib
@@ -0,0 +1,135 @@
+/**
+ * @file communication_state.cpp
+ * @brief Implementation of CommunicationState
+ */
+
+ #include "aislib/communication_state.h"
+ #include "aislib/base_station_report.h"
+ #include "aislib/position_report_class_a.h"
+ #include "aislib/position_report_class_b.h"
+ #include <sstream>
+
+ namespace aislib {
+
+ CommunicationState CommunicationState::sotdma(uint32_t radio_status) {
+     CommunicationState state;
+     state.access = Access::SOTDMA;
+     state.sync_state = static_cast<SyncState>((radio_status >> 17) & 0x3);
+     state.slot_timeout = static_cast<uint8_t>((radio_status >> 14) & 0x7);
+     state.sub_message = static_cast<uint16_t>(radio_status & 0x3FFF);
+     return state;
+ }
+
+ CommunicationState CommunicationState::itdma(uint32_t radio_status) {
+     CommunicationState state;
+     state.access = Access::ITDMA;
+     state.sync_state = static_cast<SyncState>((radio_status >> 17) & 0x3);
+     state.slot_increment = static_cast<uint16_t>((radio_status >> 4) & 0x1FFF);
+     state.number_of_slots = static_cast<uint8_t>((radio_status >> 1) & 0x7);
+     state.keep_flag = (radio_status & 0x1) != 0;
+     return state;
+ }
+
+ bool CommunicationState::from_message(const AISMessage& message, CommunicationState& state) {
+     if (auto* class_a = dynamic_cast<const PositionReportClassA*>(&message)) {
+         state = class_a->get_communication_state();
+         return true;
+     }
+     if (auto* base_station = dynamic_cast<const BaseStationReport*>(&message)) {
+         state = base_station->get_communication_state();
+         return true;
+     }
+     // Type 19 derives from type 18 but carries no communication state
+     if (message.get_message_type() == 18) {
+         if (auto* class_b = dynamic_cast<const StandardPositionReportClassB*>(&message)) {
+             state = class_b->get_communication_state();
+             return true;
+         }
+     }
+     return false;
+ }
+
+ uint32_t CommunicationState::encode() const {
+     uint32_t value = static_cast<uint32_t>(sync_state) << 17;
+     if (access == Access::SOTDMA) {
+         value |= static_cast<uint32_t>(slot_timeout & 0x7) << 14;
+         value |= sub_message & 0x3FFF;
+     } else if (access == Access::ITDMA) {
+         value |= static_cast<uint32_t>(slot_increment & 0x1FFF) << 4;
+         value |= static_cast<uint32_t>(number_of_slots & 0x7) << 1;
+         value |= keep_flag ? 1 : 0;
+     } else {
+         return 0;
+     }
+     return value;
+ }
+
+ CommunicationState::SubMessage CommunicationState::get_sub_message_type() const {
+     if (access != Access::SOTDMA) {
+         return SubMessage::NONE;
+     }
+     switch (slot_timeout & 0x7) {
+         case 0:
+             return SubMessage::SLOT_OFFSET;
+         case 1:
+             return SubMessage::UTC_HOUR_MINUTE;
+         case 2:
+         case 4:
+         case 6:
+             return SubMessage::SLOT_NUMBER;
+         default:
+             return SubMessage::RECEIVED_STATIONS;
+     }
+ }
+
+ int CommunicationState::get_received_stations() const {
+     return get_sub_message_type() == SubMessage::RECEIVED_STATIONS ? sub_message : -1;
+ }
+
+ int CommunicationState::get_slot_number() const {
+     return get_sub_message_type() == SubMessage::SLOT_NUMBER ? sub_message : -1;
+ }
+
+ std::string CommunicationState::to_string() const {
+     std::stringstream ss;
+
+     switch (access) {
+         case Access::NONE:
+             return "No TDMA state";
+         case Access::SOTDMA:
+             ss << "SOTDMA";
+             break;
+         case Access::ITDMA:
+             ss << "ITDMA";
+             break;
+     }
+
+     ss << ", sync state " << static_cast<int>(sync_state);
+     if (access == Access::ITDMA) {
+         ss << ", slot increment " << slot_increment
+            << ", slots " << static_cast<int>(number_of_slots)
+            << (keep_flag ? ", keep" : "");
+         return ss.str();
+     }
+
+     ss << ", slot timeout " << static_cast<int>(slot_timeout);
+     switch (get_sub_message_type()) {
+         case SubMessage::SLOT_OFFSET:
+             ss << ", slot offset " << sub_message;
+             break;
+         case SubMessage::UTC_HOUR_MINUTE:
+             ss << ", UTC " << (sub_message >> 9) << ":" << ((sub_message >> 2) & 0x7F);
+             break;
+         case SubMessage::SLOT_NUMBER:
+             ss << ", slot " << sub_message;
+             break;
+         case SubMessage::RECEIVED_STATIONS:
+             ss << ", received stations " << sub_message;
+             break;
+         case SubMessage::NONE:
+             break;
+     }
+     return ss.str();
+ }
+
+ } // namespace aislib
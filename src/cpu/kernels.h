@@ -0,0 +1,79 @@
+/**
+ * @file kernels.h
+ * @brief Internal declarations of the per-level kernel tables
+ */
+
+ #ifndef AISLIB_CPU_KERNELS_H
+ #define AISLIB_CPU_KERNELS_H
+
+ #include "aislib/cpu_dispatch.h"
+ #include "aislib/geo.h"
+
+ namespace aislib {
+ namespace cpu {
+ namespace impl {
+
+ // Portable reference implementations
+ extern const Kernels scalar;
+
+ #if defined(__x86_64__) || defined(__i386__)
+ #if defined(__GNUC__)
+ #define AISLIB_CPU_HAVE_X86_KERNELS 1
+ extern const Kernels sse42;
+ extern const Kernels avx2;
+ extern const Kernels avx512;
+ #endif
+ #endif
+
+ #if defined(__aarch64__) || (defined(__ARM_NEON) && defined(__arm__))
+ #define AISLIB_CPU_HAVE_NEON_KERNELS 1
+ extern const Kernels neon;
+ #endif
+
+ // Tail helpers shared by the vector kernels
+ uint8_t xor_bytes_scalar(const char* data, size_t length);
+ bool dearmor_scalar(const char* payload, size_t length, uint8_t* values);
+ size_t find_all_scalar(const char* data, size_t length, char delimiter, uint32_t* positions, size_t max_positions);
+ void haversine_scalar(const double* lat1, const double* lon1, const double* lat2, const double* lon2,
+                       size_t count, double* meters);
+
+ // Constants of the haversine kernels. Every level evaluates the same
+ // polynomials in the same order, so all levels return the same distances.
+ namespace haversine {
+
+ const double RADIANS = 3.14159265358979323846 / 180.0;
+ const double HALF_RADIANS = RADIANS / 2.0;
+ const double HALF_PI = 3.14159265358979323846 / 2.0;
+ const double DIAMETER = 2.0 * geo::EARTH_RADIUS;
+
+ // sin(x) = x * SIN(x^2) and cos(x) = COS(x^2) for |x| <= pi/2 (Taylor series)
+ const int SIN_TERMS = 9;
+ const double SIN[SIN_TERMS] = {
+     1.0, -0.16666666666666666, 0.008333333333333333, -0.0001984126984126984,
+     2.7557319223985893e-06, -2.505210838544172e-08, 1.6059043836821613e-10,
+     -7.647163731819816e-13, 2.8114572543455206e-15
+ };
+ const int COS_TERMS = 10;
+ const double COS[COS_TERMS] = {
+     1.0, -0.5, 0.041666666666666664, -0.001388888888888889, 2.48015873015873e-05,
+     -2.755731922398589e-07, 2.08767569878681e-09, -1.1470745597729725e-11,
+     4.779477332387385e-14, -1.5619206968586225e-16
+ };
+
+ // asin(s) = s + s * z * ASIN(z) with z = s^2 <= 1/4 (Taylor series); larger
+ // arguments use asin(x) = pi/2 - 2 asin(sqrt((1 - x) / 2))
+ const int ASIN_TERMS = 16;
+ const double ASIN[ASIN_TERMS] = {
+     0.16666666666666666, 0.075, 0.044642857142857144, 0.030381944444444444,
+     0.022372159090909092, 0.017352764423076924, 0.01396484375, 0.011551800896139705,
+     0.009761609529194078, 0.008390335809616815, 0.0073125258735988454, 0.006447210311889649,
+     0.005740037670841924, 0.005153309682319905, 0.004660143486915096, 0.004240907093679363
+ };
+
+ } // namespace haversine
+
+ } // namespace impl
+ } // namespace cpu
+ } // namespace aislib
+
+ #endif // AISLIB_CPU_KERNELS_H
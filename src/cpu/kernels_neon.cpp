@@ -0,0 +1,158 @@
+/**
+ * @file kernels_neon.cpp
+ * @brief ARM Advanced SIMD kernels
+ */
+
+ #include "cpu/kernels.h"
+
+ #if defined(AISLIB_CPU_HAVE_NEON_KERNELS)
+
+ #include <arm_neon.h>
+
+ namespace aislib {
+ namespace cpu {
+ namespace impl {
+
+ namespace {
+
+ uint8_t xor_bytes_neon(const char* data, size_t length) {
+     uint8x16_t acc = vdupq_n_u8(0);
+     size_t i = 0;
+     for (; i + 16 <= length; i += 16) {
+         acc = veorq_u8(acc, vld1q_u8(reinterpret_cast<const uint8_t*>(data + i)));
+     }
+     uint8_t lanes[16];
+     vst1q_u8(lanes, acc);
+     uint8_t checksum = 0;
+     for (uint8_t lane : lanes) {
+         checksum ^= lane;
+     }
+     return static_cast<uint8_t>(checksum ^ xor_bytes_scalar(data + i, length - i));
+ }
+
+ bool dearmor_neon(const char* payload, size_t length, uint8_t* values) {
+     const uint8x16_t low_base = vdupq_n_u8('0');
+     const uint8x16_t high_base = vdupq_n_u8('`');
+     const uint8x16_t low_max = vdupq_n_u8('W' - '0');
+     const uint8x16_t high_max = vdupq_n_u8('w' - '`');
+     const uint8x16_t high_offset = vdupq_n_u8(40);
+
+     size_t i = 0;
+     for (; i + 16 <= length; i += 16) {
+         uint8x16_t c = vld1q_u8(reinterpret_cast<const uint8_t*>(payload + i));
+         uint8x16_t low = vsubq_u8(c, low_base);
+         uint8x16_t high = vsubq_u8(c, high_base);
+         uint8x16_t in_low = vcleq_u8(low, low_max);
+         uint8x16_t in_high = vcleq_u8(high, high_max);
+         uint8x16_t valid = vorrq_u8(in_low, in_high);
+ #if defined(__aarch64__)
+         if (vminvq_u8(valid) == 0) {
+             return false;
+         }
+ #else
+         uint8x8_t folded = vpmin_u8(vget_low_u8(valid), vget_high_u8(valid));
+         folded = vpmin_u8(folded, folded);
+         folded = vpmin_u8(folded, folded);
+         folded = vpmin_u8(folded, folded);
+         if (vget_lane_u8(folded, 0) == 0) {
+             return false;
+         }
+ #endif
+         uint8x16_t value = vbslq_u8(in_low, low, vaddq_u8(high, high_offset));
+         vst1q_u8(values + i, value);
+     }
+     return dearmor_scalar(payload + i, length - i, values + i);
+ }
+
+ size_t find_all_neon(const char* data, size_t length, char delimiter, uint32_t* positions, size_t max_positions) {
+     const uint8x16_t needle = vdupq_n_u8(static_cast<uint8_t>(delimiter));
+     size_t count = 0;
+     size_t i = 0;
+     for (; i + 16 <= length && count < max_positions; i += 16) {
+         uint8x16_t eq = vceqq_u8(vld1q_u8(reinterpret_cast<const uint8_t*>(data + i)), needle);
+         // Narrow to one nibble per byte to get a 64-bit mask
+         uint64_t mask = vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(eq), 4)), 0);
+         while (mask != 0 && count < max_positions) {
+             unsigned bit = static_cast<unsigned>(__builtin_ctzll(mask));
+             positions[count++] = static_cast<uint32_t>(i + bit / 4);
+             mask &= ~(0xFULL << (bit & ~3U));
+         }
+     }
+     for (; i < length && count < max_positions; ++i) {
+         if (data[i] == delimiter) {
+             positions[count++] = static_cast<uint32_t>(i);
+         }
+     }
+     return count;
+ }
+
+
+ #if defined(__aarch64__)
+
+ // Follows haversine_scalar() operation for operation
+ inline float64x2_t horner_neon(const double* coefficients, int count, float64x2_t z) {
+     float64x2_t p = vdupq_n_f64(coefficients[count - 1]);
+     for (int k = count - 2; k >= 0; --k) {
+         p = vaddq_f64(vmulq_f64(p, z), vdupq_n_f64(coefficients[k]));
+     }
+     return p;
+ }
+
+ void haversine_neon(const double* lat1, const double* lon1, const double* lat2, const double* lon2,
+                     size_t count, double* meters) {
+     using namespace haversine;
+     const float64x2_t half_radians = vdupq_n_f64(HALF_RADIANS);
+     const float64x2_t radians = vdupq_n_f64(RADIANS);
+     const float64x2_t zero = vdupq_n_f64(0.0);
+     const float64x2_t full_turn = vdupq_n_f64(360.0);
+     const float64x2_t one = vdupq_n_f64(1.0);
+     const float64x2_t half = vdupq_n_f64(0.5);
+
+     size_t i = 0;
+     for (; i + 2 <= count; i += 2) {
+         float64x2_t a_lat = vld1q_f64(lat1 + i);
+         float64x2_t b_lat = vld1q_f64(lat2 + i);
+         float64x2_t half_lat = vmulq_f64(vsubq_f64(b_lat, a_lat), half_radians);
+         float64x2_t dlon = vsubq_f64(vld1q_f64(lon2 + i), vld1q_f64(lon1 + i));
+         dlon = vsubq_f64(dlon, vbslq_f64(vcgtq_f64(dlon, vdupq_n_f64(180.0)), full_turn, zero));
+         dlon = vaddq_f64(dlon, vbslq_f64(vcltq_f64(dlon, vdupq_n_f64(-180.0)), full_turn, zero));
+         float64x2_t half_lon = vmulq_f64(dlon, half_radians);
+
+         float64x2_t sin_lat = vmulq_f64(half_lat, horner_neon(SIN, SIN_TERMS, vmulq_f64(half_lat, half_lat)));
+         float64x2_t sin_lon = vmulq_f64(half_lon, horner_neon(SIN, SIN_TERMS, vmulq_f64(half_lon, half_lon)));
+         float64x2_t r1 = vmulq_f64(a_lat, radians);
+         float64x2_t r2 = vmulq_f64(b_lat, radians);
+         float64x2_t cos_product = vmulq_f64(horner_neon(COS, COS_TERMS, vmulq_f64(r1, r1)),
+                                             horner_neon(COS, COS_TERMS, vmulq_f64(r2, r2)));
+
+         float64x2_t h = vaddq_f64(vmulq_f64(sin_lat, sin_lat), vmulq_f64(cos_product, vmulq_f64(sin_lon, sin_lon)));
+         float64x2_t x = vsqrtq_f64(vminq_f64(vmaxq_f64(h, zero), one));
+         uint64x2_t large = vcgtq_f64(x, half);
+         float64x2_t z = vbslq_f64(large, vmulq_f64(vsubq_f64(one, x), half), vmulq_f64(x, x));
+         float64x2_t sq = vbslq_f64(large, vsqrtq_f64(z), x);
+         float64x2_t r = vaddq_f64(sq, vmulq_f64(vmulq_f64(sq, z), horner_neon(ASIN, ASIN_TERMS, z)));
+         float64x2_t angle = vbslq_f64(large, vsubq_f64(vdupq_n_f64(HALF_PI), vaddq_f64(r, r)), r);
+         vst1q_f64(meters + i, vmulq_f64(angle, vdupq_n_f64(DIAMETER)));
+     }
+     haversine_scalar(lat1 + i, lon1 + i, lat2 + i, lon2 + i, count - i, meters + i);
+ }
+
+ #else
+
+ // 32-bit ARM has no double-precision vectors
+ void haversine_neon(const double* lat1, const double* lon1, const double* lat2, const double* lon2,
+                     size_t count, double* meters) {
+     haversine_scalar(lat1, lon1, lat2, lon2, count, meters);
+ }
+
+ #endif
+
+ } // anonymous namespace
+
+ const Kernels neon = {Level::NEON, xor_bytes_neon, dearmor_neon, find_all_neon, haversine_neon};
+
+ } // namespace impl
+ } // namespace cpu
+ } // namespace aislib
+
+ #endif // AISLIB_CPU_HAVE_NEON_KERNELS
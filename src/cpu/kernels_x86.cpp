@@ -0,0 +1,392 @@
+/**
+ * @file kernels_x86.cpp
+ * @brief SSE4.2, AVX2 and AVX-512 kernels
+ *
+ * Each function is compiled for its own target so the file builds without
+ * -m flags; the dispatcher only binds a table the CPU supports.
+ */
+
+ #include "cpu/kernels.h"
+
+ #if defined(AISLIB_CPU_HAVE_X86_KERNELS)
+
+ #include <immintrin.h>
+
+ namespace aislib {
+ namespace cpu {
+ namespace impl {
+
+ namespace {
+
+ // Scalar handling of the bytes after the last full vector
+ inline size_t find_all_tail(const char* data, size_t begin, size_t length, char delimiter,
+                             uint32_t* positions, size_t count, size_t max_positions) {
+     for (size_t i = begin; i < length && count < max_positions; ++i) {
+         if (data[i] == delimiter) {
+             positions[count++] = static_cast<uint32_t>(i);
+         }
+     }
+     return count;
+ }
+
+ // Store the set bits of a comparison mask as offsets from base
+ inline size_t store_mask(uint64_t mask, size_t base, uint32_t* positions, size_t count, size_t max_positions) {
+     while (mask != 0 && count < max_positions) {
+         positions[count++] = static_cast<uint32_t>(base + static_cast<size_t>(__builtin_ctzll(mask)));
+         mask &= mask - 1;
+     }
+     return count;
+ }
+
+ // ---- SSE4.2 ----
+
+ __attribute__((target("sse4.2")))
+ uint8_t xor_bytes_sse42(const char* data, size_t length) {
+     __m128i acc = _mm_setzero_si128();
+     size_t i = 0;
+     for (; i + 16 <= length; i += 16) {
+         acc = _mm_xor_si128(acc, _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i)));
+     }
+     acc = _mm_xor_si128(acc, _mm_srli_si128(acc, 8));
+     acc = _mm_xor_si128(acc, _mm_srli_si128(acc, 4));
+     acc = _mm_xor_si128(acc, _mm_srli_si128(acc, 2));
+     acc = _mm_xor_si128(acc, _mm_srli_si128(acc, 1));
+     uint8_t checksum = static_cast<uint8_t>(_mm_cvtsi128_si32(acc));
+     return static_cast<uint8_t>(checksum ^ xor_bytes_scalar(data + i, length - i));
+ }
+
+ __attribute__((target("sse4.2")))
+ bool dearmor_sse42(const char* payload, size_t length, uint8_t* values) {
+     const __m128i low_base = _mm_set1_epi8('0');
+     const __m128i high_base = _mm_set1_epi8('`');
+     const __m128i low_max = _mm_set1_epi8('W' - '0');
+     const __m128i high_max = _mm_set1_epi8('w' - '`');
+     const __m128i high_offset = _mm_set1_epi8(40);
+
+     size_t i = 0;
+     for (; i + 16 <= length; i += 16) {
+         __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(payload + i));
+         // Unsigned range checks: x - base <= max
+         __m128i low = _mm_sub_epi8(c, low_base);
+         __m128i high = _mm_sub_epi8(c, high_base);
+         __m128i in_low = _mm_cmpeq_epi8(_mm_min_epu8(low, low_max), low);
+         __m128i in_high = _mm_cmpeq_epi8(_mm_min_epu8(high, high_max), high);
+         if (_mm_movemask_epi8(_mm_or_si128(in_low, in_high)) != 0xFFFF) {
+             return false;
+         }
+         __m128i value = _mm_blendv_epi8(_mm_add_epi8(high, high_offset), low, in_low);
+         _mm_storeu_si128(reinterpret_cast<__m128i*>(values + i), value);
+     }
+     return dearmor_scalar(payload + i, length - i, values + i);
+ }
+
+ __attribute__((target("sse4.2")))
+ size_t find_all_sse42(const char* data, size_t length, char delimiter, uint32_t* positions, size_t max_positions) {
+     const __m128i needle = _mm_set1_epi8(delimiter);
+     size_t count = 0;
+     size_t i = 0;
+     for (; i + 16 <= length && count < max_positions; i += 16) {
+         __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+         uint64_t mask = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(c, needle)));
+         count = store_mask(mask, i, positions, count, max_positions);
+     }
+     return find_all_tail(data, i, length, delimiter, positions, count, max_positions);
+ }
+
+ // The haversine kernels follow haversine_scalar() operation for operation
+
+ __attribute__((target("sse4.2")))
+ inline __m128d horner_sse42(const double* coefficients, int count, __m128d z) {
+     __m128d p = _mm_set1_pd(coefficients[count - 1]);
+     for (int k = count - 2; k >= 0; --k) {
+         p = _mm_add_pd(_mm_mul_pd(p, z), _mm_set1_pd(coefficients[k]));
+     }
+     return p;
+ }
+
+ __attribute__((target("sse4.2")))
+ void haversine_sse42(const double* lat1, const double* lon1, const double* lat2, const double* lon2,
+                      size_t count, double* meters) {
+     using namespace haversine;
+     const __m128d half_radians = _mm_set1_pd(HALF_RADIANS);
+     const __m128d radians = _mm_set1_pd(RADIANS);
+     const __m128d full_turn = _mm_set1_pd(360.0);
+     const __m128d half_turn = _mm_set1_pd(180.0);
+     const __m128d minus_half_turn = _mm_set1_pd(-180.0);
+     const __m128d zero = _mm_setzero_pd();
+     const __m128d one = _mm_set1_pd(1.0);
+     const __m128d half = _mm_set1_pd(0.5);
+
+     size_t i = 0;
+     for (; i + 2 <= count; i += 2) {
+         __m128d a_lat = _mm_loadu_pd(lat1 + i);
+         __m128d b_lat = _mm_loadu_pd(lat2 + i);
+         __m128d half_lat = _mm_mul_pd(_mm_sub_pd(b_lat, a_lat), half_radians);
+         __m128d dlon = _mm_sub_pd(_mm_loadu_pd(lon2 + i), _mm_loadu_pd(lon1 + i));
+         dlon = _mm_sub_pd(dlon, _mm_and_pd(_mm_cmpgt_pd(dlon, half_turn), full_turn));
+         dlon = _mm_add_pd(dlon, _mm_and_pd(_mm_cmplt_pd(dlon, minus_half_turn), full_turn));
+         __m128d half_lon = _mm_mul_pd(dlon, half_radians);
+
+         __m128d sin_lat = _mm_mul_pd(half_lat, horner_sse42(SIN, SIN_TERMS, _mm_mul_pd(half_lat, half_lat)));
+         __m128d sin_lon = _mm_mul_pd(half_lon, horner_sse42(SIN, SIN_TERMS, _mm_mul_pd(half_lon, half_lon)));
+         __m128d r1 = _mm_mul_pd(a_lat, radians);
+         __m128d r2 = _mm_mul_pd(b_lat, radians);
+         __m128d cos_product = _mm_mul_pd(horner_sse42(COS, COS_TERMS, _mm_mul_pd(r1, r1)),
+                                          horner_sse42(COS, COS_TERMS, _mm_mul_pd(r2, r2)));
+
+         __m128d h = _mm_add_pd(_mm_mul_pd(sin_lat, sin_lat), _mm_mul_pd(cos_product, _mm_mul_pd(sin_lon, sin_lon)));
+         __m128d x = _mm_sqrt_pd(_mm_min_pd(_mm_max_pd(h, zero), one));
+         __m128d large = _mm_cmpgt_pd(x, half);
+         __m128d z = _mm_blendv_pd(_mm_mul_pd(x, x), _mm_mul_pd(_mm_sub_pd(one, x), half), large);
+         __m128d sq = _mm_blendv_pd(x, _mm_sqrt_pd(z), large);
+         __m128d r = _mm_add_pd(sq, _mm_mul_pd(_mm_mul_pd(sq, z), horner_sse42(ASIN, ASIN_TERMS, z)));
+         __m128d angle = _mm_blendv_pd(r, _mm_sub_pd(_mm_set1_pd(HALF_PI), _mm_add_pd(r, r)), large);
+         _mm_storeu_pd(meters + i, _mm_mul_pd(angle, _mm_set1_pd(DIAMETER)));
+     }
+     haversine_scalar(lat1 + i, lon1 + i, lat2 + i, lon2 + i, count - i, meters + i);
+ }
+
+ // ---- AVX2 ----
+
+ __attribute__((target("avx2")))
+ uint8_t xor_bytes_avx2(const char* data, size_t length) {
+     __m256i acc = _mm256_setzero_si256();
+     size_t i = 0;
+     for (; i + 32 <= length; i += 32) {
+         acc = _mm256_xor_si256(acc, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i)));
+     }
+     __m128i folded = _mm_xor_si128(_mm256_castsi256_si128(acc), _mm256_extracti128_si256(acc, 1));
+     folded = _mm_xor_si128(folded, _mm_srli_si128(folded, 8));
+     folded = _mm_xor_si128(folded, _mm_srli_si128(folded, 4));
+     folded = _mm_xor_si128(folded, _mm_srli_si128(folded, 2));
+     folded = _mm_xor_si128(folded, _mm_srli_si128(folded, 1));
+     uint8_t checksum = static_cast<uint8_t>(_mm_cvtsi128_si32(folded));
+     return static_cast<uint8_t>(checksum ^ xor_bytes_scalar(data + i, length - i));
+ }
+
+ __attribute__((target("avx2")))
+ bool dearmor_avx2(const char* payload, size_t length, uint8_t* values) {
+     const __m256i low_base = _mm256_set1_epi8('0');
+     const __m256i high_base = _mm256_set1_epi8('`');
+     const __m256i low_max = _mm256_set1_epi8('W' - '0');
+     const __m256i high_max = _mm256_set1_epi8('w' - '`');
+     const __m256i high_offset = _mm256_set1_epi8(40);
+
+     size_t i = 0;
+     for (; i + 32 <= length; i += 32) {
+         __m256i c = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(payload + i));
+         __m256i low = _mm256_sub_epi8(c, low_base);
+         __m256i high = _mm256_sub_epi8(c, high_base);
+         __m256i in_low = _mm256_cmpeq_epi8(_mm256_min_epu8(low, low_max), low);
+         __m256i in_high = _mm256_cmpeq_epi8(_mm256_min_epu8(high, high_max), high);
+         if (_mm256_movemask_epi8(_mm256_or_si256(in_low, in_high)) != -1) {
+             return false;
+         }
+         __m256i value = _mm256_blendv_epi8(_mm256_add_epi8(high, high_offset), low, in_low);
+         _mm256_storeu_si256(reinterpret_cast<__m256i*>(values + i), value);
+     }
+     return dearmor_sse42(payload + i, length - i, values + i);
+ }
+
+ __attribute__((target("avx2")))
+ size_t find_all_avx2(const char* data, size_t length, char delimiter, uint32_t* positions, size_t max_positions) {
+     const __m256i needle = _mm256_set1_epi8(delimiter);
+     size_t count = 0;
+     size_t i = 0;
+     for (; i + 32 <= length && count < max_positions; i += 32) {
+         __m256i c = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+         uint64_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(c, needle)));
+         count = store_mask(mask, i, positions, count, max_positions);
+     }
+     return find_all_tail(data, i, length, delimiter, positions, count, max_positions);
+ }
+
+ __attribute__((target("avx2")))
+ inline __m256d horner_avx2(const double* coefficients, int count, __m256d z) {
+     __m256d p = _mm256_set1_pd(coefficients[count - 1]);
+     for (int k = count - 2; k >= 0; --k) {
+         p = _mm256_add_pd(_mm256_mul_pd(p, z), _mm256_set1_pd(coefficients[k]));
+     }
+     return p;
+ }
+
+ __attribute__((target("avx2")))
+ void haversine_avx2(const double* lat1, const double* lon1, const double* lat2, const double* lon2,
+                     size_t count, double* meters) {
+     using namespace haversine;
+     const __m256d half_radians = _mm256_set1_pd(HALF_RADIANS);
+     const __m256d radians = _mm256_set1_pd(RADIANS);
+     const __m256d full_turn = _mm256_set1_pd(360.0);
+     const __m256d half_turn = _mm256_set1_pd(180.0);
+     const __m256d minus_half_turn = _mm256_set1_pd(-180.0);
+     const __m256d zero = _mm256_setzero_pd();
+     const __m256d one = _mm256_set1_pd(1.0);
+     const __m256d half = _mm256_set1_pd(0.5);
+
+     size_t i = 0;
+     for (; i + 4 <= count; i += 4) {
+         __m256d a_lat = _mm256_loadu_pd(lat1 + i);
+         __m256d b_lat = _mm256_loadu_pd(lat2 + i);
+         __m256d half_lat = _mm256_mul_pd(_mm256_sub_pd(b_lat, a_lat), half_radians);
+         __m256d dlon = _mm256_sub_pd(_mm256_loadu_pd(lon2 + i), _mm256_loadu_pd(lon1 + i));
+         dlon = _mm256_sub_pd(dlon, _mm256_and_pd(_mm256_cmp_pd(dlon, half_turn, _CMP_GT_OQ), full_turn));
+         dlon = _mm256_add_pd(dlon, _mm256_and_pd(_mm256_cmp_pd(dlon, minus_half_turn, _CMP_LT_OQ), full_turn));
+         __m256d half_lon = _mm256_mul_pd(dlon, half_radians);
+
+         __m256d sin_lat = _mm256_mul_pd(half_lat, horner_avx2(SIN, SIN_TERMS, _mm256_mul_pd(half_lat, half_lat)));
+         __m256d sin_lon = _mm256_mul_pd(half_lon, horner_avx2(SIN, SIN_TERMS, _mm256_mul_pd(half_lon, half_lon)));
+         __m256d r1 = _mm256_mul_pd(a_lat, radians);
+         __m256d r2 = _mm256_mul_pd(b_lat, radians);
+         __m256d cos_product = _mm256_mul_pd(horner_avx2(COS, COS_TERMS, _mm256_mul_pd(r1, r1)),
+                                             horner_avx2(COS, COS_TERMS, _mm256_mul_pd(r2, r2)));
+
+         __m256d h = _mm256_add_pd(_mm256_mul_pd(sin_lat, sin_lat),
+                                   _mm256_mul_pd(cos_product, _mm256_mul_pd(sin_lon, sin_lon)));
+         __m256d x = _mm256_sqrt_pd(_mm256_min_pd(_mm256_max_pd(h, zero), one));
+         __m256d large = _mm256_cmp_pd(x, half, _CMP_GT_OQ);
+         __m256d z = _mm256_blendv_pd(_mm256_mul_pd(x, x), _mm256_mul_pd(_mm256_sub_pd(one, x), half), large);
+         __m256d sq = _mm256_blendv_pd(x, _mm256_sqrt_pd(z), large);
+         __m256d r = _mm256_add_pd(sq, _mm256_mul_pd(_mm256_mul_pd(sq, z), horner_avx2(ASIN, ASIN_TERMS, z)));
+         __m256d angle = _mm256_blendv_pd(r, _mm256_sub_pd(_mm256_set1_pd(HALF_PI), _mm256_add_pd(r, r)), large);
+         _mm256_storeu_pd(meters + i, _mm256_mul_pd(angle, _mm256_set1_pd(DIAMETER)));
+     }
+     haversine_scalar(lat1 + i, lon1 + i, lat2 + i, lon2 + i, count - i, meters + i);
+ }
+
+ // ---- AVX-512 ----
+
+ // GCC 12's avx512fintrin.h passes _mm512_undefined_*() as the unused source
+ // operand of many intrinsics, and -Wuninitialized reports it once they
+ // are inlined here. The register is never read.
+ #pragma GCC diagnostic push
+ #pragma GCC diagnostic ignored "-Wuninitialized"
+ #pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+ __attribute__((target("avx512f,avx512bw,bmi2")))
+ uint8_t xor_bytes_avx512(const char* data, size_t length) {
+     __m512i acc = _mm512_setzero_si512();
+     size_t i = 0;
+     for (; i + 64 <= length; i += 64) {
+         acc = _mm512_xor_si512(acc, _mm512_loadu_si512(data + i));
+     }
+     // The remainder is loaded with a mask, so no scalar tail is needed
+     if (i < length) {
+         __mmask64 rest = _bzhi_u64(~0ULL, static_cast<unsigned>(length - i));
+         acc = _mm512_xor_si512(acc, _mm512_maskz_loadu_epi8(rest, data + i));
+     }
+     __m256i half = _mm256_xor_si256(_mm512_castsi512_si256(acc), _mm512_extracti64x4_epi64(acc, 1));
+     __m128i folded = _mm_xor_si128(_mm256_castsi256_si128(half), _mm256_extracti128_si256(half, 1));
+     folded = _mm_xor_si128(folded, _mm_srli_si128(folded, 8));
+     folded = _mm_xor_si128(folded, _mm_srli_si128(folded, 4));
+     folded = _mm_xor_si128(folded, _mm_srli_si128(folded, 2));
+     folded = _mm_xor_si128(folded, _mm_srli_si128(folded, 1));
+     return static_cast<uint8_t>(_mm_cvtsi128_si32(folded));
+ }
+ #pragma GCC diagnostic pop
+
+ __attribute__((target("avx512f,avx512bw,bmi2")))
+ bool dearmor_avx512(const char* payload, size_t length, uint8_t* values) {
+     const __m512i low_base = _mm512_set1_epi8('0');
+     const __m512i high_base = _mm512_set1_epi8('`');
+     const __m512i low_max = _mm512_set1_epi8('W' - '0');
+     const __m512i high_max = _mm512_set1_epi8('w' - '`');
+     const __m512i high_offset = _mm512_set1_epi8(40);
+
+     for (size_t i = 0; i < length; i += 64) {
+         __mmask64 lanes = length - i >= 64 ? ~0ULL : _bzhi_u64(~0ULL, static_cast<unsigned>(length - i));
+         __m512i c = _mm512_maskz_loadu_epi8(lanes, payload + i);
+         __m512i low = _mm512_sub_epi8(c, low_base);
+         __m512i high = _mm512_sub_epi8(c, high_base);
+         __mmask64 in_low = _mm512_cmple_epu8_mask(low, low_max);
+         __mmask64 in_high = _mm512_cmple_epu8_mask(high, high_max);
+         if (((in_low | in_high) & lanes) != lanes) {
+             return false;
+         }
+         __m512i value = _mm512_mask_blend_epi8(in_low, _mm512_add_epi8(high, high_offset), low);
+         _mm512_mask_storeu_epi8(values + i, lanes, value);
+     }
+     return true;
+ }
+
+ __attribute__((target("avx512f,avx512bw,bmi2")))
+ size_t find_all_avx512(const char* data, size_t length, char delimiter, uint32_t* positions, size_t max_positions) {
+     const __m512i needle = _mm512_set1_epi8(delimiter);
+     size_t count = 0;
+     for (size_t i = 0; i < length && count < max_positions; i += 64) {
+         __mmask64 lanes = length - i >= 64 ? ~0ULL : _bzhi_u64(~0ULL, static_cast<unsigned>(length - i));
+         __m512i c = _mm512_maskz_loadu_epi8(lanes, data + i);
+         uint64_t mask = _mm512_mask_cmpeq_epi8_mask(lanes, c, needle);
+         count = store_mask(mask, i, positions, count, max_positions);
+     }
+     return count;
+ }
+
+
+ __attribute__((target("avx512f,avx512bw,bmi2")))
+ inline __m512d horner_avx512(const double* coefficients, int count, __m512d z) {
+     __m512d p = _mm512_set1_pd(coefficients[count - 1]);
+     for (int k = count - 2; k >= 0; --k) {
+         p = _mm512_add_pd(_mm512_mul_pd(p, z), _mm512_set1_pd(coefficients[k]));
+     }
+     return p;
+ }
+
+ // Same GCC 12 header issue as xor_bytes_avx512, from min, max and sqrt
+ #pragma GCC diagnostic push
+ #pragma GCC diagnostic ignored "-Wuninitialized"
+ #pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+ __attribute__((target("avx512f,avx512bw,bmi2")))
+ void haversine_avx512(const double* lat1, const double* lon1, const double* lat2, const double* lon2,
+                       size_t count, double* meters) {
+     using namespace haversine;
+     const __m512d half_radians = _mm512_set1_pd(HALF_RADIANS);
+     const __m512d radians = _mm512_set1_pd(RADIANS);
+     const __m512d full_turn = _mm512_set1_pd(360.0);
+     const __m512d half_turn = _mm512_set1_pd(180.0);
+     const __m512d minus_half_turn = _mm512_set1_pd(-180.0);
+     const __m512d zero = _mm512_setzero_pd();
+     const __m512d one = _mm512_set1_pd(1.0);
+     const __m512d half = _mm512_set1_pd(0.5);
+
+     size_t i = 0;
+     for (; i < count; i += 8) {
+         // The last iteration loads and stores only the remaining lanes
+         __mmask8 lanes = count - i >= 8 ? __mmask8(0xFF) : static_cast<__mmask8>(_bzhi_u32(0xFF, static_cast<unsigned>(count - i)));
+         __m512d a_lat = _mm512_maskz_loadu_pd(lanes, lat1 + i);
+         __m512d b_lat = _mm512_maskz_loadu_pd(lanes, lat2 + i);
+         __m512d half_lat = _mm512_mul_pd(_mm512_sub_pd(b_lat, a_lat), half_radians);
+         __m512d dlon = _mm512_sub_pd(_mm512_maskz_loadu_pd(lanes, lon2 + i), _mm512_maskz_loadu_pd(lanes, lon1 + i));
+         dlon = _mm512_mask_sub_pd(dlon, _mm512_cmp_pd_mask(dlon, half_turn, _CMP_GT_OQ), dlon, full_turn);
+         dlon = _mm512_mask_add_pd(dlon, _mm512_cmp_pd_mask(dlon, minus_half_turn, _CMP_LT_OQ), dlon, full_turn);
+         __m512d half_lon = _mm512_mul_pd(dlon, half_radians);
+
+         __m512d sin_lat = _mm512_mul_pd(half_lat, horner_avx512(SIN, SIN_TERMS, _mm512_mul_pd(half_lat, half_lat)));
+         __m512d sin_lon = _mm512_mul_pd(half_lon, horner_avx512(SIN, SIN_TERMS, _mm512_mul_pd(half_lon, half_lon)));
+         __m512d r1 = _mm512_mul_pd(a_lat, radians);
+         __m512d r2 = _mm512_mul_pd(b_lat, radians);
+         __m512d cos_product = _mm512_mul_pd(horner_avx512(COS, COS_TERMS, _mm512_mul_pd(r1, r1)),
+                                             horner_avx512(COS, COS_TERMS, _mm512_mul_pd(r2, r2)));
+
+         __m512d h = _mm512_add_pd(_mm512_mul_pd(sin_lat, sin_lat),
+                                   _mm512_mul_pd(cos_product, _mm512_mul_pd(sin_lon, sin_lon)));
+         __m512d x = _mm512_sqrt_pd(_mm512_min_pd(_mm512_max_pd(h, zero), one));
+         __mmask8 large = _mm512_cmp_pd_mask(x, half, _CMP_GT_OQ);
+         __m512d z = _mm512_mask_blend_pd(large, _mm512_mul_pd(x, x), _mm512_mul_pd(_mm512_sub_pd(one, x), half));
+         __m512d sq = _mm512_mask_blend_pd(large, x, _mm512_sqrt_pd(z));
+         __m512d r = _mm512_add_pd(sq, _mm512_mul_pd(_mm512_mul_pd(sq, z), horner_avx512(ASIN, ASIN_TERMS, z)));
+         __m512d angle = _mm512_mask_blend_pd(large, r, _mm512_sub_pd(_mm512_set1_pd(HALF_PI), _mm512_add_pd(r, r)));
+         _mm512_mask_storeu_pd(meters + i, lanes, _mm512_mul_pd(angle, _mm512_set1_pd(DIAMETER)));
+     }
+ }
+ #pragma GCC diagnostic pop
+
+ } // anonymous namespace
+
+ const Kernels sse42 = {Level::SSE42, xor_bytes_sse42, dearmor_sse42, find_all_sse42, haversine_sse42};
+ const Kernels avx2 = {Level::AVX2, xor_bytes_avx2, dearmor_avx2, find_all_avx2, haversine_avx2};
+ const Kernels avx512 = {Level::AVX512, xor_bytes_avx512, dearmor_avx512, find_all_avx512, haversine_avx512};
+
+ } // namespace impl
+ } // namespace cpu
+ } // namespace aislib
+
+ #endif // AISLIB_CPU_HAVE_X86_KERNELS
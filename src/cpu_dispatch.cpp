@@ -0,0 +1,251 @@
+/**
+ * @file cpu_dispatch.cpp
+ * @brief Implementation of CPU detection, kernel binding and the scalar kernels
+ */
+
+ #include "aislib/cpu_dispatch.h"
+ #include "cpu/kernels.h"
+ #include <algorithm>
+ #include <cctype>
+ #include <cmath>
+ #include <cstdlib>
+ #include <mutex>
+ #include <stdexcept>
+
+ namespace aislib {
+ namespace cpu {
+
+ namespace impl {
+
+ uint8_t xor_bytes_scalar(const char* data, size_t length) {
+     uint8_t checksum = 0;
+     for (size_t i = 0; i < length; ++i) {
+         checksum ^= static_cast<uint8_t>(data[i]);
+     }
+     return checksum;
+ }
+
+ bool dearmor_scalar(const char* payload, size_t length, uint8_t* values) {
+     for (size_t i = 0; i < length; ++i) {
+         uint8_t c = static_cast<uint8_t>(payload[i]);
+         if (c >= '0' && c <= 'W') {
+             values[i] = static_cast<uint8_t>(c - '0');
+         } else if (c >= '`' && c <= 'w') {
+             values[i] = static_cast<uint8_t>(c - '`' + 40);
+         } else {
+             return false;
+         }
+     }
+     return true;
+ }
+
+ size_t find_all_scalar(const char* data, size_t length, char delimiter, uint32_t* positions, size_t max_positions) {
+     size_t count = 0;
+     for (size_t i = 0; i < length && count < max_positions; ++i) {
+         if (data[i] == delimiter) {
+             positions[count++] = static_cast<uint32_t>(i);
+         }
+     }
+     return count;
+ }
+
+ namespace {
+
+ double horner(const double* coefficients, int count, double z) {
+     double p = coefficients[count - 1];
+     for (int k = count - 2; k >= 0; --k) {
+         p = p * z + coefficients[k];
+     }
+     return p;
+ }
+
+ } // anonymous namespace
+
+ void haversine_scalar(const double* lat1, const double* lon1, const double* lat2, const double* lon2,
+                       size_t count, double* meters) {
+     using namespace haversine;
+     for (size_t i = 0; i < count; ++i) {
+         double half_lat = (lat2[i] - lat1[i]) * HALF_RADIANS;
+         double dlon = lon2[i] - lon1[i];
+         dlon = dlon - (dlon > 180.0 ? 360.0 : 0.0);
+         dlon = dlon + (dlon < -180.0 ? 360.0 : 0.0);
+         double half_lon = dlon * HALF_RADIANS;
+
+         double sin_lat = half_lat * horner(SIN, SIN_TERMS, half_lat * half_lat);
+         double sin_lon = half_lon * horner(SIN, SIN_TERMS, half_lon * half_lon);
+         double r1 = lat1[i] * RADIANS;
+         double r2 = lat2[i] * RADIANS;
+         double cos_product = horner(COS, COS_TERMS, r1 * r1) * horner(COS, COS_TERMS, r2 * r2);
+
+         double h = sin_lat * sin_lat + cos_product * (sin_lon * sin_lon);
+         double x = std::sqrt(std::min(std::max(h, 0.0), 1.0));
+         bool large = x > 0.5;
+         double z = large ? (1.0 - x) * 0.5 : x * x;
+         double s = large ? std::sqrt(z) : x;
+         double r = s + (s * z) * horner(ASIN, ASIN_TERMS, z);
+         meters[i] = (large ? HALF_PI - (r + r) : r) * DIAMETER;
+     }
+ }
+
+ const Kernels scalar = {Level::SCALAR, xor_bytes_scalar, dearmor_scalar, find_all_scalar, haversine_scalar};
+
+ } // namespace impl
+
+ namespace detail {
+
+ std::atomic<const Kernels*> active{nullptr};
+
+ } // namespace detail
+
+ namespace {
+
+ Level detect() {
+ #if defined(AISLIB_CPU_HAVE_X86_KERNELS)
+     // Uses cpuid, and xgetbv for the OS support of the AVX register state
+     __builtin_cpu_init();
+     if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw") &&
+         __builtin_cpu_supports("bmi2")) {
+         return Level::AVX512;
+     }
+     if (__builtin_cpu_supports("avx2")) {
+         return Level::AVX2;
+     }
+     if (__builtin_cpu_supports("sse4.2")) {
+         return Level::SSE42;
+     }
+     return Level::SCALAR;
+ #elif defined(AISLIB_CPU_HAVE_NEON_KERNELS)
+     // Advanced SIMD is mandatory on AArch64
+     return Level::NEON;
+ #else
+     return Level::SCALAR;
+ #endif
+ }
+
+ // Startup level: the detected one, lowered by AISLIB_CPU_LEVEL if set
+ Level startup_level() {
+     Level level = detected_level();
+     const char* requested = std::getenv("AISLIB_CPU_LEVEL");
+     if (requested == nullptr || *requested == '\0') {
+         return level;
+     }
+
+     try {
+         Level forced = parse_level(requested);
+         // A level the CPU cannot run falls back to the detected one
+         if (is_supported(forced)) {
+             level = forced;
+         }
+     } catch (const std::invalid_argument&) {
+         // Unknown names are ignored
+     }
+     return level;
+ }
+
+ } // anonymous namespace
+
+ Level detected_level() {
+     static const Level level = detect();
+     return level;
+ }
+
+ bool is_supported(Level level) {
+     Level detected = detected_level();
+     switch (level) {
+         case Level::SCALAR:
+             return true;
+         case Level::SSE42:
+         case Level::AVX2:
+         case Level::AVX512:
+             return detected != Level::NEON && static_cast<int>(level) <= static_cast<int>(detected);
+         case Level::NEON:
+             return detected == Level::NEON;
+     }
+     return false;
+ }
+
+ std::vector<Level> supported_levels() {
+     std::vector<Level> levels;
+     for (Level level : {Level::SCALAR, Level::SSE42, Level::AVX2, Level::AVX512, Level::NEON}) {
+         if (is_supported(level)) {
+             levels.push_back(level);
+         }
+     }
+     return levels;
+ }
+
+ const Kernels& kernels_for(Level level) {
+     if (!is_supported(level)) {
+         throw std::invalid_argument(std::string("CPU level not supported: ") + level_name(level));
+     }
+
+     switch (level) {
+ #if defined(AISLIB_CPU_HAVE_X86_KERNELS)
+         case Level::SSE42:
+             return impl::sse42;
+         case Level::AVX2:
+             return impl::avx2;
+         case Level::AVX512:
+             return impl::avx512;
+ #endif
+ #if defined(AISLIB_CPU_HAVE_NEON_KERNELS)
+         case Level::NEON:
+             return impl::neon;
+ #endif
+         default:
+             return impl::scalar;
+     }
+ }
+
+ Level active_level() {
+     return kernels().level;
+ }
+
+ void force_level(Level level) {
+     detail::active.store(&kernels_for(level), std::memory_order_release);
+ }
+
+ void reset_level() {
+     static const Level level = startup_level();
+     force_level(level);
+ }
+
+ const char* level_name(Level level) {
+     switch (level) {
+         case Level::SCALAR: return "scalar";
+         case Level::SSE42: return "sse4.2";
+         case Level::AVX2: return "avx2";
+         case Level::AVX512: return "avx512";
+         case Level::NEON: return "neon";
+     }
+     return "unknown";
+ }
+
+ Level parse_level(const std::string& name) {
+     std::string lower(name);
+     std::transform(lower.begin(), lower.end(), lower.begin(),
+                    [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+
+     for (Level level : {Level::SCALAR, Level::SSE42, Level::AVX2, Level::AVX512, Level::NEON}) {
+         if (lower == level_name(level)) {
+             return level;
+         }
+     }
+     if (lower == "sse42") {
+         return Level::SSE42;
+     }
+     throw std::invalid_argument("Unknown CPU level: " + name);
+ }
+
+ namespace detail {
+
+ const Kernels& initialize() {
+     static std::once_flag once;
+     std::call_once(once, []() { reset_level(); });
+     return *active.load(std::memory_order_acquire);
+ }
+
+ } // namespace detail
+
+ } // namespace cpu
+ } // namespace aislib
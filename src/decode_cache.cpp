@@ -0,0 +1,163 @@
+/**
+ * @file decode_cache.cpp
+ * @brief Implementation of the DecodeCache class
+ */
+
+ #include "aislib/decode_cache.h"
+ #include <cstring>
+
+ namespace aislib {
+
+ namespace {
+
+ uint64_t mix(uint64_t h) {
+     h ^= h >> 33;
+     h *= 0xFF51AFD7ED558CCDULL;
+     h ^= h >> 33;
+     h *= 0xC4CEB9FE1A85EC53ULL;
+     h ^= h >> 33;
+     return h;
+ }
+
+ // Last byte with the bits past the end cleared
+ uint8_t last_byte(const uint8_t* bytes, size_t bit_count) {
+     uint8_t byte = bytes[(bit_count - 1) / 8];
+     if (bit_count % 8 != 0) {
+         byte &= static_cast<uint8_t>(0xFF << (8 - bit_count % 8));
+     }
+     return byte;
+ }
+
+ } // anonymous namespace
+
+ double DecodeCache::Stats::hit_rate() const {
+     uint64_t lookups = hits + misses;
+     return lookups > 0 ? static_cast<double>(hits) / static_cast<double>(lookups) : 0.0;
+ }
+
+ DecodeCache::DecodeCache(const Config& config)
+     : config_(config),
+       hits_(0),
+       misses_(0),
+       bypassed_(0),
+       evictions_(0) {
+     if (config_.max_entries == 0) {
+         config_.max_entries = 1;
+     }
+ }
+
+ std::shared_ptr<const AISMessage> DecodeCache::decode(const BitVector& bits, bool* hit) {
+     if (hit != nullptr) {
+         *hit = false;
+     }
+
+     if (bits.size() < 6 || !is_cacheable(static_cast<uint8_t>(bits.get_uint(0, 6)))) {
+         bypassed_.fetch_add(1, std::memory_order_relaxed);
+         return AISMessage::from_bits(bits);
+     }
+
+     uint64_t hash = hash_bits(bits);
+     {
+         std::lock_guard<std::mutex> lock(mutex_);
+         auto it = index_.find(hash);
+         if (it != index_.end() && same_bits(*it->second, bits)) {
+             lru_.splice(lru_.begin(), lru_, it->second);
+             hits_.fetch_add(1, std::memory_order_relaxed);
+             if (hit != nullptr) {
+                 *hit = true;
+             }
+             return it->second->message;
+         }
+     }
+
+     // Decode outside the lock; a concurrent miss on the same bits decodes twice
+     misses_.fetch_add(1, std::memory_order_relaxed);
+     std::shared_ptr<const AISMessage> message = AISMessage::from_bits(bits);
+
+     Entry entry;
+     entry.hash = hash;
+     entry.bit_count = bits.size();
+     entry.bytes.assign(bits.data(), bits.data() + (bits.size() + 7) / 8);
+     if (bits.size() % 8 != 0) {
+         entry.bytes.back() = last_byte(bits.data(), bits.size());
+     }
+     entry.message = message;
+
+     std::lock_guard<std::mutex> lock(mutex_);
+     auto it = index_.find(hash);
+     if (it != index_.end()) {
+         // Same bits inserted meanwhile, or a colliding payload: keep the newest
+         lru_.erase(it->second);
+         index_.erase(it);
+     }
+     lru_.push_front(std::move(entry));
+     index_[hash] = lru_.begin();
+
+     while (lru_.size() > config_.max_entries) {
+         index_.erase(lru_.back().hash);
+         lru_.pop_back();
+         evictions_.fetch_add(1, std::memory_order_relaxed);
+     }
+
+     return message;
+ }
+
+ bool DecodeCache::is_cacheable(uint8_t message_type) const {
+     return message_type < 64 && config_.message_types.test(message_type);
+ }
+
+ DecodeCache::Stats DecodeCache::get_stats() const {
+     Stats stats;
+     stats.hits = hits_.load(std::memory_order_relaxed);
+     stats.misses = misses_.load(std::memory_order_relaxed);
+     stats.bypassed = bypassed_.load(std::memory_order_relaxed);
+     stats.evictions = evictions_.load(std::memory_order_relaxed);
+
+     std::lock_guard<std::mutex> lock(mutex_);
+     stats.entries = lru_.size();
+     return stats;
+ }
+
+ void DecodeCache::clear() {
+     std::lock_guard<std::mutex> lock(mutex_);
+     index_.clear();
+     lru_.clear();
+ }
+
+ uint64_t DecodeCache::hash_bits(const BitVector& bits) {
+     size_t bit_count = bits.size();
+     uint64_t h = mix(bit_count ^ 0x9E3779B97F4A7C15ULL);
+     if (bit_count == 0) {
+         return h;
+     }
+
+     const uint8_t* bytes = bits.data();
+     size_t full_bytes = (bit_count - 1) / 8;
+     size_t i = 0;
+     for (; i + 8 <= full_bytes; i += 8) {
+         uint64_t word;
+         std::memcpy(&word, bytes + i, sizeof(word));
+         h = mix(h ^ word) + i;
+     }
+
+     uint64_t tail = 0;
+     for (; i < full_bytes; ++i) {
+         tail = (tail << 8) | bytes[i];
+     }
+     tail = (tail << 8) | last_byte(bytes, bit_count);
+     return mix(h ^ tail);
+ }
+
+ bool DecodeCache::same_bits(const Entry& entry, const BitVector& bits) {
+     if (entry.bit_count != bits.size()) {
+         return false;
+     }
+     if (entry.bit_count == 0) {
+         return true;
+     }
+     size_t full_bytes = (entry.bit_count - 1) / 8;
+     return std::memcmp(entry.bytes.data(), bits.data(), full_bytes) == 0 &&
+            entry.bytes[full_bytes] == last_byte(bits.data(), entry.bit_count);
+ }
+
+ } // namespace aislib
@@ -0,0 +1,288 @@
+/**
+ * @file density_grid.cpp
+ * @brief Implementation of DensityGrid and DensityAggregator
+ */
+
+ #include "aislib/density_grid.h"
+ #include "aislib/position_report_class_b.h"
+ #include "aislib/static_data.h"
+ #include "aislib/static_data_report.h"
+ #include <algorithm>
+ #include <cmath>
+ #include <limits>
+ #include <stdexcept>
+ #include <thread>
+
+ namespace aislib {
+
+ namespace {
+
+ const double kPi = 3.14159265358979323846;
+ const double kMaxMercatorLatitude = 85.05112877980659;
+
+ // Cell keys hold the level in the top bits and 29 bits each for x and y
+ const uint32_t kCoordinateBits = 29;
+ const uint32_t kMaxZoom = 28;
+ const uint32_t kMaxLevels = 24;
+
+ bool known_speed(float speed) {
+     // 102.2 knots means 102.2 or more
+     return speed >= 0.0f && speed < 102.2f;
+ }
+
+ } // anonymous namespace
+
+ // ---- DensityGrid ----
+
+ DensityGrid::DensityGrid(const Config& config)
+     : config_(config),
+       reports_(0) {
+     if (config_.levels == 0 || config_.levels > kMaxLevels) {
+         throw std::invalid_argument("Density grid levels must be between 1 and 24");
+     }
+     if (config_.projection == GridProjection::LAT_LON) {
+         if (!(config_.cell_size > 0.0) || 360.0 / config_.cell_size >= double(1u << kCoordinateBits)) {
+             throw std::invalid_argument("Density grid cell size out of range");
+         }
+     } else if (config_.zoom > kMaxZoom || config_.levels > config_.zoom + 1) {
+         throw std::invalid_argument("Density grid zoom must be at most 28 and levels at most zoom + 1");
+     }
+     // Validates the precision
+     HyperLogLog sketch(config_.hll_precision);
+ }
+
+ uint64_t DensityGrid::key(uint32_t level, uint32_t x, uint32_t y) {
+     return (uint64_t(level) << (2 * kCoordinateBits)) | (uint64_t(x) << kCoordinateBits) | y;
+ }
+
+ DensityGrid::Cell& DensityGrid::cell(uint64_t cell_key) {
+     return cells_.try_emplace(cell_key, config_.hll_precision).first->second;
+ }
+
+ bool DensityGrid::cell_of(double latitude, double longitude, uint32_t level, uint32_t& x, uint32_t& y) const {
+     if (!(latitude >= -90.0 && latitude <= 90.0 && longitude >= -180.0 && longitude <= 180.0)) {
+         return false;
+     }
+     double column;
+     double row;
+     double columns;
+     double rows;
+     if (config_.projection == GridProjection::LAT_LON) {
+         column = std::floor((longitude + 180.0) / config_.cell_size);
+         row = std::floor((latitude + 90.0) / config_.cell_size);
+         columns = std::ceil(360.0 / config_.cell_size);
+         rows = std::ceil(180.0 / config_.cell_size);
+     } else {
+         if (latitude > kMaxMercatorLatitude || latitude < -kMaxMercatorLatitude) {
+             return false;
+         }
+         columns = std::ldexp(1.0, static_cast<int>(config_.zoom));
+         rows = columns;
+         double radians = latitude * kPi / 180.0;
+         column = std::floor((longitude + 180.0) / 360.0 * columns);
+         row = std::floor((1.0 - std::asinh(std::tan(radians)) / kPi) / 2.0 * rows);
+     }
+     // The eastern and northern edges belong to the last cell
+     column = std::min(std::max(column, 0.0), columns - 1.0);
+     row = std::min(std::max(row, 0.0), rows - 1.0);
+     x = static_cast<uint32_t>(column) >> level;
+     y = static_cast<uint32_t>(row) >> level;
+     return true;
+ }
+
+ void DensityGrid::cell_bounds(uint32_t level, uint32_t x, uint32_t y,
+                               double& min_lat, double& min_lon, double& max_lat, double& max_lon) const {
+     if (config_.projection == GridProjection::LAT_LON) {
+         double size = std::ldexp(config_.cell_size, static_cast<int>(level));
+         min_lon = -180.0 + x * size;
+         max_lon = std::min(180.0, min_lon + size);
+         min_lat = -90.0 + y * size;
+         max_lat = std::min(90.0, min_lat + size);
+         return;
+     }
+     double tiles = std::ldexp(1.0, static_cast<int>(config_.zoom) - static_cast<int>(level));
+     min_lon = x / tiles * 360.0 - 180.0;
+     max_lon = (x + 1) / tiles * 360.0 - 180.0;
+     max_lat = std::atan(std::sinh(kPi * (1.0 - 2.0 * y / tiles))) * 180.0 / kPi;
+     min_lat = std::atan(std::sinh(kPi * (1.0 - 2.0 * (y + 1) / tiles))) * 180.0 / kPi;
+ }
+
+ bool DensityGrid::add(uint32_t mmsi, double latitude, double longitude, float speed) {
+     uint32_t x;
+     uint32_t y;
+     if (!cell_of(latitude, longitude, 0, x, y)) {
+         return false;
+     }
+     uint64_t hash = HyperLogLog::hash(mmsi);
+     bool has_speed = known_speed(speed);
+     for (uint32_t level = 0; level < config_.levels; ++level) {
+         Cell& target = cell(key(level, x >> level, y >> level));
+         ++target.reports;
+         target.vessels.add(hash);
+         if (has_speed) {
+             ++target.speed_reports;
+             target.speed_sum += speed;
+         }
+     }
+     ++reports_;
+     return true;
+ }
+
+ void DensityGrid::merge(const DensityGrid& other) {
+     const Config& theirs = other.config_;
+     if (theirs.projection != config_.projection || theirs.cell_size != config_.cell_size ||
+         theirs.zoom != config_.zoom || theirs.levels != config_.levels ||
+         theirs.hll_precision != config_.hll_precision) {
+         throw std::invalid_argument("Cannot merge density grids with different configurations");
+     }
+     for (const auto& entry : other.cells_) {
+         Cell& target = cell(entry.first);
+         target.reports += entry.second.reports;
+         target.speed_reports += entry.second.speed_reports;
+         target.speed_sum += entry.second.speed_sum;
+         target.vessels.merge(entry.second.vessels);
+     }
+     reports_ += other.reports_;
+ }
+
+ std::vector<DensityCell> DensityGrid::get_cells(uint32_t level) const {
+     const uint64_t mask = (uint64_t(1) << kCoordinateBits) - 1;
+     std::vector<DensityCell> result;
+     for (const auto& entry : cells_) {
+         if ((entry.first >> (2 * kCoordinateBits)) != level) {
+             continue;
+         }
+         DensityCell cell;
+         cell.level = level;
+         cell.x = static_cast<uint32_t>((entry.first >> kCoordinateBits) & mask);
+         cell.y = static_cast<uint32_t>(entry.first & mask);
+         cell.reports = entry.second.reports;
+         cell.vessels = entry.second.vessels.estimate();
+         cell.average_speed = entry.second.speed_reports > 0
+                                  ? entry.second.speed_sum / static_cast<double>(entry.second.speed_reports)
+                                  : std::numeric_limits<double>::quiet_NaN();
+         result.push_back(cell);
+     }
+     return result;
+ }
+
+ uint64_t DensityGrid::get_reports() const {
+     return reports_;
+ }
+
+ size_t DensityGrid::cell_count() const {
+     return cells_.size();
+ }
+
+ const DensityGrid::Config& DensityGrid::get_config() const {
+     return config_;
+ }
+
+ void DensityGrid::clear() {
+     cells_.clear();
+     reports_ = 0;
+ }
+
+ // ---- DensityAggregator ----
+
+ DensityAggregator::DensityAggregator(const Config& config)
+     : config_(config),
+       threads_(config.threads > 0 ? config.threads : std::max(1u, std::thread::hardware_concurrency())),
+       result_(config.grid) {
+     partials_.assign(threads_, result_);
+     for (uint8_t type : config_.ship_types) {
+         accepted_types_.set(type);
+     }
+ }
+
+ bool DensityAggregator::update_static(const AISMessage& message) {
+     if (auto* static_data = dynamic_cast<const StaticAndVoyageData*>(&message)) {
+         set_ship_type(static_data->get_mmsi(), static_cast<uint8_t>(static_data->get_ship_type()));
+         return true;
+     }
+     if (auto* extended = dynamic_cast<const ExtendedPositionReportClassB*>(&message)) {
+         set_ship_type(extended->get_mmsi(), extended->get_ship_type());
+         return true;
+     }
+     if (auto* report = dynamic_cast<const StaticDataReport*>(&message)) {
+         if (report->get_part() == StaticDataReport::Part::B) {
+             set_ship_type(report->get_mmsi(), report->get_ship_type());
+             return true;
+         }
+     }
+     return false;
+ }
+
+ void DensityAggregator::set_ship_type(uint32_t mmsi, uint8_t ship_type) {
+     ship_types_[mmsi] = ship_type;
+ }
+
+ size_t DensityAggregator::add_rows(const PositionBatch& batch, size_t begin, size_t end,
+                                    DensityGrid& grid) const {
+     const bool filtered = !config_.ship_types.empty();
+     size_t added = 0;
+     for (size_t i = begin; i < end; ++i) {
+         if (filtered) {
+             auto found = ship_types_.find(batch.mmsi[i]);
+             if (found == ship_types_.end() || !accepted_types_.test(found->second)) {
+                 continue;
+             }
+         }
+         added += grid.add(batch.mmsi[i], batch.latitude[i], batch.longitude[i], batch.speed[i]);
+     }
+     return added;
+ }
+
+ size_t DensityAggregator::add(const PositionBatch& batch) {
+     const size_t rows = batch.size();
+     size_t min_rows = std::max<size_t>(1, config_.min_rows_per_thread);
+     size_t workers = std::min<size_t>(threads_, std::max<size_t>(1, rows / min_rows));
+     if (workers <= 1) {
+         return add_rows(batch, 0, rows, partials_[0]);
+     }
+
+     // Each worker fills its own partial grid; the calling thread takes the last share
+     size_t share = (rows + workers - 1) / workers;
+     std::vector<size_t> added(workers, 0);
+     std::vector<std::thread> threads;
+     threads.reserve(workers - 1);
+     for (size_t w = 0; w + 1 < workers; ++w) {
+         threads.emplace_back([this, &batch, &added, share, rows, w] {
+             added[w] = add_rows(batch, w * share, std::min(rows, (w + 1) * share), partials_[w]);
+         });
+     }
+     size_t last = workers - 1;
+     added[last] = add_rows(batch, std::min(rows, last * share), rows, partials_[last]);
+     for (auto& thread : threads) {
+         thread.join();
+     }
+
+     size_t total = 0;
+     for (size_t count : added) {
+         total += count;
+     }
+     return total;
+ }
+
+ const DensityGrid& DensityAggregator::result() {
+     for (auto& partial : partials_) {
+         if (partial.get_reports() > 0) {
+             result_.merge(partial);
+             partial.clear();
+         }
+     }
+     return result_;
+ }
+
+ unsigned DensityAggregator::get_threads() const {
+     return threads_;
+ }
+
+ void DensityAggregator::clear() {
+     result_.clear();
+     for (auto& partial : partials_) {
+         partial.clear();
+     }
+ }
+
+ } // namespace aislib
@@ -0,0 +1,304 @@
+/**
+ * @file filter_dispatcher.cpp
+ * @brief Implementation of FilterDispatcher
+ */
+
+ #include "aislib/filter_dispatcher.h"
+ #include "aislib/position_report_class_a.h"
+ #include "aislib/position_report_class_b.h"
+ #include "aislib/static_data.h"
+ #include "aislib/static_data_report.h"
+ #include <algorithm>
+ #include <cmath>
+ #include <stdexcept>
+
+ namespace aislib {
+
+ namespace {
+
+ const size_t kMessageTypes = 64;
+ const size_t kShipTypes = 256;
+
+ bool valid_position(double latitude, double longitude) {
+     return latitude >= -90.0 && latitude <= 90.0 && longitude >= -180.0 && longitude <= 180.0;
+ }
+
+ } // anonymous namespace
+
+ FilterDispatcher::FilterDispatcher(const Config& config)
+     : config_(config),
+       stale_(true),
+       words_(0),
+       type_bits_(0),
+       ship_bits_(0),
+       any_mmsi_(0),
+       any_ship_(0),
+       any_position_(0),
+       wide_(0) {
+     if (!(config_.cell_size > 0.0)) {
+         throw std::invalid_argument("Filter dispatcher cell_size must be positive");
+     }
+ }
+
+ uint32_t FilterDispatcher::subscribe(const SubscriptionFilter& filter) {
+     for (uint8_t type : filter.message_types) {
+         if (type >= kMessageTypes) {
+             throw std::invalid_argument("Subscription message type out of range");
+         }
+     }
+     for (const auto& box : filter.boxes) {
+         if (!valid_position(box.min_lat, box.min_lon) || !valid_position(box.max_lat, box.max_lon) ||
+             box.min_lat > box.max_lat) {
+             throw std::invalid_argument("Invalid subscription box");
+         }
+     }
+
+     uint32_t subscriber;
+     if (!free_ids_.empty()) {
+         subscriber = free_ids_.back();
+         free_ids_.pop_back();
+         subscriptions_[subscriber] = Subscription{true, filter};
+     } else {
+         subscriber = static_cast<uint32_t>(subscriptions_.size());
+         subscriptions_.push_back(Subscription{true, filter});
+     }
+     stale_ = true;
+     return subscriber;
+ }
+
+ bool FilterDispatcher::unsubscribe(uint32_t subscriber) {
+     if (subscriber >= subscriptions_.size() || !subscriptions_[subscriber].active) {
+         return false;
+     }
+     subscriptions_[subscriber] = Subscription{false, SubscriptionFilter()};
+     free_ids_.push_back(subscriber);
+     stale_ = true;
+     return true;
+ }
+
+ bool FilterDispatcher::update_static(const AISMessage& message) {
+     if (auto* static_data = dynamic_cast<const StaticAndVoyageData*>(&message)) {
+         set_ship_type(static_data->get_mmsi(), static_cast<uint8_t>(static_data->get_ship_type()));
+         return true;
+     }
+     if (auto* extended = dynamic_cast<const ExtendedPositionReportClassB*>(&message)) {
+         set_ship_type(extended->get_mmsi(), extended->get_ship_type());
+         return true;
+     }
+     if (auto* report = dynamic_cast<const StaticDataReport*>(&message)) {
+         if (report->get_part() == StaticDataReport::Part::B) {
+             set_ship_type(report->get_mmsi(), report->get_ship_type());
+             return true;
+         }
+     }
+     return false;
+ }
+
+ void FilterDispatcher::set_ship_type(uint32_t mmsi, uint8_t ship_type) {
+     ship_types_[mmsi] = ship_type;
+ }
+
+ size_t FilterDispatcher::allocate_bitset() {
+     size_t offset = bits_.size();
+     bits_.resize(offset + words_, 0);
+     return offset;
+ }
+
+ void FilterDispatcher::set_bit(size_t bitset, uint32_t subscriber) {
+     bits_[bitset + subscriber / 64] |= uint64_t(1) << (subscriber % 64);
+ }
+
+ void FilterDispatcher::compile() {
+     words_ = (subscriptions_.size() + 63) / 64;
+     bits_.clear();
+     mmsi_bits_.clear();
+     cells_.clear();
+     boxes_.clear();
+     first_box_.assign(1, 0);
+
+     type_bits_ = bits_.size();
+     bits_.resize(type_bits_ + kMessageTypes * words_, 0);
+     ship_bits_ = bits_.size();
+     bits_.resize(ship_bits_ + kShipTypes * words_, 0);
+     any_mmsi_ = allocate_bitset();
+     any_ship_ = allocate_bitset();
+     any_position_ = allocate_bitset();
+     wide_ = allocate_bitset();
+
+     for (uint32_t subscriber = 0; subscriber < subscriptions_.size(); ++subscriber) {
+         const Subscription& subscription = subscriptions_[subscriber];
+         const SubscriptionFilter& filter = subscription.filter;
+         boxes_.insert(boxes_.end(), filter.boxes.begin(), filter.boxes.end());
+         first_box_.push_back(static_cast<uint32_t>(boxes_.size()));
+         if (!subscription.active) {
+             continue;
+         }
+
+         if (filter.message_types.empty()) {
+             for (size_t type = 0; type < kMessageTypes; ++type) {
+                 set_bit(type_bits_ + type * words_, subscriber);
+             }
+         }
+         for (uint8_t type : filter.message_types) {
+             set_bit(type_bits_ + type * words_, subscriber);
+         }
+
+         if (filter.mmsis.empty()) {
+             set_bit(any_mmsi_, subscriber);
+         }
+         for (uint32_t mmsi : filter.mmsis) {
+             auto found = mmsi_bits_.find(mmsi);
+             if (found == mmsi_bits_.end()) {
+                 found = mmsi_bits_.emplace(mmsi, allocate_bitset()).first;
+             }
+             set_bit(found->second, subscriber);
+         }
+
+         if (filter.ship_types.empty()) {
+             set_bit(any_ship_, subscriber);
+         }
+         for (uint8_t type : filter.ship_types) {
+             set_bit(ship_bits_ + type * words_, subscriber);
+         }
+
+         if (filter.boxes.empty()) {
+             set_bit(any_position_, subscriber);
+         }
+         for (const auto& box : filter.boxes) {
+             if (box.min_lon <= box.max_lon) {
+                 index_box(subscriber, box.min_lat, box.min_lon, box.max_lat, box.max_lon);
+             } else {
+                 index_box(subscriber, box.min_lat, box.min_lon, box.max_lat, 180.0);
+                 index_box(subscriber, box.min_lat, -180.0, box.max_lat, box.max_lon);
+             }
+         }
+     }
+     stale_ = false;
+ }
+
+ void FilterDispatcher::index_box(uint32_t subscriber, double min_lat, double min_lon,
+                                  double max_lat, double max_lon) {
+     int64_t first_row = cell_coordinate(min_lat);
+     int64_t last_row = cell_coordinate(max_lat);
+     int64_t first_column = cell_coordinate(min_lon);
+     int64_t last_column = cell_coordinate(max_lon);
+     double cells = static_cast<double>(last_row - first_row + 1) * static_cast<double>(last_column - first_column + 1);
+     if (cells > static_cast<double>(config_.max_cells_per_box)) {
+         set_bit(wide_, subscriber);
+         return;
+     }
+
+     const double size = config_.cell_size;
+     for (int64_t row = first_row; row <= last_row; ++row) {
+         bool rows_covered = row * size >= min_lat && (row + 1) * size <= max_lat;
+         for (int64_t column = first_column; column <= last_column; ++column) {
+             bool covered = rows_covered && column * size >= min_lon && (column + 1) * size <= max_lon;
+             auto found = cells_.find(cell_key(row, column));
+             if (found == cells_.end()) {
+                 size_t full = allocate_bitset();
+                 size_t partial = allocate_bitset();
+                 found = cells_.emplace(cell_key(row, column), Cell{full, partial}).first;
+             }
+             set_bit(covered ? found->second.full : found->second.partial, subscriber);
+         }
+     }
+ }
+
+ bool FilterDispatcher::in_boxes(uint32_t subscriber, double latitude, double longitude) const {
+     for (uint32_t i = first_box_[subscriber]; i < first_box_[subscriber + 1]; ++i) {
+         const SubscriptionFilter::Box& box = boxes_[i];
+         if (latitude < box.min_lat || latitude > box.max_lat) {
+             continue;
+         }
+         bool inside = box.min_lon <= box.max_lon
+                           ? longitude >= box.min_lon && longitude <= box.max_lon
+                           : longitude >= box.min_lon || longitude <= box.max_lon;
+         if (inside) {
+             return true;
+         }
+     }
+     return false;
+ }
+
+ size_t FilterDispatcher::route(uint8_t message_type, uint32_t mmsi, double latitude, double longitude,
+                                std::vector<uint32_t>& subscribers) {
+     subscribers.clear();
+     if (stale_) {
+         compile();
+     }
+     if (words_ == 0 || message_type >= kMessageTypes) {
+         return 0;
+     }
+
+     const uint64_t* bits = bits_.data();
+     const uint64_t* type_mask = bits + type_bits_ + message_type * words_;
+     const uint64_t* any_mmsi = bits + any_mmsi_;
+     const uint64_t* any_ship = bits + any_ship_;
+     const uint64_t* any_position = bits + any_position_;
+
+     auto listed = mmsi_bits_.find(mmsi);
+     const uint64_t* mmsi_mask = listed != mmsi_bits_.end() ? bits + listed->second : nullptr;
+     auto ship_type = ship_types_.find(mmsi);
+     const uint64_t* ship_mask = ship_type != ship_types_.end() ? bits + ship_bits_ + ship_type->second * words_ : nullptr;
+
+     // Cells covered in full match outright; partly covered cells and wide boxes are tested exactly
+     const bool positioned = valid_position(latitude, longitude);
+     const uint64_t* full = nullptr;
+     const uint64_t* partial = nullptr;
+     const uint64_t* wide = positioned ? bits + wide_ : nullptr;
+     if (positioned) {
+         auto cell = cells_.find(cell_key(cell_coordinate(latitude), cell_coordinate(longitude)));
+         if (cell != cells_.end()) {
+             full = bits + cell->second.full;
+             partial = bits + cell->second.partial;
+         }
+     }
+
+     for (size_t w = 0; w < words_; ++w) {
+         uint64_t candidates = type_mask[w] &
+                               (any_mmsi[w] | (mmsi_mask != nullptr ? mmsi_mask[w] : 0)) &
+                               (any_ship[w] | (ship_mask != nullptr ? ship_mask[w] : 0));
+         if (candidates == 0) {
+             continue;
+         }
+         uint64_t matched = any_position[w] | (full != nullptr ? full[w] : 0);
+         uint64_t check = ((partial != nullptr ? partial[w] : 0) | (wide != nullptr ? wide[w] : 0)) & ~matched;
+         candidates &= matched | check;
+         while (candidates != 0) {
+             uint32_t bit = static_cast<uint32_t>(__builtin_ctzll(candidates));
+             candidates &= candidates - 1;
+             uint32_t subscriber = static_cast<uint32_t>(w * 64 + bit);
+             if ((matched >> bit) & 1 || in_boxes(subscriber, latitude, longitude)) {
+                 subscribers.push_back(subscriber);
+             }
+         }
+     }
+     return subscribers.size();
+ }
+
+ size_t FilterDispatcher::route(const AISMessage& message, std::vector<uint32_t>& subscribers) {
+     update_static(message);
+     uint8_t type = static_cast<uint8_t>(message.get_message_type());
+     if (auto* class_a = dynamic_cast<const PositionReportClassA*>(&message)) {
+         return route(type, class_a->get_mmsi(), class_a->get_latitude(), class_a->get_longitude(), subscribers);
+     }
+     // Covers type 19, which derives from type 18
+     if (auto* class_b = dynamic_cast<const StandardPositionReportClassB*>(&message)) {
+         return route(type, class_b->get_mmsi(), class_b->get_latitude(), class_b->get_longitude(), subscribers);
+     }
+     return route(type, message.get_mmsi(), 91.0, 181.0, subscribers);
+ }
+
+ size_t FilterDispatcher::size() const {
+     return subscriptions_.size() - free_ids_.size();
+ }
+
+ int64_t FilterDispatcher::cell_coordinate(double degrees) const {
+     return static_cast<int64_t>(std::floor(degrees / config_.cell_size));
+ }
+
+ uint64_t FilterDispatcher::cell_key(int64_t row, int64_t column) {
+     return (static_cast<uint64_t>(static_cast<uint32_t>(row)) << 32) | static_cast<uint32_t>(column);
+ }
+
+ } // namespace aislib
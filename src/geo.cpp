@@ -0,0 +1,24 @@
+/**
+ * @file geo.cpp
+ * @brief Implementation of the great-circle distance functions
+ */
+
+ #include "aislib/geo.h"
+ #include "aislib/cpu_dispatch.h"
+
+ namespace aislib {
+ namespace geo {
+
+ double haversine(double lat1, double lon1, double lat2, double lon2) {
+     double meters;
+     cpu::kernels().haversine(&lat1, &lon1, &lat2, &lon2, 1, &meters);
+     return meters;
+ }
+
+ void haversine_batch(const double* lat1, const double* lon1, const double* lat2, const double* lon2,
+                      size_t count, double* meters) {
+     cpu::kernels().haversine(lat1, lon1, lat2, lon2, count, meters);
+ }
+
+ } // namespace geo
+ } // namespace aislib
@@ -0,0 +1,554 @@
+/**
+ * @file geofence.cpp
+ * @brief Implementation of GeofenceEngine
+ */
+
+ #include "aislib/geofence.h"
+ #include "aislib/position_report_class_a.h"
+ #include "aislib/position_report_class_b.h"
+ #include <algorithm>
+ #include <cmath>
+ #include <stdexcept>
+
+ namespace aislib {
+
+ namespace {
+
+ const double kPi = 3.14159265358979323846;
+
+ // One minute of latitude is one nautical mile
+ const double kMetersPerDegree = 1852.0 * 60.0;
+
+ // Area notice positions are in 1/10000 minutes
+ const double kAreaNoticeScale = 600000.0;
+
+ bool valid_position(double latitude, double longitude) {
+     return latitude >= -90.0 && latitude <= 90.0 && longitude >= -180.0 && longitude <= 180.0;
+ }
+
+ double meters_per_degree_lon(double latitude) {
+     return kMetersPerDegree * std::cos(latitude * kPi / 180.0);
+ }
+
+ // Longitude difference taken the shorter way round, in [-180, 180]
+ double wrap_longitude(double degrees) {
+     return degrees > 180.0 ? degrees - 360.0 : (degrees < -180.0 ? degrees + 360.0 : degrees);
+ }
+
+ // Position at an offset in meters (east, north) from a reference point
+ std::pair<double, double> offset(double latitude, double longitude, double east, double north) {
+     return std::make_pair(latitude + north / kMetersPerDegree,
+                           wrap_longitude(longitude + east / meters_per_degree_lon(latitude)));
+ }
+
+ } // anonymous namespace
+
+ GeofenceEngine::GeofenceEngine(const Config& config)
+     : config_(config) {
+     if (!(config_.cell_size > 0.0)) {
+         throw std::invalid_argument("Geofence grid cell size must be positive");
+     }
+ }
+
+ void GeofenceEngine::add_circle(uint32_t id, double latitude, double longitude, double radius) {
+     if (!valid_position(latitude, longitude)) {
+         throw std::invalid_argument("Invalid geofence centre");
+     }
+     if (!(radius > 0.0)) {
+         throw std::invalid_argument("Geofence radius must be positive");
+     }
+
+     Fence fence = Fence();
+     fence.id = id;
+     fence.shape = Shape::CIRCLE;
+     fence.center_lat = latitude;
+     fence.center_lon = longitude;
+     fence.meters_per_degree_lon = meters_per_degree_lon(latitude);
+     fence.radius_squared = radius * radius;
+
+     double lat_extent = radius / kMetersPerDegree;
+     double lon_extent = fence.meters_per_degree_lon > 1.0 ? radius / fence.meters_per_degree_lon : 180.0;
+     fence.min_lat = std::max(-90.0, latitude - lat_extent);
+     fence.max_lat = std::min(90.0, latitude + lat_extent);
+     if (lon_extent >= 180.0) {
+         fence.min_lon = -180.0;
+         fence.max_lon = 180.0;
+     } else {
+         // A circle across the 180th meridian extends past 180 degrees east
+         fence.min_lon = longitude - lon_extent;
+         fence.max_lon = longitude + lon_extent;
+         if (fence.min_lon < -180.0) {
+             fence.min_lon += 360.0;
+             fence.max_lon += 360.0;
+         }
+     }
+     insert(fence);
+ }
+
+ void GeofenceEngine::add_polygon(uint32_t id, const std::vector<std::pair<double, double>>& vertices) {
+     if (vertices.size() < 3) {
+         throw std::invalid_argument("Geofence polygon needs at least 3 vertices");
+     }
+
+     Fence fence = Fence();
+     fence.id = id;
+     fence.shape = Shape::POLYGON;
+     fence.min_lat = fence.min_lon = 1000.0;
+     fence.max_lat = fence.max_lon = -1000.0;
+     // Longitudes are unwrapped along the edges, each taking the shorter way
+     // round, so a polygon across the 180th meridian stays contiguous
+     std::vector<double> longitudes;
+     longitudes.reserve(vertices.size());
+     for (const auto& vertex : vertices) {
+         if (!valid_position(vertex.first, vertex.second)) {
+             throw std::invalid_argument("Invalid geofence vertex");
+         }
+         double longitude = longitudes.empty() ? vertex.second
+                          : longitudes.back() + wrap_longitude(vertex.second - longitudes.back());
+         longitudes.push_back(longitude);
+         fence.min_lat = std::min(fence.min_lat, vertex.first);
+         fence.max_lat = std::max(fence.max_lat, vertex.first);
+         fence.min_lon = std::min(fence.min_lon, longitude);
+         fence.max_lon = std::max(fence.max_lon, longitude);
+     }
+     // Around a pole the closing edge ends a full turn away from the first vertex
+     double closing = longitudes.back() + wrap_longitude(longitudes.front() - longitudes.back());
+     if (std::fabs(closing - longitudes.front()) > 180.0) {
+         throw std::invalid_argument("Geofence polygon must not encircle a pole");
+     }
+     if (fence_index_.count(id) != 0) {
+         throw std::invalid_argument("Geofence ID already in use");
+     }
+
+     // Keep min_lon within [-180, 180]; max_lon may then exceed 180
+     double shift = fence.min_lon < -180.0 ? 360.0 : (fence.min_lon > 180.0 ? -360.0 : 0.0);
+     fence.min_lon += shift;
+     fence.max_lon += shift;
+     fence.first_vertex = static_cast<uint32_t>(vertex_lat_.size());
+     fence.vertex_count = static_cast<uint32_t>(vertices.size());
+     for (size_t i = 0; i < vertices.size(); ++i) {
+         vertex_lat_.push_back(vertices[i].first);
+         vertex_lon_.push_back(longitudes[i] + shift);
+     }
+     insert(fence);
+ }
+
+ size_t GeofenceEngine::add_area_notice(const application::AreaNotice& notice, uint32_t first_id) {
+     using AreaShape = application::AreaNotice::AreaShape;
+
+     // Build every fence first so that a duplicate ID leaves the engine unchanged
+     struct Pending {
+         bool circle;
+         double latitude, longitude, radius;
+         std::vector<std::pair<double, double>> vertices;
+     };
+     std::vector<Pending> pending;
+
+     const auto& subareas = notice.get_subareas();
+     for (size_t i = 0; i < subareas.size(); ++i) {
+         const auto& area = subareas[i];
+         double latitude = area.latitude / kAreaNoticeScale;
+         double longitude = area.longitude / kAreaNoticeScale;
+         if (!valid_position(latitude, longitude)) {
+             continue;
+         }
+
+         Pending fence;
+         fence.circle = false;
+         fence.latitude = latitude;
+         fence.longitude = longitude;
+         fence.radius = 0.0;
+
+         switch (area.shape_type) {
+             case AreaShape::CIRCLE:
+                 if (area.params.circle.radius == 0) {
+                     continue;
+                 }
+                 fence.circle = true;
+                 fence.radius = area.params.circle.radius;
+                 break;
+
+             case AreaShape::RECTANGLE: {
+                 // Reference point is the south-west corner; the rectangle is rotated clockwise about it
+                 double east = area.params.rectangle.e_dimension;
+                 double north = area.params.rectangle.n_dimension;
+                 if (east == 0.0 || north == 0.0) {
+                     continue;
+                 }
+                 double angle = area.params.rectangle.orientation * kPi / 180.0;
+                 double c = std::cos(angle);
+                 double s = std::sin(angle);
+                 const double corners[4][2] = {{0.0, 0.0}, {east, 0.0}, {east, north}, {0.0, north}};
+                 for (const auto& corner : corners) {
+                     fence.vertices.push_back(offset(latitude, longitude,
+                                                     corner[0] * c + corner[1] * s,
+                                                     corner[1] * c - corner[0] * s));
+                 }
+                 break;
+             }
+
+             case AreaShape::SECTOR: {
+                 double radius = area.params.sector.radius;
+                 if (radius == 0.0) {
+                     continue;
+                 }
+                 double left = area.params.sector.left_bound % 360;
+                 double right = area.params.sector.right_bound % 360;
+                 if (left == right) {
+                     fence.circle = true;
+                     fence.radius = radius;
+                     break;
+                 }
+                 if (right < left) {
+                     right += 360.0;
+                 }
+                 // Arc from the left to the right bound, clockwise, in steps of at most 10 degrees
+                 int steps = static_cast<int>(std::ceil((right - left) / 10.0));
+                 fence.vertices.emplace_back(latitude, longitude);
+                 for (int step = 0; step <= steps; ++step) {
+                     double bearing = (left + (right - left) * step / steps) * kPi / 180.0;
+                     fence.vertices.push_back(offset(latitude, longitude,
+                                                     radius * std::sin(bearing),
+                                                     radius * std::cos(bearing)));
+                 }
+                 break;
+             }
+
+             case AreaShape::POLYGON:
+                 // A polygon continues through the following polygon sub-areas
+                 for (; i < subareas.size() && subareas[i].shape_type == AreaShape::POLYGON; ++i) {
+                     const auto& part = subareas[i];
+                     fence.vertices.emplace_back(part.latitude / kAreaNoticeScale, part.longitude / kAreaNoticeScale);
+                     for (int j = 0; j < 4; j += 2) {
+                         if (part.params.points.angles[j] == 0 && part.params.points.angles[j + 1] == 0) {
+                             continue;
+                         }
+                         fence.vertices.emplace_back(part.params.points.angles[j + 1] / kAreaNoticeScale,
+                                                     part.params.points.angles[j] / kAreaNoticeScale);
+                     }
+                 }
+                 --i;
+                 fence.vertices.erase(std::remove_if(fence.vertices.begin(), fence.vertices.end(),
+                                                     [](const std::pair<double, double>& vertex) {
+                                                         return !valid_position(vertex.first, vertex.second);
+                                                     }),
+                                      fence.vertices.end());
+                 if (fence.vertices.size() < 3) {
+                     continue;
+                 }
+                 break;
+
+             case AreaShape::POLYLINE:
+             case AreaShape::TEXT:
+             case AreaShape::RESERVED_6:
+             case AreaShape::RESERVED_7:
+                 continue;
+         }
+         pending.push_back(std::move(fence));
+     }
+
+     for (size_t i = 0; i < pending.size(); ++i) {
+         if (fence_index_.count(first_id + static_cast<uint32_t>(i)) != 0) {
+             throw std::invalid_argument("Geofence ID already in use");
+         }
+     }
+     for (size_t i = 0; i < pending.size(); ++i) {
+         uint32_t id = first_id + static_cast<uint32_t>(i);
+         if (pending[i].circle) {
+             add_circle(id, pending[i].latitude, pending[i].longitude, pending[i].radius);
+         } else {
+             add_polygon(id, pending[i].vertices);
+         }
+     }
+     return pending.size();
+ }
+
+ bool GeofenceEngine::remove_fence(uint32_t id) {
+     auto it = fence_index_.find(id);
+     if (it == fence_index_.end()) {
+         return false;
+     }
+     uint32_t index = it->second;
+     Fence& fence = fences_[index];
+     fence_index_.erase(it);
+     fence.removed = true;
+     --stats_.fences;
+
+     if (fence.wide) {
+         wide_.erase(std::find(wide_.begin(), wide_.end(), index));
+         return true;
+     }
+     int64_t columns[2][2];
+     size_t ranges = column_ranges(fence, columns);
+     for (int64_t row = cell_coordinate(fence.min_lat); row <= cell_coordinate(fence.max_lat); ++row) {
+         for (size_t range = 0; range < ranges; ++range) {
+             for (int64_t column = columns[range][0]; column <= columns[range][1]; ++column) {
+                 auto cell = cells_.find(cell_key(row, column));
+                 if (cell == cells_.end()) {
+                     continue;
+                 }
+                 auto& list = cell->second;
+                 list.erase(std::remove(list.begin(), list.end(), index), list.end());
+                 if (list.empty()) {
+                     cells_.erase(cell);
+                 }
+             }
+         }
+     }
+     return true;
+ }
+
+ bool GeofenceEngine::contains(uint32_t id, double latitude, double longitude) const {
+     auto it = fence_index_.find(id);
+     return it != fence_index_.end() && inside(fences_[it->second], latitude, longitude);
+ }
+
+ size_t GeofenceEngine::update(uint32_t mmsi, double latitude, double longitude, double time,
+                               std::vector<GeofenceEvent>& events) {
+     if (!valid_position(latitude, longitude)) {
+         return 0;
+     }
+
+     auto vessel = vessels_.find(mmsi);
+     if (vessel != vessels_.end() && time < vessel->second.last_time) {
+         ++stats_.out_of_order;
+         return 0;
+     }
+     ++stats_.evaluations;
+
+     hits_.clear();
+     auto cell = cells_.find(cell_key(cell_coordinate(latitude), cell_coordinate(longitude)));
+     if (cell != cells_.end()) {
+         stats_.candidates += cell->second.size();
+         for (uint32_t index : cell->second) {
+             if (inside(fences_[index], latitude, longitude)) {
+                 hits_.push_back(index);
+             }
+         }
+     }
+     stats_.candidates += wide_.size();
+     for (uint32_t index : wide_) {
+         if (inside(fences_[index], latitude, longitude)) {
+             hits_.push_back(index);
+         }
+     }
+
+     // Vessels outside every fence hold no state
+     if (vessel == vessels_.end()) {
+         if (hits_.empty()) {
+             return 0;
+         }
+         vessel = vessels_.emplace(mmsi, Vessel()).first;
+     }
+     vessel->second.last_time = time;
+
+     size_t emitted = 0;
+     auto emit = [&](GeofenceEvent::Type type, const Membership& membership) {
+         GeofenceEvent event;
+         event.type = type;
+         event.mmsi = mmsi;
+         event.fence_id = fences_[membership.fence].id;
+         event.time = time;
+         event.enter_time = membership.enter_time;
+         events.push_back(event);
+         ++emitted;
+     };
+
+     auto& inside_list = vessel->second.inside;
+     size_t kept = 0;
+     for (size_t i = 0; i < inside_list.size(); ++i) {
+         Membership& membership = inside_list[i];
+         if (fences_[membership.fence].removed) {
+             continue;
+         }
+         auto hit = std::find(hits_.begin(), hits_.end(), membership.fence);
+         if (hit == hits_.end()) {
+             emit(GeofenceEvent::Type::EXIT, membership);
+             continue;
+         }
+         // Still inside: the fence needs no ENTER event
+         *hit = hits_.back();
+         hits_.pop_back();
+         if (config_.dwell_time > 0.0 && !membership.dwell_reported &&
+             time - membership.enter_time >= config_.dwell_time) {
+             membership.dwell_reported = true;
+             emit(GeofenceEvent::Type::DWELL, membership);
+         }
+         inside_list[kept++] = membership;
+     }
+     inside_list.resize(kept);
+
+     for (uint32_t index : hits_) {
+         Membership membership;
+         membership.fence = index;
+         membership.enter_time = time;
+         membership.dwell_reported = false;
+         inside_list.push_back(membership);
+         emit(GeofenceEvent::Type::ENTER, membership);
+     }
+
+     if (inside_list.empty()) {
+         vessels_.erase(vessel);
+     }
+     stats_.events += emitted;
+     return emitted;
+ }
+
+ size_t GeofenceEngine::update(const AISMessage& message, double time, std::vector<GeofenceEvent>& events) {
+     if (auto* class_a = dynamic_cast<const PositionReportClassA*>(&message)) {
+         return update(class_a->get_mmsi(), class_a->get_latitude(), class_a->get_longitude(), time, events);
+     }
+     // Covers type 19, which derives from type 18
+     if (auto* class_b = dynamic_cast<const StandardPositionReportClassB*>(&message)) {
+         return update(class_b->get_mmsi(), class_b->get_latitude(), class_b->get_longitude(), time, events);
+     }
+     return 0;
+ }
+
+ size_t GeofenceEngine::expire(double now, std::vector<GeofenceEvent>& events) {
+     size_t emitted = 0;
+     for (auto it = vessels_.begin(); it != vessels_.end();) {
+         const Vessel& vessel = it->second;
+         if (now - vessel.last_time < config_.state_timeout) {
+             ++it;
+             continue;
+         }
+         for (const Membership& membership : vessel.inside) {
+             if (fences_[membership.fence].removed) {
+                 continue;
+             }
+             GeofenceEvent event;
+             event.type = GeofenceEvent::Type::EXIT;
+             event.mmsi = it->first;
+             event.fence_id = fences_[membership.fence].id;
+             event.time = now;
+             event.enter_time = membership.enter_time;
+             events.push_back(event);
+             ++emitted;
+         }
+         it = vessels_.erase(it);
+     }
+     stats_.events += emitted;
+     return emitted;
+ }
+
+ std::vector<uint32_t> GeofenceEngine::get_fences(uint32_t mmsi) const {
+     std::vector<uint32_t> ids;
+     auto it = vessels_.find(mmsi);
+     if (it == vessels_.end()) {
+         return ids;
+     }
+     for (const Membership& membership : it->second.inside) {
+         if (!fences_[membership.fence].removed) {
+             ids.push_back(fences_[membership.fence].id);
+         }
+     }
+     return ids;
+ }
+
+ void GeofenceEngine::clear_vessels() {
+     vessels_.clear();
+ }
+
+ void GeofenceEngine::clear() {
+     fences_.clear();
+     vertex_lat_.clear();
+     vertex_lon_.clear();
+     fence_index_.clear();
+     cells_.clear();
+     wide_.clear();
+     vessels_.clear();
+     stats_.fences = 0;
+ }
+
+ GeofenceEngine::Stats GeofenceEngine::get_stats() const {
+     Stats stats = stats_;
+     stats.vessels = vessels_.size();
+     return stats;
+ }
+
+ void GeofenceEngine::insert(Fence& fence) {
+     if (fence_index_.count(fence.id) != 0) {
+         throw std::invalid_argument("Geofence ID already in use");
+     }
+
+     uint32_t index = static_cast<uint32_t>(fences_.size());
+     int64_t first_row = cell_coordinate(fence.min_lat);
+     int64_t last_row = cell_coordinate(fence.max_lat);
+     int64_t columns[2][2];
+     size_t ranges = column_ranges(fence, columns);
+     double column_count = 0.0;
+     for (size_t range = 0; range < ranges; ++range) {
+         column_count += static_cast<double>(columns[range][1] - columns[range][0] + 1);
+     }
+     double cells = static_cast<double>(last_row - first_row + 1) * column_count;
+
+     fence.removed = false;
+     fence.wide = cells > static_cast<double>(config_.max_cells_per_fence);
+     if (fence.wide) {
+         wide_.push_back(index);
+     } else {
+         for (int64_t row = first_row; row <= last_row; ++row) {
+             for (size_t range = 0; range < ranges; ++range) {
+                 for (int64_t column = columns[range][0]; column <= columns[range][1]; ++column) {
+                     cells_[cell_key(row, column)].push_back(index);
+                 }
+             }
+         }
+     }
+
+     fences_.push_back(fence);
+     fence_index_.emplace(fence.id, index);
+     ++stats_.fences;
+ }
+
+ bool GeofenceEngine::inside(const Fence& fence, double latitude, double longitude) const {
+     // West of the fence may still be inside it, past the 180th meridian
+     if (longitude < fence.min_lon) {
+         longitude += 360.0;
+     }
+     if (latitude < fence.min_lat || latitude > fence.max_lat ||
+         longitude < fence.min_lon || longitude > fence.max_lon) {
+         return false;
+     }
+
+     if (fence.shape == Shape::CIRCLE) {
+         double north = (latitude - fence.center_lat) * kMetersPerDegree;
+         double east = wrap_longitude(longitude - fence.center_lon) * fence.meters_per_degree_lon;
+         return north * north + east * east <= fence.radius_squared;
+     }
+
+     // Even-odd rule: count the edges crossed by a ray running east from the point
+     const double* lat = vertex_lat_.data() + fence.first_vertex;
+     const double* lon = vertex_lon_.data() + fence.first_vertex;
+     bool result = false;
+     for (uint32_t i = 0, j = fence.vertex_count - 1; i < fence.vertex_count; j = i++) {
+         if ((lat[i] > latitude) != (lat[j] > latitude) &&
+             longitude < lon[i] + (latitude - lat[i]) * (lon[j] - lon[i]) / (lat[j] - lat[i])) {
+             result = !result;
+         }
+     }
+     return result;
+ }
+
+ size_t GeofenceEngine::column_ranges(const Fence& fence, int64_t columns[2][2]) const {
+     columns[0][0] = cell_coordinate(fence.min_lon);
+     columns[0][1] = cell_coordinate(std::min(fence.max_lon, 180.0));
+     if (fence.max_lon <= 180.0) {
+         return 1;
+     }
+     // The part past the 180th meridian is indexed from 180 degrees west
+     columns[1][0] = cell_coordinate(-180.0);
+     columns[1][1] = cell_coordinate(fence.max_lon - 360.0);
+     return 2;
+ }
+
+ int64_t GeofenceEngine::cell_coordinate(double degrees) const {
+     return static_cast<int64_t>(std::floor(degrees / config_.cell_size));
+ }
+
+ uint64_t GeofenceEngine::cell_key(int64_t row, int64_t column) {
+     return (static_cast<uint64_t>(static_cast<uint32_t>(row)) << 32) | static_cast<uint32_t>(column);
+ }
+
+ } // namespace aislib
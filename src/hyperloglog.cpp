@@ -0,0 +1,142 @@
+/**
+ * @file hyperloglog.cpp
+ * @brief Implementation of HyperLogLog
+ */
+
+ #include "aislib/hyperloglog.h"
+ #include <algorithm>
+ #include <cmath>
+ #include <stdexcept>
+
+ namespace aislib {
+
+ const uint8_t HyperLogLog::MIN_PRECISION;
+ const uint8_t HyperLogLog::MAX_PRECISION;
+
+ namespace {
+
+ // Bias correction constant of the raw estimate (Flajolet et al., 2007)
+ double alpha(double registers) {
+     if (registers <= 16.0) {
+         return 0.673;
+     }
+     if (registers <= 32.0) {
+         return 0.697;
+     }
+     if (registers <= 64.0) {
+         return 0.709;
+     }
+     return 0.7213 / (1.0 + 1.079 / registers);
+ }
+
+ } // anonymous namespace
+
+ HyperLogLog::HyperLogLog(uint8_t precision)
+     : precision_(precision) {
+     if (precision < MIN_PRECISION || precision > MAX_PRECISION) {
+         throw std::invalid_argument("HyperLogLog precision must be between 4 and 16");
+     }
+ }
+
+ void HyperLogLog::add(uint64_t hash) {
+     uint32_t index = static_cast<uint32_t>(hash >> (64 - precision_));
+     // Rank is the position of the first set bit after the index; the guard bit caps it
+     uint64_t rest = (hash << precision_) | (1ULL << (precision_ - 1));
+     uint8_t rank = static_cast<uint8_t>(__builtin_clzll(rest) + 1);
+     set_register(index, rank);
+ }
+
+ void HyperLogLog::set_register(uint32_t index, uint8_t rank) {
+     if (!registers_.empty()) {
+         registers_[index] = std::max(registers_[index], rank);
+         return;
+     }
+     for (uint32_t& entry : sparse_) {
+         if ((entry >> 8) == index) {
+             if ((entry & 0xFF) < rank) {
+                 entry = (index << 8) | rank;
+             }
+             return;
+         }
+     }
+     sparse_.push_back((index << 8) | rank);
+     // Four bytes per sparse entry against one per dense register
+     if (sparse_.size() > (size_t(1) << precision_) / 4) {
+         densify();
+     }
+ }
+
+ void HyperLogLog::densify() {
+     registers_.assign(size_t(1) << precision_, 0);
+     for (uint32_t entry : sparse_) {
+         registers_[entry >> 8] = static_cast<uint8_t>(entry & 0xFF);
+     }
+     sparse_.clear();
+     sparse_.shrink_to_fit();
+ }
+
+ void HyperLogLog::merge(const HyperLogLog& other) {
+     if (other.precision_ != precision_) {
+         throw std::invalid_argument("Cannot merge HyperLogLog sketches of different precision");
+     }
+     if (other.registers_.empty()) {
+         for (uint32_t entry : other.sparse_) {
+             set_register(entry >> 8, static_cast<uint8_t>(entry & 0xFF));
+         }
+         return;
+     }
+     if (registers_.empty()) {
+         densify();
+     }
+     for (size_t i = 0; i < registers_.size(); ++i) {
+         registers_[i] = std::max(registers_[i], other.registers_[i]);
+     }
+ }
+
+ double HyperLogLog::estimate() const {
+     const double registers = static_cast<double>(size_t(1) << precision_);
+     double sum = 0.0;
+     size_t zeros = 0;
+     if (registers_.empty()) {
+         zeros = (size_t(1) << precision_) - sparse_.size();
+         sum = static_cast<double>(zeros);
+         for (uint32_t entry : sparse_) {
+             sum += std::ldexp(1.0, -static_cast<int>(entry & 0xFF));
+         }
+     } else {
+         for (uint8_t rank : registers_) {
+             sum += std::ldexp(1.0, -static_cast<int>(rank));
+             zeros += rank == 0;
+         }
+     }
+
+     double raw = alpha(registers) * registers * registers / sum;
+     // Linear counting is more accurate for small counts; a 64-bit hash needs no large-range correction
+     if (raw <= 2.5 * registers && zeros > 0) {
+         return registers * std::log(registers / static_cast<double>(zeros));
+     }
+     return raw;
+ }
+
+ uint8_t HyperLogLog::get_precision() const {
+     return precision_;
+ }
+
+ bool HyperLogLog::is_sparse() const {
+     return registers_.empty();
+ }
+
+ void HyperLogLog::clear() {
+     sparse_.clear();
+     registers_.clear();
+ }
+
+ uint64_t HyperLogLog::hash(uint32_t key) {
+     // splitmix64 finalizer
+     uint64_t h = key + 0x9E3779B97F4A7C15ULL;
+     h = (h ^ (h >> 30)) * 0xBF58476D1CE4E5B9ULL;
+     h = (h ^ (h >> 27)) * 0x94D049BB133111EBULL;
+     return h ^ (h >> 31);
+ }
+
+ } // namespace aislib
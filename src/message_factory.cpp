@@ -4,8 +4,12 @@
  */
 
  #include "aislib/message_factory.h"
+ #include "aislib/position_report_class_a.h"
+ #include "aislib/base_station_report.h"
  #include "aislib/position_report_class_b.h"
  #include "aislib/static_data.h"
+ #include "aislib/static_data_report.h"
+ #include "aislib/tracing.h"
  #include <stdexcept>
  
  namespace aislib {
@@ -17,6 +21,22 @@
  
  MessageFactory::MessageFactory() {
      // Register message types implemented so far
+     register_message_type(1, [](const BitVector& bits) {
+         return std::make_unique<PositionReportClassA>(bits);
+     });
+     
+     register_message_type(2, [](const BitVector& bits) {
+         return std::make_unique<PositionReportClassA>(bits);
+     });
+     
+     register_message_type(3, [](const BitVector& bits) {
+         return std::make_unique<PositionReportClassA>(bits);
+     });
+     
+     register_message_type(4, [](const BitVector& bits) {
+         return std::make_unique<BaseStationReport>(bits);
+     });
+     
      register_message_type(18, [](const BitVector& bits) {
          return std::make_unique<StandardPositionReportClassB>(bits);
      });
@@ -28,6 +48,10 @@
      register_message_type(5, [](const BitVector& bits) {
          return std::make_unique<StaticAndVoyageData>(bits);
      });
+
+     register_message_type(24, [](const BitVector& bits) {
+         return std::make_unique<StaticDataReport>(bits);
+     });
  
      // Additional message types will be registered as they are implemented
  }
@@ -42,12 +66,17 @@
      uint8_t message_type = static_cast<uint8_t>(bits.get_uint(0, 6));
      
      // Find the constructor for this message type
-     auto it = constructors_.find(message_type);
+     auto it = constructors_.end();
+     {
+         AISLIB_TRACE_SCOPE_ARG(FACTORY_DISPATCH, message_type);
+         it = constructors_.find(message_type);
+     }
      if (it == constructors_.end()) {
          throw std::invalid_argument("Unsupported message type: " + std::to_string(message_type));
      }
      
      // Create the message using the constructor
+     AISLIB_TRACE_SCOPE_ARG(DECODE, message_type);
      return it->second(bits);
  }
  
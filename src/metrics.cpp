@@ -0,0 +1,255 @@
+/**
+ * @file metrics.cpp
+ * @brief Implementation of MetricsRegistry and the Prometheus renderer
+ */
+
+ #include "aislib/metrics.h"
+ #include <algorithm>
+ #include <sstream>
+ #include <thread>
+
+ namespace aislib {
+
+ namespace {
+
+ // Index of the highest set bit (value must be non-zero)
+ unsigned highest_bit(uint64_t value) {
+ #if defined(__GNUC__) || defined(__clang__)
+     return 63u - static_cast<unsigned>(__builtin_clzll(value));
+ #else
+     unsigned bit = 0;
+     while (value >>= 1) {
+         ++bit;
+     }
+     return bit;
+ #endif
+ }
+
+ // Snake-case names of AISParser::ParseError::ErrorType values
+ const char* const kErrorNames[MetricsSnapshot::kErrorTypeCount] = {
+     "none",
+     "invalid_checksum",
+     "invalid_sentence_format",
+     "invalid_fragment_info",
+     "unsupported_message_type",
+     "invalid_payload",
+     "other"
+ };
+
+ void write_counter(std::ostream& out, const std::string& name, const char* help, uint64_t value) {
+     out << "# HELP " << name << " " << help << "\n";
+     out << "# TYPE " << name << " counter\n";
+     out << name << " " << value << "\n";
+ }
+
+ void write_histogram(std::ostream& out, const std::string& name, const char* help, const HistogramSnapshot& histogram) {
+     out << "# HELP " << name << " " << help << "\n";
+     out << "# TYPE " << name << " histogram\n";
+
+     // Power-of-two boundaries from 256 ns to 64 s, every other power; each is the
+     // inclusive upper bound of an internal bucket, so le counts are exact
+     size_t bucket = 0;
+     uint64_t cumulative = 0;
+     for (unsigned exponent = 8; exponent <= 36; exponent += 2) {
+         uint64_t bound = uint64_t{1} << exponent;
+         while (bucket < histogram.counts.size() && HistogramSnapshot::bucket_upper_bound(bucket) <= bound) {
+             cumulative += histogram.counts[bucket++];
+         }
+         out << name << "_bucket{le=\"" << static_cast<double>(bound) * 1e-9 << "\"} " << cumulative << "\n";
+     }
+     out << name << "_bucket{le=\"+Inf\"} " << histogram.total_count << "\n";
+     out << name << "_sum " << static_cast<double>(histogram.sum) * 1e-9 << "\n";
+     out << name << "_count " << histogram.total_count << "\n";
+ }
+
+ } // anonymous namespace
+
+ size_t HistogramSnapshot::bucket_index(uint64_t value) {
+     if (value <= 16) {
+         return static_cast<size_t>(value);
+     }
+
+     // Buckets above 16 include their upper end, so they are found from value - 1
+     uint64_t below = value - 1;
+     unsigned exponent = highest_bit(below);
+     if (exponent >= 40) {
+         return MetricsRegistry::kHistogramBuckets - 1;
+     }
+
+     // The four bits below the highest set bit select the sub-bucket
+     size_t sub_bucket = static_cast<size_t>((below >> (exponent - 4)) & 15);
+     return 17 + (exponent - 4) * 16 + sub_bucket;
+ }
+
+ uint64_t HistogramSnapshot::bucket_upper_bound(size_t index) {
+     if (index <= 16) {
+         return index;
+     }
+
+     size_t exponent = (index - 17) / 16 + 4;
+     uint64_t sub_bucket = (index - 17) % 16;
+     uint64_t lower = (16 + sub_bucket) << (exponent - 4);
+     return lower + (uint64_t{1} << (exponent - 4));
+ }
+
+ uint64_t HistogramSnapshot::value_at_quantile(double quantile) const {
+     if (total_count == 0) {
+         return 0;
+     }
+
+     quantile = std::min(std::max(quantile, 0.0), 1.0);
+     uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(quantile * static_cast<double>(total_count) + 0.5));
+
+     uint64_t cumulative = 0;
+     for (size_t i = 0; i < counts.size(); ++i) {
+         cumulative += counts[i];
+         if (cumulative >= rank) {
+             return bucket_upper_bound(i);
+         }
+     }
+     return bucket_upper_bound(counts.size() - 1);
+ }
+
+ uint64_t MetricsSnapshot::total_messages() const {
+     uint64_t total = 0;
+     for (uint64_t count : messages_by_type) {
+         total += count;
+     }
+     return total;
+ }
+
+ uint64_t MetricsSnapshot::total_errors() const {
+     uint64_t total = 0;
+     for (uint64_t count : errors) {
+         total += count;
+     }
+     return total;
+ }
+
+ MetricsRegistry::MetricsRegistry(size_t shard_count) {
+     if (shard_count == 0) {
+         shard_count = std::max(1u, std::thread::hardware_concurrency());
+     }
+
+     // Round up to a power of two so the shard can be selected with a mask
+     size_t rounded = 1;
+     while (rounded < shard_count) {
+         rounded <<= 1;
+     }
+
+     shards_.reset(new Shard[rounded]());
+     shard_mask_ = rounded - 1;
+ }
+
+ size_t MetricsRegistry::thread_slot() {
+     static std::atomic<size_t> next_slot{0};
+     static thread_local size_t slot = next_slot.fetch_add(1, std::memory_order_relaxed);
+     return slot;
+ }
+
+ MetricsSnapshot MetricsRegistry::snapshot() const {
+     MetricsSnapshot result;
+     result.parse_latency.counts.assign(kHistogramBuckets, 0);
+     result.reassembly_dwell.counts.assign(kHistogramBuckets, 0);
+
+     auto load = [](const std::atomic<uint64_t>& counter) {
+         return counter.load(std::memory_order_relaxed);
+     };
+
+     for (size_t i = 0; i <= shard_mask_; ++i) {
+         const Shard& s = shards_[i];
+         result.sentences += load(s.sentences);
+         for (size_t type = 0; type < s.messages_by_type.size(); ++type) {
+             result.messages_by_type[type] += load(s.messages_by_type[type]);
+         }
+         for (size_t error = 0; error < s.errors.size(); ++error) {
+             result.errors[error] += load(s.errors[error]);
+         }
+         result.multipart_completed += load(s.multipart_completed);
+         result.multipart_evicted += load(s.multipart_evicted);
+         result.multipart_expired += load(s.multipart_expired);
+         result.decode_cache_hits += load(s.decode_cache_hits);
+         result.decode_cache_misses += load(s.decode_cache_misses);
+         result.parse_latency.sum += load(s.parse_latency_sum);
+         result.reassembly_dwell.sum += load(s.reassembly_dwell_sum);
+         for (size_t bucket = 0; bucket < kHistogramBuckets; ++bucket) {
+             result.parse_latency.counts[bucket] += load(s.parse_latency[bucket]);
+             result.reassembly_dwell.counts[bucket] += load(s.reassembly_dwell[bucket]);
+         }
+     }
+
+     for (size_t bucket = 0; bucket < kHistogramBuckets; ++bucket) {
+         result.parse_latency.total_count += result.parse_latency.counts[bucket];
+         result.reassembly_dwell.total_count += result.reassembly_dwell.counts[bucket];
+     }
+
+     return result;
+ }
+
+ void MetricsRegistry::reset() {
+     auto clear = [](std::atomic<uint64_t>& counter) {
+         counter.store(0, std::memory_order_relaxed);
+     };
+
+     for (size_t i = 0; i <= shard_mask_; ++i) {
+         Shard& s = shards_[i];
+         clear(s.sentences);
+         std::for_each(s.messages_by_type.begin(), s.messages_by_type.end(), clear);
+         std::for_each(s.errors.begin(), s.errors.end(), clear);
+         clear(s.multipart_completed);
+         clear(s.multipart_evicted);
+         clear(s.multipart_expired);
+         clear(s.decode_cache_hits);
+         clear(s.decode_cache_misses);
+         clear(s.parse_latency_sum);
+         clear(s.reassembly_dwell_sum);
+         std::for_each(s.parse_latency.begin(), s.parse_latency.end(), clear);
+         std::for_each(s.reassembly_dwell.begin(), s.reassembly_dwell.end(), clear);
+     }
+ }
+
+ size_t MetricsRegistry::get_shard_count() const {
+     return shard_mask_ + 1;
+ }
+
+ std::string to_prometheus(const MetricsSnapshot& snapshot, const std::string& prefix) {
+     std::stringstream out;
+
+     write_counter(out, prefix + "_sentences_total", "NMEA sentences passed to the parser.", snapshot.sentences);
+
+     out << "# HELP " << prefix << "_messages_decoded_total Decoded AIS messages by message type.\n";
+     out << "# TYPE " << prefix << "_messages_decoded_total counter\n";
+     for (size_t type = 0; type < snapshot.messages_by_type.size(); ++type) {
+         if (snapshot.messages_by_type[type] > 0) {
+             out << prefix << "_messages_decoded_total{type=\"" << type << "\"} "
+                 << snapshot.messages_by_type[type] << "\n";
+         }
+     }
+
+     out << "# HELP " << prefix << "_parse_errors_total Sentences rejected by the parser by error type.\n";
+     out << "# TYPE " << prefix << "_parse_errors_total counter\n";
+     for (size_t error = 1; error < snapshot.errors.size(); ++error) {
+         out << prefix << "_parse_errors_total{error=\"" << kErrorNames[error] << "\"} "
+             << snapshot.errors[error] << "\n";
+     }
+
+     write_counter(out, prefix + "_multipart_completed_total", "Multi-part messages reassembled.",
+                   snapshot.multipart_completed);
+     write_counter(out, prefix + "_multipart_evicted_total", "Incomplete multi-part messages evicted by the size limit.",
+                   snapshot.multipart_evicted);
+     write_counter(out, prefix + "_multipart_expired_total", "Incomplete multi-part messages dropped after the timeout.",
+                   snapshot.multipart_expired);
+     write_counter(out, prefix + "_decode_cache_hits_total", "Messages answered by the decode cache.",
+                   snapshot.decode_cache_hits);
+     write_counter(out, prefix + "_decode_cache_misses_total", "Cacheable messages decoded because they were not cached.",
+                   snapshot.decode_cache_misses);
+
+     write_histogram(out, prefix + "_parse_latency_seconds", "Time spent parsing one sentence.",
+                     snapshot.parse_latency);
+     write_histogram(out, prefix + "_reassembly_dwell_seconds", "Time from first fragment to completed message.",
+                     snapshot.reassembly_dwell);
+
+     return out.str();
+ }
+
+ } // namespace aislib
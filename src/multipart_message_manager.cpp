@@ -4,6 +4,8 @@
  */
 
  #include "aislib/multipart_message_manager.h"
+ #include "aislib/metrics.h"
+ #include "aislib/tracing.h"
  #include <stdexcept>
  #include <algorithm>
  
@@ -19,7 +21,7 @@
  MultipartMessageManager::MultipartMessageManager(
      std::chrono::seconds timeout,
      size_t max_messages
- ) : timeout_(timeout), max_messages_(max_messages) {
+ ) : timeout_(timeout), max_messages_(max_messages), metrics_(nullptr) {
  }
  
  std::optional<BitVector> MultipartMessageManager::add_fragment(
@@ -58,7 +60,8 @@
         // Create a new message info
         MessageInfo info;
         info.fragments.resize(fragment_count);
-        info.last_update = std::chrono::steady_clock::now();
+        info.first_received = std::chrono::steady_clock::now();
+        info.last_update = info.first_received;
         info.received_count = 0;
         
         // Initialize all fragments as not received
@@ -85,6 +88,10 @@
             // Remove the oldest message
             if (oldest_it != messages_.end()) {
                 messages_.erase(oldest_it);
+                
+                if (metrics_) {
+                    metrics_->record_multipart_evicted();
+                }
             }
         }
     }
@@ -109,6 +116,10 @@
         // Combine all fragments
         BitVector combined = combine_fragments(info.fragments);
         
+        if (metrics_) {
+            metrics_->record_multipart_completed(info.last_update - info.first_received);
+        }
+        
         // Remove the message from the map
         messages_.erase(it);
         
@@ -122,16 +133,22 @@
  
  void MultipartMessageManager::cleanup_expired() {
      auto now = std::chrono::steady_clock::now();
+     uint64_t expired = 0;
      
      for (auto it = messages_.begin(); it != messages_.end();) {
          auto elapsed = now - it->second.last_update;
          
          if (elapsed > timeout_) {
              it = messages_.erase(it);
+             ++expired;
          } else {
              ++it;
          }
      }
+     
+     if (metrics_ && expired > 0) {
+         metrics_->record_multipart_expired(expired);
+     }
  }
  
  void MultipartMessageManager::clear() {
@@ -169,10 +186,20 @@
         for (size_t i = 0; i < to_remove; ++i) {
             messages_.erase(time_sorted[i].second);
         }
+        
+        if (metrics_) {
+            metrics_->record_multipart_evicted(to_remove);
+        }
     }
 }
  
+ void MultipartMessageManager::set_metrics(MetricsRegistry* metrics) {
+     metrics_ = metrics;
+ }
+ 
 BitVector MultipartMessageManager::combine_fragments(const std::vector<Fragment>& fragments) {
+    AISLIB_TRACE_SCOPE_ARG(MULTIPART_COMPLETE, fragments.size());
+    
     BitVector combined;
     
     // Calculate the total size needed (excluding fill bits in the last fragment)
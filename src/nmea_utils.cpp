@@ -4,16 +4,18 @@
  */
 
  #include "aislib/nmea_utils.h"
+ #include "aislib/tracing.h"
+ #include "aislib/cpu_dispatch.h"
  #include <sstream>
  #include <iomanip>
  #include <stdexcept>
+ #include <cmath>
+ #include <cstdlib>
  
  namespace aislib {
  
     uint8_t NMEAUtils::calculate_checksum(const std::string& sentence) {
         // Checksum is XOR of all characters between '$' or '!' and '*'
-        uint8_t checksum = 0;
-        
         // Start after the first character if it's $ or !
         size_t start_pos = 0;
         if (!sentence.empty() && (sentence[0] == '$' || sentence[0] == '!')) {
@@ -27,59 +29,138 @@
         }
         
         // XOR all characters
-        for (size_t i = start_pos; i < end_pos; ++i) {
-            checksum ^= static_cast<uint8_t>(sentence[i]);
-        }
-        
-        return checksum;
+        return cpu::kernels().xor_bytes(sentence.data() + start_pos, end_pos - start_pos);
     }
  
     bool NMEAUtils::validate_checksum(const std::string& sentence) {
+        AISLIB_TRACE_SCOPE(CHECKSUM);
+        
         // Find the '*' character that precedes the checksum
         size_t asterisk_pos = sentence.find('*');
         if (asterisk_pos == std::string::npos || asterisk_pos + 3 > sentence.length()) {
             return false; // No checksum or not enough characters for checksum
         }
         
-        // Extract the checksum from the sentence
-        std::string checksum_str = sentence.substr(asterisk_pos + 1, 2);
-        uint8_t expected_checksum;
+        // Extract the checksum from the sentence (one or two hex digits)
+        auto hex_value = [](char c) -> int {
+            if (c >= '0' && c <= '9') return c - '0';
+            if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+            if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+            return -1;
+        };
         
-        try {
-            expected_checksum = static_cast<uint8_t>(std::stoi(checksum_str, nullptr, 16));
-        } catch (const std::exception&) {
+        int high = hex_value(sentence[asterisk_pos + 1]);
+        int low = hex_value(sentence[asterisk_pos + 2]);
+        if (high < 0) {
             return false; // Invalid checksum format
         }
+        uint8_t expected_checksum = static_cast<uint8_t>(low < 0 ? high : high * 16 + low);
         
-        // Calculate the actual checksum from the part of the sentence before the asterisk
-        std::string sentence_part = sentence.substr(0, asterisk_pos);
-        uint8_t actual_checksum = calculate_checksum(sentence_part);
+        // Calculate the actual checksum in place; calculate_checksum would need a copy
+        size_t start_pos = (sentence[0] == '$' || sentence[0] == '!') ? 1 : 0;
+        uint8_t actual_checksum = cpu::kernels().xor_bytes(sentence.data() + start_pos, asterisk_pos - start_pos);
         
         return actual_checksum == expected_checksum;
     }
  
  std::vector<std::string> NMEAUtils::parse_fields(const std::string& sentence) {
      std::vector<std::string> fields;
+     parse_fields(sentence, fields);
+     return fields;
+ }
+ 
+ void NMEAUtils::parse_fields(const std::string& sentence, std::vector<std::string>& fields) {
+     AISLIB_TRACE_SCOPE(SENTENCE_SCAN);
+     
+     // Ignore the checksum part
+     size_t end = sentence.find('*');
+     if (end == std::string::npos) {
+         end = sentence.length();
+     }
      
-     // Remove checksum part
-     size_t asterisk_pos = sentence.find('*');
-     std::string sentence_without_checksum;
+     // Locate the commas with the dispatched kernel; AIVDM has six, so the
+     // fixed buffer only overflows for unusual sentences, which fall back to find
+     uint32_t commas[32];
+     const size_t max_commas = sizeof(commas) / sizeof(commas[0]);
+     size_t comma_count = cpu::kernels().find_all(sentence.data(), end, ',', commas, max_commas);
      
-     if (asterisk_pos != std::string::npos) {
-         sentence_without_checksum = sentence.substr(0, asterisk_pos);
-     } else {
-         sentence_without_checksum = sentence;
+     // Split by commas, assigning into existing strings to reuse their buffers.
+     // Like std::getline, a trailing empty field is not reported.
+     size_t count = 0;
+     size_t start = 0;
+     while (start < end) {
+         size_t comma;
+         if (count < comma_count) {
+             comma = commas[count];
+         } else if (comma_count < max_commas) {
+             comma = end;
+         } else {
+             comma = sentence.find(',', start);
+             if (comma == std::string::npos || comma > end) {
+                 comma = end;
+             }
+         }
+         
+         if (count < fields.size()) {
+             fields[count].assign(sentence, start, comma - start);
+         } else {
+             fields.emplace_back(sentence, start, comma - start);
+         }
+         ++count;
+         
+         start = comma + 1;
      }
      
-     // Split by commas
-     std::stringstream ss(sentence_without_checksum);
-     std::string field;
+     fields.resize(count);
+ }
+ 
+ size_t NMEAUtils::parse_tag_block(const std::string& line, TagBlock& tag) {
+     tag.source.clear();
+     tag.time = std::nan("");
      
-     while (std::getline(ss, field, ',')) {
-         fields.push_back(field);
+     if (line.empty() || line[0] != '\\') {
+         return 0;
      }
      
-     return fields;
+     size_t end = line.find('\\', 1);
+     if (end == std::string::npos) {
+         throw std::invalid_argument("Unterminated tag block");
+     }
+     
+     // The checksum covers the characters between the backslash and '*'
+     size_t asterisk = line.find('*', 1);
+     size_t fields_end = end;
+     if (asterisk != std::string::npos && asterisk < end) {
+         uint8_t checksum = cpu::kernels().xor_bytes(line.data() + 1, asterisk - 1);
+         char* parsed_end = nullptr;
+         std::string digits = line.substr(asterisk + 1, end - asterisk - 1);
+         unsigned long expected = std::strtoul(digits.c_str(), &parsed_end, 16);
+         if (digits.empty() || *parsed_end != '\0' || expected != checksum) {
+             throw std::invalid_argument("Invalid tag block checksum");
+         }
+         fields_end = asterisk;
+     }
+     
+     size_t start = 1;
+     while (start < fields_end) {
+         size_t comma = line.find(',', start);
+         if (comma == std::string::npos || comma > fields_end) {
+             comma = fields_end;
+         }
+         
+         if (comma - start > 2 && line[start + 1] == ':') {
+             if (line[start] == 's') {
+                 tag.source.assign(line, start + 2, comma - start - 2);
+             } else if (line[start] == 'c') {
+                 double time = std::strtod(line.substr(start + 2, comma - start - 2).c_str(), nullptr);
+                 tag.time = time > 1e11 ? time / 1000.0 : time;
+             }
+         }
+         
+         start = comma + 1;
+     }
+     
+     return end + 1;
  }
  
  std::string NMEAUtils::create_aivdm_sentence(
@@ -310,6 +310,19 @@
      raim_flag_ = raim;
  }
  
+ uint32_t PositionReportClassA::get_radio_status() const {
+     return radio_status_;
+ }
+ 
+ CommunicationState PositionReportClassA::get_communication_state() const {
+     return message_type_ == 3 ? CommunicationState::itdma(radio_status_)
+                               : CommunicationState::sotdma(radio_status_);
+ }
+ 
+ void PositionReportClassA::set_radio_status(uint32_t radio_status) {
+     radio_status_ = radio_status & 0x7FFFF;
+ }
+ 
  void PositionReportClassA::to_bits(BitVector& bits) const {
      // Clear the bit vector
      bits.clear();
@@ -175,6 +175,15 @@
      return radio_status_;
  }
  
+ CommunicationState StandardPositionReportClassB::get_communication_state() const {
+     if (cs_flag_) {
+         return CommunicationState();
+     }
+     // Communication state selector flag, then the 19-bit state
+     return (radio_status_ & 0x80000) != 0 ? CommunicationState::itdma(radio_status_ & 0x7FFFF)
+                                           : CommunicationState::sotdma(radio_status_ & 0x7FFFF);
+ }
+ 
  void StandardPositionReportClassB::set_speed_over_ground(float sog) {
      if (sog < 0.0f) {
          speed_over_ground_ = SOG_NOT_AVAILABLE;
@@ -436,7 +445,7 @@
      // Regional reserved (4 bits) - skipped
      
      // Parse the extended fields
-     vessel_name_ = bits.get_string(143, 120);
+     bits.get_string(143, 120, vessel_name_);
      ship_type_ = static_cast<uint8_t>(bits.get_uint(263, 8));
      dimension_to_bow_ = static_cast<uint16_t>(bits.get_uint(271, 9));
      dimension_to_stern_ = static_cast<uint16_t>(bits.get_uint(280, 9));
@@ -455,7 +464,7 @@
      return 19;
  }
  
- std::string ExtendedPositionReportClassB::get_vessel_name() const {
+ std::string_view ExtendedPositionReportClassB::get_vessel_name() const {
      return vessel_name_;
  }
  
@@ -483,8 +492,9 @@
      return epfd_type_;
  }
  
- void ExtendedPositionReportClassB::set_vessel_name(const std::string& name) {
-     vessel_name_ = name;
+ void ExtendedPositionReportClassB::set_vessel_name(std::string_view name) {
+     // Truncated to 20 characters (120 bits)
+     vessel_name_.assign(name);
  }
  
  void ExtendedPositionReportClassB::set_ship_type(uint8_t type) {
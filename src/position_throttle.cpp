@@ -0,0 +1,200 @@
+/**
+ * @file position_throttle.cpp
+ * @brief Implementation of PositionThrottle
+ */
+
+ #include "aislib/position_throttle.h"
+ #include "aislib/geo.h"
+ #include "aislib/position_report_class_a.h"
+ #include "aislib/position_report_class_b.h"
+ #include <algorithm>
+ #include <cmath>
+ #include <limits>
+ #include <stdexcept>
+
+ namespace aislib {
+
+ namespace {
+
+ const size_t kInitialCapacity = 1024;
+ const uint8_t kStatusNotDefined = 15;
+
+ float speed_or_nan(float speed) {
+     // 102.3 knots means not available for both classes
+     return speed >= 0.0f && speed < 102.25f ? speed : std::numeric_limits<float>::quiet_NaN();
+ }
+
+ float course_or_nan(float course) {
+     return course >= 0.0f && course < 360.0f ? course : std::numeric_limits<float>::quiet_NaN();
+ }
+
+ bool valid_position(double latitude, double longitude) {
+     return latitude >= -90.0 && latitude <= 90.0 && longitude >= -180.0 && longitude <= 180.0;
+ }
+
+ size_t slot_of(uint32_t mmsi, size_t mask) {
+     uint32_t hash = mmsi * 2654435761u;
+     return (hash ^ (hash >> 16)) & mask;
+ }
+
+ } // anonymous namespace
+
+ const uint32_t PositionThrottle::EMPTY;
+
+ PositionThrottle::PositionThrottle(const Config& config)
+     : config_(config),
+       count_(0) {
+     if (config_.interval < 0.0 || config_.min_spacing < 0.0 || config_.distance < 0.0 ||
+         config_.course_change < 0.0 || config_.speed_change < 0.0 || config_.max_age < 0.0) {
+         throw std::invalid_argument("Position throttle settings must not be negative");
+     }
+ }
+
+ size_t PositionThrottle::find(uint32_t mmsi) const {
+     const size_t mask = table_.size() - 1;
+     size_t slot = slot_of(mmsi, mask);
+     while (table_[slot].mmsi != mmsi && table_[slot].mmsi != EMPTY) {
+         slot = (slot + 1) & mask;
+     }
+     return slot;
+ }
+
+ void PositionThrottle::grow() {
+     std::vector<Entry> old;
+     old.swap(table_);
+     Entry empty = Entry();
+     empty.mmsi = EMPTY;
+     table_.assign(old.empty() ? kInitialCapacity : old.size() * 2, empty);
+     for (const Entry& entry : old) {
+         if (entry.mmsi != EMPTY) {
+             table_[find(entry.mmsi)] = entry;
+         }
+     }
+ }
+
+ void PositionThrottle::store(Entry& entry, uint32_t mmsi, double time, double latitude, double longitude,
+                              float speed, float course, uint8_t navigation_status) {
+     entry.mmsi = mmsi;
+     entry.navigation_status = navigation_status;
+     entry.speed = speed;
+     entry.course = course;
+     entry.latitude = static_cast<float>(latitude);
+     entry.longitude = static_cast<float>(longitude);
+     entry.time = time;
+ }
+
+ bool PositionThrottle::accept(uint32_t mmsi, double time, double latitude, double longitude,
+                               float speed, float course, uint8_t navigation_status) {
+     stats_.reports++;
+     if (mmsi == EMPTY) {
+         stats_.passed++;
+         return true;
+     }
+     if ((count_ + 1) * 2 > table_.size()) {
+         grow();
+     }
+
+     Entry& entry = table_[find(mmsi)];
+     if (entry.mmsi == EMPTY) {
+         store(entry, mmsi, time, latitude, longitude, speed, course, navigation_status);
+         count_++;
+         stats_.passed++;
+         return true;
+     }
+     if (time < entry.time) {
+         stats_.out_of_order++;
+         stats_.dropped++;
+         return false;
+     }
+
+     double elapsed = time - entry.time;
+     bool pass = false;
+     if (elapsed >= config_.min_spacing) {
+         pass = elapsed >= config_.interval ||
+                (config_.status_change && navigation_status != entry.navigation_status);
+         if (!pass && config_.course_change > 0.0 && !std::isnan(course) && !std::isnan(entry.course)) {
+             double turn = std::fabs(static_cast<double>(course) - entry.course);
+             pass = std::min(turn, 360.0 - turn) >= config_.course_change;
+         }
+         if (!pass && config_.speed_change > 0.0 && !std::isnan(speed) && !std::isnan(entry.speed)) {
+             pass = std::fabs(static_cast<double>(speed) - entry.speed) >= config_.speed_change;
+         }
+         if (!pass && config_.distance > 0.0 && valid_position(latitude, longitude) &&
+             valid_position(entry.latitude, entry.longitude)) {
+             pass = geo::haversine(entry.latitude, entry.longitude, latitude, longitude) >= config_.distance;
+         }
+     }
+
+     if (!pass) {
+         stats_.dropped++;
+         return false;
+     }
+     store(entry, mmsi, time, latitude, longitude, speed, course, navigation_status);
+     stats_.passed++;
+     return true;
+ }
+
+ bool PositionThrottle::accept(double time, const AISMessage& message) {
+     if (auto* class_a = dynamic_cast<const PositionReportClassA*>(&message)) {
+         return accept(class_a->get_mmsi(), time, class_a->get_latitude(), class_a->get_longitude(),
+                       speed_or_nan(class_a->get_speed_over_ground()),
+                       course_or_nan(class_a->get_course_over_ground()),
+                       static_cast<uint8_t>(class_a->get_navigation_status()));
+     }
+     // Covers type 19, which derives from type 18
+     if (auto* class_b = dynamic_cast<const StandardPositionReportClassB*>(&message)) {
+         return accept(class_b->get_mmsi(), time, class_b->get_latitude(), class_b->get_longitude(),
+                       speed_or_nan(class_b->get_speed_over_ground()),
+                       course_or_nan(class_b->get_course_over_ground()), kStatusNotDefined);
+     }
+     return true;
+ }
+
+ bool PositionThrottle::may_accept(uint32_t mmsi, double time) const {
+     if (table_.empty()) {
+         return true;
+     }
+     const Entry& entry = table_[find(mmsi)];
+     if (entry.mmsi == EMPTY || mmsi == EMPTY) {
+         return true;
+     }
+     return time >= entry.time && time - entry.time >= config_.min_spacing;
+ }
+
+ size_t PositionThrottle::expire(double now) {
+     if (count_ == 0) {
+         return 0;
+     }
+     // Survivors are reinserted so that no probe sequence runs across a removed entry
+     std::vector<Entry> old;
+     old.swap(table_);
+     Entry empty = Entry();
+     empty.mmsi = EMPTY;
+     table_.assign(old.size(), empty);
+     size_t dropped = 0;
+     for (const Entry& entry : old) {
+         if (entry.mmsi == EMPTY) {
+             continue;
+         }
+         if (now - entry.time > config_.max_age) {
+             dropped++;
+         } else {
+             table_[find(entry.mmsi)] = entry;
+         }
+     }
+     count_ -= dropped;
+     return dropped;
+ }
+
+ void PositionThrottle::clear() {
+     table_.clear();
+     count_ = 0;
+ }
+
+ PositionThrottle::Stats PositionThrottle::get_stats() const {
+     Stats stats = stats_;
+     stats.vessels = count_;
+     return stats;
+ }
+
+ } // namespace aislib
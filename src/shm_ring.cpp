@@ -0,0 +1,391 @@
+/**
+ * @file shm_ring.cpp
+ * @brief Implementation of ShmRingPublisher and ShmRingSubscriber
+ */
+
+ #include "aislib/shm_ring.h"
+ #include "aislib/position_report_class_a.h"
+ #include "aislib/position_report_class_b.h"
+ #include <algorithm>
+ #include <atomic>
+ #include <cstring>
+ #include <limits>
+ #include <new>
+ #include <stdexcept>
+
+ #ifdef __linux__
+ #include <cerrno>
+ #include <fcntl.h>
+ #include <sys/mman.h>
+ #include <sys/stat.h>
+ #include <unistd.h>
+ #endif
+
+ namespace aislib {
+
+ // Segment layout: header, slots, side data. The counters sit on their own
+ // cache lines so that readers polling them do not share a line with the
+ // constant fields.
+ struct alignas(64) ShmRingHeader {
+     std::atomic<uint64_t> magic;        // Stored last, once the segment is initialized
+     uint32_t version;
+     uint32_t slot_size;
+     uint64_t capacity;
+     uint64_t side_capacity;
+     alignas(64) std::atomic<uint64_t> published;      // Records completely written
+     alignas(64) std::atomic<uint64_t> side_reserved;  // Side bytes handed out, including skipped tails
+ };
+
+ struct alignas(64) ShmRingSlot {
+     std::atomic<uint64_t> sequence;   // 2s + 1 while record s is written, 2s + 2 once written
+     ShmRecord record;
+     uint64_t side_offset;             // Position in the side ring, counting from the start of the segment's life
+     uint32_t side_length;
+ };
+
+ static_assert(std::atomic<uint64_t>::is_always_lock_free, "Ring counters must be lock-free to be shared between processes");
+
+ namespace {
+
+ const uint64_t kMagic = 0x474E495254534941ULL;   // "AISTRING"
+ const uint32_t kVersion = 1;
+
+ bool power_of_two(size_t value) {
+     return value != 0 && (value & (value - 1)) == 0;
+ }
+
+ size_t segment_size(uint64_t capacity, uint64_t side_capacity) {
+     return sizeof(ShmRingHeader) + capacity * sizeof(ShmRingSlot) + side_capacity;
+ }
+
+ float speed_or_nan(float speed) {
+     // 102.3 knots means not available for both classes
+     return speed >= 0.0f && speed < 102.25f ? speed : std::numeric_limits<float>::quiet_NaN();
+ }
+
+ float course_or_nan(float course) {
+     return course >= 0.0f && course < 360.0f ? course : std::numeric_limits<float>::quiet_NaN();
+ }
+
+ #ifdef __linux__
+ std::runtime_error os_error(const char* what) {
+     return std::runtime_error(std::string(what) + ": " + std::strerror(errno));
+ }
+
+ std::string segment_path(const std::string& name) {
+     if (name.empty() || name.find('/') != std::string::npos) {
+         throw std::invalid_argument("Shared-memory segment name must be a non-empty file name");
+     }
+     return "/dev/shm/" + name;
+ }
+ #endif
+
+ } // anonymous namespace
+
+ // ---- ShmRingPublisher ----
+
+ ShmRingPublisher::ShmRingPublisher(const std::string& name, const Config& config)
+     : fd_(-1),
+       memory_(nullptr),
+       size_(0),
+       header_(nullptr),
+       slots_(nullptr),
+       side_(nullptr),
+       capacity_(config.capacity),
+       side_capacity_(config.side_capacity),
+       published_(0),
+       side_reserved_(0) {
+     if (!power_of_two(config.capacity) || !power_of_two(config.side_capacity)) {
+         throw std::invalid_argument("Ring capacity and side_capacity must be powers of two");
+     }
+ #ifdef __linux__
+     if (name.empty()) {
+         fd_ = memfd_create("aislib-ring", MFD_CLOEXEC);
+         if (fd_ < 0) {
+             throw os_error("Failed to create memfd segment");
+         }
+     } else {
+         path_ = segment_path(name);
+         // Replace a segment left behind by an earlier publisher; its readers keep their mapping
+         ::unlink(path_.c_str());
+         fd_ = ::open(path_.c_str(), O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0600);
+         if (fd_ < 0) {
+             throw os_error("Failed to create shared-memory segment");
+         }
+     }
+
+     size_ = segment_size(capacity_, side_capacity_);
+     if (::ftruncate(fd_, static_cast<off_t>(size_)) != 0) {
+         std::runtime_error error = os_error("Failed to size shared-memory segment");
+         ::close(fd_);
+         if (!path_.empty()) {
+             ::unlink(path_.c_str());
+         }
+         throw error;
+     }
+     memory_ = ::mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+     if (memory_ == MAP_FAILED) {
+         std::runtime_error error = os_error("Failed to map shared-memory segment");
+         ::close(fd_);
+         if (!path_.empty()) {
+             ::unlink(path_.c_str());
+         }
+         throw error;
+     }
+
+     // The file is zero-filled; construct the header and slot counters in place
+     header_ = new (memory_) ShmRingHeader();
+     header_->version = kVersion;
+     header_->slot_size = sizeof(ShmRingSlot);
+     header_->capacity = capacity_;
+     header_->side_capacity = side_capacity_;
+     header_->published.store(0, std::memory_order_relaxed);
+     header_->side_reserved.store(0, std::memory_order_relaxed);
+     slots_ = reinterpret_cast<ShmRingSlot*>(static_cast<char*>(memory_) + sizeof(ShmRingHeader));
+     for (uint64_t i = 0; i < capacity_; ++i) {
+         new (&slots_[i]) ShmRingSlot();
+     }
+     side_ = reinterpret_cast<char*>(slots_ + capacity_);
+     header_->magic.store(kMagic, std::memory_order_release);
+ #else
+     (void)name;
+     throw std::runtime_error("Shared-memory rings are only supported on Linux");
+ #endif
+ }
+
+ ShmRingPublisher::~ShmRingPublisher() {
+ #ifdef __linux__
+     if (memory_ != nullptr) {
+         ::munmap(memory_, size_);
+     }
+     if (fd_ >= 0) {
+         ::close(fd_);
+     }
+     if (!path_.empty()) {
+         ::unlink(path_.c_str());
+     }
+ #endif
+ }
+
+ uint64_t ShmRingPublisher::publish(const ShmRecord& record, const char* side, size_t side_length) {
+     if (side_length > side_capacity_) {
+         throw std::invalid_argument("Side data larger than the ring's side_capacity");
+     }
+
+     // Side data is never split across the end of the ring; skip the tail instead
+     uint64_t offset = side_reserved_;
+     if ((offset & (side_capacity_ - 1)) + side_length > side_capacity_) {
+         offset = (offset | (side_capacity_ - 1)) + 1;
+     }
+     side_reserved_ = offset + side_length;
+
+     uint64_t sequence = published_;
+     ShmRingSlot& slot = slots_[sequence & (capacity_ - 1)];
+     // Mark the slot and the side bytes as being overwritten before touching either;
+     // a reader that sees any of the new bytes then also sees these stores
+     slot.sequence.store(2 * sequence + 1, std::memory_order_relaxed);
+     header_->side_reserved.store(side_reserved_, std::memory_order_relaxed);
+     std::atomic_thread_fence(std::memory_order_release);
+
+     slot.record = record;
+     slot.side_offset = offset;
+     slot.side_length = static_cast<uint32_t>(side_length);
+     if (side_length > 0) {
+         std::memcpy(side_ + (offset & (side_capacity_ - 1)), side, side_length);
+     }
+
+     slot.sequence.store(2 * sequence + 2, std::memory_order_release);
+     published_ = sequence + 1;
+     header_->published.store(published_, std::memory_order_release);
+     return sequence;
+ }
+
+ uint64_t ShmRingPublisher::publish(double time, const AISMessage& message, const std::string& sentence) {
+     ShmRecord record;
+     record.time = time;
+     record.mmsi = message.get_mmsi();
+     record.message_type = static_cast<uint8_t>(message.get_message_type());
+     record.speed = std::numeric_limits<float>::quiet_NaN();
+     record.course = std::numeric_limits<float>::quiet_NaN();
+     if (auto* class_a = dynamic_cast<const PositionReportClassA*>(&message)) {
+         record.latitude = class_a->get_latitude();
+         record.longitude = class_a->get_longitude();
+         record.speed = speed_or_nan(class_a->get_speed_over_ground());
+         record.course = course_or_nan(class_a->get_course_over_ground());
+         record.heading = class_a->get_true_heading();
+         record.navigation_status = static_cast<uint8_t>(class_a->get_navigation_status());
+     } else if (auto* class_b = dynamic_cast<const StandardPositionReportClassB*>(&message)) {
+         // Covers type 19, which derives from type 18
+         record.latitude = class_b->get_latitude();
+         record.longitude = class_b->get_longitude();
+         record.speed = speed_or_nan(class_b->get_speed_over_ground());
+         record.course = course_or_nan(class_b->get_course_over_ground());
+         record.heading = class_b->get_true_heading();
+     }
+     return publish(record, sentence.data(), sentence.size());
+ }
+
+ int ShmRingPublisher::fd() const {
+     return fd_;
+ }
+
+ uint64_t ShmRingPublisher::get_published() const {
+     return published_;
+ }
+
+ // ---- ShmRingSubscriber ----
+
+ ShmRingSubscriber::ShmRingSubscriber(const std::string& name)
+     : memory_(nullptr),
+       size_(0),
+       header_(nullptr),
+       slots_(nullptr),
+       side_(nullptr),
+       capacity_(0),
+       side_capacity_(0),
+       cursor_(0),
+       lost_(0) {
+ #ifdef __linux__
+     std::string path = segment_path(name);
+     int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+     if (fd < 0) {
+         throw os_error("Failed to open shared-memory segment");
+     }
+     try {
+         map(fd);
+     } catch (...) {
+         ::close(fd);
+         throw;
+     }
+     ::close(fd);
+ #else
+     (void)name;
+     throw std::runtime_error("Shared-memory rings are only supported on Linux");
+ #endif
+ }
+
+ ShmRingSubscriber::ShmRingSubscriber(int fd)
+     : memory_(nullptr),
+       size_(0),
+       header_(nullptr),
+       slots_(nullptr),
+       side_(nullptr),
+       capacity_(0),
+       side_capacity_(0),
+       cursor_(0),
+       lost_(0) {
+ #ifdef __linux__
+     map(fd);
+ #else
+     (void)fd;
+     throw std::runtime_error("Shared-memory rings are only supported on Linux");
+ #endif
+ }
+
+ ShmRingSubscriber::~ShmRingSubscriber() {
+ #ifdef __linux__
+     if (memory_ != nullptr) {
+         ::munmap(memory_, size_);
+     }
+ #endif
+ }
+
+ void ShmRingSubscriber::map(int fd) {
+ #ifdef __linux__
+     struct stat status;
+     if (::fstat(fd, &status) != 0) {
+         throw os_error("Failed to inspect shared-memory segment");
+     }
+     size_t size = static_cast<size_t>(status.st_size);
+     if (size < sizeof(ShmRingHeader)) {
+         throw std::runtime_error("Shared-memory segment is not an AIS ring");
+     }
+     void* memory = ::mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+     if (memory == MAP_FAILED) {
+         throw os_error("Failed to map shared-memory segment");
+     }
+
+     const ShmRingHeader* header = static_cast<const ShmRingHeader*>(memory);
+     bool valid = header->magic.load(std::memory_order_acquire) == kMagic &&
+                  header->version == kVersion &&
+                  header->slot_size == sizeof(ShmRingSlot) &&
+                  power_of_two(header->capacity) && power_of_two(header->side_capacity) &&
+                  segment_size(header->capacity, header->side_capacity) == size;
+     if (!valid) {
+         ::munmap(memory, size);
+         throw std::runtime_error("Shared-memory segment is not an AIS ring");
+     }
+
+     // The mapping keeps the segment alive after the descriptor is closed
+     memory_ = memory;
+     size_ = size;
+     header_ = header;
+     capacity_ = header->capacity;
+     side_capacity_ = header->side_capacity;
+     slots_ = reinterpret_cast<const ShmRingSlot*>(static_cast<const char*>(memory) + sizeof(ShmRingHeader));
+     side_ = reinterpret_cast<const char*>(slots_ + capacity_);
+     cursor_ = header->published.load(std::memory_order_acquire);
+ #else
+     (void)fd;
+ #endif
+ }
+
+ bool ShmRingSubscriber::read(ShmRecord& record, std::string& side) {
+     while (true) {
+         uint64_t published = header_->published.load(std::memory_order_acquire);
+         if (cursor_ >= published) {
+             return false;
+         }
+         // Lapped: resume at the oldest record that is still in the ring
+         if (published - cursor_ > capacity_) {
+             lost_ += published - capacity_ - cursor_;
+             cursor_ = published - capacity_;
+         }
+
+         const ShmRingSlot& slot = slots_[cursor_ & (capacity_ - 1)];
+         uint64_t expected = 2 * cursor_ + 2;
+         if (slot.sequence.load(std::memory_order_acquire) != expected) {
+             // Overwritten since published was read
+             lost_++;
+             cursor_++;
+             continue;
+         }
+
+         record = slot.record;
+         uint64_t offset = slot.side_offset;
+         uint32_t length = slot.side_length;
+         if (length <= side_capacity_) {
+             side.resize(length);
+             std::memcpy(&side[0], side_ + (offset & (side_capacity_ - 1)),
+                         std::min<uint64_t>(length, side_capacity_ - (offset & (side_capacity_ - 1))));
+         }
+
+         // The copy is good if neither the slot nor the side bytes were reused meanwhile
+         std::atomic_thread_fence(std::memory_order_acquire);
+         bool slot_intact = slot.sequence.load(std::memory_order_relaxed) == expected;
+         bool side_intact = header_->side_reserved.load(std::memory_order_relaxed) - offset <= side_capacity_;
+         cursor_++;
+         if (slot_intact && side_intact && length <= side_capacity_) {
+             return true;
+         }
+         lost_++;
+     }
+ }
+
+ void ShmRingSubscriber::seek(uint64_t sequence) {
+     cursor_ = sequence;
+ }
+
+ uint64_t ShmRingSubscriber::get_cursor() const {
+     return cursor_;
+ }
+
+ uint64_t ShmRingSubscriber::get_published() const {
+     return header_->published.load(std::memory_order_acquire);
+ }
+
+ uint64_t ShmRingSubscriber::get_lost() const {
+     return lost_;
+ }
+
+ } // namespace aislib
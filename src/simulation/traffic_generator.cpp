@@ -0,0 +1,455 @@
+/**
+ * @file traffic_generator.cpp
+ * @brief Implementation of the TrafficGenerator class
+ */
+
+ #include "aislib/simulation/traffic_generator.h"
+ #include "aislib/nmea_utils.h"
+ #include "aislib/position_report_class_a.h"
+ #include "aislib/base_station_report.h"
+ #include "aislib/communication_state.h"
+ #include "aislib/position_report_class_b.h"
+ #include "aislib/static_and_voyage_data.h"
+ #include "aislib/static_data_report.h"
+ #include <algorithm>
+ #include <chrono>
+ #include <cmath>
+ #include <iomanip>
+ #include <sstream>
+ #include <stdexcept>
+
+ namespace aislib {
+ namespace simulation {
+
+ namespace {
+
+ const double kPi = 3.14159265358979323846;
+
+ const char* const kNamePrefixes[] = {
+     "NORDIC", "ATLANTIC", "PACIFIC", "BALTIC", "ARCTIC", "OCEAN", "SEA", "STAR",
+     "MAERSK", "EVER", "CMA CGM", "MSC", "STENA", "SVITZER", "PILOT", "WIND"
+ };
+
+ const char* const kNameSuffixes[] = {
+     "HERON", "SPIRIT", "VOYAGER", "TRADER", "PRINCESS", "EXPRESS", "MARS", "SUN",
+     "CARRIER", "PIONEER", "GLORY", "BREEZE", "FALCON", "HARMONY", "LEGEND", "WAVE"
+ };
+
+ const char* const kDestinations[] = {
+     "ROTTERDAM", "NL RTM", "HAMBURG", "ANTWERP", "FELIXSTOWE",
+     "SINGAPORE", "DOVER STRAIT", "LE HAVRE", "BREMERHAVEN", "GDANSK"
+ };
+
+ // Maritime identification digits used for simulated MMSIs
+ const uint32_t kMids[] = {244, 235, 227, 211, 219, 265, 257, 636};
+
+ const uint8_t kSupportedTypes[] = {1, 2, 3, 4, 5, 18, 19, 24};
+
+ // Communication state of a transmission at the given time. SOTDMA slot
+ // timeouts count down once a frame, staggered by MMSI, and the slot follows
+ // from the time within the minute (2250 slots per minute); type 3 uses ITDMA.
+ uint32_t communication_state(uint8_t type, uint32_t mmsi, double time, size_t stations) {
+     CommunicationState state;
+     state.sync_state = CommunicationState::SyncState::UTC_DIRECT;
+     if (type == 3) {
+         state.access = CommunicationState::Access::ITDMA;
+         state.slot_increment = static_cast<uint16_t>(mmsi % 1125 + 1);
+         return state.encode();
+     }
+
+     state.access = CommunicationState::Access::SOTDMA;
+     int64_t seconds = static_cast<int64_t>(time);
+     state.slot_timeout = static_cast<uint8_t>(7 - (seconds / 60 + mmsi) % 8);
+     uint16_t slot = static_cast<uint16_t>(std::fmod(time, 60.0) * 37.5) % 2250;
+     switch (state.slot_timeout) {
+         case 0:
+             state.sub_message = static_cast<uint16_t>(2250 + mmsi % 16);
+             break;
+         case 1:
+             state.sub_message = static_cast<uint16_t>(((seconds / 3600) % 24) << 9 | ((seconds / 60) % 60) << 2);
+             break;
+         case 2:
+         case 4:
+         case 6:
+             state.sub_message = slot;
+             break;
+         default:
+             state.sub_message = static_cast<uint16_t>(std::min<size_t>(stations, 0x3FFF));
+             break;
+     }
+     return state.encode();
+ }
+
+ } // anonymous namespace
+
+ std::string GeneratedSentence::with_tag_block() const {
+     std::stringstream tag;
+     tag << "s:r" << receiver_id << ",c:" << static_cast<int64_t>(time);
+     std::string content = tag.str();
+
+     std::stringstream ss;
+     ss << "\\" << content << "*"
+        << std::hex << std::uppercase << std::setw(2) << std::setfill('0')
+        << static_cast<int>(NMEAUtils::calculate_checksum(content))
+        << "\\" << sentence;
+     return ss.str();
+ }
+
+ TrafficGenerator::TrafficGenerator(const TrafficConfig& config)
+     : config_(config),
+       rng_(config.seed),
+       next_message_id_(config.receiver_count, 0),
+       time_(static_cast<double>(config.start_time)) {
+     if (config_.vessel_count == 0 || config_.receiver_count == 0) {
+         throw std::invalid_argument("Traffic generator needs at least one vessel and one receiver");
+     }
+     if (config_.messages_per_second <= 0.0) {
+         throw std::invalid_argument("Message rate must be positive");
+     }
+     if (config_.min_latitude >= config_.max_latitude || config_.min_longitude >= config_.max_longitude) {
+         throw std::invalid_argument("Invalid simulation area");
+     }
+     for (double p : {config_.class_b_fraction, config_.duplicate_probability, config_.fragment_loss_probability,
+                      config_.reorder_probability, config_.corrupt_probability}) {
+         if (p < 0.0 || p > 1.0) {
+             throw std::invalid_argument("Probabilities must be between 0 and 1");
+         }
+     }
+
+     // Build the cumulative type distribution
+     double total = 0.0;
+     for (const auto& entry : config_.type_mix) {
+         if (std::find(std::begin(kSupportedTypes), std::end(kSupportedTypes), entry.first) == std::end(kSupportedTypes)) {
+             throw std::invalid_argument("Traffic generator does not support message type " + std::to_string(entry.first));
+         }
+         if (entry.second < 0.0) {
+             throw std::invalid_argument("Message type weights must not be negative");
+         }
+         if (entry.first == 4 && config_.base_station_count == 0 && entry.second > 0.0) {
+             throw std::invalid_argument("Message type 4 requires at least one base station");
+         }
+         total += entry.second;
+         cumulative_mix_.push_back({entry.first, total});
+     }
+     if (total <= 0.0) {
+         throw std::invalid_argument("Message type mix is empty");
+     }
+
+     // Create the fleet, spread uniformly over the area
+     size_t class_b_count = static_cast<size_t>(std::round(config_.vessel_count * config_.class_b_fraction));
+     vessels_.reserve(config_.vessel_count);
+     for (size_t i = 0; i < config_.vessel_count; ++i) {
+         Vessel vessel;
+         vessel.class_b = i >= config_.vessel_count - class_b_count;
+         vessel.mmsi = kMids[i % 8] * 1000000u + static_cast<uint32_t>(i + 1) % 1000000u;
+         vessel.latitude = config_.min_latitude + uniform() * (config_.max_latitude - config_.min_latitude);
+         vessel.longitude = config_.min_longitude + uniform() * (config_.max_longitude - config_.min_longitude);
+         vessel.speed = static_cast<float>(vessel.class_b ? uniform() * 8.0 : 6.0 + uniform() * 16.0);
+         vessel.course = static_cast<float>(uniform() * 360.0);
+         vessel.rate_of_turn = 0.0f;
+         vessel.last_update = time_;
+         vessel.name = std::string(kNamePrefixes[rng_() % 16]) + " " + kNameSuffixes[rng_() % 16];
+         vessel.call_sign = "C" + std::to_string(100000 + i % 900000);
+         vessel.destination = kDestinations[rng_() % 10];
+         vessel.ship_type = vessel.class_b ? 37 : static_cast<uint8_t>(70 + (rng_() % 3) * 10);
+         vessels_.push_back(vessel);
+     }
+
+     for (size_t i = 0; i < config_.base_station_count; ++i) {
+         base_stations_.push_back(2320000u + static_cast<uint32_t>(i + 1));
+     }
+ }
+
+ size_t TrafficGenerator::next(std::vector<GeneratedSentence>& out) {
+     size_t initial_size = out.size();
+     time_ += 1.0 / config_.messages_per_second;
+
+     release_pending(out);
+
+     uint8_t type = pick_type();
+     BitVector bits = build_message(type);
+     ++statistics_.messages;
+
+     // The primary receiver always hears the message, the others with the duplicate probability
+     size_t primary = rng_() % config_.receiver_count;
+     char channel = (rng_() % 2 == 0) ? 'A' : 'B';
+
+     for (size_t offset = 0; offset < config_.receiver_count; ++offset) {
+         size_t receiver = (primary + offset) % config_.receiver_count;
+         bool duplicate = offset > 0;
+         if (duplicate && uniform() >= config_.duplicate_probability) {
+             continue;
+         }
+
+         uint8_t message_id = next_message_id_[receiver];
+         std::vector<std::string> sentences = encode_sentences(bits, message_id, channel);
+         if (sentences.size() > 1) {
+             next_message_id_[receiver] = static_cast<uint8_t>((message_id + 1) % 10);
+             if (uniform() < config_.reorder_probability) {
+                 std::reverse(sentences.begin(), sentences.end());
+                 ++statistics_.reordered_messages;
+             }
+         }
+
+         size_t hold_back = 0;
+         for (const auto& text : sentences) {
+             if (sentences.size() > 1 && uniform() < config_.fragment_loss_probability) {
+                 ++statistics_.lost_fragments;
+                 continue;
+             }
+
+             GeneratedSentence sentence;
+             sentence.sentence = text;
+             sentence.receiver_id = static_cast<uint16_t>(receiver);
+             sentence.time = time_ + (duplicate ? 0.05 * offset : 0.0);
+             sentence.message_type = type;
+             if (duplicate) {
+                 ++statistics_.duplicates;
+             }
+
+             deliver(std::move(sentence), hold_back, out);
+             if (config_.max_interleave > 0) {
+                 hold_back += rng_() % (config_.max_interleave + 1);
+             }
+         }
+     }
+
+     return out.size() - initial_size;
+ }
+
+ std::vector<GeneratedSentence> TrafficGenerator::generate(size_t message_count) {
+     std::vector<GeneratedSentence> result;
+     result.reserve(message_count + message_count / 8);
+     for (size_t i = 0; i < message_count; ++i) {
+         next(result);
+     }
+     flush(result);
+     return result;
+ }
+
+ void TrafficGenerator::flush(std::vector<GeneratedSentence>& out) {
+     for (auto& pending : pending_) {
+         pending.sentence.time = time_;
+         out.push_back(std::move(pending.sentence));
+         ++statistics_.sentences;
+     }
+     pending_.clear();
+ }
+
+ double TrafficGenerator::get_time() const {
+     return time_;
+ }
+
+ const TrafficStatistics& TrafficGenerator::get_statistics() const {
+     return statistics_;
+ }
+
+ std::vector<std::string> TrafficGenerator::encode_sentences(const BitVector& bits, uint8_t message_id, char channel) {
+     const size_t max_chars = 60;
+
+     std::string payload = bits.to_nmea_payload();
+     uint8_t fill_bits = static_cast<uint8_t>((6 - (bits.size() % 6)) % 6);
+     size_t count = std::max<size_t>(1, (payload.length() + max_chars - 1) / max_chars);
+     std::string id = count > 1 ? std::to_string(message_id) : std::string();
+
+     std::vector<std::string> sentences;
+     for (size_t i = 0; i < count; ++i) {
+         sentences.push_back(NMEAUtils::create_aivdm_sentence(
+             payload.substr(i * max_chars, max_chars),
+             static_cast<uint8_t>(count),
+             static_cast<uint8_t>(i + 1),
+             id,
+             channel,
+             i + 1 == count ? fill_bits : 0));
+     }
+     return sentences;
+ }
+
+ uint8_t TrafficGenerator::pick_type() {
+     double r = uniform() * cumulative_mix_.back().second;
+     for (const auto& entry : cumulative_mix_) {
+         if (r < entry.second) {
+             return entry.first;
+         }
+     }
+     return cumulative_mix_.back().first;
+ }
+
+ TrafficGenerator::Vessel& TrafficGenerator::pick_vessel(bool class_b) {
+     // Fall back to any vessel when the fleet has none of the requested class
+     for (int attempt = 0; attempt < 64; ++attempt) {
+         Vessel& vessel = vessels_[rng_() % vessels_.size()];
+         if (vessel.class_b == class_b) {
+             return vessel;
+         }
+     }
+     return vessels_[rng_() % vessels_.size()];
+ }
+
+ void TrafficGenerator::advance(Vessel& vessel) {
+     double dt = time_ - vessel.last_update;
+     vessel.last_update = time_;
+     if (dt <= 0.0) {
+         return;
+     }
+
+     // Occasionally start or stop a turn and change speed a little
+     if (uniform() < 0.1) {
+         vessel.rate_of_turn = uniform() < 0.5 ? 0.0f : static_cast<float>((uniform() - 0.5) * 20.0);
+         vessel.speed = std::max(0.0f, static_cast<float>(vessel.speed + (uniform() - 0.5)));
+     }
+
+     vessel.course = static_cast<float>(std::fmod(vessel.course + vessel.rate_of_turn * dt / 60.0 + 360.0, 360.0));
+
+     // Flat-earth step, adequate over the few seconds between reports
+     double distance_nm = vessel.speed * dt / 3600.0;
+     double course_rad = vessel.course * kPi / 180.0;
+     vessel.latitude += distance_nm * std::cos(course_rad) / 60.0;
+     vessel.longitude += distance_nm * std::sin(course_rad) / (60.0 * std::cos(vessel.latitude * kPi / 180.0));
+
+     // Turn back into the area at its edges
+     if (vessel.latitude < config_.min_latitude || vessel.latitude > config_.max_latitude) {
+         vessel.latitude = std::clamp(vessel.latitude, config_.min_latitude, config_.max_latitude);
+         vessel.course = static_cast<float>(std::fmod(540.0 - vessel.course, 360.0));
+     }
+     if (vessel.longitude < config_.min_longitude || vessel.longitude > config_.max_longitude) {
+         vessel.longitude = std::clamp(vessel.longitude, config_.min_longitude, config_.max_longitude);
+         vessel.course = static_cast<float>(std::fmod(360.0 - vessel.course, 360.0));
+     }
+ }
+
+ BitVector TrafficGenerator::build_message(uint8_t type) {
+     BitVector bits;
+     uint8_t utc_second = static_cast<uint8_t>(static_cast<int64_t>(time_) % 60);
+
+     if (type == 4) {
+         BaseStationReport report(base_stations_[rng_() % base_stations_.size()], 0);
+         report.set_utc_timestamp(std::chrono::system_clock::time_point(
+             std::chrono::seconds(static_cast<int64_t>(time_))));
+         report.set_position_accuracy(true);
+         report.set_latitude((config_.min_latitude + config_.max_latitude) / 2.0);
+         report.set_longitude((config_.min_longitude + config_.max_longitude) / 2.0);
+         report.set_epfd_type(7); // Surveyed
+         report.set_radio_status(communication_state(type, report.get_mmsi(), time_, vessels_.size()));
+         report.to_bits(bits);
+         return bits;
+     }
+
+     Vessel& vessel = pick_vessel(type >= 18);
+     advance(vessel);
+
+     switch (type) {
+         case 1:
+         case 2:
+         case 3: {
+             PositionReportClassA report(type, vessel.mmsi, 0,
+                 vessel.speed < 0.5f ? PositionReportClassA::NavigationStatus::MOORED
+                                     : PositionReportClassA::NavigationStatus::UNDER_WAY_USING_ENGINE);
+             report.set_rate_of_turn(vessel.rate_of_turn);
+             report.set_speed_over_ground(vessel.speed);
+             report.set_position_accuracy(true);
+             report.set_latitude(vessel.latitude);
+             report.set_longitude(vessel.longitude);
+             report.set_course_over_ground(vessel.course);
+             report.set_true_heading(static_cast<uint16_t>(vessel.course) % 360);
+             report.set_timestamp(utc_second);
+             report.set_radio_status(communication_state(type, vessel.mmsi, time_, vessels_.size()));
+             report.to_bits(bits);
+             break;
+         }
+         case 5: {
+             StaticAndVoyageData report(vessel.mmsi, 0);
+             report.set_imo_number(9000000 + vessel.mmsi % 1000000);
+             report.set_call_sign(vessel.call_sign);
+             report.set_vessel_name(vessel.name);
+             report.set_ship_type(static_cast<StaticAndVoyageData::ShipType>(vessel.ship_type));
+             report.set_ship_dimensions(150, 30, 12, 12);
+             report.set_epfd_type(1);
+             report.set_eta_components(6, 3, 14, 30);
+             report.set_draught(9.5f);
+             report.set_destination(vessel.destination);
+             report.to_bits(bits);
+             break;
+         }
+         case 18: {
+             StandardPositionReportClassB report(vessel.mmsi, 0);
+             report.set_speed_over_ground(vessel.speed);
+             report.set_latitude(vessel.latitude);
+             report.set_longitude(vessel.longitude);
+             report.set_course_over_ground(vessel.course);
+             report.set_true_heading(511);
+             report.set_timestamp(utc_second);
+             report.to_bits(bits);
+             break;
+         }
+         case 19: {
+             ExtendedPositionReportClassB report(vessel.mmsi, 0);
+             report.set_speed_over_ground(vessel.speed);
+             report.set_latitude(vessel.latitude);
+             report.set_longitude(vessel.longitude);
+             report.set_course_over_ground(vessel.course);
+             report.set_timestamp(utc_second);
+             report.set_vessel_name(vessel.name);
+             report.set_ship_type(vessel.ship_type);
+             report.set_ship_dimensions(10, 4, 2, 2);
+             report.set_epfd_type(1);
+             report.to_bits(bits);
+             break;
+         }
+         default: {
+             bool part_b = uniform() < 0.5;
+             StaticDataReport report(vessel.mmsi, 0, part_b ? StaticDataReport::Part::B : StaticDataReport::Part::A);
+             if (!part_b) {
+                 report.set_vessel_name(vessel.name);
+             } else {
+                 report.set_ship_type(vessel.ship_type);
+                 report.set_vendor_id("SIM");
+                 report.set_unit_model(1);
+                 report.set_serial_number(vessel.mmsi % 1000000);
+                 report.set_call_sign(vessel.call_sign);
+                 report.set_ship_dimensions(8, 4, 2, 2);
+             }
+             report.to_bits(bits);
+             break;
+         }
+     }
+
+     return bits;
+ }
+
+ void TrafficGenerator::deliver(GeneratedSentence sentence, size_t hold_back, std::vector<GeneratedSentence>& out) {
+     if (uniform() < config_.corrupt_probability) {
+         // Replace the last checksum digit with a different hex digit
+         char& digit = sentence.sentence.back();
+         digit = (digit == '0') ? '1' : '0';
+         ++statistics_.corrupted;
+     }
+
+     if (hold_back > 0) {
+         pending_.push_back({std::move(sentence), hold_back});
+         return;
+     }
+
+     out.push_back(std::move(sentence));
+     ++statistics_.sentences;
+ }
+
+ void TrafficGenerator::release_pending(std::vector<GeneratedSentence>& out) {
+     for (auto it = pending_.begin(); it != pending_.end();) {
+         if (--it->countdown == 0) {
+             it->sentence.time = time_;
+             out.push_back(std::move(it->sentence));
+             ++statistics_.sentences;
+             it = pending_.erase(it);
+         } else {
+             ++it;
+         }
+     }
+ }
+
+ double TrafficGenerator::uniform() {
+     return std::uniform_real_distribution<double>(0.0, 1.0)(rng_);
+ }
+
+ } // namespace simulation
+ } // namespace aislib
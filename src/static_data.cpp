@@ -63,8 +63,8 @@
      mmsi_ = static_cast<uint32_t>(bits.get_uint(8, 30));
      ais_version_ = static_cast<uint8_t>(bits.get_uint(38, 2));
      imo_number_ = static_cast<uint32_t>(bits.get_uint(40, 30));
-     call_sign_ = bits.get_string(70, 42);  // 7 six-bit characters
-     vessel_name_ = bits.get_string(112, 120);  // 20 six-bit characters
+     bits.get_string(70, 42, call_sign_);  // 7 six-bit characters
+     bits.get_string(112, 120, vessel_name_);  // 20 six-bit characters
      ship_type_ = static_cast<ShipType>(bits.get_uint(232, 8));
      dimension_to_bow_ = static_cast<uint16_t>(bits.get_uint(240, 9));
      dimension_to_stern_ = static_cast<uint16_t>(bits.get_uint(249, 9));
@@ -76,7 +76,7 @@
      eta_hour_ = static_cast<uint8_t>(bits.get_uint(283, 5));
      eta_minute_ = static_cast<uint8_t>(bits.get_uint(288, 6));
      draught_ = static_cast<uint8_t>(bits.get_uint(294, 8));
-     destination_ = bits.get_string(302, 120);  // 20 six-bit characters
+     bits.get_string(302, 120, destination_);  // 20 six-bit characters
      dte_flag_ = bits.get_bit(422);
      
      // Spare (1 bit) - skipped
@@ -102,11 +102,11 @@
      return imo_number_;
  }
  
- std::string StaticAndVoyageData::get_call_sign() const {
+ std::string_view StaticAndVoyageData::get_call_sign() const {
      return call_sign_;
  }
  
- std::string StaticAndVoyageData::get_vessel_name() const {
+ std::string_view StaticAndVoyageData::get_vessel_name() const {
      return vessel_name_;
  }
  
@@ -185,7 +185,7 @@
      return draught_ * 0.1f;
  }
  
- std::string StaticAndVoyageData::get_destination() const {
+ std::string_view StaticAndVoyageData::get_destination() const {
      return destination_;
  }
  
@@ -205,19 +205,19 @@
      imo_number_ = imo;
  }
  
-void StaticAndVoyageData::set_call_sign(const std::string& call_sign) {
+void StaticAndVoyageData::set_call_sign(std::string_view call_sign) {
     // Call sign is limited to 7 characters (42 bits)
-    call_sign_ = call_sign.length() > 7 ? call_sign.substr(0, 7) : call_sign;
+    call_sign_.assign(call_sign);
 }
 
-void StaticAndVoyageData::set_vessel_name(const std::string& name) {
+void StaticAndVoyageData::set_vessel_name(std::string_view name) {
     // Vessel name is limited to 20 characters (120 bits)
-    vessel_name_ = name.length() > 20 ? name.substr(0, 20) : name;
+    vessel_name_.assign(name);
 }
 
-void StaticAndVoyageData::set_destination(const std::string& destination) {
+void StaticAndVoyageData::set_destination(std::string_view destination) {
     // Destination is limited to 20 characters (120 bits)
-    destination_ = destination.length() > 20 ? destination.substr(0, 20) : destination;
+    destination_.assign(destination);
 } 
  void StaticAndVoyageData::set_ship_type(ShipType type) {
      ship_type_ = type;
@@ -0,0 +1,271 @@
+/**
+ * @file static_data_report.cpp
+ * @brief Implementation of StaticDataReport class
+ */
+
+ #include "aislib/static_data_report.h"
+ #include <sstream>
+ #include <stdexcept>
+
+ namespace aislib {
+
+ StaticDataReport::StaticDataReport(
+     uint32_t mmsi,
+     uint8_t repeat_indicator,
+     Part part
+ ) : mmsi_(mmsi),
+     repeat_indicator_(repeat_indicator),
+     part_(part),
+     vessel_name_(),
+     ship_type_(0),
+     vendor_id_(),
+     unit_model_(0),
+     serial_number_(0),
+     call_sign_(),
+     dimension_to_bow_(0),
+     dimension_to_stern_(0),
+     dimension_to_port_(0),
+     dimension_to_starboard_(0),
+     mothership_mmsi_(0) {
+ }
+
+ StaticDataReport::StaticDataReport(const BitVector& bits)
+     : StaticDataReport(0, 0, Part::A) {
+     // Part number is the last common field
+     if (bits.size() < 40) {
+         throw std::invalid_argument("Bit vector too small for a Static Data Report message");
+     }
+
+     // Extract message type
+     uint8_t message_type = static_cast<uint8_t>(bits.get_uint(0, 6));
+     if (message_type != 24) {
+         throw std::invalid_argument("Invalid message type for Static Data Report");
+     }
+
+     repeat_indicator_ = static_cast<uint8_t>(bits.get_uint(6, 2));
+     mmsi_ = static_cast<uint32_t>(bits.get_uint(8, 30));
+
+     uint8_t part_number = static_cast<uint8_t>(bits.get_uint(38, 2));
+     if (part_number == 0) {
+         // Part A: the 8 spare bits are optional
+         if (bits.size() < 160) {
+             throw std::invalid_argument("Bit vector too small for a Static Data Report Part A");
+         }
+         part_ = Part::A;
+         bits.get_string(40, 120, vessel_name_);
+     } else if (part_number == 1) {
+         // Part B: the 6 spare bits are optional
+         if (bits.size() < 162) {
+             throw std::invalid_argument("Bit vector too small for a Static Data Report Part B");
+         }
+         part_ = Part::B;
+         ship_type_ = static_cast<uint8_t>(bits.get_uint(40, 8));
+         bits.get_string(48, 18, vendor_id_);
+         unit_model_ = static_cast<uint8_t>(bits.get_uint(66, 4));
+         serial_number_ = static_cast<uint32_t>(bits.get_uint(70, 20));
+         bits.get_string(90, 42, call_sign_);
+         if (is_auxiliary_craft()) {
+             mothership_mmsi_ = static_cast<uint32_t>(bits.get_uint(132, 30));
+         } else {
+             dimension_to_bow_ = static_cast<uint16_t>(bits.get_uint(132, 9));
+             dimension_to_stern_ = static_cast<uint16_t>(bits.get_uint(141, 9));
+             dimension_to_port_ = static_cast<uint8_t>(bits.get_uint(150, 6));
+             dimension_to_starboard_ = static_cast<uint8_t>(bits.get_uint(156, 6));
+         }
+     } else {
+         throw std::invalid_argument("Invalid part number for Static Data Report");
+     }
+ }
+
+ uint8_t StaticDataReport::get_message_type() const {
+     return 24;
+ }
+
+ uint32_t StaticDataReport::get_mmsi() const {
+     return mmsi_;
+ }
+
+ uint8_t StaticDataReport::get_repeat_indicator() const {
+     return repeat_indicator_;
+ }
+
+ StaticDataReport::Part StaticDataReport::get_part() const {
+     return part_;
+ }
+
+ bool StaticDataReport::is_auxiliary_craft() const {
+     return mmsi_ / 10000000 == 98;
+ }
+
+ std::string_view StaticDataReport::get_vessel_name() const {
+     return vessel_name_;
+ }
+
+ uint8_t StaticDataReport::get_ship_type() const {
+     return ship_type_;
+ }
+
+ std::string_view StaticDataReport::get_vendor_id() const {
+     return vendor_id_;
+ }
+
+ uint8_t StaticDataReport::get_unit_model() const {
+     return unit_model_;
+ }
+
+ uint32_t StaticDataReport::get_serial_number() const {
+     return serial_number_;
+ }
+
+ std::string_view StaticDataReport::get_call_sign() const {
+     return call_sign_;
+ }
+
+ uint16_t StaticDataReport::get_dimension_to_bow() const {
+     return dimension_to_bow_;
+ }
+
+ uint16_t StaticDataReport::get_dimension_to_stern() const {
+     return dimension_to_stern_;
+ }
+
+ uint8_t StaticDataReport::get_dimension_to_port() const {
+     return dimension_to_port_;
+ }
+
+ uint8_t StaticDataReport::get_dimension_to_starboard() const {
+     return dimension_to_starboard_;
+ }
+
+ uint32_t StaticDataReport::get_mothership_mmsi() const {
+     return mothership_mmsi_;
+ }
+
+ void StaticDataReport::set_vessel_name(std::string_view name) {
+     vessel_name_.assign(name);
+ }
+
+ void StaticDataReport::set_ship_type(uint8_t type) {
+     ship_type_ = type;
+ }
+
+ void StaticDataReport::set_vendor_id(std::string_view vendor_id) {
+     vendor_id_.assign(vendor_id);
+ }
+
+ void StaticDataReport::set_unit_model(uint8_t model) {
+     unit_model_ = model & 0x0F;
+ }
+
+ void StaticDataReport::set_serial_number(uint32_t serial) {
+     serial_number_ = serial & 0xFFFFF;
+ }
+
+ void StaticDataReport::set_call_sign(std::string_view call_sign) {
+     call_sign_.assign(call_sign);
+ }
+
+ void StaticDataReport::set_ship_dimensions(
+     uint16_t to_bow,
+     uint16_t to_stern,
+     uint8_t to_port,
+     uint8_t to_starboard
+ ) {
+     // Values beyond the field width are capped (511 m / 63 m mean "or more")
+     dimension_to_bow_ = to_bow > 511 ? 511 : to_bow;
+     dimension_to_stern_ = to_stern > 511 ? 511 : to_stern;
+     dimension_to_port_ = to_port > 63 ? 63 : to_port;
+     dimension_to_starboard_ = to_starboard > 63 ? 63 : to_starboard;
+ }
+
+ void StaticDataReport::set_mothership_mmsi(uint32_t mmsi) {
+     mothership_mmsi_ = mmsi & 0x3FFFFFFF;
+ }
+
+ void StaticDataReport::to_bits(BitVector& bits) const {
+     // Clear the bit vector
+     bits.clear();
+
+     // Message Type (6 bits) = 24
+     bits.append_uint(24, 6);
+
+     // Repeat Indicator (2 bits)
+     bits.append_uint(repeat_indicator_, 2);
+
+     // MMSI (30 bits)
+     bits.append_uint(mmsi_, 30);
+
+     // Part Number (2 bits)
+     bits.append_uint(static_cast<uint8_t>(part_), 2);
+
+     if (part_ == Part::A) {
+         // Vessel Name (120 bits)
+         bits.append_string(vessel_name_, 120);
+
+         // Spare (8 bits)
+         bits.append_uint(0, 8);
+         return;
+     }
+
+     // Ship Type (8 bits)
+     bits.append_uint(ship_type_, 8);
+
+     // Vendor ID (18 bits)
+     bits.append_string(vendor_id_, 18);
+
+     // Unit Model Code (4 bits)
+     bits.append_uint(unit_model_, 4);
+
+     // Serial Number (20 bits)
+     bits.append_uint(serial_number_, 20);
+
+     // Call Sign (42 bits)
+     bits.append_string(call_sign_, 42);
+
+     if (is_auxiliary_craft()) {
+         // Mothership MMSI (30 bits)
+         bits.append_uint(mothership_mmsi_, 30);
+     } else {
+         // Dimensions (30 bits)
+         bits.append_uint(dimension_to_bow_, 9);
+         bits.append_uint(dimension_to_stern_, 9);
+         bits.append_uint(dimension_to_port_, 6);
+         bits.append_uint(dimension_to_starboard_, 6);
+     }
+
+     // Spare (6 bits)
+     bits.append_uint(0, 6);
+ }
+
+ std::string StaticDataReport::to_string() const {
+     std::stringstream ss;
+
+     ss << "AIS Message Type: 24 (Static Data Report)\n";
+     ss << "MMSI: " << mmsi_ << "\n";
+     ss << "Repeat Indicator: " << static_cast<int>(repeat_indicator_) << "\n";
+
+     if (part_ == Part::A) {
+         ss << "Part: A\n";
+         ss << "Vessel Name: " << vessel_name_;
+         return ss.str();
+     }
+
+     ss << "Part: B\n";
+     ss << "Ship Type: " << static_cast<int>(ship_type_) << "\n";
+     ss << "Vendor ID: " << vendor_id_ << "\n";
+     ss << "Unit Model: " << static_cast<int>(unit_model_) << "\n";
+     ss << "Serial Number: " << serial_number_ << "\n";
+     ss << "Call Sign: " << call_sign_ << "\n";
+     if (is_auxiliary_craft()) {
+         ss << "Mothership MMSI: " << mothership_mmsi_;
+     } else {
+         ss << "Dimensions: " << dimension_to_bow_ << "m (bow), "
+            << dimension_to_stern_ << "m (stern), "
+            << static_cast<int>(dimension_to_port_) << "m (port), "
+            << static_cast<int>(dimension_to_starboard_) << "m (starboard)";
+     }
+
+     return ss.str();
+ }
+
+ } // namespace aislib
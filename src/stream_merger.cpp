@@ -0,0 +1,333 @@
+/**
+ * @file stream_merger.cpp
+ * @brief Implementation of StreamMerger
+ */
+
+ #include "aislib/stream_merger.h"
+ #include <algorithm>
+ #include <limits>
+ #include <stdexcept>
+
+ namespace aislib {
+
+ namespace {
+
+ const double kInfinity = std::numeric_limits<double>::infinity();
+
+ // FNV-1a over a range of characters
+ uint64_t hash_range(uint64_t h, const char* begin, const char* end) {
+     for (const char* p = begin; p < end; ++p) {
+         h ^= static_cast<unsigned char>(*p);
+         h *= 0x100000001B3ULL;
+     }
+     // Field separator, so that moving characters between fields changes the hash
+     h ^= 0xFF;
+     return h * 0x100000001B3ULL;
+ }
+
+ } // anonymous namespace
+
+ const uint64_t StreamMerger::EMPTY_KEY;
+
+ StreamMerger::StreamMerger(size_t sources, const Config& config)
+     : config_(config),
+       sequence_(0),
+       watermark_(-kInfinity),
+       forced_(-kInfinity),
+       seen_head_(0),
+       seen_count_(0) {
+     if (sources == 0 || sources > 65536) {
+         throw std::invalid_argument("Stream merger sources must be between 1 and 65536");
+     }
+     if (config_.buffer_capacity == 0 || config_.buffer_capacity > std::numeric_limits<uint32_t>::max()) {
+         throw std::invalid_argument("Stream merger buffer capacity out of range");
+     }
+
+     sources_.resize(sources);
+     for (Source& source : sources_) {
+         source.heap.reserve(config_.buffer_capacity);
+         source.slots.resize(config_.buffer_capacity);
+         for (std::string& slot : source.slots) {
+             slot.reserve(config_.sentence_capacity);
+         }
+         source.free_slots.reserve(config_.buffer_capacity);
+         for (size_t slot = config_.buffer_capacity; slot-- > 0;) {
+             source.free_slots.push_back(static_cast<uint32_t>(slot));
+         }
+         source.newest = -kInfinity;
+         source.delay = config_.max_delay;
+         std::fill(std::begin(source.fragment_keys), std::end(source.fragment_keys), 0);
+     }
+     merge_heap_.reserve(sources);
+
+     if (config_.dedup_window > 0.0) {
+         // The table stays at most half full
+         size_t remembered = 1;
+         while (remembered < 2 * config_.buffer_capacity) {
+             remembered *= 2;
+         }
+         seen_order_.resize(remembered);
+         seen_.assign(2 * remembered, Seen{EMPTY_KEY, 0.0});
+     }
+ }
+
+ bool StreamMerger::later(const Entry& a, const Entry& b) {
+     return a.time > b.time || (a.time == b.time && a.sequence > b.sequence);
+ }
+
+ StreamMerger::Source& StreamMerger::source_at(uint16_t source) {
+     if (source >= sources_.size()) {
+         throw std::out_of_range("Source index out of range");
+     }
+     return sources_[source];
+ }
+
+ void StreamMerger::set_max_delay(uint16_t source, double seconds) {
+     source_at(source).delay = seconds;
+ }
+
+ bool StreamMerger::push(uint16_t source, double time, const std::string& sentence) {
+     Source& target = source_at(source);
+     if (target.free_slots.empty()) {
+         // Let the next pop() release this source's oldest record, late sources or not
+         forced_ = std::max(forced_, target.heap.front().time);
+         ++stats_.overflows;
+         return false;
+     }
+
+     uint32_t slot = target.free_slots.back();
+     target.free_slots.pop_back();
+     target.slots[slot].assign(sentence);
+     target.heap.push_back(Entry{time, sequence_++, slot});
+     std::push_heap(target.heap.begin(), target.heap.end(), later);
+     target.newest = std::max(target.newest, time);
+
+     if (time < watermark_) {
+         ++stats_.late;
+     }
+     ++stats_.pushed;
+     return true;
+ }
+
+ void StreamMerger::advance(uint16_t source, double time) {
+     Source& target = source_at(source);
+     target.newest = std::max(target.newest, time);
+ }
+
+ double StreamMerger::compute_watermark() const {
+     double newest = -kInfinity;
+     for (const Source& source : sources_) {
+         newest = std::max(newest, source.newest);
+     }
+     if (newest == -kInfinity) {
+         return forced_;
+     }
+
+     // Sources that have never delivered anything are idle as well
+     double limit = kInfinity;
+     for (const Source& source : sources_) {
+         if (source.newest < newest - config_.idle_timeout) {
+             continue;
+         }
+         limit = std::min(limit, source.newest - source.delay);
+     }
+     return std::max(limit, forced_);
+ }
+
+ template <typename Record>
+ size_t StreamMerger::release(double limit, std::vector<Record>& out) {
+     auto source_after = [this](uint16_t a, uint16_t b) {
+         return later(sources_[a].heap.front(), sources_[b].heap.front());
+     };
+
+     merge_heap_.clear();
+     for (size_t i = 0; i < sources_.size(); ++i) {
+         if (!sources_[i].heap.empty() && sources_[i].heap.front().time <= limit) {
+             merge_heap_.push_back(static_cast<uint16_t>(i));
+         }
+     }
+     std::make_heap(merge_heap_.begin(), merge_heap_.end(), source_after);
+
+     size_t released = 0;
+     while (!merge_heap_.empty()) {
+         std::pop_heap(merge_heap_.begin(), merge_heap_.end(), source_after);
+         uint16_t index = merge_heap_.back();
+         Source& source = sources_[index];
+
+         Entry entry = source.heap.front();
+         std::pop_heap(source.heap.begin(), source.heap.end(), later);
+         source.heap.pop_back();
+
+         // The slot is only reused by the next push(), so views into it stay valid until then
+         const std::string& sentence = source.slots[entry.slot];
+         if (duplicate(source, sentence, entry.time)) {
+             ++stats_.duplicates;
+         } else {
+             out.emplace_back();
+             Record& record = out.back();
+             record.sentence = sentence;
+             record.time = entry.time;
+             record.source = index;
+             ++stats_.released;
+             ++released;
+         }
+         source.free_slots.push_back(entry.slot);
+         watermark_ = std::max(watermark_, entry.time);
+
+         if (!source.heap.empty() && source.heap.front().time <= limit) {
+             std::push_heap(merge_heap_.begin(), merge_heap_.end(), source_after);
+         } else {
+             merge_heap_.pop_back();
+         }
+     }
+     return released;
+ }
+
+ size_t StreamMerger::pop(std::vector<MergedSentence>& out) {
+     double limit = compute_watermark();
+     size_t released = release(limit, out);
+     watermark_ = std::max(watermark_, limit);
+     return released;
+ }
+
+ size_t StreamMerger::pop(std::vector<MergedView>& out) {
+     double limit = compute_watermark();
+     size_t released = release(limit, out);
+     watermark_ = std::max(watermark_, limit);
+     return released;
+ }
+
+ size_t StreamMerger::flush(std::vector<MergedSentence>& out) {
+     return release(kInfinity, out);
+ }
+
+ size_t StreamMerger::flush(std::vector<MergedView>& out) {
+     return release(kInfinity, out);
+ }
+
+ bool StreamMerger::duplicate(Source& source, const std::string& sentence, double time) {
+     if (!(config_.dedup_window > 0.0)) {
+         return false;
+     }
+
+     // Forget transmissions that have left the window
+     while (seen_count_ > 0 && seen_order_[seen_head_].first < time - config_.dedup_window) {
+         forget_oldest();
+     }
+
+     uint64_t key = transmission_key(source, sentence);
+     key = key == EMPTY_KEY ? 1 : key;
+     Seen& found = seen_[seen_slot(key)];
+     if (found.key == key && time - found.time <= config_.dedup_window) {
+         return true;
+     }
+     if (seen_count_ == seen_order_.size()) {
+         forget_oldest();
+     }
+     // The slot may have moved while the oldest entry was removed
+     Seen& entry = seen_[seen_slot(key)];
+     entry.key = key;
+     entry.time = time;
+     seen_order_[(seen_head_ + seen_count_) & (seen_order_.size() - 1)] = std::make_pair(time, key);
+     ++seen_count_;
+     return false;
+ }
+
+ size_t StreamMerger::seen_slot(uint64_t key) const {
+     const size_t mask = seen_.size() - 1;
+     size_t slot = key & mask;
+     while (seen_[slot].key != key && seen_[slot].key != EMPTY_KEY) {
+         slot = (slot + 1) & mask;
+     }
+     return slot;
+ }
+
+ void StreamMerger::forget_oldest() {
+     const std::pair<double, uint64_t> oldest = seen_order_[seen_head_];
+     seen_head_ = (seen_head_ + 1) & (seen_order_.size() - 1);
+     --seen_count_;
+
+     // A key seen again since keeps its newer entry
+     size_t slot = seen_slot(oldest.second);
+     if (seen_[slot].key != oldest.second || seen_[slot].time != oldest.first) {
+         return;
+     }
+     // Backward-shift deletion: move later entries of the probe sequence into the hole
+     const size_t mask = seen_.size() - 1;
+     size_t hole = slot;
+     for (size_t next = (hole + 1) & mask; seen_[next].key != EMPTY_KEY; next = (next + 1) & mask) {
+         size_t home = seen_[next].key & mask;
+         bool stays = hole <= next ? (home > hole && home <= next) : (home > hole || home <= next);
+         if (!stays) {
+             seen_[hole] = seen_[next];
+             hole = next;
+         }
+     }
+     seen_[hole].key = EMPTY_KEY;
+ }
+
+ uint64_t StreamMerger::transmission_key(Source& source, const std::string& sentence) {
+     const char* begin = sentence.data();
+     const char* end = begin + sentence.size();
+     if (begin < end && *begin == '\\') {
+         const char* close = std::find(begin + 1, end, '\\');
+         begin = close < end ? close + 1 : end;
+     }
+
+     // !AIVDM,count,number,sequence,channel,payload,fill*hh: the sequential
+     // message ID and channel differ between receivers, the rest does not
+     const char* commas[6];
+     size_t found = 0;
+     for (const char* p = begin; p < end && found < 6; ++p) {
+         if (*p == ',') {
+             commas[found++] = p;
+         }
+     }
+     uint64_t h = 0xCBF29CE484222325ULL;
+     if (found < 6) {
+         h = hash_range(h, begin, end);
+     } else {
+         const char* fill_end = std::find(commas[5] + 1, end, '*');
+         h = hash_range(h, commas[0] + 1, commas[1]);
+         h = hash_range(h, commas[1] + 1, commas[2]);
+         h = hash_range(h, commas[4] + 1, commas[5]);
+         h = hash_range(h, commas[5] + 1, fill_end);
+     }
+
+     // Later fragments, such as the short tail of a type 5 message, can be
+     // the same for different messages; chain them to the earlier fragments
+     // of the same message from this source
+     bool multipart = found == 6 && commas[1] - commas[0] == 2 && commas[0][1] > '1';
+     bool has_sequence = found == 6 && commas[3] - commas[2] == 2 && commas[2][1] >= '0' && commas[2][1] <= '9';
+     if (multipart && has_sequence) {
+         uint64_t& chain = source.fragment_keys[commas[2][1] - '0'];
+         if (commas[2] - commas[1] == 2 && commas[1][1] != '1') {
+             h ^= chain;
+         }
+         chain = h * 0x9E3779B97F4A7C15ULL;
+     }
+
+     // Finalizer (MurmurHash3)
+     h ^= h >> 33;
+     h *= 0xFF51AFD7ED558CCDULL;
+     h ^= h >> 33;
+     return h;
+ }
+
+ double StreamMerger::get_watermark() const {
+     return watermark_;
+ }
+
+ size_t StreamMerger::buffered() const {
+     size_t count = 0;
+     for (const Source& source : sources_) {
+         count += source.heap.size();
+     }
+     return count;
+ }
+
+ StreamMerger::Stats StreamMerger::get_stats() const {
+     return stats_;
+ }
+
+ } // namespace aislib
@@ -0,0 +1,261 @@
+/**
+ * @file string_pool.cpp
+ * @brief Implementation of the StringPool class
+ */
+
+ #include "aislib/string_pool.h"
+ #include <stdexcept>
+
+ namespace aislib {
+
+ namespace {
+
+ const size_t kCharsPerWord = 10;
+
+ // AIS 6-bit ASCII, indexed by value
+ const char kSixBitAscii[65] =
+     "@ABCDEFGHIJKLMNOPQRSTUVWXYZ[\\]^_ !\"#$%&'()*+,-./0123456789:;<=>?";
+
+ // Same mapping as BitVector::append_string
+ uint8_t encode_char(char c) {
+     if (c >= '@' && c <= '_') return static_cast<uint8_t>(c - 64);
+     if (c >= ' ' && c <= '?') return static_cast<uint8_t>(c);
+     return 0;
+ }
+
+ // Character i of a key, stored most significant first
+ uint8_t char_at(const uint64_t* words, size_t i) {
+     size_t shift = 6 * (kCharsPerWord - 1 - i % kCharsPerWord);
+     return static_cast<uint8_t>((words[i / kCharsPerWord] >> shift) & 0x3F);
+ }
+
+ } // anonymous namespace
+
+ StringPool::StringPool(size_t initial_capacity)
+     : chunks_(new std::atomic<Chunk*>[MAX_CHUNKS]),
+       size_(0),
+       table_(nullptr) {
+     for (size_t i = 0; i < MAX_CHUNKS; ++i) {
+         chunks_[i].store(nullptr, std::memory_order_relaxed);
+     }
+
+     // Index at most half full
+     size_t slots = 16;
+     while (slots < initial_capacity * 2) {
+         slots *= 2;
+     }
+     auto table = std::make_unique<Table>();
+     table->mask = slots - 1;
+     table->slots.reset(new std::atomic<Handle>[slots]);
+     for (size_t i = 0; i < slots; ++i) {
+         table->slots[i].store(0, std::memory_order_relaxed);
+     }
+     table_.store(table.get(), std::memory_order_release);
+     tables_.push_back(std::move(table));
+
+     // Entry 0 is the empty string
+     Chunk* first = new Chunk();
+     first->entries[0] = Entry{};
+     chunks_[0].store(first, std::memory_order_release);
+     size_.store(1, std::memory_order_release);
+ }
+
+ StringPool::~StringPool() {
+     for (size_t i = 0; i < MAX_CHUNKS; ++i) {
+         delete chunks_[i].load(std::memory_order_relaxed);
+     }
+ }
+
+ StringPool::Handle StringPool::intern(const BitVector& bits, size_t start_index, size_t bit_count) {
+     if (bit_count % 6 != 0) {
+         throw std::invalid_argument("String bit count must be multiple of 6");
+     }
+     if (bit_count > MAX_LENGTH * 6) {
+         throw std::invalid_argument("String too long for the string pool");
+     }
+     if (start_index + bit_count > bits.size()) {
+         throw std::out_of_range("Bit range out of bounds");
+     }
+
+     // Read the packed characters as two words, left-aligned
+     Key key{};
+     size_t chars = bit_count / 6;
+     size_t first = chars < kCharsPerWord ? chars : kCharsPerWord;
+     if (first > 0) {
+         key.words[0] = bits.get_uint(start_index, first * 6) << (6 * (kCharsPerWord - first));
+     }
+     if (chars > kCharsPerWord) {
+         size_t second = chars - kCharsPerWord;
+         key.words[1] = bits.get_uint(start_index + 60, second * 6) << (6 * (kCharsPerWord - second));
+     }
+     key.length = static_cast<uint8_t>(chars);
+
+     normalize(key);
+     if (key.length == 0) {
+         return EMPTY;
+     }
+
+     Table* table = table_.load(std::memory_order_acquire);
+     Handle handle = find(*table, key, hash(key));
+     return handle != EMPTY ? handle : insert(key);
+ }
+
+ StringPool::Handle StringPool::intern(std::string_view value) {
+     if (value.size() > MAX_LENGTH) {
+         throw std::invalid_argument("String too long for the string pool");
+     }
+
+     Key key{};
+     for (size_t i = 0; i < value.size(); ++i) {
+         size_t shift = 6 * (kCharsPerWord - 1 - i % kCharsPerWord);
+         key.words[i / kCharsPerWord] |= static_cast<uint64_t>(encode_char(value[i])) << shift;
+     }
+     key.length = static_cast<uint8_t>(value.size());
+
+     normalize(key);
+     if (key.length == 0) {
+         return EMPTY;
+     }
+
+     Table* table = table_.load(std::memory_order_acquire);
+     Handle handle = find(*table, key, hash(key));
+     return handle != EMPTY ? handle : insert(key);
+ }
+
+ std::string_view StringPool::view(Handle handle) const {
+     if (handle >= size_.load(std::memory_order_acquire)) {
+         throw std::out_of_range("Invalid string pool handle");
+     }
+     const Entry& e = entry(handle);
+     return std::string_view(e.text, e.key.length);
+ }
+
+ size_t StringPool::size() const {
+     return size_.load(std::memory_order_acquire);
+ }
+
+ size_t StringPool::memory_usage() const {
+     size_t chunk_count = (size() + CHUNK_SIZE - 1) / CHUNK_SIZE;
+     Table* table = table_.load(std::memory_order_acquire);
+     return chunk_count * sizeof(Chunk) + (table->mask + 1) * sizeof(std::atomic<Handle>) +
+            MAX_CHUNKS * sizeof(std::atomic<Chunk*>);
+ }
+
+ StringPool& StringPool::global() {
+     static StringPool pool(1 << 16);
+     return pool;
+ }
+
+ uint64_t StringPool::hash(const Key& key) {
+     // splitmix64 finalizer over both words
+     uint64_t h = key.words[0] * 0x9E3779B97F4A7C15ULL ^ (key.words[1] + key.length);
+     h ^= h >> 30;
+     h *= 0xBF58476D1CE4E5B9ULL;
+     h ^= h >> 27;
+     h *= 0x94D049BB133111EBULL;
+     h ^= h >> 31;
+     return h;
+ }
+
+ void StringPool::normalize(Key& key) {
+     // Trailing '@' (0) and space (32) are padding
+     while (key.length > 0) {
+         uint8_t value = char_at(key.words, key.length - 1);
+         if (value != 0 && value != 32) {
+             break;
+         }
+         size_t i = key.length - 1;
+         size_t shift = 6 * (kCharsPerWord - 1 - i % kCharsPerWord);
+         key.words[i / kCharsPerWord] &= ~(uint64_t(0x3F) << shift);
+         --key.length;
+     }
+ }
+
+ const StringPool::Entry& StringPool::entry(Handle handle) const {
+     const Chunk* chunk = chunks_[handle >> CHUNK_BITS].load(std::memory_order_acquire);
+     return chunk->entries[handle & (CHUNK_SIZE - 1)];
+ }
+
+ StringPool::Handle StringPool::find(const Table& table, const Key& key, uint64_t hash_value) const {
+     for (size_t slot = hash_value & table.mask;; slot = (slot + 1) & table.mask) {
+         Handle handle = table.slots[slot].load(std::memory_order_acquire);
+         if (handle == EMPTY) {
+             return EMPTY;
+         }
+         const Key& candidate = entry(handle).key;
+         if (candidate.length == key.length && candidate.words[0] == key.words[0] &&
+             candidate.words[1] == key.words[1]) {
+             return handle;
+         }
+     }
+ }
+
+ StringPool::Handle StringPool::insert(const Key& key) {
+     std::lock_guard<std::mutex> lock(mutex_);
+     uint64_t hash_value = hash(key);
+
+     // Another thread may have inserted it since the lock-free lookup
+     Handle existing = find(*table_.load(std::memory_order_relaxed), key, hash_value);
+     if (existing != EMPTY) {
+         return existing;
+     }
+
+     size_t index = size_.load(std::memory_order_relaxed);
+     if (index >= MAX_CHUNKS * CHUNK_SIZE) {
+         throw std::length_error("String pool is full");
+     }
+     if ((index + 1) * 2 > table_.load(std::memory_order_relaxed)->mask + 1) {
+         grow();
+     }
+
+     // Fill the entry before publishing its handle
+     std::atomic<Chunk*>& chunk_slot = chunks_[index >> CHUNK_BITS];
+     Chunk* chunk = chunk_slot.load(std::memory_order_relaxed);
+     if (chunk == nullptr) {
+         chunk = new Chunk();
+         chunk_slot.store(chunk, std::memory_order_release);
+     }
+     Entry& e = chunk->entries[index & (CHUNK_SIZE - 1)];
+     e.key = key;
+     for (size_t i = 0; i < key.length; ++i) {
+         e.text[i] = kSixBitAscii[char_at(key.words, i)];
+     }
+
+     Handle handle = static_cast<Handle>(index);
+     size_.store(index + 1, std::memory_order_release);
+
+     Table* table = table_.load(std::memory_order_relaxed);
+     size_t slot = hash_value & table->mask;
+     while (table->slots[slot].load(std::memory_order_relaxed) != EMPTY) {
+         slot = (slot + 1) & table->mask;
+     }
+     table->slots[slot].store(handle, std::memory_order_release);
+     return handle;
+ }
+
+ void StringPool::grow() {
+     Table* old_table = table_.load(std::memory_order_relaxed);
+     size_t slots = (old_table->mask + 1) * 2;
+
+     auto table = std::make_unique<Table>();
+     table->mask = slots - 1;
+     table->slots.reset(new std::atomic<Handle>[slots]);
+     for (size_t i = 0; i < slots; ++i) {
+         table->slots[i].store(EMPTY, std::memory_order_relaxed);
+     }
+
+     size_t count = size_.load(std::memory_order_relaxed);
+     for (Handle handle = 1; handle < count; ++handle) {
+         size_t slot = hash(entry(handle).key) & table->mask;
+         while (table->slots[slot].load(std::memory_order_relaxed) != EMPTY) {
+             slot = (slot + 1) & table->mask;
+         }
+         table->slots[slot].store(handle, std::memory_order_relaxed);
+     }
+
+     // Readers may still be probing the old table; it is kept until destruction
+     table_.store(table.get(), std::memory_order_release);
+     tables_.push_back(std::move(table));
+ }
+
+ } // namespace aislib
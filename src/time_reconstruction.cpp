@@ -0,0 +1,218 @@
+/**
+ * @file time_reconstruction.cpp
+ * @brief Implementation of TimeBatch and TimeReconstructor
+ */
+
+ #include "aislib/time_reconstruction.h"
+ #include "aislib/base_station_report.h"
+ #include "aislib/position_report_class_a.h"
+ #include "aislib/position_report_class_b.h"
+ #include <cmath>
+ #include <limits>
+ #include <stdexcept>
+
+ namespace aislib {
+
+ namespace {
+
+ const size_t kNoRow = std::numeric_limits<size_t>::max();
+
+ // Consecutive rejected samples after which the estimate is restarted (the receiver clock was stepped)
+ const uint32_t kRestartAfterRejections = 3;
+
+ } // anonymous namespace
+
+ void TimeBatch::append(uint32_t receiver_id, double receive_time_value, uint8_t utc_second_value,
+                        double reference_time_value) {
+     receiver.push_back(receiver_id);
+     receive_time.push_back(receive_time_value);
+     utc_second.push_back(utc_second_value);
+     reference_time.push_back(reference_time_value);
+ }
+
+ void TimeBatch::append(uint32_t receiver_id, double receive_time_value, const AISMessage& message) {
+     uint8_t second = 60;
+     double reference = std::nan("");
+
+     if (auto* class_a = dynamic_cast<const PositionReportClassA*>(&message)) {
+         second = class_a->get_timestamp();
+     } else if (auto* class_b = dynamic_cast<const StandardPositionReportClassB*>(&message)) {
+         second = class_b->get_timestamp();
+     } else if (auto* base_station = dynamic_cast<const BaseStationReport*>(&message)) {
+         second = base_station->get_utc_second();
+         auto timestamp = base_station->get_utc_timestamp();
+         if (timestamp.time_since_epoch().count() != 0) {
+             reference = static_cast<double>(
+                 std::chrono::duration_cast<std::chrono::seconds>(timestamp.time_since_epoch()).count());
+         }
+     }
+
+     append(receiver_id, receive_time_value, second, reference);
+ }
+
+ size_t TimeBatch::size() const {
+     return receiver.size();
+ }
+
+ void TimeBatch::reserve(size_t rows) {
+     receiver.reserve(rows);
+     receive_time.reserve(rows);
+     utc_second.reserve(rows);
+     reference_time.reserve(rows);
+     time.reserve(rows);
+     source.reserve(rows);
+ }
+
+ void TimeBatch::clear() {
+     receiver.clear();
+     receive_time.clear();
+     utc_second.clear();
+     reference_time.clear();
+     time.clear();
+     source.clear();
+ }
+
+ TimeReconstructor::TimeReconstructor(const Config& config)
+     : config_(config),
+       rejected_samples_(0) {
+     if (!(config_.skew_smoothing > 0.0 && config_.skew_smoothing <= 1.0)) {
+         throw std::invalid_argument("Skew smoothing must be in (0, 1]");
+     }
+ }
+
+ void TimeReconstructor::reconstruct(TimeBatch& batch) {
+     const size_t rows = batch.receiver.size();
+     if (batch.receive_time.size() != rows || batch.utc_second.size() != rows ||
+         batch.reference_time.size() != rows) {
+         throw std::invalid_argument("Time batch columns differ in length");
+     }
+
+     batch.time.resize(rows);
+     batch.source.resize(rows);
+     row_skew_.resize(rows);
+     row_anchor_.resize(rows);
+     row_anchor_distance_.resize(rows);
+
+     const uint32_t* receiver = batch.receiver.data();
+     const double* receive_time = batch.receive_time.data();
+     const uint8_t* utc_second = batch.utc_second.data();
+     const double* reference_time = batch.reference_time.data();
+
+     // Pass 1, forward: update the skew estimates at base station reports and
+     // record, for every row, the estimate and the latest report before it
+     std::unordered_map<uint32_t, size_t> reference_rows;
+     uint32_t cached_id = 0;
+     ReceiverState* cached = nullptr;
+     for (size_t i = 0; i < rows; ++i) {
+         if (cached == nullptr || receiver[i] != cached_id) {
+             auto it = receivers_.find(receiver[i]);
+             if (it == receivers_.end()) {
+                 it = receivers_.emplace(receiver[i], ReceiverState{std::nan(""), 0, 0, std::nan("")}).first;
+             }
+             cached_id = receiver[i];
+             cached = &it->second;
+         }
+         ReceiverState& state = *cached;
+
+         size_t distance = kNoRow;
+         if (!std::isnan(reference_time[i])) {
+             if (!std::isnan(receive_time[i])) {
+                 add_sample(state, receive_time[i] - reference_time[i]);
+             }
+             state.last_reference = reference_time[i];
+             reference_rows[receiver[i]] = i;
+             distance = 0;
+         } else if (!std::isnan(state.last_reference)) {
+             auto it = reference_rows.find(receiver[i]);
+             distance = it != reference_rows.end() ? i - it->second : kNoRow - 1;
+         }
+
+         row_skew_[i] = state.skew;
+         row_anchor_[i] = state.last_reference;
+         row_anchor_distance_[i] = distance;
+     }
+
+     // Pass 2, backward: rows before the first estimate of their receiver use the
+     // first one after them, and rows closer to a later report are anchored to it
+     next_.clear();
+     if (!reference_rows.empty()) {
+         for (size_t i = rows; i-- > 0;) {
+             if (!std::isnan(reference_time[i])) {
+                 next_[receiver[i]] = Neighbour{row_skew_[i], reference_time[i], i};
+                 continue;
+             }
+             auto it = next_.find(receiver[i]);
+             if (it == next_.end()) {
+                 continue;
+             }
+             if (std::isnan(row_skew_[i])) {
+                 row_skew_[i] = it->second.skew;
+             }
+             if (it->second.row - i < row_anchor_distance_[i]) {
+                 row_anchor_[i] = it->second.reference;
+             }
+         }
+     }
+
+     // Pass 3: place the UTC seconds; no dependencies between rows
+     const double* skew = row_skew_.data();
+     const double* anchor = row_anchor_.data();
+     double* time = batch.time.data();
+     TimeSource* source = batch.source.data();
+     for (size_t i = 0; i < rows; ++i) {
+         double correction = std::isnan(skew[i]) ? 0.0 : skew[i];
+         double estimate = std::isnan(receive_time[i]) ? anchor[i] : receive_time[i] - correction;
+
+         // Closest time with the reported second: same minute, or the one before or after
+         double placed = std::floor(estimate / 60.0) * 60.0 + utc_second[i];
+         double offset = placed - estimate;
+         placed += (offset > 30.0 ? -60.0 : 0.0) + (offset < -30.0 ? 60.0 : 0.0);
+
+         bool has_second = utc_second[i] < 60;
+         bool is_reference = !std::isnan(reference_time[i]);
+         time[i] = is_reference ? reference_time[i] : (has_second ? placed : estimate);
+         source[i] = is_reference ? TimeSource::BASE_STATION
+                   : std::isnan(estimate) ? TimeSource::NONE
+                   : has_second ? TimeSource::UTC_SECOND
+                   : std::isnan(receive_time[i]) ? TimeSource::NEAREST_BASE_STATION
+                   : TimeSource::RECEIVE_TIME;
+     }
+ }
+
+ double TimeReconstructor::get_skew(uint32_t receiver) const {
+     auto it = receivers_.find(receiver);
+     return it != receivers_.end() ? it->second.skew : std::nan("");
+ }
+
+ uint64_t TimeReconstructor::get_rejected_samples() const {
+     return rejected_samples_;
+ }
+
+ void TimeReconstructor::reset() {
+     receivers_.clear();
+     rejected_samples_ = 0;
+ }
+
+ void TimeReconstructor::add_sample(ReceiverState& state, double sample) {
+     if (std::fabs(sample) > config_.max_skew) {
+         ++rejected_samples_;
+         return;
+     }
+
+     // A base station with a wrong clock disagrees with an established estimate;
+     // several disagreeing samples in a row mean the receiver clock itself moved
+     if (state.samples >= kRestartAfterRejections &&
+         std::fabs(sample - state.skew) > config_.outlier_threshold) {
+         ++rejected_samples_;
+         if (++state.rejected_run < kRestartAfterRejections) {
+             return;
+         }
+         state.samples = 0;
+     }
+
+     state.skew = state.samples == 0 ? sample : state.skew + config_.skew_smoothing * (sample - state.skew);
+     ++state.samples;
+     state.rejected_run = 0;
+ }
+
+ } // namespace aislib
@@ -0,0 +1,172 @@
+/**
+ * @file tracing.cpp
+ * @brief Implementation of the per-thread trace buffers
+ */
+
+ #include "aislib/tracing.h"
+ #include <algorithm>
+ #include <iomanip>
+ #include <memory>
+ #include <mutex>
+
+ namespace aislib {
+ namespace trace {
+
+ namespace detail {
+
+ std::atomic<bool> enabled{false};
+
+ } // namespace detail
+
+ namespace {
+
+ // Ring buffer owned by one thread; only the owner writes
+ struct ThreadBuffer {
+     std::vector<Event> events;
+     std::atomic<uint64_t> written{0};
+     uint32_t thread;
+ };
+
+ struct BufferRegistry {
+     std::mutex mutex;
+     std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+     size_t capacity = 1 << 16;
+ };
+
+ // Buffers outlive their threads so that events of finished threads can still be dumped
+ BufferRegistry& registry() {
+     static BufferRegistry instance;
+     return instance;
+ }
+
+ ThreadBuffer& thread_buffer() {
+     thread_local std::shared_ptr<ThreadBuffer> buffer = []() {
+         BufferRegistry& r = registry();
+         std::lock_guard<std::mutex> lock(r.mutex);
+         auto created = std::make_shared<ThreadBuffer>();
+         created->events.resize(r.capacity);
+         created->thread = static_cast<uint32_t>(r.buffers.size() + 1);
+         r.buffers.push_back(created);
+         return created;
+     }();
+     return *buffer;
+ }
+
+ } // anonymous namespace
+
+ namespace detail {
+
+ void record(Point point, uint32_t arg, uint64_t begin_ns, uint64_t end_ns) {
+     ThreadBuffer& buffer = thread_buffer();
+     uint64_t index = buffer.written.load(std::memory_order_relaxed);
+     buffer.events[index & (buffer.events.size() - 1)] = Event{begin_ns, end_ns, buffer.thread, arg, point};
+     buffer.written.store(index + 1, std::memory_order_release);
+ }
+
+ } // namespace detail
+
+ bool is_compiled_in() {
+ #ifdef AISLIB_ENABLE_TRACING
+     return true;
+ #else
+     return false;
+ #endif
+ }
+
+ void set_enabled(bool enabled) {
+     detail::enabled.store(enabled, std::memory_order_relaxed);
+ }
+
+ bool is_enabled() {
+     return detail::enabled.load(std::memory_order_relaxed);
+ }
+
+ void set_buffer_capacity(size_t events) {
+     size_t capacity = 1;
+     while (capacity < events) {
+         capacity <<= 1;
+     }
+
+     BufferRegistry& r = registry();
+     std::lock_guard<std::mutex> lock(r.mutex);
+     r.capacity = capacity;
+ }
+
+ void clear() {
+     BufferRegistry& r = registry();
+     std::lock_guard<std::mutex> lock(r.mutex);
+     for (auto& buffer : r.buffers) {
+         buffer->written.store(0, std::memory_order_relaxed);
+     }
+ }
+
+ std::vector<Event> collect() {
+     std::vector<Event> result;
+
+     BufferRegistry& r = registry();
+     {
+         std::lock_guard<std::mutex> lock(r.mutex);
+         for (const auto& buffer : r.buffers) {
+             uint64_t written = buffer->written.load(std::memory_order_acquire);
+             uint64_t size = buffer->events.size();
+             uint64_t first = written > size ? written - size : 0;
+             for (uint64_t i = first; i < written; ++i) {
+                 result.push_back(buffer->events[i & (size - 1)]);
+             }
+         }
+     }
+
+     std::sort(result.begin(), result.end(), [](const Event& a, const Event& b) {
+         return a.begin_ns < b.begin_ns;
+     });
+     return result;
+ }
+
+ const char* point_name(Point point) {
+     switch (point) {
+         case Point::PARSE: return "parse";
+         case Point::SENTENCE_SCAN: return "sentence_scan";
+         case Point::CHECKSUM: return "checksum";
+         case Point::DEARMOR: return "dearmor";
+         case Point::FACTORY_DISPATCH: return "factory_dispatch";
+         case Point::DECODE: return "decode";
+         case Point::MULTIPART_ADD: return "multipart_add";
+         case Point::MULTIPART_COMPLETE: return "multipart_complete";
+     }
+     return "unknown";
+ }
+
+ void write_chrome_trace(std::ostream& out, const std::vector<Event>& events) {
+     // Complete ("X") events; timestamps are microseconds relative to the first event
+     uint64_t origin = events.empty() ? 0 : events.front().begin_ns;
+     for (const Event& event : events) {
+         origin = std::min(origin, event.begin_ns);
+     }
+
+     // Fixed notation keeps nanosecond resolution however far an event is from the origin
+     std::ios_base::fmtflags flags = out.flags();
+     std::streamsize precision = out.precision();
+     out << std::fixed << std::setprecision(3);
+     out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+     for (size_t i = 0; i < events.size(); ++i) {
+         const Event& event = events[i];
+         if (i > 0) {
+             out << ",";
+         }
+         out << "\n{\"name\":\"" << point_name(event.point) << "\",\"cat\":\"aislib\",\"ph\":\"X\""
+             << ",\"ts\":" << static_cast<double>(event.begin_ns - origin) / 1000.0
+             << ",\"dur\":" << static_cast<double>(event.end_ns - event.begin_ns) / 1000.0
+             << ",\"pid\":1,\"tid\":" << event.thread
+             << ",\"args\":{\"arg\":" << event.arg << "}}";
+     }
+     out << "\n]}\n";
+     out.flags(flags);
+     out.precision(precision);
+ }
+
+ void write_chrome_trace(std::ostream& out) {
+     write_chrome_trace(out, collect());
+ }
+
+ } // namespace trace
+ } // namespace aislib
@@ -0,0 +1,377 @@
+/**
+ * @file track_store.cpp
+ * @brief Implementation of TrackStore
+ */
+
+ #include "aislib/track_store.h"
+ #include "aislib/geo.h"
+ #include "aislib/position_report_class_a.h"
+ #include "aislib/position_report_class_b.h"
+ #include <algorithm>
+ #include <cmath>
+ #include <stdexcept>
+
+ namespace aislib {
+
+ namespace {
+
+ const double kPi = 3.14159265358979323846;
+ const double kRadiansPerDegree = kPi / 180.0;
+ const double kMetersPerDegree = geo::METERS_PER_NM * 60.0;
+ const double kMetersPerSecondPerKnot = geo::METERS_PER_NM / 3600.0;
+
+ // Longitude scale is capped close to the poles
+ const double kMinCosLatitude = 0.01;
+
+ bool valid_position(double latitude, double longitude) {
+     return latitude >= -90.0 && latitude <= 90.0 && longitude >= -180.0 && longitude <= 180.0;
+ }
+
+ bool known_speed(float speed) {
+     // 102.2 knots means 102.2 or more
+     return speed >= 0.0f && speed < 102.2f;
+ }
+
+ bool known_course(float course) {
+     return course >= 0.0f && course < 360.0f;
+ }
+
+ double wrap_longitude(double longitude) {
+     longitude = longitude > 180.0 ? longitude - 360.0 : longitude;
+     return longitude < -180.0 ? longitude + 360.0 : longitude;
+ }
+
+ double clamp_latitude(double latitude) {
+     latitude = latitude > 90.0 ? 90.0 : latitude;
+     return latitude < -90.0 ? -90.0 : latitude;
+ }
+
+ double longitude_scale(double latitude) {
+     return 1.0 / std::max(std::cos(latitude * kRadiansPerDegree), kMinCosLatitude);
+ }
+
+ } // anonymous namespace
+
+ // ---- ProjectedPositions ----
+
+ size_t ProjectedPositions::size() const {
+     return mmsi.size();
+ }
+
+ void ProjectedPositions::clear() {
+     mmsi.clear();
+     latitude.clear();
+     longitude.clear();
+     method.clear();
+ }
+
+ // ---- TrackStore ----
+
+ TrackStore::TrackStore(const Config& config)
+     : config_(config) {
+     if (!(config_.max_extrapolation >= 0.0) || !(config_.max_age >= 0.0)) {
+         throw std::invalid_argument("Track store extrapolation and age limits must not be negative");
+     }
+ }
+
+ bool TrackStore::update(uint32_t mmsi, double time, double latitude, double longitude,
+                         float speed, float course, float rate_of_turn) {
+     if (!valid_position(latitude, longitude) || !std::isfinite(time)) {
+         ++stats_.invalid;
+         return false;
+     }
+
+     size_t row;
+     auto found = index_.find(mmsi);
+     if (found == index_.end()) {
+         row = mmsi_.size();
+         index_.emplace(mmsi, static_cast<uint32_t>(row));
+         mmsi_.push_back(mmsi);
+         time_.push_back(time);
+         latitude_.push_back(latitude);
+         longitude_.push_back(longitude);
+         previous_time_.push_back(time);
+         previous_latitude_.push_back(latitude);
+         previous_longitude_.push_back(longitude);
+         north_.push_back(0.0);
+         east_.push_back(0.0);
+         speed_.push_back(-1.0);
+         course_.push_back(0.0);
+         turn_.push_back(0.0);
+     } else {
+         row = found->second;
+         if (time <= time_[row]) {
+             ++stats_.out_of_order;
+             return false;
+         }
+         previous_time_[row] = time_[row];
+         previous_latitude_[row] = latitude_[row];
+         previous_longitude_[row] = longitude_[row];
+         time_[row] = time;
+         latitude_[row] = latitude;
+         longitude_[row] = longitude;
+     }
+
+     if (known_speed(speed) && known_course(course)) {
+         double meters_per_second = speed * kMetersPerSecondPerKnot;
+         double radians = course * kRadiansPerDegree;
+         speed_[row] = meters_per_second;
+         course_[row] = radians;
+         north_[row] = meters_per_second * std::cos(radians) / kMetersPerDegree;
+         east_[row] = meters_per_second * std::sin(radians) / kMetersPerDegree * longitude_scale(latitude);
+         // Rate of turn is in degrees per minute; infinite means more than 5 degrees in 30 seconds
+         turn_[row] = std::isfinite(rate_of_turn) ? rate_of_turn * kRadiansPerDegree / 60.0 : 0.0;
+     } else {
+         speed_[row] = -1.0;
+         course_[row] = 0.0;
+         north_[row] = 0.0;
+         east_[row] = 0.0;
+         turn_[row] = 0.0;
+     }
+
+     ++stats_.updates;
+     return true;
+ }
+
+ bool TrackStore::update(double time, const AISMessage& message) {
+     if (auto* class_a = dynamic_cast<const PositionReportClassA*>(&message)) {
+         return update(class_a->get_mmsi(), time, class_a->get_latitude(), class_a->get_longitude(),
+                       class_a->get_speed_over_ground(), class_a->get_course_over_ground(),
+                       class_a->get_rate_of_turn());
+     }
+     // Covers type 19, which derives from type 18; Class B reports no rate of turn
+     if (auto* class_b = dynamic_cast<const StandardPositionReportClassB*>(&message)) {
+         return update(class_b->get_mmsi(), time, class_b->get_latitude(), class_b->get_longitude(),
+                       class_b->get_speed_over_ground(), class_b->get_course_over_ground(), 0.0f);
+     }
+     return false;
+ }
+
+ ProjectedPosition TrackStore::position_of(size_t row, double time) const {
+     ProjectedPosition position;
+     if (time < time_[row]) {
+         if (time < previous_time_[row]) {
+             position.latitude = previous_latitude_[row];
+             position.longitude = previous_longitude_[row];
+             position.method = ProjectionMethod::HELD;
+             return position;
+         }
+         double fraction = (time - previous_time_[row]) / (time_[row] - previous_time_[row]);
+         double delta = longitude_[row] - previous_longitude_[row];
+         delta = delta > 180.0 ? delta - 360.0 : (delta < -180.0 ? delta + 360.0 : delta);
+         position.latitude = previous_latitude_[row] + fraction * (latitude_[row] - previous_latitude_[row]);
+         position.longitude = wrap_longitude(previous_longitude_[row] + fraction * delta);
+         position.method = ProjectionMethod::INTERPOLATED;
+         return position;
+     }
+
+     if (speed_[row] < 0.0) {
+         position.latitude = latitude_[row];
+         position.longitude = longitude_[row];
+         position.method = ProjectionMethod::HELD;
+         return position;
+     }
+
+     double ahead = std::min(time - time_[row], config_.max_extrapolation);
+     double turn = turn_[row];
+     if (turn == 0.0) {
+         position.latitude = clamp_latitude(latitude_[row] + north_[row] * ahead);
+         position.longitude = wrap_longitude(longitude_[row] + east_[row] * ahead);
+     } else {
+         // Constant-rate turn: integrate the velocity over the arc
+         double course = course_[row];
+         double radius = speed_[row] / turn;
+         double north = radius * (std::sin(course + turn * ahead) - std::sin(course));
+         double east = radius * (std::cos(course) - std::cos(course + turn * ahead));
+         position.latitude = clamp_latitude(latitude_[row] + north / kMetersPerDegree);
+         position.longitude = wrap_longitude(longitude_[row] +
+                                             east / kMetersPerDegree * longitude_scale(latitude_[row]));
+     }
+     position.method = ProjectionMethod::DEAD_RECKONED;
+     return position;
+ }
+
+ bool TrackStore::position_at(uint32_t mmsi, double time, ProjectedPosition& position) const {
+     auto found = index_.find(mmsi);
+     if (found == index_.end() || time - time_[found->second] > config_.max_age) {
+         return false;
+     }
+     position = position_of(found->second, time);
+     return true;
+ }
+
+ size_t TrackStore::project(double time, double min_lat, double min_lon, double max_lat, double max_lon,
+                            ProjectedPositions& positions) {
+     positions.clear();
+     const size_t rows = mmsi_.size();
+     straight_latitude_.resize(rows);
+     straight_longitude_.resize(rows);
+
+     // First pass: every vessel moves along its course, without branches
+     const double max_extrapolation = config_.max_extrapolation;
+     const double* time_column = time_.data();
+     const double* latitude_column = latitude_.data();
+     const double* longitude_column = longitude_.data();
+     const double* north_column = north_.data();
+     const double* east_column = east_.data();
+     double* straight_latitude = straight_latitude_.data();
+     double* straight_longitude = straight_longitude_.data();
+     for (size_t i = 0; i < rows; ++i) {
+         double ahead = time - time_column[i];
+         ahead = ahead < 0.0 ? 0.0 : ahead;
+         ahead = ahead > max_extrapolation ? max_extrapolation : ahead;
+         straight_latitude[i] = clamp_latitude(latitude_column[i] + north_column[i] * ahead);
+         straight_longitude[i] = wrap_longitude(longitude_column[i] + east_column[i] * ahead);
+     }
+
+     // Second pass: recompute turning vessels and queries before the last report, then test the box
+     const bool wraps = min_lon > max_lon;
+     for (size_t i = 0; i < rows; ++i) {
+         if (time - time_column[i] > config_.max_age) {
+             continue;
+         }
+         ProjectedPosition position;
+         if (time >= time_column[i] && turn_[i] == 0.0) {
+             position.latitude = straight_latitude[i];
+             position.longitude = straight_longitude[i];
+             position.method = speed_[i] < 0.0 ? ProjectionMethod::HELD : ProjectionMethod::DEAD_RECKONED;
+         } else {
+             position = position_of(i, time);
+         }
+
+         if (position.latitude < min_lat || position.latitude > max_lat) {
+             continue;
+         }
+         bool inside = wraps ? (position.longitude >= min_lon || position.longitude <= max_lon)
+                             : (position.longitude >= min_lon && position.longitude <= max_lon);
+         if (!inside) {
+             continue;
+         }
+         positions.mmsi.push_back(mmsi_[i]);
+         positions.latitude.push_back(position.latitude);
+         positions.longitude.push_back(position.longitude);
+         positions.method.push_back(position.method);
+     }
+     return positions.size();
+ }
+
+ void TrackStore::remove_row(size_t row) {
+     size_t last = mmsi_.size() - 1;
+     index_.erase(mmsi_[row]);
+     if (row != last) {
+         mmsi_[row] = mmsi_[last];
+         time_[row] = time_[last];
+         latitude_[row] = latitude_[last];
+         longitude_[row] = longitude_[last];
+         previous_time_[row] = previous_time_[last];
+         previous_latitude_[row] = previous_latitude_[last];
+         previous_longitude_[row] = previous_longitude_[last];
+         north_[row] = north_[last];
+         east_[row] = east_[last];
+         speed_[row] = speed_[last];
+         course_[row] = course_[last];
+         turn_[row] = turn_[last];
+         index_[mmsi_[row]] = static_cast<uint32_t>(row);
+     }
+     mmsi_.pop_back();
+     time_.pop_back();
+     latitude_.pop_back();
+     longitude_.pop_back();
+     previous_time_.pop_back();
+     previous_latitude_.pop_back();
+     previous_longitude_.pop_back();
+     north_.pop_back();
+     east_.pop_back();
+     speed_.pop_back();
+     course_.pop_back();
+     turn_.pop_back();
+ }
+
+ size_t TrackStore::expire(double now) {
+     size_t dropped = 0;
+     // Rows moved into a freed row come from the end, which has already been checked
+     for (size_t row = mmsi_.size(); row-- > 0;) {
+         if (now - time_[row] > config_.max_age) {
+             remove_row(row);
+             ++dropped;
+         }
+     }
+     return dropped;
+ }
+
+ void TrackStore::clear() {
+     index_.clear();
+     mmsi_.clear();
+     time_.clear();
+     latitude_.clear();
+     longitude_.clear();
+     previous_time_.clear();
+     previous_latitude_.clear();
+     previous_longitude_.clear();
+     north_.clear();
+     east_.clear();
+     speed_.clear();
+     course_.clear();
+     turn_.clear();
+ }
+
+ size_t TrackStore::tracks(std::vector<Track>& tracks) const {
+     tracks.resize(mmsi_.size());
+     for (size_t row = 0; row < mmsi_.size(); ++row) {
+         Track& track = tracks[row];
+         track.mmsi = mmsi_[row];
+         track.time = time_[row];
+         track.latitude = latitude_[row];
+         track.longitude = longitude_[row];
+         track.previous_time = previous_time_[row];
+         track.previous_latitude = previous_latitude_[row];
+         track.previous_longitude = previous_longitude_[row];
+         track.north = north_[row];
+         track.east = east_[row];
+         track.speed = speed_[row];
+         track.course = course_[row];
+         track.turn = turn_[row];
+     }
+     return tracks.size();
+ }
+
+ void TrackStore::restore(const Track* tracks, size_t count) {
+     clear();
+     index_.reserve(count);
+     for (auto* column : {&time_, &latitude_, &longitude_, &previous_time_, &previous_latitude_,
+                          &previous_longitude_, &north_, &east_, &speed_, &course_, &turn_}) {
+         column->resize(count);
+     }
+     mmsi_.resize(count);
+     for (size_t row = 0; row < count; ++row) {
+         const Track& track = tracks[row];
+         if (!index_.emplace(track.mmsi, static_cast<uint32_t>(row)).second) {
+             clear();
+             throw std::invalid_argument("Restored tracks repeat an MMSI");
+         }
+         mmsi_[row] = track.mmsi;
+         time_[row] = track.time;
+         latitude_[row] = track.latitude;
+         longitude_[row] = track.longitude;
+         previous_time_[row] = track.previous_time;
+         previous_latitude_[row] = track.previous_latitude;
+         previous_longitude_[row] = track.previous_longitude;
+         north_[row] = track.north;
+         east_[row] = track.east;
+         speed_[row] = track.speed;
+         course_[row] = track.course;
+         turn_[row] = track.turn;
+     }
+ }
+
+ size_t TrackStore::size() const {
+     return mmsi_.size();
+ }
+
+ TrackStore::Stats TrackStore::get_stats() const {
+     Stats stats = stats_;
+     stats.vessels = mmsi_.size();
+     return stats;
+ }
+
+ } // namespace aislib
@@ -0,0 +1,204 @@
+/**
+ * @file vdl_load.cpp
+ * @brief Implementation of VdlLoadMonitor
+ */
+
+ #include "aislib/vdl_load.h"
+ #include <algorithm>
+ #include <cmath>
+ #include <stdexcept>
+
+ namespace aislib {
+
+ VdlLoadMonitor::VdlLoadMonitor(const Config& config)
+     : config_(config),
+       late_(0) {
+     if (config_.window_frames == 0) {
+         throw std::invalid_argument("VDL load window must cover at least one frame");
+     }
+ }
+
+ bool VdlLoadMonitor::add(uint32_t receiver, char channel, double time, const AISMessage& message) {
+     CommunicationState state;
+     CommunicationState::from_message(message, state);
+     return add(receiver, channel, time, state, slots_for_type(message.get_message_type()));
+ }
+
+ bool VdlLoadMonitor::add(uint32_t receiver, char channel, double time, const CommunicationState& state, uint8_t slots) {
+     uint64_t key = key_for(receiver, channel);
+     auto it = cells_.find(key);
+     if (it == cells_.end()) {
+         Cell cell;
+         cell.first = static_cast<int64_t>(std::floor(time / 60.0));
+         cell.latest = cell.first;
+         cell.frames.resize(config_.window_frames);
+         for (auto& frame : cell.frames) {
+             frame.index = -1;
+         }
+         it = cells_.emplace(key, std::move(cell)).first;
+     }
+
+     Frame* frame = frame_for(it->second, static_cast<int64_t>(std::floor(time / 60.0)));
+     if (frame == nullptr) {
+         ++late_;
+         return false;
+     }
+
+     ++frame->messages;
+     frame->slots += slots;
+     switch (state.access) {
+         case CommunicationState::Access::NONE:
+             ++frame->no_tdma;
+             return true;
+         case CommunicationState::Access::SOTDMA:
+             ++frame->sotdma;
+             break;
+         case CommunicationState::Access::ITDMA:
+             ++frame->itdma;
+             break;
+     }
+     ++frame->sync_states[static_cast<size_t>(state.sync_state) & 0x3];
+
+     int stations = state.get_received_stations();
+     if (stations >= 0) {
+         ++frame->received_stations[station_bucket(static_cast<uint32_t>(stations))];
+         ++frame->station_reports;
+         frame->station_sum += static_cast<uint64_t>(stations);
+         frame->station_max = std::max(frame->station_max, static_cast<uint32_t>(stations));
+     }
+
+     int slot = state.get_slot_number();
+     if (slot >= 0 && static_cast<uint32_t>(slot) < SLOTS_PER_FRAME) {
+         frame->slot_bits[static_cast<size_t>(slot) / 64] |= uint64_t(1) << (slot % 64);
+     }
+     return true;
+ }
+
+ void VdlLoadMonitor::advance(double time) {
+     int64_t index = static_cast<int64_t>(std::floor(time / 60.0));
+     for (auto& entry : cells_) {
+         entry.second.latest = std::max(entry.second.latest, index);
+     }
+ }
+
+ VdlLoad VdlLoadMonitor::get_load(uint32_t receiver, char channel) const {
+     uint64_t key = key_for(receiver, channel);
+     auto it = cells_.find(key);
+     if (it == cells_.end()) {
+         VdlLoad load;
+         load.receiver = receiver;
+         load.channel = static_cast<char>(key & 0xFF);
+         return load;
+     }
+     return summarize(key, it->second);
+ }
+
+ std::vector<VdlLoad> VdlLoadMonitor::get_loads() const {
+     std::vector<std::pair<uint64_t, const Cell*>> ordered;
+     ordered.reserve(cells_.size());
+     for (const auto& entry : cells_) {
+         ordered.emplace_back(entry.first, &entry.second);
+     }
+     std::sort(ordered.begin(), ordered.end(),
+               [](const auto& a, const auto& b) { return a.first < b.first; });
+
+     std::vector<VdlLoad> loads;
+     loads.reserve(ordered.size());
+     for (const auto& entry : ordered) {
+         loads.push_back(summarize(entry.first, *entry.second));
+     }
+     return loads;
+ }
+
+ uint64_t VdlLoadMonitor::get_late() const {
+     return late_;
+ }
+
+ void VdlLoadMonitor::clear() {
+     cells_.clear();
+     late_ = 0;
+ }
+
+ uint8_t VdlLoadMonitor::slots_for_type(uint8_t message_type) {
+     // Types 5 (424 bits) and 19 (312 bits) need two slots; the others fit in one
+     return (message_type == 5 || message_type == 19) ? 2 : 1;
+ }
+
+ VdlLoadMonitor::Frame* VdlLoadMonitor::frame_for(Cell& cell, int64_t index) {
+     const int64_t window = static_cast<int64_t>(config_.window_frames);
+     if (index <= cell.latest - window) {
+         return nullptr;
+     }
+     cell.latest = std::max(cell.latest, index);
+     cell.first = std::min(cell.first, index);
+
+     // Each ring slot holds one frame; a slot still holding an older frame is reused
+     Frame& frame = cell.frames[static_cast<size_t>(((index % window) + window) % window)];
+     if (frame.index != index) {
+         frame = Frame();
+         frame.index = index;
+     }
+     return &frame;
+ }
+
+ VdlLoad VdlLoadMonitor::summarize(uint64_t key, const Cell& cell) const {
+     const int64_t window = static_cast<int64_t>(config_.window_frames);
+
+     VdlLoad load;
+     load.receiver = static_cast<uint32_t>(key >> 8);
+     load.channel = static_cast<char>(key & 0xFF);
+     load.first_frame = std::max(cell.first, cell.latest - window + 1);
+     load.frames = static_cast<uint32_t>(cell.latest - load.first_frame + 1);
+
+     std::array<uint64_t, SLOT_WORDS> slot_bits{};
+     uint64_t station_reports = 0;
+     uint64_t station_sum = 0;
+     for (const Frame& frame : cell.frames) {
+         if (frame.index < load.first_frame || frame.index > cell.latest) {
+             continue;
+         }
+         load.messages += frame.messages;
+         load.slots += frame.slots;
+         load.sotdma += frame.sotdma;
+         load.itdma += frame.itdma;
+         load.no_tdma += frame.no_tdma;
+         for (size_t i = 0; i < load.sync_states.size(); ++i) {
+             load.sync_states[i] += frame.sync_states[i];
+         }
+         for (size_t i = 0; i < load.received_stations.size(); ++i) {
+             load.received_stations[i] += frame.received_stations[i];
+         }
+         station_reports += frame.station_reports;
+         station_sum += frame.station_sum;
+         load.max_received_stations = std::max(load.max_received_stations, frame.station_max);
+         for (size_t i = 0; i < SLOT_WORDS; ++i) {
+             slot_bits[i] |= frame.slot_bits[i];
+         }
+     }
+
+     for (uint64_t word : slot_bits) {
+         load.distinct_slots += static_cast<uint32_t>(__builtin_popcountll(word));
+     }
+     load.occupancy = static_cast<double>(load.slots) / (static_cast<double>(SLOTS_PER_FRAME) * load.frames);
+     if (station_reports > 0) {
+         load.mean_received_stations = static_cast<double>(station_sum) / static_cast<double>(station_reports);
+     }
+     return load;
+ }
+
+ uint64_t VdlLoadMonitor::key_for(uint32_t receiver, char channel) {
+     // Some receivers log the channels as 1 and 2
+     char normalized = (channel == '1') ? 'A' : (channel == '2') ? 'B' : channel;
+     return (static_cast<uint64_t>(receiver) << 8) | static_cast<uint8_t>(normalized);
+ }
+
+ size_t VdlLoadMonitor::station_bucket(uint32_t stations) {
+     size_t bucket = 0;
+     while (stations != 0 && bucket + 1 < VdlLoad::STATION_BUCKETS) {
+         stations >>= 1;
+         ++bucket;
+     }
+     return bucket;
+ }
+
+ } // namespace aislib
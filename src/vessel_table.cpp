@@ -0,0 +1,397 @@
+/**
+ * @file vessel_table.cpp
+ * @brief Implementation of VesselTable
+ */
+
+ #include "aislib/vessel_table.h"
+ #include "aislib/static_and_voyage_data.h"
+ #include "aislib/static_data_report.h"
+ #include <algorithm>
+ #include <cerrno>
+ #include <chrono>
+ #include <cstdio>
+ #include <cstring>
+ #include <stdexcept>
+ #include <type_traits>
+
+ #ifdef __linux__
+ #include <fcntl.h>
+ #include <sys/mman.h>
+ #include <sys/stat.h>
+ #include <unistd.h>
+ #endif
+
+ namespace aislib {
+
+ namespace {
+
+ const uint64_t kMagic = 0x4C42545654534941ULL;   // "AISVTBL"
+ const uint32_t kVersion = 1;
+
+ enum Section : uint32_t { STRINGS, STATICS, TRACKS, CLASS_B, SECTION_COUNT };
+
+ struct SnapshotSection {
+     uint64_t offset;        // From the start of the file, a multiple of 8
+     uint64_t count;
+     uint64_t record_size;   // Checked on load, so a changed record layout is rejected
+ };
+
+ struct SnapshotHeader {
+     uint64_t magic;
+     uint32_t version;
+     uint32_t section_count;
+     double saved_at;        // Wall-clock time of the snapshot (Unix seconds)
+     uint64_t file_size;
+     SnapshotSection sections[SECTION_COUNT];
+ };
+
+ struct SavedString {
+     uint8_t length;
+     char text[StringPool::MAX_LENGTH];
+ };
+
+ // Steady-clock part times do not survive a restart; they are saved as ages
+ struct SavedClassB {
+     ClassBStaticRecord record;   // Part times zeroed
+     double part_a_age;           // Seconds before the snapshot
+     double part_b_age;
+ };
+
+ const uint64_t kRecordSizes[SECTION_COUNT] = {
+     sizeof(SavedString), sizeof(VesselStatic), sizeof(TrackStore::Track), sizeof(SavedClassB)
+ };
+
+ // Records are copied into and out of the snapshot with memcpy
+ static_assert(std::is_trivially_copyable<SavedString>::value, "Snapshot records must be trivially copyable");
+ static_assert(std::is_trivially_copyable<VesselStatic>::value, "Snapshot records must be trivially copyable");
+ static_assert(std::is_trivially_copyable<TrackStore::Track>::value, "Snapshot records must be trivially copyable");
+ static_assert(std::is_trivially_copyable<SavedClassB>::value, "Snapshot records must be trivially copyable");
+
+ size_t align8(size_t offset) {
+     return (offset + 7) & ~size_t(7);
+ }
+
+ double wall_clock_now() {
+     return std::chrono::duration<double>(std::chrono::system_clock::now().time_since_epoch()).count();
+ }
+
+ std::runtime_error os_error(const std::string& what) {
+     return std::runtime_error(what + ": " + std::strerror(errno));
+ }
+
+ std::runtime_error invalid_snapshot(const char* why) {
+     return std::runtime_error(std::string("Invalid vessel snapshot: ") + why);
+ }
+
+ size_t write_file(const std::vector<char>& image, const std::string& path) {
+     const std::string temporary = path + ".tmp";
+     std::FILE* file = std::fopen(temporary.c_str(), "wb");
+     if (file == nullptr) {
+         throw os_error("Failed to create " + temporary);
+     }
+     bool written = std::fwrite(image.data(), 1, image.size(), file) == image.size() && std::fflush(file) == 0;
+ #ifdef __linux__
+     written = written && ::fsync(::fileno(file)) == 0;
+ #endif
+     if (std::fclose(file) != 0 || !written) {
+         std::runtime_error error = os_error("Failed to write " + temporary);
+         std::remove(temporary.c_str());
+         throw error;
+     }
+     if (std::rename(temporary.c_str(), path.c_str()) != 0) {
+         std::runtime_error error = os_error("Failed to replace " + path);
+         std::remove(temporary.c_str());
+         throw error;
+     }
+     return image.size();
+ }
+
+ } // anonymous namespace
+
+ VesselTable::VesselTable(const Config& config)
+     : config_(config),
+       tracks_(config.tracks),
+       class_b_(config.class_b),
+       strings_(std::make_unique<StringPool>()) {
+ }
+
+ bool VesselTable::update(double time, const AISMessage& message, Clock::time_point now) {
+     if (auto* voyage = dynamic_cast<const StaticAndVoyageData*>(&message)) {
+         uint32_t mmsi = voyage->get_mmsi();
+         auto found = static_index_.find(mmsi);
+         if (found == static_index_.end()) {
+             found = static_index_.emplace(mmsi, static_cast<uint32_t>(statics_.size())).first;
+             statics_.emplace_back();
+         } else if (time < statics_[found->second].time) {
+             return false;
+         }
+
+         VesselStatic& record = statics_[found->second];
+         record.mmsi = mmsi;
+         record.imo_number = voyage->get_imo_number();
+         record.dimension_to_bow = voyage->get_dimension_to_bow();
+         record.dimension_to_stern = voyage->get_dimension_to_stern();
+         record.dimension_to_port = voyage->get_dimension_to_port();
+         record.dimension_to_starboard = voyage->get_dimension_to_starboard();
+         record.ship_type = static_cast<uint8_t>(voyage->get_ship_type());
+         record.epfd_type = voyage->get_epfd_type();
+         record.eta_month = voyage->get_eta_month();
+         record.eta_day = voyage->get_eta_day();
+         record.eta_hour = voyage->get_eta_hour();
+         record.eta_minute = voyage->get_eta_minute();
+         record.draught = voyage->get_draught();
+         record.vessel_name = strings_->intern(voyage->get_vessel_name());
+         record.call_sign = strings_->intern(voyage->get_call_sign());
+         record.destination = strings_->intern(voyage->get_destination());
+         record.time = time;
+         return true;
+     }
+     if (auto* report = dynamic_cast<const StaticDataReport*>(&message)) {
+         class_b_.update(*report, now);
+         return true;
+     }
+     return tracks_.update(time, message);
+ }
+
+ const VesselStatic* VesselTable::find_static(uint32_t mmsi) const {
+     auto found = static_index_.find(mmsi);
+     return found != static_index_.end() ? &statics_[found->second] : nullptr;
+ }
+
+ std::string_view VesselTable::text(StringPool::Handle handle) const {
+     return strings_->view(handle);
+ }
+
+ TrackStore& VesselTable::tracks() {
+     return tracks_;
+ }
+
+ const TrackStore& VesselTable::tracks() const {
+     return tracks_;
+ }
+
+ ClassBStaticCache& VesselTable::class_b() {
+     return class_b_;
+ }
+
+ const ClassBStaticCache& VesselTable::class_b() const {
+     return class_b_;
+ }
+
+ std::vector<char> VesselTable::serialize() const {
+     std::vector<TrackStore::Track> tracks;
+     tracks_.tracks(tracks);
+     std::vector<ClassBStaticRecord> class_b;
+     class_b_.records(class_b);
+
+     SnapshotHeader header = SnapshotHeader();
+     header.magic = kMagic;
+     header.version = kVersion;
+     header.section_count = SECTION_COUNT;
+     header.saved_at = wall_clock_now();
+     const uint64_t counts[SECTION_COUNT] = {strings_->size(), statics_.size(), tracks.size(), class_b.size()};
+     size_t offset = align8(sizeof(SnapshotHeader));
+     for (uint32_t section = 0; section < SECTION_COUNT; ++section) {
+         header.sections[section] = SnapshotSection{offset, counts[section], kRecordSizes[section]};
+         offset = align8(offset + counts[section] * kRecordSizes[section]);
+     }
+     header.file_size = offset;
+
+     std::vector<char> image(offset, 0);
+     std::memcpy(image.data(), &header, sizeof(header));
+
+     char* strings = image.data() + header.sections[STRINGS].offset;
+     for (StringPool::Handle handle = 0; handle < counts[STRINGS]; ++handle) {
+         std::string_view value = strings_->view(handle);
+         SavedString saved = SavedString();
+         saved.length = static_cast<uint8_t>(value.size());
+         std::memcpy(saved.text, value.data(), value.size());
+         std::memcpy(strings + handle * sizeof(SavedString), &saved, sizeof(saved));
+     }
+     if (!statics_.empty()) {
+         std::memcpy(image.data() + header.sections[STATICS].offset, statics_.data(),
+                     statics_.size() * sizeof(VesselStatic));
+     }
+     if (!tracks.empty()) {
+         std::memcpy(image.data() + header.sections[TRACKS].offset, tracks.data(),
+                     tracks.size() * sizeof(TrackStore::Track));
+     }
+
+     const Clock::time_point now = Clock::now();
+     char* saved_class_b = image.data() + header.sections[CLASS_B].offset;
+     for (size_t i = 0; i < class_b.size(); ++i) {
+         SavedClassB saved{};
+         saved.record = class_b[i];
+         saved.part_a_age = std::chrono::duration<double>(now - class_b[i].part_a_time).count();
+         saved.part_b_age = std::chrono::duration<double>(now - class_b[i].part_b_time).count();
+         saved.record.part_a_time = Clock::time_point();
+         saved.record.part_b_time = Clock::time_point();
+         std::memcpy(saved_class_b + i * sizeof(SavedClassB), &saved, sizeof(saved));
+     }
+     return image;
+ }
+
+ size_t VesselTable::save(const std::string& path) const {
+     return write_file(serialize(), path);
+ }
+
+ std::future<size_t> VesselTable::save_async(const std::string& path) const {
+     return std::async(std::launch::async, [image = serialize(), path]() {
+         return write_file(image, path);
+     });
+ }
+
+ void VesselTable::restore(const char* data, size_t size, Clock::time_point now) {
+     SnapshotHeader header;
+     if (size < sizeof(header)) {
+         throw invalid_snapshot("file too short");
+     }
+     std::memcpy(&header, data, sizeof(header));
+     if (header.magic != kMagic) {
+         throw invalid_snapshot("bad magic");
+     }
+     if (header.version != kVersion || header.section_count != SECTION_COUNT) {
+         throw invalid_snapshot("unsupported version");
+     }
+     if (header.file_size != size) {
+         throw invalid_snapshot("file size does not match the header");
+     }
+     for (uint32_t section = 0; section < SECTION_COUNT; ++section) {
+         const SnapshotSection& entry = header.sections[section];
+         if (entry.record_size != kRecordSizes[section]) {
+             throw invalid_snapshot("record layout differs");
+         }
+         if (entry.offset % 8 != 0 || entry.offset > size ||
+             entry.count > (size - entry.offset) / entry.record_size) {
+             throw invalid_snapshot("section out of bounds");
+         }
+     }
+
+     // Strings are interned in handle order, so saved handles stay valid
+     const SnapshotSection& strings = header.sections[STRINGS];
+     if (strings.count == 0) {
+         throw invalid_snapshot("string table without the empty string");
+     }
+     strings_ = std::make_unique<StringPool>(strings.count);
+     for (uint64_t handle = 0; handle < strings.count; ++handle) {
+         SavedString saved;
+         std::memcpy(&saved, data + strings.offset + handle * sizeof(SavedString), sizeof(saved));
+         if (saved.length > StringPool::MAX_LENGTH ||
+             strings_->intern(std::string_view(saved.text, saved.length)) != handle) {
+             throw invalid_snapshot("corrupt string table");
+         }
+     }
+
+     const SnapshotSection& statics = header.sections[STATICS];
+     statics_.resize(statics.count);
+     if (statics.count != 0) {
+         std::memcpy(statics_.data(), data + statics.offset, statics.count * sizeof(VesselStatic));
+     }
+     static_index_.reserve(statics.count);
+     for (uint32_t i = 0; i < statics_.size(); ++i) {
+         const VesselStatic& record = statics_[i];
+         if (record.vessel_name >= strings.count || record.call_sign >= strings.count ||
+             record.destination >= strings.count) {
+             throw invalid_snapshot("string handle out of range");
+         }
+         if (!static_index_.emplace(record.mmsi, i).second) {
+             throw invalid_snapshot("static data repeats an MMSI");
+         }
+     }
+
+     // The mapping is page-aligned and sections are 8-byte aligned, so tracks are read in place
+     const SnapshotSection& tracks = header.sections[TRACKS];
+     try {
+         tracks_.restore(reinterpret_cast<const TrackStore::Track*>(data + tracks.offset), tracks.count);
+     } catch (const std::invalid_argument&) {
+         throw invalid_snapshot("tracks repeat an MMSI");
+     }
+
+     // Part ages grow by the time the service was down
+     const double downtime = std::max(0.0, wall_clock_now() - header.saved_at);
+     const SnapshotSection& class_b = header.sections[CLASS_B];
+     for (uint64_t i = 0; i < class_b.count; ++i) {
+         SavedClassB saved;
+         std::memcpy(&saved, data + class_b.offset + i * sizeof(SavedClassB), sizeof(saved));
+         saved.record.part_a_time = now - std::chrono::duration_cast<Clock::duration>(
+                                              std::chrono::duration<double>(saved.part_a_age + downtime));
+         saved.record.part_b_time = now - std::chrono::duration_cast<Clock::duration>(
+                                              std::chrono::duration<double>(saved.part_b_age + downtime));
+         class_b_.restore(saved.record);
+     }
+ }
+
+ void VesselTable::load(const std::string& path, Clock::time_point now) {
+     clear();
+ #ifdef __linux__
+     int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+     if (fd < 0) {
+         throw os_error("Failed to open " + path);
+     }
+     struct stat status;
+     if (::fstat(fd, &status) != 0) {
+         std::runtime_error error = os_error("Failed to stat " + path);
+         ::close(fd);
+         throw error;
+     }
+     size_t size = static_cast<size_t>(status.st_size);
+     if (size < sizeof(SnapshotHeader)) {
+         ::close(fd);
+         throw invalid_snapshot("file too short");
+     }
+     void* memory = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE | MAP_POPULATE, fd, 0);
+     ::close(fd);
+     if (memory == MAP_FAILED) {
+         throw os_error("Failed to map " + path);
+     }
+     try {
+         restore(static_cast<const char*>(memory), size, now);
+     } catch (...) {
+         ::munmap(memory, size);
+         clear();
+         throw;
+     }
+     ::munmap(memory, size);
+ #else
+     std::FILE* file = std::fopen(path.c_str(), "rb");
+     if (file == nullptr) {
+         throw os_error("Failed to open " + path);
+     }
+     std::fseek(file, 0, SEEK_END);
+     long length = std::ftell(file);
+     std::fseek(file, 0, SEEK_SET);
+     size_t size = length > 0 ? static_cast<size_t>(length) : 0;
+     // 8-byte aligned storage, as the tracks are read in place
+     std::vector<uint64_t> buffer((size + 7) / 8);
+     bool complete = std::fread(buffer.data(), 1, size, file) == size;
+     std::fclose(file);
+     if (!complete) {
+         throw std::runtime_error("Failed to read " + path);
+     }
+     try {
+         restore(reinterpret_cast<const char*>(buffer.data()), size, now);
+     } catch (...) {
+         clear();
+         throw;
+     }
+ #endif
+ }
+
+ void VesselTable::clear() {
+     tracks_.clear();
+     class_b_.clear();
+     strings_ = std::make_unique<StringPool>();
+     statics_.clear();
+     static_index_.clear();
+ }
+
+ VesselTable::Stats VesselTable::get_stats() const {
+     Stats stats;
+     stats.tracks = tracks_.size();
+     stats.statics = statics_.size();
+     stats.class_b = class_b_.size();
+     stats.strings = strings_->size();
+     return stats;
+ }
+
+ } // namespace aislib
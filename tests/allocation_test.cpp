@@ -0,0 +1,89 @@
+#include <gtest/gtest.h>
+#include "aislib/allocation_counter.h"
+#include "aislib/ais_parser.h"
+#include "aislib/nmea_utils.h"
+#include <string>
+#include <vector>
+
+using namespace aislib;
+using aislib::alloc::AllocationScope;
+
+namespace {
+
+// One sentence per single-part message type
+const std::vector<std::string> kPositionReports = {
+    "!AIVDM,1,1,,A,13P7AnP01rP5@HHLrMOd6ab00000,0*37",
+    "!AIVDM,1,1,,A,23tfDIP012P9wmfM6L2paVr00000,0*4E",
+    "!AIVDM,1,1,,B,33tfE5P0jEP4G8rMD:Sn54n00000,0*30",
+    "!AIVDM,1,1,,B,402=VQ1vQPd00P80dPMDm<700000,0*38",
+    "!AIVDM,1,1,,A,B3m63eh0;@1gkRWH@IHnwwP40000,0*42"
+};
+
+const int kWarmUpRounds = 4;
+const int kMeasuredRounds = 100;
+
+} // anonymous namespace
+
+TEST(AllocationTest, CounterCountsThisThread) {
+    AllocationScope scope;
+    // Volatile sinks keep the optimizer from eliding the allocations
+    void* volatile first = ::operator new(64);
+    void* volatile second = ::operator new(400);
+    ::operator delete(first);
+    ::operator delete(second);
+    EXPECT_EQ(scope.count(), 2u);
+}
+
+TEST(AllocationTest, ChecksumDoesNotAllocate) {
+    AllocationScope scope;
+    for (const auto& sentence : kPositionReports) {
+        EXPECT_TRUE(NMEAUtils::validate_checksum(sentence));
+    }
+    EXPECT_EQ(scope.count(), 0u);
+}
+
+TEST(AllocationTest, FieldParsingReusesStorage) {
+    std::vector<std::string> fields;
+    NMEAUtils::parse_fields(kPositionReports[0], fields);
+
+    AllocationScope scope;
+    for (int round = 0; round < kMeasuredRounds; ++round) {
+        for (const auto& sentence : kPositionReports) {
+            NMEAUtils::parse_fields(sentence, fields);
+            ASSERT_EQ(fields.size(), 7u);
+        }
+    }
+    EXPECT_EQ(scope.count(), 0u);
+}
+
+// After warm-up, a single-part sentence costs exactly one allocation: the returned message
+TEST(AllocationTest, SteadyStateParseAllocatesOnlyTheMessage) {
+    AISParser parser;
+    for (int round = 0; round < kWarmUpRounds; ++round) {
+        for (const auto& sentence : kPositionReports) {
+            ASSERT_NE(parser.parse(sentence), nullptr) << sentence;
+        }
+    }
+
+    for (const auto& sentence : kPositionReports) {
+        AllocationScope scope;
+        for (int round = 0; round < kMeasuredRounds; ++round) {
+            auto message = parser.parse(sentence);
+            ASSERT_NE(message, nullptr);
+        }
+        EXPECT_EQ(scope.count(), static_cast<uint64_t>(kMeasuredRounds)) << sentence;
+    }
+}
+
+TEST(AllocationTest, RejectedSentencesDoNotAllocate) {
+    const std::string bad_checksum = "!AIVDM,1,1,,A,13P7AnP01rP5@HHLrMOd6ab00000,0*00";
+    AISParser parser;
+    parser.parse(kPositionReports[0]);
+    parser.parse(bad_checksum);
+
+    AllocationScope scope;
+    for (int round = 0; round < kMeasuredRounds; ++round) {
+        EXPECT_EQ(parser.parse(bad_checksum), nullptr);
+    }
+    EXPECT_EQ(scope.count(), 0u);
+}
@@ -0,0 +1,196 @@
+#include <gtest/gtest.h>
+#include "aislib/anomaly_detector.h"
+#include "aislib/ais_parser.h"
+#include "aislib/simulation/traffic_generator.h"
+#include "test_support.h"
+#include <cmath>
+#include <limits>
+
+using namespace aislib;
+using namespace aislib::test_support;
+
+namespace {
+
+const uint32_t kMmsi = 244000001;
+const uint8_t kUnderWay = 0;
+const uint8_t kMoored = 5;
+const uint8_t kSart = 14;
+
+} // anonymous namespace
+
+TEST(AnomalyDetectorTest, ValidMid) {
+    EXPECT_TRUE(AnomalyDetector::has_valid_mid(244123456));   // Ship
+    EXPECT_TRUE(AnomalyDetector::has_valid_mid(2442000));     // 002442000: coast station
+    EXPECT_TRUE(AnomalyDetector::has_valid_mid(24400000));    // 024400000: group
+    EXPECT_TRUE(AnomalyDetector::has_valid_mid(111244123));   // SAR aircraft
+    EXPECT_TRUE(AnomalyDetector::has_valid_mid(982441234));   // Auxiliary craft
+    EXPECT_TRUE(AnomalyDetector::has_valid_mid(992441234));   // Aid to navigation
+    EXPECT_TRUE(AnomalyDetector::has_valid_mid(970123456));   // AIS-SART
+    EXPECT_FALSE(AnomalyDetector::has_valid_mid(123456789));
+    EXPECT_FALSE(AnomalyDetector::has_valid_mid(217000000));
+    EXPECT_FALSE(AnomalyDetector::has_valid_mid(981231234));
+    EXPECT_FALSE(AnomalyDetector::has_valid_mid(0));
+    EXPECT_FALSE(AnomalyDetector::has_valid_mid(1000000000));
+
+    AnomalyDetector detector;
+    EXPECT_EQ(detector.check(123456789, kStart, 51.0, 1.0, 10.0f, kUnderWay), AnomalyDetector::INVALID_MID);
+    EXPECT_EQ(detector.get_stats().invalid_mid, 1u);
+}
+
+TEST(AnomalyDetectorTest, SpeedMismatchAndTeleport) {
+    AnomalyDetector detector;
+    double latitude = 51.0;
+    double time = kStart;
+
+    // Consistent track at 12 knots
+    for (int i = 0; i < 10; ++i) {
+        EXPECT_EQ(detector.check(kMmsi, time, latitude, 1.0, 12.0f, kUnderWay), 0u) << i;
+        time += 5.0;
+        latitude += northing(12.0, 5.0);
+    }
+
+    // Still moving at 12 knots while reporting 2
+    uint32_t flags = 0;
+    for (int i = 0; i < 4; ++i) {
+        flags |= detector.check(kMmsi, time, latitude, 1.0, 2.0f, kUnderWay);
+        time += 5.0;
+        latitude += northing(12.0, 5.0);
+    }
+    EXPECT_EQ(flags, AnomalyDetector::SPEED_MISMATCH);
+
+    // 50 km in 10 seconds
+    time += 10.0;
+    EXPECT_EQ(detector.check(kMmsi, time, latitude + 0.45, 1.0, 12.0f, kUnderWay), AnomalyDetector::TELEPORT);
+
+    // Older reports are not checked for motion
+    EXPECT_EQ(detector.check(kMmsi, time - 60.0, 40.0, 1.0, 12.0f, kUnderWay), 0u);
+    EXPECT_EQ(detector.get_stats().out_of_order, 1u);
+
+    // Unavailable positions are only checked for identity
+    EXPECT_EQ(detector.check(kMmsi, time + 1.0, 91.0, 181.0, 12.0f, kUnderWay), 0u);
+    EXPECT_EQ(detector.get_stats().teleport, 1u);
+}
+
+TEST(AnomalyDetectorTest, MmsiCollision) {
+    AnomalyDetector detector;
+    std::vector<uint32_t> flags;
+    // Two vessels 100 km apart share one MMSI and report in turn
+    for (int i = 0; i < 6; ++i) {
+        double time = kStart + 30.0 * i;
+        double latitude = (i % 2 == 0 ? 51.0 : 51.9) + northing(10.0, 30.0 * i);
+        flags.push_back(detector.check(kMmsi, time, latitude, 1.0, 10.0f, kUnderWay));
+    }
+
+    EXPECT_EQ(flags[0], 0u);
+    EXPECT_EQ(flags[1], AnomalyDetector::TELEPORT);
+    EXPECT_EQ(flags[2], 0u);  // First switch back
+    EXPECT_EQ(flags[3], AnomalyDetector::MMSI_COLLISION);
+    EXPECT_EQ(flags[4], AnomalyDetector::MMSI_COLLISION);
+    EXPECT_EQ(detector.get_stats().mmsi_collision, 3u);
+
+    // A single glitch is only a teleport
+    AnomalyDetector glitch;
+    EXPECT_EQ(glitch.check(kMmsi, kStart, 51.0, 1.0, 0.0f, kMoored), 0u);
+    EXPECT_EQ(glitch.check(kMmsi, kStart + 10.0, 52.0, 1.0, 0.0f, kMoored), AnomalyDetector::TELEPORT);
+    EXPECT_EQ(glitch.check(kMmsi, kStart + 20.0, 52.0, 1.0, 0.0f, kMoored), 0u);
+}
+
+TEST(AnomalyDetectorTest, NavigationStatus) {
+    AnomalyDetector detector;
+    // Moored but reporting 8 knots
+    EXPECT_EQ(detector.check(kMmsi, kStart, 51.0, 1.0, 8.0f, kMoored), AnomalyDetector::NAV_STATUS);
+    // SART status from a ship MMSI, but not from a SART
+    EXPECT_EQ(detector.check(kMmsi + 1, kStart, 51.0, 1.0, 0.0f, kSart), AnomalyDetector::NAV_STATUS);
+    EXPECT_EQ(detector.check(970010001, kStart, 51.0, 1.0, 0.0f, kSart), 0u);
+
+    // Moored with no reported speed while moving at 10 knots
+    AnomalyDetector moving;
+    float unknown = std::numeric_limits<float>::quiet_NaN();
+    EXPECT_EQ(moving.check(kMmsi, kStart, 51.0, 1.0, unknown, kMoored), 0u);
+    EXPECT_EQ(moving.check(kMmsi, kStart + 30.0, 51.0 + northing(10.0, 30.0), 1.0, unknown, kMoored),
+              AnomalyDetector::NAV_STATUS);
+}
+
+TEST(AnomalyDetectorTest, NavigationStatusTransitions) {
+    // Casting off and picking up speed
+    AnomalyDetector detector;
+    EXPECT_EQ(detector.check(kMmsi, kStart, 51.0, 1.0, 0.0f, kMoored), 0u);
+    EXPECT_EQ(detector.check(kMmsi, kStart + 180.0, 51.0 + northing(3.0, 180.0), 1.0, 3.0f, kUnderWay), 0u);
+    // Moored again 5 seconds after passing at 12 knots
+    double latitude = 51.0 + northing(3.0, 180.0) + northing(12.0, 60.0);
+    EXPECT_EQ(detector.check(kMmsi, kStart + 240.0, latitude, 1.0, 12.0f, kUnderWay), 0u);
+    EXPECT_EQ(detector.check(kMmsi, kStart + 245.0, latitude + northing(12.0, 5.0), 1.0, 0.0f, kMoored),
+              AnomalyDetector::NAV_STATUS);
+
+    // Moored, then under way 300 meters away 10 seconds later
+    AnomalyDetector jump;
+    EXPECT_EQ(jump.check(kMmsi, kStart, 51.0, 1.0, 0.0f, kMoored), 0u);
+    EXPECT_EQ(jump.check(kMmsi, kStart + 60.0, 51.0, 1.0, 0.0f, kMoored), 0u);
+    EXPECT_EQ(jump.check(kMmsi, kStart + 70.0, 51.0 + northing(60.0, 10.0), 1.0, 40.0f, kUnderWay),
+              AnomalyDetector::NAV_STATUS);
+    EXPECT_EQ(jump.get_stats().nav_status, 1u);
+}
+
+TEST(AnomalyDetectorTest, ExpireAndClear) {
+    AnomalyDetector detector;
+    detector.check(kMmsi, kStart, 51.0, 1.0, 0.0f, kMoored);
+    detector.check(kMmsi + 1, kStart + 3000.0, 51.0, 1.0, 0.0f, kMoored);
+    EXPECT_EQ(detector.get_stats().vessels, 2u);
+    EXPECT_EQ(detector.expire(kStart + 3700.0), 1u);
+    EXPECT_EQ(detector.get_stats().vessels, 1u);
+
+    // A vessel seen again after expiry starts a new track
+    EXPECT_EQ(detector.check(kMmsi, kStart + 3800.0, 55.0, 1.0, 0.0f, kMoored), 0u);
+    detector.clear();
+    EXPECT_EQ(detector.get_stats().vessels, 0u);
+}
+
+TEST(AnomalyDetectorTest, BatchMatchesSingleReports) {
+    simulation::TrafficConfig config;
+    config.vessel_count = 300;
+    config.type_mix = {{1, 4.0}, {3, 1.0}, {18, 2.0}, {5, 1.0}};
+    simulation::TrafficGenerator generator(config);
+    auto sentences = generator.generate(6000);
+
+    AISParser parser;
+    PositionBatch all;
+    for (const auto& generated : sentences) {
+        auto message = parser.parse(generated.sentence);
+        if (message) {
+            all.append(generated.time, *message);
+        }
+    }
+    // A collision and a teleport the generator does not produce
+    for (int i = 0; i < 8; ++i) {
+        all.append(244999999, kStart + 20.0 * i, i % 2 == 0 ? 51.0 : 52.0, 1.0, 5.0f, kUnderWay);
+    }
+    ASSERT_GT(all.size(), 4000u);
+
+    // Batches of 256 rows, in which vessels repeat
+    AnomalyDetector batched;
+    std::vector<uint32_t> batch_flags;
+    PositionBatch batch;
+    for (size_t begin = 0; begin < all.size(); begin += 256) {
+        batch.clear();
+        for (size_t i = begin; i < std::min(all.size(), begin + 256); ++i) {
+            batch.append(all.mmsi[i], all.time[i], all.latitude[i], all.longitude[i], all.speed[i],
+                         all.navigation_status[i]);
+        }
+        batched.check(batch);
+        batch_flags.insert(batch_flags.end(), batch.anomalies.begin(), batch.anomalies.end());
+    }
+
+    AnomalyDetector single;
+    for (size_t i = 0; i < all.size(); ++i) {
+        ASSERT_EQ(single.check(all.mmsi[i], all.time[i], all.latitude[i], all.longitude[i], all.speed[i],
+                               all.navigation_status[i]),
+                  batch_flags[i]) << "row " << i;
+    }
+
+    AnomalyDetector::Stats stats = batched.get_stats();
+    EXPECT_EQ(stats.reports, all.size());
+    EXPECT_EQ(stats.invalid_mid, 0u);
+    EXPECT_EQ(stats.teleport, 1u);
+    EXPECT_GT(stats.mmsi_collision, 0u);
+    EXPECT_EQ(stats.vessels, single.get_stats().vessels);
+}
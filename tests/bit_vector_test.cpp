@@ -120,6 +120,11 @@ TEST(BitVectorTest, GetInt) {
     
     // Value too large for int64_t
     EXPECT_THROW(bits.get_int(0, 65), std::invalid_argument);
+    
+    // Full 64-bit read is returned as is
+    BitVector bits_64;
+    bits_64.append_uint(0x8000000000000001ULL, 64);
+    EXPECT_EQ(bits_64.get_int(0, 64), static_cast<int64_t>(0x8000000000000001ULL));
 }
 
 TEST(BitVectorTest, AppendUint) {
@@ -206,6 +211,36 @@ TEST(BitVectorTest, GetString) {
     EXPECT_THROW(bits.get_string(0, 7), std::invalid_argument);
 }
 
+TEST(BitVectorTest, GetStringInline) {
+    BitVector bits;
+    bits.append_string("CALL1", 42);               // padded with spaces
+    bits.append_string("MY VESSEL@@@", 120);        // '@' padding after the name
+    bits.append_string("", 120);
+    
+    CallSign call_sign;
+    ShipName name;
+    ShipName empty;
+    bits.get_string(0, 42, call_sign);
+    bits.get_string(42, 120, name);
+    bits.get_string(162, 120, empty);
+    
+    EXPECT_EQ(call_sign, "CALL1");
+    EXPECT_EQ(name.view(), "MY VESSEL");
+    EXPECT_TRUE(empty.empty());
+    EXPECT_EQ(bits.get_string(42, 120), "MY VESSEL");
+    
+    // Unaligned start
+    EXPECT_EQ(bits.get_string(6, 24), "ALL1");
+    
+    // Destination too small
+    EXPECT_THROW(bits.get_string(42, 120, call_sign), std::invalid_argument);
+    
+    // Assignment truncates to the capacity
+    CallSign truncated("ABCDEFGHIJ");
+    EXPECT_EQ(truncated.view(), "ABCDEFG");
+    EXPECT_EQ(truncated.size(), 7u);
+}
+
 TEST(BitVectorTest, AppendString) {
     BitVector bits;
     
@@ -0,0 +1,233 @@
+#include <gtest/gtest.h>
+#include "aislib/cpu_dispatch.h"
+#include "aislib/ais_parser.h"
+#include "aislib/bit_vector.h"
+#include "aislib/geo.h"
+#include "aislib/nmea_utils.h"
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace aislib;
+
+namespace {
+
+const std::string kArmorAlphabet =
+    "0123456789:;<=>?@ABCDEFGHIJKLMNOPQRSTUVW`abcdefghijklmnopqrstuvw";
+
+// Lengths around every vector width, plus typical payload sizes
+const std::vector<size_t> kLengths = {0, 1, 3, 4, 15, 16, 17, 28, 31, 32, 33, 56, 63, 64, 65, 127, 128, 129, 200};
+
+std::string random_payload(std::mt19937& rng, size_t length) {
+    std::uniform_int_distribution<size_t> pick(0, kArmorAlphabet.size() - 1);
+    std::string payload(length, '0');
+    for (char& c : payload) {
+        c = kArmorAlphabet[pick(rng)];
+    }
+    return payload;
+}
+
+// Restores the startup kernels when a test forces a level
+class LevelGuard {
+public:
+    ~LevelGuard() { cpu::reset_level(); }
+};
+
+} // anonymous namespace
+
+TEST(CpuDispatchTest, ScalarAlwaysSupported) {
+    auto levels = cpu::supported_levels();
+    ASSERT_FALSE(levels.empty());
+    EXPECT_EQ(levels.front(), cpu::Level::SCALAR);
+    EXPECT_TRUE(cpu::is_supported(cpu::detected_level()));
+    EXPECT_TRUE(cpu::is_supported(cpu::active_level()));
+}
+
+TEST(CpuDispatchTest, LevelNamesRoundTrip) {
+    for (cpu::Level level : {cpu::Level::SCALAR, cpu::Level::SSE42, cpu::Level::AVX2,
+                             cpu::Level::AVX512, cpu::Level::NEON}) {
+        EXPECT_EQ(cpu::parse_level(cpu::level_name(level)), level);
+    }
+    EXPECT_EQ(cpu::parse_level("AVX2"), cpu::Level::AVX2);
+    EXPECT_EQ(cpu::parse_level("sse42"), cpu::Level::SSE42);
+    EXPECT_THROW(cpu::parse_level("mmx"), std::invalid_argument);
+}
+
+TEST(CpuDispatchTest, ForceLevel) {
+    LevelGuard guard;
+
+    for (cpu::Level level : cpu::supported_levels()) {
+        cpu::force_level(level);
+        EXPECT_EQ(cpu::active_level(), level);
+        EXPECT_EQ(cpu::kernels().level, level);
+    }
+
+    for (cpu::Level level : {cpu::Level::SSE42, cpu::Level::AVX2, cpu::Level::AVX512, cpu::Level::NEON}) {
+        if (!cpu::is_supported(level)) {
+            EXPECT_THROW(cpu::force_level(level), std::invalid_argument);
+        }
+    }
+}
+
+TEST(CpuDispatchTest, XorMatchesScalar) {
+    const cpu::Kernels& scalar = cpu::kernels_for(cpu::Level::SCALAR);
+    std::mt19937 rng(1);
+    std::uniform_int_distribution<int> byte(0, 255);
+
+    for (cpu::Level level : cpu::supported_levels()) {
+        const cpu::Kernels& kernels = cpu::kernels_for(level);
+        for (size_t length : kLengths) {
+            std::string data(length, '\0');
+            for (char& c : data) {
+                c = static_cast<char>(byte(rng));
+            }
+            EXPECT_EQ(kernels.xor_bytes(data.data(), length), scalar.xor_bytes(data.data(), length))
+                << cpu::level_name(level) << " length " << length;
+        }
+    }
+}
+
+TEST(CpuDispatchTest, DearmorMatchesScalar) {
+    const cpu::Kernels& scalar = cpu::kernels_for(cpu::Level::SCALAR);
+    std::mt19937 rng(2);
+
+    for (cpu::Level level : cpu::supported_levels()) {
+        const cpu::Kernels& kernels = cpu::kernels_for(level);
+        for (size_t length : kLengths) {
+            std::string payload = random_payload(rng, length);
+            std::vector<uint8_t> expected(length + 1, 0xEE);
+            std::vector<uint8_t> actual(length + 1, 0xEE);
+
+            ASSERT_TRUE(scalar.dearmor(payload.data(), length, expected.data()));
+            ASSERT_TRUE(kernels.dearmor(payload.data(), length, actual.data()))
+                << cpu::level_name(level) << " length " << length;
+            EXPECT_EQ(actual, expected) << cpu::level_name(level) << " length " << length;
+        }
+    }
+}
+
+TEST(CpuDispatchTest, DearmorRejectsEveryInvalidCharacter) {
+    for (cpu::Level level : cpu::supported_levels()) {
+        const cpu::Kernels& kernels = cpu::kernels_for(level);
+        std::vector<uint8_t> values(100);
+
+        for (int c = 0; c < 256; ++c) {
+            bool valid = kArmorAlphabet.find(static_cast<char>(c)) != std::string::npos;
+            // Put the character in the vector body and in the tail
+            for (size_t position : {size_t(5), size_t(70), size_t(99)}) {
+                std::string payload(100, 'A');
+                payload[position] = static_cast<char>(c);
+                EXPECT_EQ(kernels.dearmor(payload.data(), payload.size(), values.data()), valid)
+                    << cpu::level_name(level) << " character " << c << " at " << position;
+            }
+        }
+    }
+}
+
+TEST(CpuDispatchTest, FindAllMatchesScalar) {
+    const cpu::Kernels& scalar = cpu::kernels_for(cpu::Level::SCALAR);
+    std::mt19937 rng(3);
+    std::uniform_int_distribution<int> pick(0, 7);
+
+    for (cpu::Level level : cpu::supported_levels()) {
+        const cpu::Kernels& kernels = cpu::kernels_for(level);
+        for (size_t length : kLengths) {
+            std::string data(length, 'x');
+            for (char& c : data) {
+                c = pick(rng) == 0 ? ',' : 'x';
+            }
+            for (size_t max_positions : {size_t(0), size_t(1), size_t(6), size_t(256)}) {
+                std::vector<uint32_t> expected(max_positions + 1, 0);
+                std::vector<uint32_t> actual(max_positions + 1, 0);
+                size_t expected_count = scalar.find_all(data.data(), length, ',', expected.data(), max_positions);
+                size_t actual_count = kernels.find_all(data.data(), length, ',', actual.data(), max_positions);
+
+                ASSERT_EQ(actual_count, expected_count) << cpu::level_name(level) << " length " << length;
+                EXPECT_EQ(actual, expected) << cpu::level_name(level) << " length " << length;
+            }
+        }
+    }
+}
+
+TEST(CpuDispatchTest, HaversineMatchesScalar) {
+    const cpu::Kernels& scalar = cpu::kernels_for(cpu::Level::SCALAR);
+    std::mt19937 rng(4);
+    std::uniform_real_distribution<double> latitude(-90.0, 90.0);
+    std::uniform_real_distribution<double> longitude(-180.0, 180.0);
+    std::uniform_real_distribution<double> step(-0.01, 0.01);
+
+    // Half the pairs are nearby positions, the others anywhere on the globe
+    const size_t count = 203;
+    std::vector<double> lat1(count), lon1(count), lat2(count), lon2(count);
+    for (size_t i = 0; i < count; ++i) {
+        lat1[i] = latitude(rng);
+        lon1[i] = longitude(rng);
+        lat2[i] = i % 2 == 0 ? latitude(rng) : std::max(-90.0, std::min(90.0, lat1[i] + step(rng)));
+        lon2[i] = i % 2 == 0 ? longitude(rng) : lon1[i] + step(rng);
+    }
+    lat2[1] = lat1[1];
+    lon2[1] = lon1[1];
+
+    std::vector<double> expected(count);
+    scalar.haversine(lat1.data(), lon1.data(), lat2.data(), lon2.data(), count, expected.data());
+
+    // Reference: the haversine formula with the standard library
+    const double radians = 3.14159265358979323846 / 180.0;
+    for (size_t i = 0; i < count; ++i) {
+        double a = std::pow(std::sin((lat2[i] - lat1[i]) * radians / 2), 2) +
+                   std::cos(lat1[i] * radians) * std::cos(lat2[i] * radians) *
+                   std::pow(std::sin((lon2[i] - lon1[i]) * radians / 2), 2);
+        double reference = 2 * geo::EARTH_RADIUS * std::asin(std::sqrt(std::min(1.0, a)));
+        ASSERT_NEAR(expected[i], reference, 1e-3) << "pair " << i;
+    }
+    EXPECT_EQ(expected[1], 0.0);
+
+    for (cpu::Level level : cpu::supported_levels()) {
+        const cpu::Kernels& kernels = cpu::kernels_for(level);
+        for (size_t length : kLengths) {
+            std::vector<double> actual(length + 1, -1.0);
+            kernels.haversine(lat1.data(), lon1.data(), lat2.data(), lon2.data(), length, actual.data());
+            for (size_t i = 0; i < length; ++i) {
+                ASSERT_NEAR(actual[i], expected[i], 1e-6) << cpu::level_name(level) << " length " << length;
+            }
+            EXPECT_EQ(actual[length], -1.0) << cpu::level_name(level) << " wrote past length " << length;
+        }
+    }
+}
+
+TEST(CpuDispatchTest, ParserResultsIdenticalAtEveryLevel) {
+    LevelGuard guard;
+    const std::vector<std::string> sentences = {
+        "!AIVDM,1,1,,A,15MgK45P3@G?fl0E`JbR0OwT0@MS,0*4E",
+        "!AIVDM,2,1,0,B,53tfDKP29E6p?7333CDpu8@T>0P58ltqV222221JBhN<<5QfNGljCQhD3lQH,0*74",
+        "!AIVDM,2,2,0,B,88888888880,2*27",
+    };
+
+    std::vector<std::string> reference;
+    cpu::force_level(cpu::Level::SCALAR);
+    {
+        AISParser parser;
+        for (const auto& sentence : sentences) {
+            auto message = parser.parse(sentence);
+            reference.push_back(message ? message->to_string() : "");
+        }
+    }
+    ASSERT_FALSE(reference[0].empty());
+    ASSERT_FALSE(reference[2].empty());
+
+    for (cpu::Level level : cpu::supported_levels()) {
+        cpu::force_level(level);
+        AISParser parser;
+        for (size_t i = 0; i < sentences.size(); ++i) {
+            auto message = parser.parse(sentences[i]);
+            EXPECT_EQ(message ? message->to_string() : "", reference[i]) << cpu::level_name(level);
+        }
+
+        BitVector bits;
+        EXPECT_THROW(bits.assign_payload("15MgK45P3@G?fl0E`JbR0OwT0@M!"), std::invalid_argument);
+        EXPECT_EQ(bits.size(), 0u);
+    }
+}
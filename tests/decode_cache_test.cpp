@@ -0,0 +1,158 @@
+#include <gtest/gtest.h>
+#include "aislib/decode_cache.h"
+#include "aislib/ais_parser.h"
+#include "aislib/metrics.h"
+#include "aislib/static_data.h"
+#include <memory>
+#include <string>
+
+using namespace aislib;
+
+namespace {
+
+const std::string kStaticPart1 =
+    "!AIVDM,2,1,0,B,53tfDKP29E6p?7333CDpu8@T>0P58ltqV222221JBhN<<5QfNGljCQhD3lQH,0*74";
+const std::string kStaticPart2 = "!AIVDM,2,2,0,B,88888888880,2*27";
+const std::string kPositionReport = "!AIVDM,1,1,,A,15MgK45P3@G?fl0E`JbR0OwT0@MS,0*4E";
+
+BitVector static_data_bits(uint32_t mmsi, const std::string& name) {
+    StaticAndVoyageData message(mmsi, 0);
+    message.set_vessel_name(name);
+    BitVector bits;
+    message.to_bits(bits);
+    return bits;
+}
+
+std::shared_ptr<const AISMessage> parse_static(AISParser& parser) {
+    EXPECT_EQ(parser.parse_shared(kStaticPart1), nullptr);
+    return parser.parse_shared(kStaticPart2);
+}
+
+} // anonymous namespace
+
+TEST(DecodeCacheTest, RepeatedStaticDataIsShared) {
+    AISParser::ParserConfig config;
+    config.decode_cache = std::make_shared<DecodeCache>();
+    AISParser parser(config);
+
+    auto first = parse_static(parser);
+    auto second = parse_static(parser);
+
+    ASSERT_NE(first, nullptr);
+    EXPECT_EQ(first->get_message_type(), 5);
+    EXPECT_EQ(first, second);
+
+    DecodeCache::Stats stats = config.decode_cache->get_stats();
+    EXPECT_EQ(stats.misses, 1u);
+    EXPECT_EQ(stats.hits, 1u);
+    EXPECT_EQ(stats.entries, 1u);
+    EXPECT_DOUBLE_EQ(stats.hit_rate(), 0.5);
+}
+
+TEST(DecodeCacheTest, SameResultAsUncachedParse) {
+    AISParser::ParserConfig config;
+    config.decode_cache = std::make_shared<DecodeCache>();
+    AISParser cached(config);
+    AISParser uncached;
+
+    parse_static(cached);
+    auto from_cache = parse_static(cached);
+    ASSERT_EQ(uncached.parse(kStaticPart1), nullptr);
+    auto decoded = uncached.parse(kStaticPart2);
+
+    ASSERT_NE(from_cache, nullptr);
+    ASSERT_NE(decoded, nullptr);
+    EXPECT_EQ(from_cache->to_string(), decoded->to_string());
+}
+
+TEST(DecodeCacheTest, OtherTypesBypassTheCache) {
+    AISParser::ParserConfig config;
+    config.decode_cache = std::make_shared<DecodeCache>();
+    AISParser parser(config);
+
+    auto first = parser.parse_shared(kPositionReport);
+    auto second = parser.parse_shared(kPositionReport);
+    ASSERT_NE(first, nullptr);
+    EXPECT_NE(first, second);
+
+    DecodeCache::Stats stats = config.decode_cache->get_stats();
+    EXPECT_EQ(stats.bypassed, 2u);
+    EXPECT_EQ(stats.hits + stats.misses, 0u);
+    EXPECT_EQ(stats.entries, 0u);
+}
+
+TEST(DecodeCacheTest, SharedAcrossParsers) {
+    auto cache = std::make_shared<DecodeCache>();
+    AISParser::ParserConfig config;
+    config.decode_cache = cache;
+    AISParser receiver_a(config);
+    AISParser receiver_b(config);
+
+    auto from_a = parse_static(receiver_a);
+    auto from_b = parse_static(receiver_b);
+    EXPECT_EQ(from_a, from_b);
+    EXPECT_EQ(cache->get_stats().hits, 1u);
+}
+
+TEST(DecodeCacheTest, EvictsLeastRecentlyUsed) {
+    DecodeCache::Config config;
+    config.max_entries = 2;
+    DecodeCache cache(config);
+
+    BitVector a = static_data_bits(111111111, "ALPHA");
+    BitVector b = static_data_bits(222222222, "BRAVO");
+    BitVector c = static_data_bits(333333333, "CHARLIE");
+
+    auto first_a = cache.decode(a);
+    cache.decode(b);
+    bool hit = false;
+    EXPECT_EQ(cache.decode(a, &hit), first_a);  // a is now the most recent
+    EXPECT_TRUE(hit);
+
+    cache.decode(c);                            // evicts b
+    EXPECT_EQ(cache.get_stats().evictions, 1u);
+    EXPECT_EQ(cache.get_stats().entries, 2u);
+
+    cache.decode(a, &hit);
+    EXPECT_TRUE(hit);
+    cache.decode(b, &hit);
+    EXPECT_FALSE(hit);
+}
+
+TEST(DecodeCacheTest, DistinguishesNearlyIdenticalBits) {
+    DecodeCache cache;
+    BitVector bits = static_data_bits(123456789, "NAME");
+    BitVector changed = bits;
+    changed.set_bit(changed.size() - 1, !changed.get_bit(changed.size() - 1));
+    BitVector longer = bits;
+    longer.append_bit(false);
+
+    EXPECT_NE(DecodeCache::hash_bits(bits), DecodeCache::hash_bits(changed));
+    EXPECT_NE(DecodeCache::hash_bits(bits), DecodeCache::hash_bits(longer));
+
+    auto original = cache.decode(bits);
+    EXPECT_NE(cache.decode(changed), original);
+    EXPECT_NE(cache.decode(longer), original);
+    EXPECT_EQ(cache.get_stats().misses, 3u);
+}
+
+TEST(DecodeCacheTest, RecordsMetrics) {
+    AISParser::ParserConfig config;
+    config.decode_cache = std::make_shared<DecodeCache>();
+    config.metrics = std::make_shared<MetricsRegistry>(1);
+    AISParser parser(config);
+
+    parse_static(parser);
+    parse_static(parser);
+    parse_static(parser);
+    parser.parse_shared(kPositionReport);
+
+    MetricsSnapshot snapshot = config.metrics->snapshot();
+    EXPECT_EQ(snapshot.decode_cache_hits, 2u);
+    EXPECT_EQ(snapshot.decode_cache_misses, 1u);
+    EXPECT_EQ(snapshot.messages_by_type[5], 3u);
+
+    std::string text = to_prometheus(snapshot);
+    EXPECT_NE(text.find("aislib_decode_cache_hits_total 2"), std::string::npos);
+    EXPECT_NE(text.find("aislib_decode_cache_misses_total 1"), std::string::npos);
+}
@@ -0,0 +1,230 @@
+#include <gtest/gtest.h>
+#include "aislib/density_grid.h"
+#include "aislib/ais_parser.h"
+#include "aislib/simulation/traffic_generator.h"
+#include <cmath>
+#include <limits>
+#include <map>
+#include <tuple>
+
+using namespace aislib;
+
+namespace {
+
+const uint32_t kMmsi = 244000001;
+
+using CellKey = std::tuple<uint32_t, uint32_t>;
+
+std::map<CellKey, DensityCell> cells_by_key(const DensityGrid& grid, uint32_t level) {
+    std::map<CellKey, DensityCell> result;
+    for (const auto& cell : grid.get_cells(level)) {
+        result[CellKey(cell.x, cell.y)] = cell;
+    }
+    return result;
+}
+
+} // anonymous namespace
+
+TEST(DensityGridTest, HyperLogLog) {
+    HyperLogLog small(12);
+    for (uint32_t i = 0; i < 10; ++i) {
+        small.add(HyperLogLog::hash(kMmsi + i));
+        small.add(HyperLogLog::hash(kMmsi + i));
+    }
+    EXPECT_TRUE(small.is_sparse());
+    EXPECT_NEAR(small.estimate(), 10.0, 0.5);
+
+    HyperLogLog all(12);
+    HyperLogLog low(12);
+    HyperLogLog high(12);
+    for (uint32_t i = 0; i < 100000; ++i) {
+        all.add(HyperLogLog::hash(i));
+        (i < 60000 ? low : high).add(HyperLogLog::hash(i));
+    }
+    EXPECT_FALSE(all.is_sparse());
+    EXPECT_NEAR(all.estimate(), 100000.0, 5000.0);
+
+    // Merging gives the registers of the union
+    low.merge(high);
+    EXPECT_EQ(low.estimate(), all.estimate());
+    small.merge(all);
+    EXPECT_FALSE(small.is_sparse());
+
+    HyperLogLog other(8);
+    EXPECT_THROW(all.merge(other), std::invalid_argument);
+    EXPECT_THROW(HyperLogLog(3), std::invalid_argument);
+    EXPECT_THROW(HyperLogLog(17), std::invalid_argument);
+}
+
+TEST(DensityGridTest, LatLonLevels) {
+    DensityGrid::Config config;
+    config.cell_size = 0.01;
+    config.levels = 3;
+    DensityGrid grid(config);
+    float unknown = std::numeric_limits<float>::quiet_NaN();
+    EXPECT_TRUE(grid.add(kMmsi, 51.003, 1.003, 10.0f));
+    EXPECT_TRUE(grid.add(kMmsi, 51.006, 1.004, 20.0f));
+    EXPECT_TRUE(grid.add(kMmsi + 1, 51.013, 1.003, unknown));
+    EXPECT_FALSE(grid.add(kMmsi + 2, 91.0, 181.0, 10.0f));
+    EXPECT_EQ(grid.get_reports(), 3u);
+
+    uint32_t x;
+    uint32_t y;
+    ASSERT_TRUE(grid.cell_of(51.003, 1.003, 0, x, y));
+    auto level0 = cells_by_key(grid, 0);
+    ASSERT_EQ(level0.size(), 2u);
+    const DensityCell& both = level0[CellKey(x, y)];
+    EXPECT_EQ(both.reports, 2u);
+    EXPECT_NEAR(both.vessels, 1.0, 0.1);
+    EXPECT_DOUBLE_EQ(both.average_speed, 15.0);
+    ASSERT_TRUE(grid.cell_of(51.013, 1.003, 0, x, y));
+    EXPECT_TRUE(std::isnan(level0[CellKey(x, y)].average_speed));
+
+    double min_lat, min_lon, max_lat, max_lon;
+    grid.cell_bounds(0, x, y, min_lat, min_lon, max_lat, max_lon);
+    EXPECT_LE(min_lat, 51.013);
+    EXPECT_GT(max_lat, 51.013);
+    EXPECT_NEAR(max_lon - min_lon, 0.01, 1e-9);
+
+    // Level 1 cells are 0.02 degrees and hold all three reports
+    auto level1 = grid.get_cells(1);
+    ASSERT_EQ(level1.size(), 1u);
+    EXPECT_EQ(level1[0].reports, 3u);
+    EXPECT_NEAR(level1[0].vessels, 2.0, 0.1);
+    EXPECT_DOUBLE_EQ(level1[0].average_speed, 15.0);
+    EXPECT_EQ(grid.get_cells(2).size(), 1u);
+    EXPECT_EQ(grid.cell_count(), 4u);
+
+    // The corners of the world fall into the edge cells
+    EXPECT_TRUE(grid.cell_of(90.0, 180.0, 0, x, y));
+    EXPECT_EQ(x, 35999u);
+    EXPECT_EQ(y, 17999u);
+
+    config.levels = 0;
+    EXPECT_THROW(DensityGrid{config}, std::invalid_argument);
+    config.levels = 3;
+    config.cell_size = 0.0;
+    EXPECT_THROW(DensityGrid{config}, std::invalid_argument);
+}
+
+TEST(DensityGridTest, WebMercatorTiles) {
+    DensityGrid::Config config;
+    config.projection = GridProjection::WEB_MERCATOR;
+    config.zoom = 10;
+    config.levels = 3;
+    DensityGrid grid(config);
+
+    // London
+    uint32_t x;
+    uint32_t y;
+    ASSERT_TRUE(grid.cell_of(51.5074, -0.1278, 0, x, y));
+    EXPECT_EQ(x, 511u);
+    EXPECT_EQ(y, 340u);
+    ASSERT_TRUE(grid.cell_of(51.5074, -0.1278, 2, x, y));
+    EXPECT_EQ(x, 127u);
+    EXPECT_EQ(y, 85u);
+
+    double min_lat, min_lon, max_lat, max_lon;
+    grid.cell_bounds(2, x, y, min_lat, min_lon, max_lat, max_lon);
+    EXPECT_LT(min_lat, 51.5074);
+    EXPECT_GT(max_lat, 51.5074);
+    EXPECT_LT(min_lon, -0.1278);
+    EXPECT_GT(max_lon, -0.1278);
+
+    EXPECT_TRUE(grid.add(kMmsi, 51.5074, -0.1278, 5.0f));
+    EXPECT_FALSE(grid.add(kMmsi, 89.0, 0.0, 5.0f));
+    auto level2 = grid.get_cells(2);
+    ASSERT_EQ(level2.size(), 1u);
+    EXPECT_EQ(level2[0].x, 127u);
+
+    config.levels = 12;
+    EXPECT_THROW(DensityGrid{config}, std::invalid_argument);
+
+    DensityGrid lat_lon;
+    EXPECT_THROW(lat_lon.merge(grid), std::invalid_argument);
+}
+
+TEST(DensityGridTest, ShipTypeFilter) {
+    DensityAggregator::Config config;
+    config.threads = 1;
+    config.ship_types = {70, 71};
+    DensityAggregator aggregator(config);
+    aggregator.set_ship_type(kMmsi, 70);
+    aggregator.set_ship_type(kMmsi + 1, 30);
+
+    PositionBatch batch;
+    batch.append(kMmsi, 0.0, 51.0, 1.0, 10.0f, 0);
+    batch.append(kMmsi + 1, 0.0, 51.0, 1.0, 10.0f, 0);
+    batch.append(kMmsi + 2, 0.0, 51.0, 1.0, 10.0f, 0);  // Ship type not known
+    EXPECT_EQ(aggregator.add(batch), 1u);
+    EXPECT_EQ(aggregator.result().get_reports(), 1u);
+
+    // Ship types are learned from type 5
+    simulation::TrafficConfig traffic;
+    traffic.vessel_count = 20;
+    traffic.type_mix = {{5, 1.0}};
+    simulation::TrafficGenerator generator(traffic);
+    AISParser parser;
+    size_t learned = 0;
+    for (const auto& generated : generator.generate(40)) {
+        auto message = parser.parse(generated.sentence);
+        if (message) {
+            learned += aggregator.update_static(*message);
+        }
+    }
+    EXPECT_GT(learned, 0u);
+
+    aggregator.clear();
+    EXPECT_EQ(aggregator.result().get_reports(), 0u);
+}
+
+TEST(DensityGridTest, ParallelMatchesSerial) {
+    simulation::TrafficConfig traffic;
+    traffic.vessel_count = 500;
+    traffic.type_mix = {{1, 4.0}, {3, 1.0}, {18, 2.0}};
+    simulation::TrafficGenerator generator(traffic);
+
+    AISParser parser;
+    PositionBatch batch;
+    for (const auto& generated : generator.generate(20000)) {
+        auto message = parser.parse(generated.sentence);
+        if (message) {
+            batch.append(generated.time, *message);
+        }
+    }
+
+    DensityAggregator::Config config;
+    config.threads = 4;
+    config.min_rows_per_thread = 1000;
+    DensityAggregator aggregator(config);
+    EXPECT_EQ(aggregator.get_threads(), 4u);
+    size_t added = aggregator.add(batch);
+    added += aggregator.add(batch);
+
+    DensityGrid serial(config.grid);
+    for (int pass = 0; pass < 2; ++pass) {
+        for (size_t i = 0; i < batch.size(); ++i) {
+            serial.add(batch.mmsi[i], batch.latitude[i], batch.longitude[i], batch.speed[i]);
+        }
+    }
+
+    const DensityGrid& parallel = aggregator.result();
+    EXPECT_EQ(added, serial.get_reports());
+    EXPECT_EQ(parallel.get_reports(), serial.get_reports());
+    EXPECT_EQ(parallel.cell_count(), serial.cell_count());
+    for (uint32_t level = 0; level < config.grid.levels; ++level) {
+        auto expected = cells_by_key(serial, level);
+        auto actual = cells_by_key(parallel, level);
+        ASSERT_EQ(actual.size(), expected.size());
+        for (const auto& entry : expected) {
+            const DensityCell& cell = actual[entry.first];
+            EXPECT_EQ(cell.reports, entry.second.reports);
+            EXPECT_EQ(cell.vessels, entry.second.vessels);
+            if (std::isnan(entry.second.average_speed)) {
+                EXPECT_TRUE(std::isnan(cell.average_speed));
+            } else {
+                EXPECT_NEAR(cell.average_speed, entry.second.average_speed, 1e-9);
+            }
+        }
+    }
+}
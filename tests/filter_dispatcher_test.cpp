@@ -0,0 +1,231 @@
+#include <gtest/gtest.h>
+#include "aislib/filter_dispatcher.h"
+#include "aislib/ais_parser.h"
+#include "aislib/simulation/traffic_generator.h"
+#include <algorithm>
+#include <random>
+#include <vector>
+
+using namespace aislib;
+
+namespace {
+
+SubscriptionFilter::Box box(double min_lat, double min_lon, double max_lat, double max_lon) {
+    SubscriptionFilter::Box result;
+    result.min_lat = min_lat;
+    result.min_lon = min_lon;
+    result.max_lat = max_lat;
+    result.max_lon = max_lon;
+    return result;
+}
+
+template <typename T>
+bool listed(const std::vector<T>& values, T value) {
+    return values.empty() || std::find(values.begin(), values.end(), value) != values.end();
+}
+
+// Filter evaluated directly, to compare the compiled indexes against
+bool matches(const SubscriptionFilter& filter, uint8_t type, uint32_t mmsi, double latitude, double longitude,
+             int ship_type) {
+    if (!listed(filter.message_types, type) || !listed(filter.mmsis, mmsi)) {
+        return false;
+    }
+    if (!filter.ship_types.empty() &&
+        (ship_type < 0 || !listed(filter.ship_types, static_cast<uint8_t>(ship_type)))) {
+        return false;
+    }
+    if (filter.boxes.empty()) {
+        return true;
+    }
+    if (latitude > 90.0 || longitude > 180.0) {
+        return false;
+    }
+    for (const auto& area : filter.boxes) {
+        bool inside_lon = area.min_lon <= area.max_lon
+                              ? longitude >= area.min_lon && longitude <= area.max_lon
+                              : longitude >= area.min_lon || longitude <= area.max_lon;
+        if (latitude >= area.min_lat && latitude <= area.max_lat && inside_lon) {
+            return true;
+        }
+    }
+    return false;
+}
+
+} // anonymous namespace
+
+TEST(FilterDispatcherTest, RoutesByEachCriterion) {
+    FilterDispatcher dispatcher;
+    SubscriptionFilter everything;
+    SubscriptionFilter positions;
+    positions.message_types = {1, 2, 3, 18};
+    SubscriptionFilter one_vessel;
+    one_vessel.mmsis = {366123456};
+    SubscriptionFilter bay;
+    bay.boxes = {box(37.4, -122.6, 38.1, -122.0)};
+    SubscriptionFilter tankers;
+    tankers.ship_types = {80, 81, 82};
+
+    uint32_t all_id = dispatcher.subscribe(everything);
+    uint32_t positions_id = dispatcher.subscribe(positions);
+    uint32_t vessel_id = dispatcher.subscribe(one_vessel);
+    uint32_t bay_id = dispatcher.subscribe(bay);
+    uint32_t tanker_id = dispatcher.subscribe(tankers);
+    EXPECT_EQ(dispatcher.size(), 5u);
+
+    std::vector<uint32_t> subscribers;
+    dispatcher.route(1, 366123456, 37.8, -122.4, subscribers);
+    EXPECT_EQ(subscribers, (std::vector<uint32_t>{all_id, positions_id, vessel_id, bay_id}));
+
+    // Static data has no position, so the area subscriber does not receive it
+    dispatcher.route(5, 366123456, 91.0, 181.0, subscribers);
+    EXPECT_EQ(subscribers, (std::vector<uint32_t>{all_id, vessel_id}));
+
+    // Same cell as the bay, outside the box
+    dispatcher.route(1, 211000000, 37.2, -122.4, subscribers);
+    EXPECT_EQ(subscribers, (std::vector<uint32_t>{all_id, positions_id}));
+
+    dispatcher.set_ship_type(211000000, 80);
+    dispatcher.route(18, 211000000, 37.9, -122.3, subscribers);
+    EXPECT_EQ(subscribers, (std::vector<uint32_t>{all_id, positions_id, bay_id, tanker_id}));
+
+    // Removed IDs are reused
+    EXPECT_TRUE(dispatcher.unsubscribe(positions_id));
+    EXPECT_FALSE(dispatcher.unsubscribe(positions_id));
+    dispatcher.route(1, 211000000, 0.0, 0.0, subscribers);
+    EXPECT_EQ(subscribers, (std::vector<uint32_t>{all_id, tanker_id}));
+    EXPECT_EQ(dispatcher.subscribe(bay), positions_id);
+    EXPECT_EQ(dispatcher.size(), 5u);
+
+    SubscriptionFilter invalid;
+    invalid.message_types = {64};
+    EXPECT_THROW(dispatcher.subscribe(invalid), std::invalid_argument);
+    invalid.message_types.clear();
+    invalid.boxes = {box(10.0, 0.0, 5.0, 1.0)};
+    EXPECT_THROW(dispatcher.subscribe(invalid), std::invalid_argument);
+}
+
+TEST(FilterDispatcherTest, BoxesAcrossTheAntimeridianAndWideBoxes) {
+    FilterDispatcher::Config config;
+    config.cell_size = 0.5;
+    config.max_cells_per_box = 100;
+    FilterDispatcher dispatcher(config);
+
+    SubscriptionFilter pacific;
+    pacific.boxes = {box(-20.0, 175.0, -10.0, -175.0)};
+    SubscriptionFilter north_atlantic;
+    north_atlantic.boxes = {box(30.0, -60.0, 65.0, -5.0)};
+    uint32_t pacific_id = dispatcher.subscribe(pacific);
+    uint32_t atlantic_id = dispatcher.subscribe(north_atlantic);
+
+    std::vector<uint32_t> subscribers;
+    dispatcher.route(1, 1, -15.0, 179.9, subscribers);
+    EXPECT_EQ(subscribers, std::vector<uint32_t>{pacific_id});
+    dispatcher.route(1, 1, -15.0, -179.9, subscribers);
+    EXPECT_EQ(subscribers, std::vector<uint32_t>{pacific_id});
+    dispatcher.route(1, 1, -15.0, 170.0, subscribers);
+    EXPECT_TRUE(subscribers.empty());
+
+    // The Atlantic box overlaps too many cells and is tested for every positioned message
+    dispatcher.route(1, 1, 50.0, -20.0, subscribers);
+    EXPECT_EQ(subscribers, std::vector<uint32_t>{atlantic_id});
+    dispatcher.route(1, 1, 20.0, -20.0, subscribers);
+    EXPECT_TRUE(subscribers.empty());
+}
+
+TEST(FilterDispatcherTest, MatchesDirectEvaluation) {
+    std::mt19937 rng(11);
+    std::uniform_real_distribution<double> latitude(-60.0, 60.0);
+    std::uniform_real_distribution<double> longitude(-180.0, 180.0);
+    std::uniform_real_distribution<double> extent(0.1, 15.0);
+    const uint8_t types[] = {1, 3, 5, 18, 19, 24};
+
+    FilterDispatcher::Config config;
+    config.max_cells_per_box = 64;
+    FilterDispatcher dispatcher(config);
+    std::vector<SubscriptionFilter> filters;
+    for (int i = 0; i < 300; ++i) {
+        SubscriptionFilter filter;
+        if (rng() % 2) {
+            filter.message_types = {types[rng() % 6], types[rng() % 6]};
+        }
+        if (rng() % 4 == 0) {
+            filter.mmsis = {static_cast<uint32_t>(rng() % 50), static_cast<uint32_t>(rng() % 50)};
+        }
+        if (rng() % 2) {
+            for (unsigned b = 0; b < 1 + rng() % 2; ++b) {
+                double lat = latitude(rng);
+                double lon = longitude(rng);
+                double east = lon + extent(rng);
+                filter.boxes.push_back(box(lat, lon, std::min(90.0, lat + extent(rng)), east > 180.0 ? east - 360.0 : east));
+            }
+        }
+        if (rng() % 4 == 0) {
+            filter.ship_types = {static_cast<uint8_t>(60 + rng() % 30)};
+        }
+        filters.push_back(filter);
+        EXPECT_EQ(dispatcher.subscribe(filter), static_cast<uint32_t>(i));
+    }
+    std::vector<int> ship_types(50, -1);
+    for (uint32_t mmsi = 0; mmsi < 50; mmsi += 2) {
+        ship_types[mmsi] = static_cast<int>(60 + rng() % 30);
+        dispatcher.set_ship_type(mmsi, static_cast<uint8_t>(ship_types[mmsi]));
+    }
+
+    std::vector<uint32_t> subscribers;
+    size_t routed = 0;
+    for (int i = 0; i < 5000; ++i) {
+        uint8_t type = types[rng() % 6];
+        uint32_t mmsi = static_cast<uint32_t>(rng() % 50);
+        bool positioned = type != 5 && type != 24;
+        double lat = positioned ? latitude(rng) : 91.0;
+        double lon = positioned ? longitude(rng) : 181.0;
+
+        std::vector<uint32_t> expected;
+        for (uint32_t s = 0; s < filters.size(); ++s) {
+            if (matches(filters[s], type, mmsi, lat, lon, ship_types[mmsi])) {
+                expected.push_back(s);
+            }
+        }
+        dispatcher.route(type, mmsi, lat, lon, subscribers);
+        ASSERT_EQ(subscribers, expected) << "message " << i;
+        routed += subscribers.size();
+    }
+    EXPECT_GT(routed, 0u);
+}
+
+TEST(FilterDispatcherTest, RoutesDecodedMessages) {
+    simulation::TrafficConfig traffic;
+    traffic.vessel_count = 30;
+    traffic.type_mix = {{1, 2.0}, {5, 1.0}};
+    simulation::TrafficGenerator generator(traffic);
+
+    FilterDispatcher dispatcher;
+    SubscriptionFilter by_ship_type;
+    for (int type = 20; type < 100; ++type) {
+        by_ship_type.ship_types.push_back(static_cast<uint8_t>(type));
+    }
+    dispatcher.subscribe(by_ship_type);
+
+    AISParser parser;
+    std::vector<uint32_t> subscribers;
+    size_t before_static = 0;
+    size_t after_static = 0;
+    bool learned = false;
+    for (const auto& generated : generator.generate(2000)) {
+        auto message = parser.parse(generated.sentence);
+        if (!message) {
+            continue;
+        }
+        size_t routed = dispatcher.route(*message, subscribers);
+        if (message->get_message_type() == 5) {
+            learned = true;
+        } else if (!learned) {
+            before_static += routed;
+        } else {
+            after_static += routed;
+        }
+    }
+    // Position reports reach the subscriber only once static data gave their ship type
+    EXPECT_EQ(before_static, 0u);
+    EXPECT_GT(after_static, 0u);
+}
@@ -0,0 +1,259 @@
+#include <gtest/gtest.h>
+#include "aislib/geofence.h"
+#include "aislib/ais_parser.h"
+#include "aislib/position_report_class_a.h"
+#include "aislib/position_report_class_b.h"
+#include "aislib/simulation/traffic_generator.h"
+#include "test_support.h"
+#include <random>
+#include <set>
+
+using namespace aislib;
+using namespace aislib::test_support;
+
+namespace {
+
+std::vector<std::pair<double, double>> square(double latitude, double longitude, double size) {
+    return {{latitude, longitude},
+            {latitude, longitude + size},
+            {latitude + size, longitude + size},
+            {latitude + size, longitude}};
+}
+
+} // anonymous namespace
+
+TEST(GeofenceTest, Containment) {
+    GeofenceEngine engine;
+    engine.add_circle(1, 51.0, 1.0, 1000.0);
+    // L-shaped polygon: the notch at the north-east is outside
+    engine.add_polygon(2, {{51.0, 2.0}, {51.0, 2.2}, {51.1, 2.2}, {51.1, 2.1}, {51.2, 2.1}, {51.2, 2.0}});
+
+    EXPECT_TRUE(engine.contains(1, 51.0, 1.0));
+    EXPECT_TRUE(engine.contains(1, 51.008, 1.0));   // ~890 m north
+    EXPECT_FALSE(engine.contains(1, 51.0095, 1.0)); // ~1055 m north
+    EXPECT_TRUE(engine.contains(1, 51.0, 1.0135));  // ~945 m east
+    EXPECT_FALSE(engine.contains(1, 51.0, 1.0150)); // ~1050 m east
+
+    EXPECT_TRUE(engine.contains(2, 51.05, 2.15));
+    EXPECT_TRUE(engine.contains(2, 51.15, 2.05));
+    EXPECT_FALSE(engine.contains(2, 51.15, 2.15));
+    EXPECT_FALSE(engine.contains(2, 50.95, 2.05));
+    EXPECT_FALSE(engine.contains(3, 51.0, 1.0));
+
+    EXPECT_THROW(engine.add_circle(1, 51.0, 1.0, 10.0), std::invalid_argument);
+    EXPECT_THROW(engine.add_circle(3, 91.0, 1.0, 10.0), std::invalid_argument);
+    EXPECT_THROW(engine.add_polygon(3, {{51.0, 1.0}, {51.1, 1.0}}), std::invalid_argument);
+    EXPECT_EQ(engine.get_stats().fences, 2u);
+}
+
+TEST(GeofenceTest, EnterDwellExit) {
+    GeofenceEngine::Config config;
+    config.dwell_time = 300.0;
+    GeofenceEngine engine(config);
+    engine.add_polygon(7, square(51.0, 1.0, 0.1));
+    engine.add_polygon(8, square(51.05, 1.05, 0.1));
+
+    std::vector<GeofenceEvent> events;
+    EXPECT_EQ(engine.update(244000001, 50.9, 1.05, kStart, events), 0u);
+    EXPECT_EQ(engine.get_stats().vessels, 0u);
+
+    ASSERT_EQ(engine.update(244000001, 51.02, 1.02, kStart + 60.0, events), 1u);
+    EXPECT_EQ(events[0].type, GeofenceEvent::Type::ENTER);
+    EXPECT_EQ(events[0].mmsi, 244000001u);
+    EXPECT_EQ(events[0].fence_id, 7u);
+
+    // Overlap of both fences
+    events.clear();
+    ASSERT_EQ(engine.update(244000001, 51.07, 1.07, kStart + 120.0, events), 1u);
+    EXPECT_EQ(events[0].type, GeofenceEvent::Type::ENTER);
+    EXPECT_EQ(events[0].fence_id, 8u);
+    EXPECT_EQ(engine.get_fences(244000001), (std::vector<uint32_t>{7, 8}));
+
+    // Older reports are ignored
+    events.clear();
+    EXPECT_EQ(engine.update(244000001, 50.0, 1.0, kStart + 100.0, events), 0u);
+    EXPECT_EQ(engine.get_stats().out_of_order, 1u);
+
+    // Dwell is reported once per stay
+    ASSERT_EQ(engine.update(244000001, 51.07, 1.07, kStart + 360.0, events), 1u);
+    EXPECT_EQ(events[0].type, GeofenceEvent::Type::DWELL);
+    EXPECT_EQ(events[0].fence_id, 7u);
+    EXPECT_DOUBLE_EQ(events[0].enter_time, kStart + 60.0);
+    events.clear();
+    ASSERT_EQ(engine.update(244000001, 51.07, 1.07, kStart + 420.0, events), 1u);
+    EXPECT_EQ(events[0].fence_id, 8u);
+    events.clear();
+    EXPECT_EQ(engine.update(244000001, 51.07, 1.07, kStart + 480.0, events), 0u);
+
+    // Leaving both fences
+    ASSERT_EQ(engine.update(244000001, 51.3, 1.3, kStart + 540.0, events), 2u);
+    EXPECT_EQ(events[0].type, GeofenceEvent::Type::EXIT);
+    EXPECT_EQ(events[1].type, GeofenceEvent::Type::EXIT);
+    EXPECT_EQ(engine.get_stats().vessels, 0u);
+    EXPECT_EQ(engine.get_stats().events, 6u);
+
+    // Unavailable positions are ignored
+    events.clear();
+    EXPECT_EQ(engine.update(244000001, 91.0, 181.0, kStart + 600.0, events), 0u);
+}
+
+TEST(GeofenceTest, RemoveAndExpire) {
+    GeofenceEngine engine;
+    engine.add_circle(1, 51.0, 1.0, 5000.0);
+    engine.add_circle(2, 51.0, 1.0, 2000.0);
+
+    std::vector<GeofenceEvent> events;
+    EXPECT_EQ(engine.update(1, 51.0, 1.0, kStart, events), 2u);
+    EXPECT_EQ(engine.update(2, 51.03, 1.0, kStart, events), 1u);
+
+    EXPECT_TRUE(engine.remove_fence(2));
+    EXPECT_FALSE(engine.remove_fence(2));
+    EXPECT_FALSE(engine.contains(2, 51.0, 1.0));
+    EXPECT_EQ(engine.get_fences(1), (std::vector<uint32_t>{1}));
+
+    // The removed fence produces no EXIT event
+    events.clear();
+    EXPECT_EQ(engine.update(1, 51.0, 1.0, kStart + 60.0, events), 0u);
+
+    // Vessel 1 keeps reporting, vessel 2 falls silent
+    EXPECT_EQ(engine.update(1, 51.0, 1.0, kStart + 1700.0, events), 1u);
+    EXPECT_EQ(events[0].type, GeofenceEvent::Type::DWELL);
+    events.clear();
+    EXPECT_EQ(engine.expire(kStart + 1800.0, events), 1u);
+    EXPECT_EQ(events[0].type, GeofenceEvent::Type::EXIT);
+    EXPECT_EQ(events[0].mmsi, 2u);
+    EXPECT_EQ(engine.get_stats().vessels, 1u);
+
+    // The ID can be reused
+    engine.add_circle(2, 52.0, 1.0, 100.0);
+    EXPECT_TRUE(engine.contains(2, 52.0, 1.0));
+}
+
+TEST(GeofenceTest, AreaNotice) {
+    std::vector<application::AreaNotice::SubArea> subareas;
+    subareas.push_back(application::AreaNotice::SubArea::Circle(1.0, 51.0, 1000));
+    subareas.push_back(application::AreaNotice::SubArea::Rectangle(2.0, 51.0, 2000, 1000, 0));
+    subareas.push_back(application::AreaNotice::SubArea::Sector(3.0, 51.0, 3000, 0, 90));
+    subareas.push_back(application::AreaNotice::SubArea::Text(3.0, 51.0, "KEEP CLEAR"));
+    application::AreaNotice notice(1, application::AreaNotice::NoticeType::RESTRICTED_AREA,
+                                   std::chrono::system_clock::now(), 60, subareas);
+
+    GeofenceEngine engine;
+    EXPECT_EQ(engine.add_area_notice(notice, 100), 3u);
+    EXPECT_EQ(engine.get_stats().fences, 3u);
+
+    EXPECT_TRUE(engine.contains(100, 51.005, 1.0));
+    // Rectangle: 2000 m east, 1000 m north of its south-west corner
+    EXPECT_TRUE(engine.contains(101, 51.005, 2.02));
+    EXPECT_FALSE(engine.contains(101, 51.005, 1.99));
+    EXPECT_FALSE(engine.contains(101, 51.005, 2.03));
+    EXPECT_FALSE(engine.contains(101, 51.01, 2.02));
+    // Sector: the north-east quadrant
+    EXPECT_TRUE(engine.contains(102, 51.01, 3.01));
+    EXPECT_FALSE(engine.contains(102, 51.01, 2.99));
+    EXPECT_FALSE(engine.contains(102, 50.99, 3.01));
+
+    // IDs in use leave the engine unchanged
+    EXPECT_THROW(engine.add_area_notice(notice, 102), std::invalid_argument);
+    EXPECT_EQ(engine.get_stats().fences, 3u);
+}
+
+TEST(GeofenceTest, WideFences) {
+    GeofenceEngine::Config config;
+    config.max_cells_per_fence = 16;
+    GeofenceEngine engine(config);
+    engine.add_polygon(1, square(40.0, -10.0, 20.0));
+    engine.add_polygon(2, square(51.0, 1.0, 0.1));
+
+    std::vector<GeofenceEvent> events;
+    EXPECT_EQ(engine.update(1, 51.05, 1.05, kStart, events), 2u);
+    EXPECT_EQ(engine.update(2, 45.0, 0.0, kStart, events), 1u);
+    EXPECT_TRUE(engine.remove_fence(1));
+    EXPECT_FALSE(engine.contains(1, 45.0, 0.0));
+}
+
+TEST(GeofenceTest, CrossesAntimeridian) {
+    GeofenceEngine engine;
+    engine.add_circle(1, -17.0, 179.99, 5000.0);
+    engine.add_polygon(2, {{-17.2, 179.8}, {-17.2, -179.8}, {-16.8, -179.8}, {-16.8, 179.8}});
+
+    EXPECT_TRUE(engine.contains(1, -17.0, 179.96));
+    EXPECT_TRUE(engine.contains(1, -17.0, -179.98));
+    EXPECT_FALSE(engine.contains(1, -17.0, -179.9));
+    EXPECT_TRUE(engine.contains(2, -17.0, 179.9));
+    EXPECT_TRUE(engine.contains(2, -17.0, -179.9));
+    EXPECT_FALSE(engine.contains(2, -17.0, -179.7));
+    EXPECT_FALSE(engine.contains(2, -17.0, 179.7));
+    EXPECT_FALSE(engine.contains(2, -17.0, 0.0));
+
+    // Both halves are in the grid
+    std::vector<GeofenceEvent> events;
+    EXPECT_EQ(engine.update(1, -17.0, 179.99, kStart, events), 2u);
+    EXPECT_EQ(engine.update(2, -17.0, -179.99, kStart, events), 2u);
+    EXPECT_EQ(engine.update(3, -17.1, -179.85, kStart, events), 1u);
+    EXPECT_TRUE(engine.remove_fence(2));
+    EXPECT_EQ(engine.update(4, -17.1, -179.85, kStart, events), 0u);
+
+    EXPECT_THROW(engine.add_polygon(3, {{80.0, 0.0}, {80.0, 120.0}, {80.0, -120.0}}), std::invalid_argument);
+}
+
+TEST(GeofenceTest, MatchesBruteForce) {
+    simulation::TrafficConfig traffic;
+    traffic.vessel_count = 200;
+    traffic.type_mix = {{1, 1.0}, {18, 1.0}};
+    simulation::TrafficGenerator generator(traffic);
+    auto sentences = generator.generate(5000);
+
+    // Random circles and squares over the simulated area
+    GeofenceEngine engine;
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<double> latitude(traffic.min_latitude, traffic.max_latitude);
+    std::uniform_real_distribution<double> longitude(traffic.min_longitude, traffic.max_longitude);
+    std::uniform_real_distribution<double> size(0.01, 0.3);
+    const uint32_t fences = 400;
+    for (uint32_t id = 0; id < fences; ++id) {
+        if (id % 2 == 0) {
+            engine.add_circle(id, latitude(rng), longitude(rng), size(rng) * 50000.0);
+        } else {
+            engine.add_polygon(id, square(latitude(rng), longitude(rng), size(rng)));
+        }
+    }
+
+    AISParser parser;
+    std::vector<GeofenceEvent> events;
+    size_t evaluated = 0;
+    for (const auto& generated : sentences) {
+        auto message = parser.parse(generated.sentence);
+        if (!message) {
+            continue;
+        }
+        engine.update(*message, generated.time, events);
+
+        double lat = 0.0;
+        double lon = 0.0;
+        if (auto* class_a = dynamic_cast<const PositionReportClassA*>(message.get())) {
+            lat = class_a->get_latitude();
+            lon = class_a->get_longitude();
+        } else if (auto* class_b = dynamic_cast<const StandardPositionReportClassB*>(message.get())) {
+            lat = class_b->get_latitude();
+            lon = class_b->get_longitude();
+        } else {
+            continue;
+        }
+        ++evaluated;
+
+        std::set<uint32_t> expected;
+        for (uint32_t id = 0; id < fences; ++id) {
+            if (engine.contains(id, lat, lon)) {
+                expected.insert(id);
+            }
+        }
+        auto actual = engine.get_fences(message->get_mmsi());
+        EXPECT_EQ(std::set<uint32_t>(actual.begin(), actual.end()), expected);
+    }
+
+    GeofenceEngine::Stats stats = engine.get_stats();
+    EXPECT_EQ(stats.evaluations, evaluated);
+    EXPECT_GT(stats.events, 0u);
+    EXPECT_LT(stats.candidates, stats.evaluations * fences / 4);
+}
@@ -0,0 +1,201 @@
+#include <gtest/gtest.h>
+#include "aislib/metrics.h"
+#include "aislib/ais_parser.h"
+#include "aislib/nmea_utils.h"
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace aislib;
+
+namespace {
+
+const std::string kPositionReport = "!AIVDM,1,1,,A,15MgK45P3@G?fl0E`JbR0OwT0@MS,0*4E";
+
+// Append a valid checksum to a sentence body
+std::string with_checksum(const std::string& body) {
+    char checksum[4];
+    std::snprintf(checksum, sizeof(checksum), "*%02X", NMEAUtils::calculate_checksum(body));
+    return body + checksum;
+}
+
+std::shared_ptr<MetricsRegistry> make_registry() {
+    return std::make_shared<MetricsRegistry>(4);
+}
+
+} // anonymous namespace
+
+TEST(MetricsTest, ShardCountRoundsUpToPowerOfTwo) {
+    EXPECT_EQ(MetricsRegistry(3).get_shard_count(), 4);
+    EXPECT_EQ(MetricsRegistry(1).get_shard_count(), 1);
+    EXPECT_GE(MetricsRegistry().get_shard_count(), 1);
+}
+
+TEST(MetricsTest, HistogramBuckets) {
+    // Exact buckets up to 16
+    for (uint64_t v = 0; v <= 16; ++v) {
+        EXPECT_EQ(HistogramSnapshot::bucket_index(v), v);
+        EXPECT_EQ(HistogramSnapshot::bucket_upper_bound(v), v);
+    }
+
+    // Every value falls into a bucket whose upper bound is within 1/16
+    for (uint64_t v : {16ull, 17ull, 31ull, 32ull, 1000ull, 123456ull, 987654321ull}) {
+        size_t index = HistogramSnapshot::bucket_index(v);
+        uint64_t upper = HistogramSnapshot::bucket_upper_bound(index);
+        EXPECT_GE(upper, v);
+        EXPECT_LE(upper - v, v / 16);
+        if (index > 0) {
+            EXPECT_LT(HistogramSnapshot::bucket_upper_bound(index - 1), v);
+        }
+    }
+
+    // Powers of two are upper bounds
+    EXPECT_EQ(HistogramSnapshot::bucket_upper_bound(HistogramSnapshot::bucket_index(1024)), 1024u);
+    EXPECT_EQ(HistogramSnapshot::bucket_index(1025), HistogramSnapshot::bucket_index(1024) + 1);
+
+    // Huge values land in the last bucket
+    EXPECT_EQ(HistogramSnapshot::bucket_index(~0ull), MetricsRegistry::kHistogramBuckets - 1);
+}
+
+TEST(MetricsTest, Quantiles) {
+    MetricsRegistry registry(1);
+    for (int i = 1; i <= 100; ++i) {
+        registry.record_parse_latency(std::chrono::nanoseconds(i * 1000));
+    }
+
+    MetricsSnapshot snapshot = registry.snapshot();
+    EXPECT_EQ(snapshot.parse_latency.total_count, 100);
+    EXPECT_EQ(snapshot.parse_latency.sum, 5050000);
+
+    uint64_t p50 = snapshot.parse_latency.value_at_quantile(0.5);
+    uint64_t p99 = snapshot.parse_latency.value_at_quantile(0.99);
+    EXPECT_GE(p50, 50000);
+    EXPECT_LE(p50, 50000 + 50000 / 16);
+    EXPECT_GE(p99, 99000);
+    EXPECT_LE(p99, 99000 + 99000 / 16);
+}
+
+TEST(MetricsTest, ParserCounters) {
+    AISParser::ParserConfig config;
+    config.metrics = make_registry();
+    config.latency_sample_interval = 1;
+    AISParser parser(config);
+
+    EXPECT_NE(parser.parse(kPositionReport), nullptr);
+    EXPECT_NE(parser.parse(kPositionReport), nullptr);
+    EXPECT_EQ(parser.parse("!AIVDM,1,1,,A,15MgK45P3@G?fl0E`JbR0OwT0@MS,0*00"), nullptr);
+    EXPECT_EQ(parser.parse(with_checksum("$GPGGA,1,2")), nullptr);
+
+    MetricsSnapshot snapshot = config.metrics->snapshot();
+    EXPECT_EQ(snapshot.sentences, 4);
+    EXPECT_EQ(snapshot.messages_by_type[1], 2);
+    EXPECT_EQ(snapshot.total_messages(), 2);
+    EXPECT_EQ(snapshot.errors[static_cast<size_t>(AISParser::ParseError::ErrorType::INVALID_CHECKSUM)], 1);
+    EXPECT_EQ(snapshot.errors[static_cast<size_t>(AISParser::ParseError::ErrorType::INVALID_SENTENCE_FORMAT)], 1);
+    EXPECT_EQ(snapshot.total_errors(), 2);
+    EXPECT_EQ(snapshot.parse_latency.total_count, 4);
+
+    config.metrics->reset();
+    snapshot = config.metrics->snapshot();
+    EXPECT_EQ(snapshot.sentences, 0);
+    EXPECT_EQ(snapshot.total_messages(), 0);
+    EXPECT_EQ(snapshot.parse_latency.total_count, 0);
+}
+
+TEST(MetricsTest, LatencySampling) {
+    AISParser::ParserConfig config;
+    config.metrics = make_registry();
+    config.latency_sample_interval = 4;
+    AISParser parser(config);
+
+    for (int i = 0; i < 10; ++i) {
+        parser.parse(kPositionReport);
+    }
+
+    MetricsSnapshot snapshot = config.metrics->snapshot();
+    EXPECT_EQ(snapshot.sentences, 10);
+    EXPECT_EQ(snapshot.parse_latency.total_count, 2);
+}
+
+TEST(MetricsTest, MultipartCounters) {
+    auto registry = make_registry();
+    MultipartMessageManager manager(std::chrono::seconds(1), 2);
+    manager.set_metrics(registry.get());
+
+    // Completed message
+    EXPECT_FALSE(manager.add_fragment(1, 2, "1", 'A', "55MgK45P3@G?fl0E", 0).has_value());
+    EXPECT_TRUE(manager.add_fragment(2, 2, "1", 'A', "`JbR0OwT0@MS", 0).has_value());
+
+    // Third incomplete message exceeds the limit of two
+    manager.add_fragment(1, 2, "2", 'A', "55MgK45P3@G?fl0E", 0);
+    manager.add_fragment(1, 2, "3", 'A', "55MgK45P3@G?fl0E", 0);
+    manager.add_fragment(1, 2, "4", 'A', "55MgK45P3@G?fl0E", 0);
+
+    // Shrinking the limit evicts one more
+    manager.set_max_messages(1);
+
+    // The remaining message times out
+    std::this_thread::sleep_for(std::chrono::milliseconds(1100));
+    manager.cleanup_expired();
+
+    MetricsSnapshot snapshot = registry->snapshot();
+    EXPECT_EQ(snapshot.multipart_completed, 1);
+    EXPECT_EQ(snapshot.reassembly_dwell.total_count, 1);
+    EXPECT_EQ(snapshot.multipart_evicted, 2);
+    EXPECT_EQ(snapshot.multipart_expired, 1);
+}
+
+TEST(MetricsTest, ConcurrentRecording) {
+    MetricsRegistry registry(8);
+    const int threads = 4;
+    const int per_thread = 10000;
+
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([&registry]() {
+            for (int i = 0; i < per_thread; ++i) {
+                registry.record_sentence();
+                registry.record_message(18);
+            }
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+
+    MetricsSnapshot snapshot = registry.snapshot();
+    EXPECT_EQ(snapshot.sentences, threads * per_thread);
+    EXPECT_EQ(snapshot.messages_by_type[18], threads * per_thread);
+}
+
+TEST(MetricsTest, PrometheusExport) {
+    MetricsRegistry registry(1);
+    registry.record_sentence();
+    registry.record_message(5);
+    registry.record_error(AISParser::ParseError::ErrorType::INVALID_PAYLOAD);
+    registry.record_parse_latency(std::chrono::microseconds(3));
+
+    std::string text = to_prometheus(registry.snapshot(), "ais");
+
+    EXPECT_NE(text.find("# TYPE ais_sentences_total counter\nais_sentences_total 1\n"), std::string::npos);
+    EXPECT_NE(text.find("ais_messages_decoded_total{type=\"5\"} 1\n"), std::string::npos);
+    EXPECT_EQ(text.find("ais_messages_decoded_total{type=\"1\"}"), std::string::npos);
+    EXPECT_NE(text.find("ais_parse_errors_total{error=\"invalid_payload\"} 1\n"), std::string::npos);
+    EXPECT_NE(text.find("# TYPE ais_parse_latency_seconds histogram"), std::string::npos);
+    EXPECT_NE(text.find("ais_parse_latency_seconds_bucket{le=\"+Inf\"} 1\n"), std::string::npos);
+    EXPECT_NE(text.find("ais_parse_latency_seconds_count 1\n"), std::string::npos);
+
+    // 3 us is above the 1.024 us boundary and below 4.096 us
+    EXPECT_NE(text.find("ais_parse_latency_seconds_bucket{le=\"1.024e-06\"} 0\n"), std::string::npos);
+    EXPECT_NE(text.find("ais_parse_latency_seconds_bucket{le=\"4.096e-06\"} 1\n"), std::string::npos);
+
+    // A sample of exactly a boundary counts in that bucket, one above it in the next
+    MetricsRegistry boundary(1);
+    boundary.record_parse_latency(std::chrono::nanoseconds(1024));
+    boundary.record_parse_latency(std::chrono::nanoseconds(1025));
+    text = to_prometheus(boundary.snapshot(), "ais");
+    EXPECT_NE(text.find("ais_parse_latency_seconds_bucket{le=\"2.56e-07\"} 0\n"), std::string::npos);
+    EXPECT_NE(text.find("ais_parse_latency_seconds_bucket{le=\"1.024e-06\"} 1\n"), std::string::npos);
+    EXPECT_NE(text.find("ais_parse_latency_seconds_bucket{le=\"4.096e-06\"} 2\n"), std::string::npos);
+}
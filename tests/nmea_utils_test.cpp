@@ -1,5 +1,7 @@
 #include <gtest/gtest.h>
 #include "aislib/nmea_utils.h"
+#include <cmath>
+#include <cstdio>
 #include <string>
 
 using namespace aislib;
@@ -149,4 +151,35 @@ TEST(NMEAUtilsTest, CreateAivdoSentence) {
     EXPECT_THROW(NMEAUtils::create_aivdo_sentence(payload, 1, 2, "", 'B', 0), std::invalid_argument);
     EXPECT_THROW(NMEAUtils::create_aivdo_sentence(payload, 1, 1, "", 'C', 0), std::invalid_argument);
     EXPECT_THROW(NMEAUtils::create_aivdo_sentence(payload, 1, 1, "", 'B', 6), std::invalid_argument);
-}
\ No newline at end of file
+}
+
+// Test tag block parsing
+TEST(NMEAUtilsTest, ParseTagBlock) {
+    const std::string sentence = "!AIVDM,1,1,,A,13P7AnP01rP5@HHLrMOd6ab00000,0*37";
+    TagBlock tag;
+    
+    // Checksum of "s:r3,c:1717243200"
+    std::string content = "s:r3,c:1717243200";
+    char checksum[3];
+    std::snprintf(checksum, sizeof(checksum), "%02X", NMEAUtils::calculate_checksum(content));
+    std::string line = "\\" + content + "*" + checksum + "\\" + sentence;
+    
+    size_t offset = NMEAUtils::parse_tag_block(line, tag);
+    EXPECT_EQ(line.substr(offset), sentence);
+    EXPECT_EQ(tag.source, "r3");
+    EXPECT_DOUBLE_EQ(tag.time, 1717243200.0);
+    
+    // Millisecond times and tag blocks without a checksum
+    EXPECT_GT(NMEAUtils::parse_tag_block("\\c:1717243200500\\" + sentence, tag), 0u);
+    EXPECT_DOUBLE_EQ(tag.time, 1717243200.5);
+    EXPECT_TRUE(tag.source.empty());
+    
+    // No tag block
+    EXPECT_EQ(NMEAUtils::parse_tag_block(sentence, tag), 0u);
+    EXPECT_TRUE(std::isnan(tag.time));
+    
+    // Malformed tag blocks
+    line[line.find('*') + 1] = (line[line.find('*') + 1] == '0') ? '1' : '0';
+    EXPECT_THROW(NMEAUtils::parse_tag_block(line, tag), std::invalid_argument);
+    EXPECT_THROW(NMEAUtils::parse_tag_block("\\s:r3" + sentence, tag), std::invalid_argument);
+}
@@ -0,0 +1,163 @@
+#include <gtest/gtest.h>
+#include "aislib/position_throttle.h"
+#include "aislib/ais_parser.h"
+#include "aislib/position_report_class_a.h"
+#include "aislib/position_report_class_b.h"
+#include "aislib/simulation/traffic_generator.h"
+#include "test_support.h"
+#include <cmath>
+#include <limits>
+#include <unordered_map>
+
+using namespace aislib;
+using namespace aislib::test_support;
+
+namespace {
+
+const float kNaN = std::numeric_limits<float>::quiet_NaN();
+const uint8_t kUnderWay = 0;
+const uint8_t kAtAnchor = 1;
+
+} // anonymous namespace
+
+TEST(PositionThrottleTest, TimePolicy) {
+    PositionThrottle::Config config;
+    config.interval = 10.0;
+    config.min_spacing = 0.0;
+    PositionThrottle throttle(config);
+
+    // A steady vessel reporting every 2 seconds passes once per interval
+    size_t passed = 0;
+    for (int i = 0; i <= 60; i += 2) {
+        passed += throttle.accept(366000001, kStart + i, 37.8, -122.4, 10.0f, 90.0f, kUnderWay);
+    }
+    EXPECT_EQ(passed, 7u);
+
+    // Reports older than the last passed one are dropped
+    EXPECT_FALSE(throttle.accept(366000001, kStart + 30, 37.8, -122.4, 10.0f, 90.0f, kUnderWay));
+    // A new vessel always passes
+    EXPECT_TRUE(throttle.accept(366000002, kStart + 30, 37.8, -122.4, 10.0f, 90.0f, kUnderWay));
+
+    auto stats = throttle.get_stats();
+    EXPECT_EQ(stats.reports, 33u);
+    EXPECT_EQ(stats.passed, 8u);
+    EXPECT_EQ(stats.dropped, 25u);
+    EXPECT_EQ(stats.out_of_order, 1u);
+    EXPECT_EQ(stats.vessels, 2u);
+
+    config.interval = -1.0;
+    EXPECT_THROW(PositionThrottle{config}, std::invalid_argument);
+}
+
+TEST(PositionThrottleTest, ChangePolicies) {
+    PositionThrottle::Config config;
+    config.interval = 300.0;
+    config.min_spacing = 5.0;
+    config.course_change = 15.0;
+    config.speed_change = 2.0;
+    config.distance = 500.0;
+    PositionThrottle throttle(config);
+    const uint32_t mmsi = 366000001;
+
+    EXPECT_TRUE(throttle.accept(mmsi, kStart, 37.8, -122.4, 10.0f, 355.0f, kUnderWay));
+    // 10 degrees across north is below the threshold, 25 degrees is not
+    EXPECT_FALSE(throttle.accept(mmsi, kStart + 10, 37.8, -122.4, 10.0f, 5.0f, kUnderWay));
+    EXPECT_TRUE(throttle.accept(mmsi, kStart + 20, 37.8, -122.4, 10.0f, 20.0f, kUnderWay));
+    // Nothing passes within min_spacing, however large the change
+    EXPECT_FALSE(throttle.accept(mmsi, kStart + 22, 37.8, -122.4, 10.0f, 200.0f, kUnderWay));
+    EXPECT_FALSE(throttle.accept(mmsi, kStart + 30, 37.8, -122.4, 11.0f, 20.0f, kUnderWay));
+    EXPECT_TRUE(throttle.accept(mmsi, kStart + 40, 37.8, -122.4, 12.5f, 20.0f, kUnderWay));
+    // Unavailable course and speed do not count as a change
+    EXPECT_FALSE(throttle.accept(mmsi, kStart + 50, 37.8, -122.4, kNaN, kNaN, kUnderWay));
+    // About 550 meters north
+    EXPECT_TRUE(throttle.accept(mmsi, kStart + 60, 37.805, -122.4, 12.5f, 20.0f, kUnderWay));
+    EXPECT_FALSE(throttle.accept(mmsi, kStart + 70, 91.0, 181.0, 12.5f, 20.0f, kUnderWay));
+    EXPECT_TRUE(throttle.accept(mmsi, kStart + 80, 37.805, -122.4, 12.5f, 20.0f, kAtAnchor));
+
+    config.status_change = false;
+    PositionThrottle quiet(config);
+    EXPECT_TRUE(quiet.accept(mmsi, kStart, 37.8, -122.4, 0.0f, 0.0f, kUnderWay));
+    EXPECT_FALSE(quiet.accept(mmsi, kStart + 10, 37.8, -122.4, 0.0f, 0.0f, kAtAnchor));
+    EXPECT_TRUE(quiet.accept(mmsi, kStart + 300, 37.8, -122.4, 0.0f, 0.0f, kAtAnchor));
+}
+
+TEST(PositionThrottleTest, GrowsAndExpires) {
+    PositionThrottle::Config config;
+    config.interval = 60.0;
+    config.min_spacing = 10.0;
+    config.max_age = 100.0;
+    PositionThrottle throttle(config);
+
+    // Enough vessels to grow the table several times
+    const uint32_t vessels = 10000;
+    for (uint32_t i = 0; i < vessels; ++i) {
+        double time = kStart + (i % 2 == 0 ? 0.0 : 50.0);
+        ASSERT_TRUE(throttle.accept(200000000 + i * 7, time, 10.0, 20.0, 5.0f, 45.0f, kUnderWay));
+    }
+    EXPECT_EQ(throttle.get_stats().vessels, vessels);
+    for (uint32_t i = 0; i < vessels; ++i) {
+        ASSERT_FALSE(throttle.accept(200000000 + i * 7, kStart + 55, 10.0, 20.0, 5.0f, 45.0f, kUnderWay));
+    }
+
+    // The pre-decode check agrees with min_spacing
+    EXPECT_FALSE(throttle.may_accept(200000000, kStart + 5));
+    EXPECT_TRUE(throttle.may_accept(200000000, kStart + 10));
+    EXPECT_FALSE(throttle.may_accept(200000007, kStart + 40));
+    EXPECT_TRUE(throttle.may_accept(123456789, kStart));
+
+    EXPECT_EQ(throttle.expire(kStart + 120), vessels / 2);
+    EXPECT_EQ(throttle.get_stats().vessels, vessels / 2);
+    // Survivors keep their state, expired vessels start over
+    EXPECT_FALSE(throttle.accept(200000007, kStart + 100, 10.0, 20.0, 5.0f, 45.0f, kUnderWay));
+    EXPECT_TRUE(throttle.accept(200000000, kStart + 100, 10.0, 20.0, 5.0f, 45.0f, kUnderWay));
+
+    throttle.clear();
+    EXPECT_EQ(throttle.get_stats().vessels, 0u);
+    EXPECT_TRUE(throttle.may_accept(200000007, kStart + 101));
+}
+
+TEST(PositionThrottleTest, ThrottlesDecodedTraffic) {
+    simulation::TrafficConfig traffic;
+    traffic.vessel_count = 40;
+    traffic.type_mix = {{1, 4.0}, {18, 2.0}, {5, 1.0}};
+    simulation::TrafficGenerator generator(traffic);
+
+    PositionThrottle::Config config;
+    config.interval = 60.0;
+    config.min_spacing = 5.0;
+    PositionThrottle throttle(config);
+
+    AISParser parser;
+    std::unordered_map<uint32_t, double> last_passed;
+    size_t positions = 0;
+    size_t other = 0;
+    for (const auto& generated : generator.generate(5000)) {
+        auto message = parser.parse(generated.sentence);
+        if (!message) {
+            continue;
+        }
+        bool positioned = dynamic_cast<const PositionReportClassA*>(message.get()) != nullptr ||
+                          dynamic_cast<const StandardPositionReportClassB*>(message.get()) != nullptr;
+        bool passed = throttle.accept(generated.time, *message);
+        if (!positioned) {
+            EXPECT_TRUE(passed);
+            other++;
+            continue;
+        }
+        positions++;
+        if (passed) {
+            auto previous = last_passed.find(message->get_mmsi());
+            if (previous != last_passed.end()) {
+                EXPECT_GE(generated.time - previous->second, config.min_spacing);
+            }
+            last_passed[message->get_mmsi()] = generated.time;
+        }
+    }
+
+    auto stats = throttle.get_stats();
+    EXPECT_GT(other, 0u);
+    EXPECT_EQ(stats.reports, positions);
+    EXPECT_EQ(stats.passed + stats.dropped, positions);
+    EXPECT_GT(stats.dropped, 0u);
+    EXPECT_EQ(stats.vessels, last_passed.size());
+}
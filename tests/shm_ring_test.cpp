@@ -0,0 +1,215 @@
+#include <gtest/gtest.h>
+#include "aislib/shm_ring.h"
+#include "aislib/ais_parser.h"
+#include "aislib/simulation/traffic_generator.h"
+#include "test_support.h"
+#include <cmath>
+#include <string>
+#include <vector>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+using namespace aislib;
+using namespace aislib::test_support;
+
+namespace {
+
+ShmRecord record_for(uint32_t index) {
+    ShmRecord record;
+    record.time = kStart + index;
+    record.mmsi = 366000000 + index;
+    record.latitude = 37.0 + index * 0.001;
+    record.longitude = -122.0;
+    record.message_type = 1;
+    return record;
+}
+
+void publish_range(ShmRingPublisher& publisher, uint32_t begin, uint32_t end) {
+    for (uint32_t i = begin; i < end; ++i) {
+        std::string side = numbered_sentence(i);
+        publisher.publish(record_for(i), side.data(), side.size());
+    }
+}
+
+std::string segment_name(const char* test) {
+    return process_name("aislib-test-", test);
+}
+
+} // anonymous namespace
+
+TEST(ShmRingTest, PublishAndRead) {
+    ShmRingPublisher::Config config;
+    config.capacity = 64;
+    config.side_capacity = 4096;
+    ShmRingPublisher publisher(segment_name("read"), config);
+    ShmRingSubscriber subscriber(segment_name("read"));
+
+    ShmRecord record;
+    std::string side;
+    EXPECT_FALSE(subscriber.read(record, side));
+
+    publish_range(publisher, 0, 10);
+    EXPECT_EQ(publisher.get_published(), 10u);
+    EXPECT_EQ(subscriber.get_published(), 10u);
+    for (uint32_t i = 0; i < 10; ++i) {
+        ASSERT_TRUE(subscriber.read(record, side));
+        EXPECT_EQ(record.mmsi, 366000000u + i);
+        EXPECT_EQ(record.time, kStart + i);
+        EXPECT_EQ(side, numbered_sentence(i));
+    }
+    EXPECT_FALSE(subscriber.read(record, side));
+    EXPECT_EQ(subscriber.get_cursor(), 10u);
+    EXPECT_EQ(subscriber.get_lost(), 0u);
+
+    // Readers joining later start at the next record, or seek back
+    ShmRingSubscriber late(segment_name("read"));
+    EXPECT_EQ(late.get_cursor(), 10u);
+    late.seek(5);
+    ASSERT_TRUE(late.read(record, side));
+    EXPECT_EQ(side, numbered_sentence(5));
+}
+
+TEST(ShmRingTest, DetectsOverruns) {
+    ShmRingPublisher::Config config;
+    config.capacity = 8;
+    config.side_capacity = 4096;
+    ShmRingPublisher publisher("", config);
+    ShmRingSubscriber slow(publisher.fd());
+    ShmRingSubscriber fast(publisher.fd());
+
+    ShmRecord record;
+    std::string side;
+    for (uint32_t i = 0; i < 20; ++i) {
+        publish_range(publisher, i, i + 1);
+        ASSERT_TRUE(fast.read(record, side));
+        EXPECT_EQ(side, numbered_sentence(i));
+    }
+    EXPECT_EQ(fast.get_lost(), 0u);
+
+    // The slow reader was lapped: it resumes at the oldest record in the ring
+    ASSERT_TRUE(slow.read(record, side));
+    EXPECT_EQ(slow.get_lost(), 12u);
+    EXPECT_EQ(record.mmsi, 366000000u + 12);
+    EXPECT_EQ(side, numbered_sentence(12));
+    size_t read = 1;
+    while (slow.read(record, side)) {
+        read++;
+    }
+    EXPECT_EQ(read, 8u);
+
+    // Side data is overwritten before the slots when it is the smaller ring
+    config.capacity = 64;
+    config.side_capacity = 256;
+    ShmRingPublisher small_side("", config);
+    ShmRingSubscriber reader(small_side.fd());
+    publish_range(small_side, 0, 40);
+    size_t intact = 0;
+    while (reader.read(record, side)) {
+        EXPECT_EQ(side, numbered_sentence(static_cast<uint32_t>(record.mmsi - 366000000u)));
+        intact++;
+    }
+    EXPECT_GT(reader.get_lost(), 0u);
+    EXPECT_EQ(intact + reader.get_lost(), 40u);
+
+    std::vector<char> too_large(257, 'x');
+    EXPECT_THROW(small_side.publish(record, too_large.data(), too_large.size()), std::invalid_argument);
+}
+
+TEST(ShmRingTest, RejectsInvalidSegments) {
+    ShmRingPublisher::Config config;
+    config.capacity = 100;
+    EXPECT_THROW(ShmRingPublisher("", config), std::invalid_argument);
+    EXPECT_THROW(ShmRingPublisher("bad/name"), std::invalid_argument);
+    EXPECT_THROW(ShmRingSubscriber(segment_name("missing")), std::runtime_error);
+
+    // A memfd that is not a ring
+    int fd = ::memfd_create("not-a-ring", 0);
+    ASSERT_GE(fd, 0);
+    ASSERT_EQ(::ftruncate(fd, 4096), 0);
+    EXPECT_THROW(ShmRingSubscriber{fd}, std::runtime_error);
+    ::close(fd);
+}
+
+TEST(ShmRingTest, FansOutToOtherProcesses) {
+    simulation::TrafficConfig traffic;
+    traffic.vessel_count = 50;
+    traffic.type_mix = {{1, 3.0}, {18, 1.0}, {5, 1.0}};
+    simulation::TrafficGenerator generator(traffic);
+    auto sentences = generator.generate(500);
+
+    ShmRingPublisher::Config config;
+    config.capacity = 1024;
+    config.side_capacity = 1 << 16;
+    const std::string name = segment_name("fanout");
+    ShmRingPublisher publisher(name, config);
+
+    // Each child reads the whole stream and reports through its exit status
+    const int readers = 2;
+    std::vector<pid_t> children;
+    int ready[2];
+    ASSERT_EQ(::pipe(ready), 0);
+    for (int i = 0; i < readers; ++i) {
+        pid_t pid = ::fork();
+        ASSERT_GE(pid, 0);
+        if (pid == 0) {
+            int status = 1;
+            try {
+                ShmRingSubscriber subscriber(name);
+                subscriber.seek(0);
+                char byte = 0;
+                (void)::write(ready[1], &byte, 1);
+                ShmRecord record;
+                std::string side;
+                size_t received = 0;
+                size_t positions = 0;
+                while (received < sentences.size()) {
+                    if (!subscriber.read(record, side)) {
+                        ::usleep(100);
+                        continue;
+                    }
+                    if (side != sentences[received].sentence) {
+                        break;
+                    }
+                    positions += !std::isnan(record.speed) && record.latitude <= 90.0;
+                    received++;
+                }
+                status = received == sentences.size() && positions > 0 && subscriber.get_lost() == 0 ? 0 : 2;
+            } catch (...) {
+                status = 3;
+            }
+            ::_exit(status);
+        }
+        children.push_back(pid);
+    }
+    // A child that fails to subscribe closes its end without writing
+    ::close(ready[1]);
+    for (int i = 0; i < readers; ++i) {
+        char byte;
+        ASSERT_EQ(::read(ready[0], &byte, 1), 1);
+    }
+
+    AISParser parser;
+    size_t published = 0;
+    for (const auto& generated : sentences) {
+        auto message = parser.parse(generated.sentence);
+        if (message) {
+            publisher.publish(generated.time, *message, generated.sentence);
+        } else {
+            // Leading fragments of multipart messages carry only the sentence
+            ShmRecord record;
+            record.time = generated.time;
+            publisher.publish(record, generated.sentence.data(), generated.sentence.size());
+        }
+        published++;
+    }
+    EXPECT_EQ(publisher.get_published(), published);
+
+    for (pid_t pid : children) {
+        int status = 0;
+        ASSERT_EQ(::waitpid(pid, &status, 0), pid);
+        ASSERT_TRUE(WIFEXITED(status));
+        EXPECT_EQ(WEXITSTATUS(status), 0);
+    }
+    ::close(ready[0]);
+}
@@ -0,0 +1,152 @@
+#include <gtest/gtest.h>
+#include "aislib/simulation/traffic_generator.h"
+#include "aislib/ais_parser.h"
+#include "aislib/nmea_utils.h"
+#include <cstdio>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+using namespace aislib;
+using namespace aislib::simulation;
+
+// Test that equal seeds give equal output
+TEST(TrafficGeneratorTest, Deterministic) {
+    TrafficConfig config;
+    config.seed = 42;
+    
+    TrafficGenerator first(config);
+    TrafficGenerator second(config);
+    
+    auto a = first.generate(500);
+    auto b = second.generate(500);
+    
+    ASSERT_EQ(a.size(), b.size());
+    for (size_t i = 0; i < a.size(); ++i) {
+        EXPECT_EQ(a[i].sentence, b[i].sentence);
+    }
+}
+
+// Test that clean traffic decodes completely and follows the configured mix
+TEST(TrafficGeneratorTest, CleanTrafficDecodes) {
+    TrafficConfig config;
+    config.type_mix = {{1, 70.0}, {5, 10.0}, {18, 20.0}};
+    TrafficGenerator generator(config);
+    
+    auto sentences = generator.generate(1000);
+    
+    AISParser parser;
+    std::map<int, size_t> decoded;
+    for (const auto& sentence : sentences) {
+        EXPECT_TRUE(NMEAUtils::validate_checksum(sentence.sentence));
+        auto message = parser.parse(sentence.sentence);
+        EXPECT_EQ(parser.get_last_error().type, AISParser::ParseError::ErrorType::NONE);
+        if (message) {
+            ++decoded[message->get_message_type()];
+        }
+    }
+    
+    size_t total = decoded[1] + decoded[5] + decoded[18];
+    EXPECT_EQ(total, 1000u);
+    EXPECT_EQ(decoded.size(), 3u);
+    EXPECT_GT(decoded[1], 600u);
+    EXPECT_LT(decoded[1], 800u);
+    EXPECT_EQ(parser.get_incomplete_message_count(), 0u);
+}
+
+// Test that interleaved fragments still reassemble
+TEST(TrafficGeneratorTest, Interleaving) {
+    TrafficConfig config;
+    config.type_mix = {{1, 50.0}, {5, 50.0}};
+    config.max_interleave = 3;
+    TrafficGenerator generator(config);
+    
+    auto sentences = generator.generate(400);
+    
+    // At least one sentence must separate two fragments of the same message
+    bool interleaved = false;
+    for (size_t i = 0; i + 1 < sentences.size(); ++i) {
+        auto fields = NMEAUtils::parse_fields(sentences[i].sentence);
+        auto next_fields = NMEAUtils::parse_fields(sentences[i + 1].sentence);
+        if (fields[1] == "2" && fields[2] == "1" && next_fields[1] != "2") {
+            interleaved = true;
+            break;
+        }
+    }
+    EXPECT_TRUE(interleaved);
+    
+    AISParser parser;
+    size_t decoded = 0;
+    for (const auto& sentence : sentences) {
+        if (parser.parse(sentence.sentence)) {
+            ++decoded;
+        }
+    }
+    EXPECT_EQ(decoded, 400u);
+}
+
+// Test the impairments and their statistics
+TEST(TrafficGeneratorTest, Impairments) {
+    TrafficConfig config;
+    config.receiver_count = 3;
+    config.duplicate_probability = 0.5;
+    config.fragment_loss_probability = 0.1;
+    config.reorder_probability = 0.2;
+    config.corrupt_probability = 0.05;
+    TrafficGenerator generator(config);
+    
+    auto sentences = generator.generate(2000);
+    const TrafficStatistics& stats = generator.get_statistics();
+    
+    EXPECT_EQ(stats.messages, 2000u);
+    EXPECT_EQ(stats.sentences, sentences.size());
+    EXPECT_GT(stats.duplicates, 0u);
+    EXPECT_GT(stats.lost_fragments, 0u);
+    EXPECT_GT(stats.reordered_messages, 0u);
+    EXPECT_GT(stats.corrupted, 0u);
+    
+    size_t bad_checksums = 0;
+    std::set<uint16_t> receivers;
+    for (const auto& sentence : sentences) {
+        if (!NMEAUtils::validate_checksum(sentence.sentence)) {
+            ++bad_checksums;
+        }
+        receivers.insert(sentence.receiver_id);
+    }
+    EXPECT_EQ(bad_checksums, stats.corrupted);
+    EXPECT_EQ(receivers.size(), 3u);
+}
+
+// Test the tag block format
+TEST(TrafficGeneratorTest, TagBlock) {
+    GeneratedSentence sentence;
+    sentence.sentence = "!AIVDM,1,1,,A,13u?etPv2;0n:dDPwUM1U1Cb069D,0*24";
+    sentence.receiver_id = 7;
+    sentence.time = 1717243200.5;
+    sentence.message_type = 1;
+    
+    std::string tagged = sentence.with_tag_block();
+    EXPECT_EQ(tagged.substr(0, 19), "\\s:r7,c:1717243200*");
+    EXPECT_EQ(tagged.substr(tagged.find('!')), sentence.sentence);
+    
+    std::string content = "s:r7,c:1717243200";
+    char checksum[3];
+    std::snprintf(checksum, sizeof(checksum), "%02X", NMEAUtils::calculate_checksum(content));
+    EXPECT_EQ(tagged.substr(19, 2), checksum);
+}
+
+// Test configuration validation
+TEST(TrafficGeneratorTest, InvalidConfig) {
+    TrafficConfig config;
+    config.type_mix = {{9, 1.0}};
+    EXPECT_THROW(TrafficGenerator{config}, std::invalid_argument);
+    
+    config = TrafficConfig();
+    config.vessel_count = 0;
+    EXPECT_THROW(TrafficGenerator{config}, std::invalid_argument);
+    
+    config = TrafficConfig();
+    config.corrupt_probability = 1.5;
+    EXPECT_THROW(TrafficGenerator{config}, std::invalid_argument);
+}
@@ -0,0 +1,167 @@
+#include <gtest/gtest.h>
+#include "aislib/static_data_report.h"
+#include "aislib/class_b_static_cache.h"
+#include "aislib/ais_parser.h"
+#include "aislib/nmea_utils.h"
+#include "test_support.h"
+#include <chrono>
+#include <memory>
+
+using namespace aislib;
+using namespace aislib::test_support;
+
+namespace {
+
+StaticDataReport part_b(uint32_t mmsi, const std::string& call_sign) {
+    StaticDataReport report(mmsi, 0, StaticDataReport::Part::B);
+    report.set_ship_type(37);
+    report.set_vendor_id("SRT");
+    report.set_unit_model(2);
+    report.set_serial_number(123456);
+    report.set_call_sign(call_sign);
+    report.set_ship_dimensions(9, 3, 2, 2);
+    return report;
+}
+
+StaticDataReport round_trip(const StaticDataReport& report) {
+    BitVector bits;
+    report.to_bits(bits);
+    return StaticDataReport(bits);
+}
+
+} // anonymous namespace
+
+TEST(StaticDataReportTest, PartARoundTrip) {
+    BitVector bits;
+    part_a(232004567, "SEA BREEZE").to_bits(bits);
+    EXPECT_EQ(bits.size(), 168u);
+
+    StaticDataReport decoded(bits);
+    EXPECT_EQ(decoded.get_message_type(), 24);
+    EXPECT_EQ(decoded.get_mmsi(), 232004567u);
+    EXPECT_EQ(decoded.get_part(), StaticDataReport::Part::A);
+    EXPECT_EQ(decoded.get_vessel_name(), "SEA BREEZE");
+    EXPECT_TRUE(decoded.get_call_sign().empty());
+
+    // Some transponders omit the Part A spare bits
+    bits.truncate(160);
+    EXPECT_EQ(StaticDataReport(bits).get_vessel_name(), "SEA BREEZE");
+}
+
+TEST(StaticDataReportTest, PartBRoundTrip) {
+    StaticDataReport decoded = round_trip(part_b(232004567, "MABC7"));
+    EXPECT_EQ(decoded.get_part(), StaticDataReport::Part::B);
+    EXPECT_EQ(decoded.get_ship_type(), 37);
+    EXPECT_EQ(decoded.get_vendor_id(), "SRT");
+    EXPECT_EQ(decoded.get_unit_model(), 2);
+    EXPECT_EQ(decoded.get_serial_number(), 123456u);
+    EXPECT_EQ(decoded.get_call_sign(), "MABC7");
+    EXPECT_EQ(decoded.get_dimension_to_bow(), 9);
+    EXPECT_EQ(decoded.get_dimension_to_stern(), 3);
+    EXPECT_EQ(decoded.get_dimension_to_port(), 2);
+    EXPECT_EQ(decoded.get_dimension_to_starboard(), 2);
+    EXPECT_EQ(decoded.get_mothership_mmsi(), 0u);
+    EXPECT_TRUE(decoded.get_vessel_name().empty());
+}
+
+TEST(StaticDataReportTest, AuxiliaryCraftCarriesMothershipMmsi) {
+    StaticDataReport report(982320001, 0, StaticDataReport::Part::B);
+    report.set_mothership_mmsi(232004567);
+    ASSERT_TRUE(report.is_auxiliary_craft());
+
+    StaticDataReport decoded = round_trip(report);
+    EXPECT_EQ(decoded.get_mothership_mmsi(), 232004567u);
+    EXPECT_EQ(decoded.get_dimension_to_bow(), 0);
+    EXPECT_FALSE(part_b(232004567, "MABC7").is_auxiliary_craft());
+}
+
+TEST(StaticDataReportTest, RejectsInvalidBits) {
+    BitVector bits;
+    part_b(232004567, "MABC7").to_bits(bits);
+    bits.set_bit(38, true);  // Part number 3
+    EXPECT_THROW(StaticDataReport report(bits), std::invalid_argument);
+
+    part_b(232004567, "MABC7").to_bits(bits);
+    bits.truncate(150);
+    EXPECT_THROW(StaticDataReport report(bits), std::invalid_argument);
+}
+
+TEST(StaticDataReportTest, ParserDecodesType24) {
+    BitVector bits;
+    part_a(232004567, "SEA BREEZE").to_bits(bits);
+    std::string sentence = NMEAUtils::create_aivdm_sentence(bits.to_nmea_payload(), 1, 1, "", 'A', 0);
+
+    AISParser parser;
+    std::unique_ptr<AISMessage> message = parser.parse(sentence);
+    auto* report = dynamic_cast<StaticDataReport*>(message.get());
+    ASSERT_NE(report, nullptr);
+    EXPECT_EQ(report->get_vessel_name(), "SEA BREEZE");
+}
+
+TEST(ClassBStaticCacheTest, MergesPartsInEitherOrder) {
+    ClassBStaticCache cache;
+    auto now = ClassBStaticCache::Clock::now();
+
+    const ClassBStaticRecord& first = cache.update(part_b(232004567, "MABC7"), now);
+    EXPECT_TRUE(first.has_part_b);
+    EXPECT_FALSE(first.is_complete());
+
+    cache.update(part_a(232004567, "SEA BREEZE"), now + std::chrono::minutes(3));
+    const ClassBStaticRecord* record = cache.find(232004567, now + std::chrono::minutes(3));
+    ASSERT_NE(record, nullptr);
+    EXPECT_TRUE(record->is_complete());
+    EXPECT_EQ(record->vessel_name, "SEA BREEZE");
+    EXPECT_EQ(record->call_sign, "MABC7");
+    EXPECT_EQ(record->ship_type, 37);
+    EXPECT_EQ(record->dimension_to_bow, 9);
+    EXPECT_EQ(cache.size(), 1u);
+    EXPECT_EQ(cache.find(232000000, now), nullptr);
+
+    ClassBStaticCache::Stats stats = cache.get_stats();
+    EXPECT_EQ(stats.updates, 2u);
+    EXPECT_EQ(stats.complete, 1u);
+}
+
+TEST(ClassBStaticCacheTest, RecordsExpire) {
+    ClassBStaticCache::Config config;
+    config.max_age = std::chrono::seconds(600);
+    ClassBStaticCache cache(config);
+    auto now = ClassBStaticCache::Clock::now();
+
+    cache.update(part_a(232004567, "SEA BREEZE"), now);
+    cache.update(part_a(232004568, "SEA SPRAY"), now + std::chrono::seconds(300));
+    EXPECT_NE(cache.find(232004567, now + std::chrono::seconds(600)), nullptr);
+    EXPECT_EQ(cache.find(232004567, now + std::chrono::seconds(601)), nullptr);
+
+    EXPECT_EQ(cache.expire(now + std::chrono::seconds(700)), 1u);
+    EXPECT_EQ(cache.size(), 1u);
+
+    // A part arriving after the record expired does not pair with it
+    const ClassBStaticRecord& record = cache.update(part_b(232004568, "MABC8"), now + std::chrono::seconds(1000));
+    EXPECT_FALSE(record.has_part_a);
+    EXPECT_EQ(cache.get_stats().expirations, 2u);
+}
+
+TEST(ClassBStaticCacheTest, EvictsLeastRecentlyUpdated) {
+    ClassBStaticCache::Config config;
+    config.max_vessels = 2;
+    ClassBStaticCache cache(config);
+    auto now = ClassBStaticCache::Clock::now();
+
+    cache.update(part_a(1, "ONE"), now);
+    cache.update(part_a(2, "TWO"), now);
+    cache.update(part_b(1, "CALL1"), now);
+    cache.update(part_a(3, "THREE"), now);
+
+    EXPECT_EQ(cache.size(), 2u);
+    EXPECT_NE(cache.find(1, now), nullptr);
+    EXPECT_EQ(cache.find(2, now), nullptr);
+    EXPECT_NE(cache.find(3, now), nullptr);
+    EXPECT_EQ(cache.get_stats().evictions, 1u);
+
+    cache.clear();
+    EXPECT_EQ(cache.size(), 0u);
+
+    config.max_vessels = 0;
+    EXPECT_THROW(ClassBStaticCache empty(config), std::invalid_argument);
+}
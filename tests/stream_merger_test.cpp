@@ -0,0 +1,225 @@
+#include <gtest/gtest.h>
+#include "aislib/stream_merger.h"
+#include "aislib/simulation/traffic_generator.h"
+#include "test_support.h"
+#include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace aislib;
+using namespace aislib::test_support;
+
+namespace {
+
+std::vector<double> times(const std::vector<MergedSentence>& merged) {
+    std::vector<double> result;
+    for (const auto& record : merged) {
+        result.push_back(record.time);
+    }
+    return result;
+}
+
+} // anonymous namespace
+
+TEST(StreamMergerTest, MergesInTimeOrder) {
+    StreamMerger merger(3);
+    int number = 0;
+    for (int i = 0; i < 30; ++i) {
+        merger.push(static_cast<uint16_t>(i % 3), kStart + i * 0.5, numbered_sentence(number++));
+    }
+    std::vector<MergedSentence> merged;
+    // Newest records are at 13.5, 14.0 and 14.5 seconds; 2 second delay
+    merger.pop(merged);
+    EXPECT_EQ(merger.get_watermark(), kStart + 11.5);
+    EXPECT_EQ(merged.size(), 24u);
+    EXPECT_EQ(merger.buffered(), 6u);
+
+    merger.flush(merged);
+    ASSERT_EQ(merged.size(), 30u);
+    auto released = times(merged);
+    EXPECT_TRUE(std::is_sorted(released.begin(), released.end()));
+    EXPECT_EQ(merged[1].source, 1u);
+    EXPECT_EQ(merged[1].sentence, numbered_sentence(1));
+    EXPECT_EQ(merger.get_stats().released, 30u);
+}
+
+TEST(StreamMergerTest, WatermarksAndIdleSources) {
+    StreamMerger::Config config;
+    config.max_delay = 1.0;
+    config.idle_timeout = 30.0;
+    StreamMerger merger(3, config);
+    // Source 2 is a satellite feed delivering minutes late
+    merger.set_max_delay(2, 120.0);
+
+    int number = 0;
+    std::vector<MergedSentence> merged;
+    for (int i = 0; i < 20; ++i) {
+        merger.push(0, kStart + i, numbered_sentence(number++));
+    }
+    merger.push(1, kStart + 5.0, numbered_sentence(number++));
+    // Source 1 lags: its watermark holds the merge at 4 seconds
+    merger.pop(merged);
+    EXPECT_EQ(merger.get_watermark(), kStart + 4.0);
+    EXPECT_EQ(merged.size(), 5u);
+
+    // Heartbeats move a quiet source's watermark
+    merger.advance(1, kStart + 10.0);
+    merger.pop(merged);
+    EXPECT_EQ(merger.get_watermark(), kStart + 9.0);
+
+    // The satellite feed holds the merge back by its delay
+    merger.push(2, kStart + 15.0, numbered_sentence(number++));
+    merger.advance(1, kStart + 20.0);
+    merger.pop(merged);
+    EXPECT_EQ(merger.get_watermark(), kStart + 9.0);
+
+    // Until it has been silent for the idle timeout
+    for (int i = 20; i < 50; ++i) {
+        merger.push(0, kStart + i, numbered_sentence(number++));
+        merger.advance(1, kStart + i);
+    }
+    merger.pop(merged);
+    EXPECT_EQ(merger.get_watermark(), kStart + 48.0);
+    auto released = times(merged);
+    EXPECT_TRUE(std::is_sorted(released.begin(), released.end()));
+    EXPECT_EQ(merged.size() + merger.buffered(), static_cast<size_t>(number));
+
+    EXPECT_THROW(merger.push(3, kStart, numbered_sentence(0)), std::out_of_range);
+    EXPECT_THROW(StreamMerger(0), std::invalid_argument);
+}
+
+TEST(StreamMergerTest, OutOfOrderAndLateRecords) {
+    StreamMerger::Config config;
+    config.max_delay = 3.0;
+    StreamMerger merger(1, config);
+    std::mt19937 rng(5);
+    std::vector<double> pushed;
+    for (int i = 0; i < 200; ++i) {
+        pushed.push_back(kStart + i + std::uniform_real_distribution<double>(-2.5, 0.0)(rng));
+    }
+
+    std::vector<MergedSentence> merged;
+    for (size_t i = 0; i < pushed.size(); ++i) {
+        merger.push(0, pushed[i], numbered_sentence(static_cast<int>(i)));
+        merger.pop(merged);
+    }
+    merger.flush(merged);
+    ASSERT_EQ(merged.size(), pushed.size());
+    auto released = times(merged);
+    EXPECT_TRUE(std::is_sorted(released.begin(), released.end()));
+    EXPECT_EQ(merger.get_stats().late, 0u);
+
+    // Older than the watermark: released by the next pop and counted
+    merger.push(0, kStart, numbered_sentence(1000));
+    EXPECT_EQ(merger.get_stats().late, 1u);
+    EXPECT_EQ(merger.pop(merged), 1u);
+    EXPECT_EQ(merged.back().time, kStart);
+}
+
+TEST(StreamMergerTest, FullBufferRaisesWatermark) {
+    StreamMerger::Config config;
+    config.buffer_capacity = 4;
+    StreamMerger merger(2, config);
+    merger.push(1, kStart, numbered_sentence(100));
+    for (int i = 0; i < 4; ++i) {
+        EXPECT_TRUE(merger.push(0, kStart + i, numbered_sentence(i)));
+    }
+    EXPECT_FALSE(merger.push(0, kStart + 4.0, numbered_sentence(4)));
+    EXPECT_EQ(merger.get_stats().overflows, 1u);
+
+    // Source 1 lags, but the full buffer forces its oldest record out
+    std::vector<MergedSentence> merged;
+    EXPECT_EQ(merger.pop(merged), 2u);
+    EXPECT_TRUE(merger.push(0, kStart + 4.0, numbered_sentence(4)));
+}
+
+TEST(StreamMergerTest, DropsRepeatedTransmissions) {
+    simulation::TrafficConfig traffic;
+    traffic.receiver_count = 4;
+    traffic.duplicate_probability = 0.5;
+    // The simulator may send a vessel's unchanged static data twice within a
+    // second, which counts as a repeated transmission; keep to position reports
+    traffic.type_mix = {{1, 2.0}, {3, 1.0}};
+    simulation::TrafficGenerator generator(traffic);
+    auto sentences = generator.generate(3000);
+    ASSERT_GT(generator.get_statistics().duplicates, 0u);
+
+    // Each receiver delivers with its own latency
+    StreamMerger::Config config;
+    config.max_delay = 0.5;
+    config.dedup_window = 0.5;
+    StreamMerger merger(traffic.receiver_count, config);
+    std::vector<MergedSentence> merged;
+    for (const auto& generated : sentences) {
+        std::string line = generated.receiver_id % 2 == 0 ? generated.sentence : generated.with_tag_block();
+        ASSERT_TRUE(merger.push(generated.receiver_id, generated.time, line));
+        merger.pop(merged);
+    }
+    merger.flush(merged);
+
+    StreamMerger::Stats stats = merger.get_stats();
+    EXPECT_EQ(stats.duplicates, generator.get_statistics().duplicates);
+    EXPECT_EQ(merged.size(), sentences.size() - generator.get_statistics().duplicates);
+    auto released = times(merged);
+    EXPECT_TRUE(std::is_sorted(released.begin(), released.end()));
+
+    // With deduplication off every record is released
+    config.dedup_window = 0.0;
+    StreamMerger keep_all(traffic.receiver_count, config);
+    std::vector<MergedSentence> all;
+    for (const auto& generated : sentences) {
+        keep_all.push(generated.receiver_id, generated.time, generated.sentence);
+    }
+    keep_all.flush(all);
+    EXPECT_EQ(all.size(), sentences.size());
+}
+
+TEST(StreamMergerTest, ViewsAndBoundedDedupTable) {
+    // Remembers twice buffer_capacity transmissions
+    StreamMerger::Config config;
+    config.buffer_capacity = 4;
+    config.max_delay = 0.0;
+    StreamMerger merger(1, config);
+    std::vector<MergedView> views;
+    for (int i = 0; i < 20; ++i) {
+        merger.push(0, kStart + i * 0.1, numbered_sentence(i));
+        ASSERT_EQ(merger.pop(views), 1u);
+        EXPECT_EQ(views[0].sentence, numbered_sentence(i));
+        EXPECT_EQ(views[0].time, kStart + i * 0.1);
+        views.clear();
+    }
+
+    merger.push(0, kStart + 2.0, numbered_sentence(19));
+    EXPECT_EQ(merger.pop(views), 0u);
+    // Within the window, but pushed out of the table by later transmissions
+    merger.push(0, kStart + 2.1, numbered_sentence(0));
+    EXPECT_EQ(merger.pop(views), 1u);
+    merger.push(0, kStart + 2.2, numbered_sentence(15));
+    EXPECT_EQ(merger.flush(views), 0u);
+    EXPECT_EQ(merger.get_stats().duplicates, 2u);
+}
+
+TEST(StreamMergerTest, ChainsLaterFragments) {
+    // Two type 5 messages whose second fragments are the same
+    const std::string first_a = "!AIVDM,2,1,3,A,55?MbV02>H97<=E;<00<4@tp4<Q@E:2222222216CP3=C55lPRl@,0*00";
+    const std::string first_b = "!AIVDM,2,1,4,A,55?MbV02>H97<=E;<00<4@tp4<Q@E:2222222216CP3=C55lPRl4,0*00";
+    const std::string second_a = "!AIVDM,2,2,3,A,88888888880,2*00";
+    const std::string second_b = "!AIVDM,2,2,4,A,88888888880,2*00";
+
+    StreamMerger merger(2);
+    merger.push(0, kStart, first_a);
+    merger.push(0, kStart, second_a);
+    merger.push(0, kStart + 0.1, first_b);
+    merger.push(0, kStart + 0.1, second_b);
+    // Message A heard by the second receiver, with its own sequential message ID
+    merger.push(1, kStart + 0.05, "!AIVDM,2,1,7,B,55?MbV02>H97<=E;<00<4@tp4<Q@E:2222222216CP3=C55lPRl@,0*00");
+    merger.push(1, kStart + 0.05, "!AIVDM,2,2,7,B,88888888880,2*00");
+
+    std::vector<MergedSentence> merged;
+    merger.flush(merged);
+    ASSERT_EQ(merged.size(), 4u);
+    EXPECT_EQ(merged[1].sentence, second_a);
+    EXPECT_EQ(merged[3].sentence, second_b);
+    EXPECT_EQ(merger.get_stats().duplicates, 2u);
+}
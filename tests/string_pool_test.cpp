@@ -0,0 +1,111 @@
+#include <gtest/gtest.h>
+#include "aislib/string_pool.h"
+#include "aislib/bit_vector.h"
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace aislib;
+
+TEST(StringPoolTest, EmptyString) {
+    StringPool pool;
+    EXPECT_EQ(pool.intern(""), StringPool::EMPTY);
+    EXPECT_EQ(pool.intern("@@@   "), StringPool::EMPTY);
+    EXPECT_EQ(pool.view(StringPool::EMPTY), "");
+    EXPECT_EQ(pool.size(), 1u);
+}
+
+TEST(StringPoolTest, DeduplicatesStrings) {
+    StringPool pool;
+    StringPool::Handle rotterdam = pool.intern("ROTTERDAM");
+    StringPool::Handle hamburg = pool.intern("HAMBURG");
+
+    EXPECT_NE(rotterdam, StringPool::EMPTY);
+    EXPECT_NE(rotterdam, hamburg);
+    EXPECT_EQ(pool.intern("ROTTERDAM"), rotterdam);
+    // Padding is not part of the string
+    EXPECT_EQ(pool.intern("ROTTERDAM@@@"), rotterdam);
+    EXPECT_EQ(pool.intern("ROTTERDAM   "), rotterdam);
+    EXPECT_EQ(pool.view(rotterdam), "ROTTERDAM");
+    EXPECT_EQ(pool.view(hamburg), "HAMBURG");
+    EXPECT_EQ(pool.size(), 3u);
+}
+
+TEST(StringPoolTest, InternFromBits) {
+    StringPool pool;
+    BitVector bits;
+    bits.append_uint(5, 6);                     // unaligned start
+    bits.append_string("CALL7", 42);
+    bits.append_string("MV SHORT NAME", 120);
+    bits.append_string("TWENTY CHARACTERS AB", 120);
+
+    StringPool::Handle call_sign = pool.intern(bits, 6, 42);
+    StringPool::Handle name = pool.intern(bits, 48, 120);
+    StringPool::Handle full = pool.intern(bits, 168, 120);
+
+    EXPECT_EQ(pool.view(call_sign), "CALL7");
+    EXPECT_EQ(pool.view(name), "MV SHORT NAME");
+    EXPECT_EQ(pool.view(full), "TWENTY CHARACTERS AB");
+
+    // Same handles as interning the decoded text
+    EXPECT_EQ(pool.intern("CALL7"), call_sign);
+    EXPECT_EQ(pool.intern(bits.get_string(48, 120)), name);
+    EXPECT_EQ(pool.intern("TWENTY CHARACTERS AB"), full);
+
+    EXPECT_THROW(pool.intern(bits, 0, 40), std::invalid_argument);
+    EXPECT_THROW(pool.intern(bits, 0, 126), std::invalid_argument);
+    EXPECT_THROW(pool.intern(bits, 200, 120), std::out_of_range);
+}
+
+TEST(StringPoolTest, RejectsLongStringsAndBadHandles) {
+    StringPool pool;
+    EXPECT_THROW(pool.intern("THIS NAME IS LONGER THAN TWENTY"), std::invalid_argument);
+    EXPECT_THROW(pool.view(1), std::out_of_range);
+}
+
+TEST(StringPoolTest, GrowsAndKeepsViewsStable) {
+    StringPool pool(4);
+    StringPool::Handle first = pool.intern("FIRST");
+    std::string_view first_view = pool.view(first);
+
+    std::vector<StringPool::Handle> handles;
+    for (int i = 0; i < 10000; ++i) {
+        handles.push_back(pool.intern("VESSEL " + std::to_string(i)));
+    }
+
+    EXPECT_EQ(pool.size(), 10002u);
+    EXPECT_EQ(first_view.data(), pool.view(first).data());
+    for (int i = 0; i < 10000; ++i) {
+        EXPECT_EQ(pool.intern("VESSEL " + std::to_string(i)), handles[i]);
+        EXPECT_EQ(pool.view(handles[i]), "VESSEL " + std::to_string(i));
+    }
+}
+
+TEST(StringPoolTest, ConcurrentInterning) {
+    StringPool pool(16);
+    const int kThreads = 4;
+    const int kStrings = 2000;
+    std::vector<std::vector<StringPool::Handle>> results(kThreads);
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; ++t) {
+        threads.emplace_back([&pool, &results, t]() {
+            for (int i = 0; i < kStrings; ++i) {
+                results[t].push_back(pool.intern("SHIP " + std::to_string(i)));
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    // Every thread got the same handle for the same string
+    for (int t = 1; t < kThreads; ++t) {
+        EXPECT_EQ(results[t], results[0]);
+    }
+    EXPECT_EQ(pool.size(), static_cast<size_t>(kStrings + 1));
+    EXPECT_EQ(std::set<StringPool::Handle>(results[0].begin(), results[0].end()).size(),
+              static_cast<size_t>(kStrings));
+}
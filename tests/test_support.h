@@ -0,0 +1,45 @@
+/**
+ * @file test_support.h
+ * @brief Constants and helpers shared by the unit tests
+ */
+
+#ifndef AISLIB_TEST_SUPPORT_H
+#define AISLIB_TEST_SUPPORT_H
+
+#include "aislib/static_data_report.h"
+#include <cstdint>
+#include <string>
+#include <unistd.h>
+
+namespace aislib {
+namespace test_support {
+
+// 2024-06-01 12:00:00 UTC
+const double kStart = 1717243200.0;
+
+// Degrees of latitude covered in a number of seconds at a speed in knots
+inline double northing(double knots, double seconds) {
+    return knots * seconds / 3600.0 / 60.0;
+}
+
+// Distinct single-fragment sentences; the payload carries the number
+inline std::string numbered_sentence(int number) {
+    return "!AIVDM,1,1,,A,13u?etPv2;0n:dDPwUM1U1Cb" + std::to_string(number) + ",0*00";
+}
+
+// Names of files and segments are per process so that parallel test runs do not collide
+inline std::string process_name(const std::string& prefix, const char* test) {
+    return prefix + test + "-" + std::to_string(::getpid());
+}
+
+// Class B static data part A carrying only a vessel name
+inline StaticDataReport part_a(uint32_t mmsi, const std::string& name) {
+    StaticDataReport report(mmsi, 0, StaticDataReport::Part::A);
+    report.set_vessel_name(name);
+    return report;
+}
+
+} // namespace test_support
+} // namespace aislib
+
+#endif // AISLIB_TEST_SUPPORT_H
@@ -0,0 +1,174 @@
+#include <gtest/gtest.h>
+#include "aislib/time_reconstruction.h"
+#include "aislib/ais_parser.h"
+#include "aislib/base_station_report.h"
+#include "aislib/nmea_utils.h"
+#include "aislib/simulation/traffic_generator.h"
+#include "test_support.h"
+#include <cmath>
+#include <string>
+
+using namespace aislib;
+using namespace aislib::test_support;
+
+namespace {
+
+const double kNone = std::nan("");
+
+uint8_t second_of(double time) {
+    return static_cast<uint8_t>(static_cast<int64_t>(time) % 60);
+}
+
+} // anonymous namespace
+
+TEST(TimeReconstructionTest, PlacesSecondInNearestMinute) {
+    TimeBatch batch;
+    batch.append(0, kStart + 0.5, 59, kNone);    // Generated just before the minute
+    batch.append(0, kStart + 59.8, 2, kNone);    // Generated just after the next minute
+    batch.append(0, kStart + 30.2, 28, kNone);
+    batch.append(0, kStart + 31.0, 60, kNone);   // No UTC second
+    batch.append(0, kNone, 10, kNone);           // Nothing to place it with
+
+    TimeReconstructor reconstructor;
+    reconstructor.reconstruct(batch);
+
+    EXPECT_DOUBLE_EQ(batch.time[0], kStart - 1.0);
+    EXPECT_DOUBLE_EQ(batch.time[1], kStart + 62.0);
+    EXPECT_DOUBLE_EQ(batch.time[2], kStart + 28.0);
+    EXPECT_DOUBLE_EQ(batch.time[3], kStart + 31.0);
+    EXPECT_TRUE(std::isnan(batch.time[4]));
+    EXPECT_EQ(batch.source[0], TimeSource::UTC_SECOND);
+    EXPECT_EQ(batch.source[3], TimeSource::RECEIVE_TIME);
+    EXPECT_EQ(batch.source[4], TimeSource::NONE);
+}
+
+TEST(TimeReconstructionTest, CorrectsReceiverSkew) {
+    // Receiver 1 runs 40 seconds fast, so its raw receive times are in the wrong minute half
+    const double skew = 40.0;
+    TimeBatch batch;
+    batch.append(1, kStart + 50.0 + skew, second_of(kStart + 50.0), kNone);
+    batch.append(1, kStart + 10.0 + skew, 10, kStart + 10.0);
+    batch.append(2, kStart + 12.0, 12, kNone);
+    batch.append(1, kStart + 20.0 + skew, 20, kStart + 20.0);
+    batch.append(1, kStart + 75.0 + skew, second_of(kStart + 75.0), kNone);
+
+    TimeReconstructor reconstructor;
+    reconstructor.reconstruct(batch);
+
+    EXPECT_NEAR(reconstructor.get_skew(1), skew, 1e-9);
+    EXPECT_TRUE(std::isnan(reconstructor.get_skew(2)));
+
+    // The first row is before any base station report and uses the next one
+    EXPECT_DOUBLE_EQ(batch.time[0], kStart + 50.0);
+    EXPECT_EQ(batch.source[1], TimeSource::BASE_STATION);
+    EXPECT_DOUBLE_EQ(batch.time[2], kStart + 12.0);
+    EXPECT_DOUBLE_EQ(batch.time[4], kStart + 75.0);
+
+    // The estimate carries over to the next batch
+    TimeBatch next;
+    next.append(1, kStart + 100.0 + skew, second_of(kStart + 100.0), kNone);
+    reconstructor.reconstruct(next);
+    EXPECT_DOUBLE_EQ(next.time[0], kStart + 100.0);
+}
+
+TEST(TimeReconstructionTest, RowsWithoutReceiveTimeUseNearestBaseStation) {
+    TimeBatch batch;
+    batch.append(3, kNone, 0, kStart + 120.0);
+    batch.append(3, kNone, 58, kNone);
+    batch.append(3, kNone, 5, kNone);
+    batch.append(3, kNone, 15, kNone);
+    batch.append(3, kNone, 19, kStart + 199.0);
+    // No UTC second either: the base station time itself is used
+    batch.append(3, kNone, 60, kNone);
+
+    TimeReconstructor reconstructor;
+    reconstructor.reconstruct(batch);
+
+    EXPECT_DOUBLE_EQ(batch.time[1], kStart + 118.0);
+    EXPECT_DOUBLE_EQ(batch.time[2], kStart + 125.0);
+    EXPECT_DOUBLE_EQ(batch.time[3], kStart + 195.0);
+    EXPECT_EQ(batch.source[3], TimeSource::UTC_SECOND);
+    EXPECT_DOUBLE_EQ(batch.time[5], kStart + 199.0);
+    EXPECT_EQ(batch.source[5], TimeSource::NEAREST_BASE_STATION);
+}
+
+TEST(TimeReconstructionTest, RejectsBaseStationOutliers) {
+    TimeReconstructor reconstructor;
+    TimeBatch batch;
+    for (int i = 0; i < 5; ++i) {
+        batch.append(0, kStart + 10.0 * i + 2.0, 0, kStart + 10.0 * i);
+    }
+    // A base station with a clock 20 minutes off
+    batch.append(0, kStart + 60.0, 0, kStart + 60.0 - 1200.0);
+    reconstructor.reconstruct(batch);
+
+    EXPECT_NEAR(reconstructor.get_skew(0), 2.0, 1e-9);
+    EXPECT_EQ(reconstructor.get_rejected_samples(), 1u);
+
+    // Three disagreeing samples in a row: the receiver clock was stepped
+    batch.clear();
+    for (int i = 0; i < 3; ++i) {
+        batch.append(0, kStart + 100.0 + 10.0 * i - 10.0, 0, kStart + 100.0 + 10.0 * i);
+    }
+    reconstructor.reconstruct(batch);
+    EXPECT_NEAR(reconstructor.get_skew(0), -10.0, 1e-9);
+}
+
+TEST(TimeReconstructionTest, BaseStationReportProvidesReference) {
+    BaseStationReport report(2300001, 0);
+    report.set_utc_time(2024, 6, 1, 12, 0, 0);
+
+    TimeBatch batch;
+    batch.append(0, kStart + 0.3, report);
+    ASSERT_EQ(batch.size(), 1u);
+    EXPECT_DOUBLE_EQ(batch.reference_time[0], kStart);
+
+    TimeReconstructor reconstructor;
+    reconstructor.reconstruct(batch);
+    EXPECT_NEAR(reconstructor.get_skew(0), 0.3, 1e-6);
+}
+
+TEST(TimeReconstructionTest, GeneratedTrafficWithSkewedReceivers) {
+    simulation::TrafficConfig config;
+    config.receiver_count = 3;
+    config.duplicate_probability = 0.3;
+    config.type_mix = {{1, 60.0}, {4, 10.0}, {5, 10.0}, {18, 20.0}};
+    simulation::TrafficGenerator generator(config);
+    auto sentences = generator.generate(2000);
+
+    const double skews[] = {0.0, 25.0, -35.0};
+    AISParser parser;
+    TimeBatch batch;
+    std::vector<double> truth;
+    for (const auto& generated : sentences) {
+        // Shift the logged receive time by the receiver's clock error
+        simulation::GeneratedSentence skewed = generated;
+        skewed.time += skews[generated.receiver_id];
+        std::string line = skewed.with_tag_block();
+
+        TagBlock tag;
+        size_t offset = NMEAUtils::parse_tag_block(line, tag);
+        auto message = parser.parse(line.substr(offset));
+        if (!message) {
+            continue;
+        }
+        batch.append(static_cast<uint32_t>(std::stoul(tag.source.substr(1))), tag.time, *message);
+        truth.push_back(std::floor(generated.time));
+    }
+
+    TimeReconstructor reconstructor;
+    reconstructor.reconstruct(batch);
+
+    size_t placed = 0;
+    for (size_t i = 0; i < batch.size(); ++i) {
+        if (batch.source[i] == TimeSource::UTC_SECOND) {
+            // Duplicates are logged up to a fraction of a second later
+            EXPECT_NEAR(batch.time[i], truth[i], 1.0) << "row " << i;
+            ++placed;
+        }
+    }
+    EXPECT_GT(placed, batch.size() / 2);
+    for (uint32_t receiver = 0; receiver < 3; ++receiver) {
+        EXPECT_NEAR(reconstructor.get_skew(receiver), skews[receiver], 1.0);
+    }
+}
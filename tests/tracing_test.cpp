@@ -0,0 +1,123 @@
+#include <gtest/gtest.h>
+#include "aislib/tracing.h"
+#include "aislib/ais_parser.h"
+#include <algorithm>
+#include <set>
+#include <sstream>
+#include <string>
+#include <thread>
+
+using namespace aislib;
+
+namespace {
+
+const std::string kPositionReport = "!AIVDM,1,1,,A,15MgK45P3@G?fl0E`JbR0OwT0@MS,0*4E";
+
+std::set<trace::Point> points_of(const std::vector<trace::Event>& events) {
+    std::set<trace::Point> points;
+    for (const auto& event : events) {
+        points.insert(event.point);
+    }
+    return points;
+}
+
+} // anonymous namespace
+
+TEST(TracingTest, DisabledRecordsNothing) {
+    trace::clear();
+    trace::set_enabled(false);
+
+    AISParser parser;
+    ASSERT_NE(parser.parse(kPositionReport), nullptr);
+
+    EXPECT_TRUE(trace::collect().empty());
+}
+
+TEST(TracingTest, RecordsParseStages) {
+    trace::clear();
+    trace::set_enabled(true);
+
+    AISParser parser;
+    ASSERT_NE(parser.parse(kPositionReport), nullptr);
+    parser.parse("!AIVDM,2,1,0,B,53tfDKP29E6p?7333CDpu8@T>0P58ltqV222221JBhN<<5QfNGljCQhD3lQH,0*74");
+    ASSERT_NE(parser.parse("!AIVDM,2,2,0,B,88888888880,2*27"), nullptr);
+
+    trace::set_enabled(false);
+    std::vector<trace::Event> events = trace::collect();
+
+    if (!trace::is_compiled_in()) {
+        EXPECT_TRUE(events.empty());
+        return;
+    }
+
+    std::set<trace::Point> points = points_of(events);
+    for (trace::Point point : {trace::Point::PARSE, trace::Point::SENTENCE_SCAN, trace::Point::CHECKSUM,
+                               trace::Point::DEARMOR, trace::Point::FACTORY_DISPATCH, trace::Point::DECODE,
+                               trace::Point::MULTIPART_ADD, trace::Point::MULTIPART_COMPLETE}) {
+        EXPECT_EQ(points.count(point), 1u) << trace::point_name(point);
+    }
+
+    // Sorted by start time, every event is well formed
+    for (size_t i = 0; i < events.size(); ++i) {
+        EXPECT_LE(events[i].begin_ns, events[i].end_ns);
+        if (i > 0) {
+            EXPECT_LE(events[i - 1].begin_ns, events[i].begin_ns);
+        }
+    }
+
+    // The decode event carries the message type
+    auto decode = std::find_if(events.begin(), events.end(), [](const trace::Event& event) {
+        return event.point == trace::Point::DECODE;
+    });
+    ASSERT_NE(decode, events.end());
+    EXPECT_EQ(decode->arg, 1u);
+}
+
+TEST(TracingTest, RingBufferKeepsNewestEvents) {
+    if (!trace::is_compiled_in()) {
+        GTEST_SKIP() << "Library built without AISLIB_ENABLE_TRACING";
+    }
+
+    // Applies to buffers created afterwards, so record on a new thread
+    trace::set_buffer_capacity(16);
+    trace::clear();
+    trace::set_enabled(true);
+    std::thread worker([]() {
+        AISParser parser;
+        for (int i = 0; i < 100; ++i) {
+            parser.parse(kPositionReport);
+        }
+    });
+    worker.join();
+    trace::set_enabled(false);
+    trace::set_buffer_capacity(1 << 16);
+
+    std::vector<trace::Event> events = trace::collect();
+    EXPECT_EQ(events.size(), 16u);
+}
+
+TEST(TracingTest, ChromeTraceFormat) {
+    std::vector<trace::Event> events = {
+        {1000, 3000, 1, 0, trace::Point::CHECKSUM},
+        {4000, 9000, 2, 5, trace::Point::DECODE},
+        {2500001234, 2500002734, 1, 0, trace::Point::DECODE}
+    };
+
+    std::stringstream out;
+    trace::write_chrome_trace(out, events);
+    std::string json = out.str();
+
+    EXPECT_EQ(json.find("{\"displayTimeUnit\":\"ns\",\"traceEvents\":["), 0u);
+    EXPECT_NE(json.find("{\"name\":\"checksum\",\"cat\":\"aislib\",\"ph\":\"X\",\"ts\":0.000,\"dur\":2.000,\"pid\":1,\"tid\":1"),
+              std::string::npos);
+    EXPECT_NE(json.find("{\"name\":\"decode\",\"cat\":\"aislib\",\"ph\":\"X\",\"ts\":3.000,\"dur\":5.000,\"pid\":1,\"tid\":2,"
+                        "\"args\":{\"arg\":5}}"),
+              std::string::npos);
+    // Events long after the origin keep their sub-microsecond digits
+    EXPECT_NE(json.find("\"ts\":2500000.234,\"dur\":1.500,"), std::string::npos);
+    EXPECT_EQ(json.substr(json.size() - 4), "\n]}\n");
+
+    // The stream's formatting is restored
+    out << 0.5;
+    EXPECT_EQ(out.str().substr(out.str().size() - 3), "0.5");
+}
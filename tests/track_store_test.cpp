@@ -0,0 +1,196 @@
+#include <gtest/gtest.h>
+#include "aislib/track_store.h"
+#include "aislib/ais_parser.h"
+#include "aislib/geo.h"
+#include "aislib/simulation/traffic_generator.h"
+#include "test_support.h"
+#include <cmath>
+#include <limits>
+#include <map>
+
+using namespace aislib;
+using namespace aislib::test_support;
+
+namespace {
+
+const uint32_t kMmsi = 244000001;
+const float kNoTurn = 0.0f;
+
+} // anonymous namespace
+
+TEST(TrackStoreTest, DeadReckoningStraight) {
+    TrackStore store;
+    ASSERT_TRUE(store.update(kMmsi, kStart, 51.0, 1.0, 12.0f, 0.0f, kNoTurn));
+    ASSERT_TRUE(store.update(kMmsi + 1, kStart, 60.0, 5.0, 12.0f, 90.0f, kNoTurn));
+
+    ProjectedPosition position;
+    ASSERT_TRUE(store.position_at(kMmsi, kStart + 60.0, position));
+    EXPECT_EQ(position.method, ProjectionMethod::DEAD_RECKONED);
+    EXPECT_NEAR(position.latitude, 51.0 + northing(12.0, 60.0), 1e-9);
+    EXPECT_NEAR(position.longitude, 1.0, 1e-9);
+
+    // Due east at 60 degrees north a degree of longitude is half as long
+    ASSERT_TRUE(store.position_at(kMmsi + 1, kStart + 60.0, position));
+    EXPECT_NEAR(position.latitude, 60.0, 1e-9);
+    EXPECT_NEAR(position.longitude, 5.0 + 2.0 * northing(12.0, 60.0), 1e-9);
+
+    // Dead reckoning stops after max_extrapolation
+    ASSERT_TRUE(store.position_at(kMmsi, kStart + 1200.0, position));
+    EXPECT_NEAR(position.latitude, 51.0 + northing(12.0, 600.0), 1e-9);
+}
+
+TEST(TrackStoreTest, DeadReckoningTurn) {
+    TrackStore::Config config;
+    config.max_extrapolation = 3600.0;
+    config.max_age = 3600.0;
+    TrackStore store(config);
+    // 10 knots, turning right at 10 degrees per minute
+    ASSERT_TRUE(store.update(kMmsi, kStart, 51.0, 1.0, 10.0f, 0.0f, 10.0f));
+
+    // After 18 minutes the vessel has turned half a circle and heads south
+    double radius = 10.0 * geo::METERS_PER_NM / 3600.0 / (10.0 * M_PI / 180.0 / 60.0);
+    ProjectedPosition position;
+    ASSERT_TRUE(store.position_at(kMmsi, kStart + 18.0 * 60.0, position));
+    EXPECT_EQ(position.method, ProjectionMethod::DEAD_RECKONED);
+    EXPECT_NEAR(position.latitude, 51.0, 1e-9);
+    EXPECT_GT(position.longitude, 1.0);
+    EXPECT_NEAR(geo::haversine(51.0, 1.0, position.latitude, position.longitude), 2.0 * radius, 5.0);
+
+    // A full circle comes back to the start
+    ASSERT_TRUE(store.position_at(kMmsi, kStart + 36.0 * 60.0, position));
+    EXPECT_NEAR(position.latitude, 51.0, 1e-9);
+    EXPECT_NEAR(position.longitude, 1.0, 1e-9);
+}
+
+TEST(TrackStoreTest, Interpolation) {
+    TrackStore store;
+    ASSERT_TRUE(store.update(kMmsi, kStart, 51.0, 1.0, 12.0f, 0.0f, kNoTurn));
+    ASSERT_TRUE(store.update(kMmsi, kStart + 10.0, 51.1, 1.2, 12.0f, 0.0f, kNoTurn));
+
+    ProjectedPosition position;
+    ASSERT_TRUE(store.position_at(kMmsi, kStart + 2.5, position));
+    EXPECT_EQ(position.method, ProjectionMethod::INTERPOLATED);
+    EXPECT_NEAR(position.latitude, 51.025, 1e-9);
+    EXPECT_NEAR(position.longitude, 1.05, 1e-9);
+
+    // Earlier than both stored reports
+    ASSERT_TRUE(store.position_at(kMmsi, kStart - 5.0, position));
+    EXPECT_EQ(position.method, ProjectionMethod::HELD);
+    EXPECT_EQ(position.latitude, 51.0);
+
+    // Across the 180th meridian
+    ASSERT_TRUE(store.update(kMmsi + 1, kStart, 10.0, 179.9, 12.0f, 90.0f, kNoTurn));
+    ASSERT_TRUE(store.update(kMmsi + 1, kStart + 20.0, 10.0, -179.7, 12.0f, 90.0f, kNoTurn));
+    ASSERT_TRUE(store.position_at(kMmsi + 1, kStart + 5.0, position));
+    EXPECT_NEAR(position.longitude, 180.0, 1e-9);
+    ASSERT_TRUE(store.position_at(kMmsi + 1, kStart + 15.0, position));
+    EXPECT_NEAR(position.longitude, -179.8, 1e-9);
+}
+
+TEST(TrackStoreTest, HeldStaleAndIgnored) {
+    TrackStore store;
+    float unknown = std::numeric_limits<float>::quiet_NaN();
+    ASSERT_TRUE(store.update(kMmsi, kStart, 51.0, 1.0, unknown, 90.0f, kNoTurn));
+
+    ProjectedPosition position;
+    ASSERT_TRUE(store.position_at(kMmsi, kStart + 60.0, position));
+    EXPECT_EQ(position.method, ProjectionMethod::HELD);
+    EXPECT_EQ(position.longitude, 1.0);
+
+    EXPECT_FALSE(store.position_at(kMmsi, kStart + 1801.0, position));
+    EXPECT_FALSE(store.position_at(kMmsi + 1, kStart, position));
+
+    EXPECT_FALSE(store.update(kMmsi, kStart, 52.0, 1.0, 10.0f, 0.0f, kNoTurn));
+    EXPECT_FALSE(store.update(kMmsi, kStart + 10.0, 91.0, 181.0, 10.0f, 0.0f, kNoTurn));
+    EXPECT_THROW(TrackStore(TrackStore::Config([] {
+                     TrackStore::Config config;
+                     config.max_age = -1.0;
+                     return config;
+                 }())),
+                 std::invalid_argument);
+
+    TrackStore::Stats stats = store.get_stats();
+    EXPECT_EQ(stats.updates, 1u);
+    EXPECT_EQ(stats.out_of_order, 1u);
+    EXPECT_EQ(stats.invalid, 1u);
+    EXPECT_EQ(stats.vessels, 1u);
+}
+
+TEST(TrackStoreTest, ProjectMatchesPositionAt) {
+    simulation::TrafficConfig config;
+    config.vessel_count = 400;
+    config.type_mix = {{1, 4.0}, {3, 1.0}, {18, 2.0}, {5, 1.0}};
+    simulation::TrafficGenerator generator(config);
+    auto sentences = generator.generate(8000);
+
+    AISParser parser;
+    TrackStore store;
+    double last = 0.0;
+    for (const auto& generated : sentences) {
+        auto message = parser.parse(generated.sentence);
+        if (message) {
+            store.update(generated.time, *message);
+            last = std::max(last, generated.time);
+        }
+    }
+    ASSERT_GT(store.size(), 300u);
+
+    // Between reports, at the newest report and ahead of it
+    for (double time : {last - 20.0, last, last + 90.0}) {
+        ProjectedPositions positions;
+        size_t count = store.project(time, -90.0, -180.0, 90.0, 180.0, positions);
+        ASSERT_EQ(count, store.size());
+        std::map<ProjectionMethod, size_t> methods;
+        for (size_t i = 0; i < count; ++i) {
+            ProjectedPosition position;
+            ASSERT_TRUE(store.position_at(positions.mmsi[i], time, position));
+            EXPECT_EQ(positions.latitude[i], position.latitude) << positions.mmsi[i];
+            EXPECT_EQ(positions.longitude[i], position.longitude) << positions.mmsi[i];
+            EXPECT_EQ(positions.method[i], position.method) << positions.mmsi[i];
+            methods[position.method]++;
+        }
+        EXPECT_GT(methods[ProjectionMethod::DEAD_RECKONED], 0u);
+        if (time < last) {
+            EXPECT_GT(methods[ProjectionMethod::INTERPOLATED], 0u);
+        }
+
+        // A box around the southern half of the traffic
+        double middle = (config.min_latitude + config.max_latitude) / 2.0;
+        ProjectedPositions south;
+        store.project(time, -90.0, -180.0, middle, 180.0, south);
+        ASSERT_GT(south.size(), 0u);
+        ASSERT_LT(south.size(), count);
+        for (size_t i = 0; i < south.size(); ++i) {
+            EXPECT_LE(south.latitude[i], middle);
+        }
+    }
+
+    // Boxes across the 180th meridian
+    TrackStore pacific;
+    pacific.update(kMmsi, kStart, 0.0, 179.5, 0.0f, 0.0f, kNoTurn);
+    pacific.update(kMmsi + 1, kStart, 0.0, -179.5, 0.0f, 0.0f, kNoTurn);
+    pacific.update(kMmsi + 2, kStart, 0.0, 0.0, 0.0f, 0.0f, kNoTurn);
+    ProjectedPositions positions;
+    EXPECT_EQ(pacific.project(kStart, -1.0, 179.0, 1.0, -179.0, positions), 2u);
+}
+
+TEST(TrackStoreTest, ExpireAndClear) {
+    TrackStore store;
+    for (uint32_t i = 0; i < 10; ++i) {
+        store.update(kMmsi + i, kStart + 100.0 * i, 51.0, 1.0 + 0.01 * i, 10.0f, 45.0f, kNoTurn);
+    }
+    // Vessels 0-4 last reported more than 30 minutes before
+    EXPECT_EQ(store.expire(kStart + 2300.0), 5u);
+    EXPECT_EQ(store.size(), 5u);
+
+    ProjectedPosition position;
+    EXPECT_FALSE(store.position_at(kMmsi + 4, kStart + 2300.0, position));
+    for (uint32_t i = 5; i < 10; ++i) {
+        ASSERT_TRUE(store.position_at(kMmsi + i, kStart + 1000.0, position)) << i;
+        EXPECT_GT(position.longitude, 1.0 + 0.01 * i);
+    }
+
+    store.clear();
+    EXPECT_EQ(store.size(), 0u);
+    EXPECT_FALSE(store.position_at(kMmsi + 9, kStart + 900.0, position));
+}
@@ -0,0 +1,173 @@
+#include <gtest/gtest.h>
+#include "aislib/vdl_load.h"
+#include "aislib/ais_parser.h"
+#include "aislib/base_station_report.h"
+#include "aislib/nmea_utils.h"
+#include "aislib/position_report_class_a.h"
+#include "aislib/position_report_class_b.h"
+#include "aislib/simulation/traffic_generator.h"
+#include "test_support.h"
+
+using namespace aislib;
+using namespace aislib::test_support;
+
+namespace {
+
+CommunicationState sotdma(uint8_t slot_timeout, uint16_t sub_message) {
+    CommunicationState state;
+    state.access = CommunicationState::Access::SOTDMA;
+    state.sync_state = CommunicationState::SyncState::UTC_DIRECT;
+    state.slot_timeout = slot_timeout;
+    state.sub_message = sub_message;
+    return state;
+}
+
+} // anonymous namespace
+
+TEST(CommunicationStateTest, DecodesSotdma) {
+    // Sync state 1, slot timeout 3, 1234 received stations
+    uint32_t raw = (1u << 17) | (3u << 14) | 1234u;
+    CommunicationState state = CommunicationState::sotdma(raw);
+    EXPECT_EQ(state.access, CommunicationState::Access::SOTDMA);
+    EXPECT_EQ(state.sync_state, CommunicationState::SyncState::UTC_INDIRECT);
+    EXPECT_EQ(state.slot_timeout, 3);
+    EXPECT_EQ(state.get_sub_message_type(), CommunicationState::SubMessage::RECEIVED_STATIONS);
+    EXPECT_EQ(state.get_received_stations(), 1234);
+    EXPECT_EQ(state.get_slot_number(), -1);
+    EXPECT_EQ(state.encode(), raw);
+
+    EXPECT_EQ(CommunicationState::sotdma(2u << 14 | 2000u).get_slot_number(), 2000);
+    EXPECT_EQ(CommunicationState::sotdma(0).get_sub_message_type(), CommunicationState::SubMessage::SLOT_OFFSET);
+    EXPECT_EQ(CommunicationState::sotdma(1u << 14).get_sub_message_type(), CommunicationState::SubMessage::UTC_HOUR_MINUTE);
+}
+
+TEST(CommunicationStateTest, DecodesItdma) {
+    // Sync state 2, slot increment 4000, 3 slots, keep flag
+    uint32_t raw = (2u << 17) | (4000u << 4) | (3u << 1) | 1u;
+    CommunicationState state = CommunicationState::itdma(raw);
+    EXPECT_EQ(state.access, CommunicationState::Access::ITDMA);
+    EXPECT_EQ(state.sync_state, CommunicationState::SyncState::BASE_STATION);
+    EXPECT_EQ(state.slot_increment, 4000);
+    EXPECT_EQ(state.number_of_slots, 3);
+    EXPECT_TRUE(state.keep_flag);
+    EXPECT_EQ(state.get_sub_message_type(), CommunicationState::SubMessage::NONE);
+    EXPECT_EQ(state.encode(), raw);
+}
+
+TEST(CommunicationStateTest, FromMessages) {
+    uint32_t raw = (3u << 14) | 77u;
+    CommunicationState state;
+
+    PositionReportClassA sotdma_report(1, 244000001, 0, PositionReportClassA::NavigationStatus::UNDER_WAY_USING_ENGINE);
+    sotdma_report.set_radio_status(raw);
+    BitVector bits;
+    sotdma_report.to_bits(bits);
+    ASSERT_TRUE(CommunicationState::from_message(PositionReportClassA(bits), state));
+    EXPECT_EQ(state.get_received_stations(), 77);
+
+    PositionReportClassA itdma_report(3, 244000001, 0, PositionReportClassA::NavigationStatus::UNDER_WAY_USING_ENGINE);
+    ASSERT_TRUE(CommunicationState::from_message(itdma_report, state));
+    EXPECT_EQ(state.access, CommunicationState::Access::ITDMA);
+
+    BaseStationReport base_station(2440001, 0);
+    base_station.set_radio_status(raw);
+    ASSERT_TRUE(CommunicationState::from_message(base_station, state));
+    EXPECT_EQ(state.get_received_stations(), 77);
+
+    // Class B: carrier-sense units have no TDMA state, SOTDMA units use the selector bit
+    StandardPositionReportClassB class_b(244000002, 0);
+    ASSERT_TRUE(CommunicationState::from_message(class_b, state));
+    EXPECT_EQ(state.access, CommunicationState::Access::NONE);
+    class_b.set_cs_flag(false);
+    class_b.set_radio_status(0x80000 | raw);
+    ASSERT_TRUE(CommunicationState::from_message(class_b, state));
+    EXPECT_EQ(state.access, CommunicationState::Access::ITDMA);
+
+    EXPECT_FALSE(CommunicationState::from_message(ExtendedPositionReportClassB(244000002, 0), state));
+}
+
+TEST(VdlLoadTest, CountsSlotsAndStations) {
+    VdlLoadMonitor monitor;
+    monitor.add(1, 'A', kStart + 1.0, sotdma(3, 100));
+    monitor.add(1, 'A', kStart + 2.0, sotdma(5, 300));
+    monitor.add(1, 'A', kStart + 3.0, sotdma(2, 42));
+    monitor.add(1, '1', kStart + 4.0, sotdma(4, 42));
+    monitor.add(1, 'A', kStart + 65.0, CommunicationState(), 2);
+    monitor.add(1, 'B', kStart + 5.0, sotdma(6, 7));
+
+    VdlLoad load = monitor.get_load(1, 'A');
+    EXPECT_EQ(load.frames, 2u);
+    EXPECT_EQ(load.messages, 5u);
+    EXPECT_EQ(load.slots, 6u);
+    EXPECT_DOUBLE_EQ(load.occupancy, 6.0 / (2.0 * VdlLoadMonitor::SLOTS_PER_FRAME));
+    EXPECT_EQ(load.sotdma, 4u);
+    EXPECT_EQ(load.no_tdma, 1u);
+    EXPECT_EQ(load.distinct_slots, 1u);
+    EXPECT_EQ(load.max_received_stations, 300u);
+    EXPECT_DOUBLE_EQ(load.mean_received_stations, 200.0);
+    EXPECT_EQ(load.received_stations[7], 1u);  // 64-127
+    EXPECT_EQ(load.received_stations[9], 1u);  // 256-511
+
+    EXPECT_EQ(monitor.get_load(1, 'B').messages, 1u);
+    EXPECT_EQ(monitor.get_load(2, 'A').messages, 0u);
+    EXPECT_EQ(monitor.get_loads().size(), 2u);
+}
+
+TEST(VdlLoadTest, WindowSlides) {
+    VdlLoadMonitor::Config config;
+    config.window_frames = 3;
+    VdlLoadMonitor monitor(config);
+
+    for (int minute = 0; minute < 5; ++minute) {
+        for (int i = 0; i <= minute; ++i) {
+            monitor.add(0, 'A', kStart + 60.0 * minute + i, sotdma(3, 10));
+        }
+    }
+
+    // Minutes 2, 3 and 4 remain
+    VdlLoad load = monitor.get_load(0, 'A');
+    EXPECT_EQ(load.frames, 3u);
+    EXPECT_EQ(load.messages, 3u + 4u + 5u);
+
+    // Too old for the window
+    EXPECT_FALSE(monitor.add(0, 'A', kStart + 30.0, sotdma(3, 10)));
+    EXPECT_EQ(monitor.get_late(), 1u);
+
+    // A silent channel empties once the window is advanced
+    monitor.advance(kStart + 60.0 * 6);
+    EXPECT_EQ(monitor.get_load(0, 'A').messages, 5u);
+    monitor.advance(kStart + 60.0 * 10);
+    EXPECT_EQ(monitor.get_load(0, 'A').messages, 0u);
+}
+
+TEST(VdlLoadTest, GeneratedTraffic) {
+    simulation::TrafficConfig config;
+    config.vessel_count = 300;
+    config.receiver_count = 2;
+    config.duplicate_probability = 0.5;
+    simulation::TrafficGenerator generator(config);
+    auto sentences = generator.generate(3000);
+
+    AISParser parser;
+    VdlLoadMonitor monitor;
+    size_t decoded = 0;
+    for (const auto& generated : sentences) {
+        auto message = parser.parse(generated.sentence);
+        if (message) {
+            char channel = NMEAUtils::parse_fields(generated.sentence)[4][0];
+            EXPECT_TRUE(monitor.add(generated.receiver_id, channel, generated.time, *message));
+            ++decoded;
+        }
+    }
+
+    uint64_t messages = 0;
+    for (const VdlLoad& load : monitor.get_loads()) {
+        messages += load.messages;
+        EXPECT_GT(load.occupancy, 0.0);
+        EXPECT_LT(load.occupancy, 1.0);
+        EXPECT_GT(load.sotdma, 0u);
+        EXPECT_EQ(load.max_received_stations, 300u);
+    }
+    EXPECT_EQ(messages, decoded);
+    EXPECT_EQ(monitor.get_loads().size(), 4u);
+}
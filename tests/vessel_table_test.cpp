@@ -0,0 +1,190 @@
+#include <gtest/gtest.h>
+#include "aislib/vessel_table.h"
+#include "aislib/ais_parser.h"
+#include "aislib/simulation/traffic_generator.h"
+#include "aislib/static_data_report.h"
+#include "test_support.h"
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+using namespace aislib;
+using namespace aislib::test_support;
+
+namespace {
+
+std::string snapshot_path(const char* test) {
+    return process_name(::testing::TempDir() + "aislib-", test) + ".snapshot";
+}
+
+void fill(VesselTable& table, size_t messages, VesselTable::Clock::time_point now) {
+    simulation::TrafficConfig traffic;
+    traffic.vessel_count = 200;
+    traffic.type_mix = {{1, 4.0}, {18, 2.0}, {5, 1.0}, {24, 1.0}};
+    simulation::TrafficGenerator generator(traffic);
+    AISParser parser;
+    for (const auto& generated : generator.generate(messages)) {
+        auto message = parser.parse(generated.sentence);
+        if (message) {
+            table.update(generated.time, *message, now);
+        }
+    }
+}
+
+} // anonymous namespace
+
+TEST(VesselTableTest, SnapshotRoundTrip) {
+    auto now = VesselTable::Clock::now();
+    VesselTable table;
+    fill(table, 5000, now);
+    VesselTable::Stats stats = table.get_stats();
+    ASSERT_GT(stats.tracks, 0u);
+    ASSERT_GT(stats.statics, 0u);
+    ASSERT_GT(stats.class_b, 0u);
+    ASSERT_GT(stats.strings, 1u);
+
+    const std::string path = snapshot_path("roundtrip");
+    size_t bytes = table.save(path);
+    EXPECT_GT(bytes, 0u);
+
+    VesselTable restored;
+    restored.load(path, now);
+    std::remove(path.c_str());
+    VesselTable::Stats restored_stats = restored.get_stats();
+    EXPECT_EQ(restored_stats.tracks, stats.tracks);
+    EXPECT_EQ(restored_stats.statics, stats.statics);
+    EXPECT_EQ(restored_stats.class_b, stats.class_b);
+    EXPECT_EQ(restored_stats.strings, stats.strings);
+
+    std::vector<TrackStore::Track> tracks;
+    table.tracks().tracks(tracks);
+    for (const auto& track : tracks) {
+        ProjectedPosition before;
+        ProjectedPosition after;
+        ASSERT_TRUE(table.tracks().position_at(track.mmsi, track.time + 30.0, before));
+        ASSERT_TRUE(restored.tracks().position_at(track.mmsi, track.time + 30.0, after));
+        EXPECT_EQ(before.latitude, after.latitude);
+        EXPECT_EQ(before.longitude, after.longitude);
+        EXPECT_EQ(before.method, after.method);
+
+        const VesselStatic* original = table.find_static(track.mmsi);
+        const VesselStatic* copy = restored.find_static(track.mmsi);
+        ASSERT_EQ(original == nullptr, copy == nullptr);
+        if (original != nullptr) {
+            EXPECT_EQ(copy->ship_type, original->ship_type);
+            EXPECT_EQ(copy->imo_number, original->imo_number);
+            EXPECT_EQ(copy->time, original->time);
+            EXPECT_EQ(restored.text(copy->vessel_name), table.text(original->vessel_name));
+            EXPECT_EQ(restored.text(copy->call_sign), table.text(original->call_sign));
+            EXPECT_EQ(restored.text(copy->destination), table.text(original->destination));
+        }
+    }
+
+    std::vector<ClassBStaticRecord> records;
+    table.class_b().records(records);
+    std::vector<ClassBStaticRecord> restored_records;
+    restored.class_b().records(restored_records);
+    ASSERT_EQ(restored_records.size(), records.size());
+    for (size_t i = 0; i < records.size(); ++i) {
+        EXPECT_EQ(restored_records[i].mmsi, records[i].mmsi);
+        EXPECT_EQ(restored_records[i].is_complete(), records[i].is_complete());
+        EXPECT_EQ(restored_records[i].vessel_name.view(), records[i].vessel_name.view());
+        EXPECT_EQ(restored_records[i].call_sign.view(), records[i].call_sign.view());
+        ASSERT_NE(restored.class_b().find(records[i].mmsi, now), nullptr);
+    }
+
+    // Restored tables keep updating
+    EXPECT_TRUE(restored.update(kStart + 1e6, part_a(232004567, "SEA BREEZE"), now));
+    EXPECT_EQ(restored.get_stats().class_b, stats.class_b + 1);
+}
+
+TEST(VesselTableTest, ClassBAgesCarryOver) {
+    VesselTable::Config config;
+    config.class_b.max_age = std::chrono::seconds(600);
+    VesselTable table(config);
+    auto now = VesselTable::Clock::now();
+    table.update(kStart, part_a(232004567, "SEA BREEZE"), now - std::chrono::seconds(500));
+    table.update(kStart, part_a(232004568, "SEA SPRAY"), now);
+
+    const std::string path = snapshot_path("ages");
+    table.save(path);
+
+    // The restarted service has a different steady clock
+    VesselTable restored(config);
+    auto later = now + std::chrono::hours(5);
+    restored.load(path, later);
+    std::remove(path.c_str());
+    ASSERT_NE(restored.class_b().find(232004567, later), nullptr);
+    EXPECT_EQ(restored.class_b().find(232004567, later + std::chrono::seconds(150)), nullptr);
+    EXPECT_NE(restored.class_b().find(232004568, later + std::chrono::seconds(150)), nullptr);
+
+    // Update order is kept: the older record expires first
+    EXPECT_EQ(restored.class_b().expire(later + std::chrono::seconds(150)), 1u);
+    EXPECT_EQ(restored.class_b().size(), 1u);
+}
+
+TEST(VesselTableTest, SavesInTheBackground) {
+    auto now = VesselTable::Clock::now();
+    VesselTable table;
+    fill(table, 2000, now);
+    VesselTable::Stats stats = table.get_stats();
+
+    const std::string path = snapshot_path("async");
+    auto pending = table.save_async(path);
+    // The snapshot was copied before save_async() returned
+    table.clear();
+    size_t bytes = pending.get();
+
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    EXPECT_EQ(static_cast<size_t>(file.tellg()), bytes);
+    VesselTable restored;
+    restored.load(path, now);
+    std::remove(path.c_str());
+    EXPECT_EQ(restored.get_stats().tracks, stats.tracks);
+    EXPECT_EQ(restored.get_stats().statics, stats.statics);
+
+    // Errors are reported through the future
+    auto failed = table.save_async(::testing::TempDir() + "missing-directory/table.snapshot");
+    EXPECT_THROW(failed.get(), std::runtime_error);
+}
+
+TEST(VesselTableTest, RejectsInvalidSnapshots) {
+    auto now = VesselTable::Clock::now();
+    VesselTable table;
+    fill(table, 1000, now);
+    const std::string path = snapshot_path("invalid");
+    table.save(path);
+
+    std::vector<char> contents;
+    {
+        std::ifstream file(path, std::ios::binary);
+        contents.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+    auto write = [&](const std::vector<char>& bytes) {
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        file.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+    };
+
+    VesselTable restored;
+    EXPECT_THROW(restored.load(snapshot_path("missing"), now), std::runtime_error);
+
+    write(std::vector<char>(contents.begin(), contents.begin() + contents.size() / 2));
+    EXPECT_THROW(restored.load(path, now), std::runtime_error);
+
+    std::vector<char> corrupt = contents;
+    corrupt[0] ^= 0x55;
+    write(corrupt);
+    EXPECT_THROW(restored.load(path, now), std::runtime_error);
+
+    write(std::vector<char>(16, 0));
+    EXPECT_THROW(restored.load(path, now), std::runtime_error);
+    EXPECT_EQ(restored.get_stats().tracks, 0u);
+    EXPECT_EQ(restored.get_stats().strings, 1u);
+
+    write(contents);
+    restored.load(path, now);
+    EXPECT_EQ(restored.get_stats().tracks, table.get_stats().tracks);
+    std::remove(path.c_str());
+}
@@ -0,0 +1,239 @@
+/**
+ * @file ais_traffic_gen.cpp
+ * @brief Command-line front end for the synthetic traffic generator
+ *
+ * Writes generated AIVDM sentences to standard output, a file or a UDP
+ * socket on the local host, optionally paced to a target sentence rate.
+ */
+
+ #include "aislib/simulation/traffic_generator.h"
+ #include <cerrno>
+ #include <chrono>
+ #include <cstring>
+ #include <fstream>
+ #include <iostream>
+ #include <map>
+ #include <memory>
+ #include <sstream>
+ #include <stdexcept>
+ #include <string>
+ #include <thread>
+ #include <vector>
+
+ #ifndef _WIN32
+ #include <arpa/inet.h>
+ #include <netinet/in.h>
+ #include <sys/socket.h>
+ #include <unistd.h>
+ #endif
+
+ using namespace aislib::simulation;
+
+ namespace {
+
+ void print_usage(const char* program_name) {
+     std::cout << "Usage: " << program_name << " [options]" << std::endl;
+     std::cout << "Options:" << std::endl;
+     std::cout << "  -n, --messages <count>     Number of messages to simulate (default 10000)" << std::endl;
+     std::cout << "  -v, --vessels <count>      Number of vessels (default 1000)" << std::endl;
+     std::cout << "  -s, --seed <seed>          Random seed (default 1)" << std::endl;
+     std::cout << "  -m, --mix <type:weight,..> Message type mix, e.g. 1:60,5:10,18:30" << std::endl;
+     std::cout << "  -r, --receivers <count>    Number of receiving stations (default 1)" << std::endl;
+     std::cout << "      --interleave <count>   Max messages between fragments of one message" << std::endl;
+     std::cout << "      --duplicates <p>       Probability of reception by another station" << std::endl;
+     std::cout << "      --loss <p>             Probability of losing a fragment" << std::endl;
+     std::cout << "      --reorder <p>          Probability of reversing a message's fragments" << std::endl;
+     std::cout << "      --corrupt <p>          Probability of a bad checksum" << std::endl;
+     std::cout << "      --tag-blocks           Prefix sentences with station/time tag blocks" << std::endl;
+     std::cout << "  -o, --output <file>        Write to a file instead of standard output" << std::endl;
+     std::cout << "  -u, --udp <port>           Send each sentence as a datagram to 127.0.0.1:<port>" << std::endl;
+     std::cout << "      --rate <sentences/s>   Pace output in wall-clock time (default: unpaced)" << std::endl;
+     std::cout << "  -h, --help                 Display this help message" << std::endl;
+ }
+
+ // Parse "1:60,5:10" into a type mix
+ std::map<uint8_t, double> parse_mix(const std::string& text) {
+     std::map<uint8_t, double> mix;
+     std::stringstream ss(text);
+     std::string item;
+     while (std::getline(ss, item, ',')) {
+         size_t colon = item.find(':');
+         if (colon == std::string::npos) {
+             throw std::invalid_argument("Invalid mix entry: " + item);
+         }
+         mix[static_cast<uint8_t>(std::stoi(item.substr(0, colon)))] = std::stod(item.substr(colon + 1));
+     }
+     return mix;
+ }
+
+ /**
+  * @class UdpSink
+  * @brief Sends sentences as datagrams to a port on the local host
+  */
+ class UdpSink {
+ public:
+     explicit UdpSink(int port) : socket_(-1) {
+ #ifndef _WIN32
+         socket_ = ::socket(AF_INET, SOCK_DGRAM, 0);
+         if (socket_ < 0) {
+             throw std::runtime_error(std::string("Cannot create socket: ") + std::strerror(errno));
+         }
+         std::memset(&address_, 0, sizeof(address_));
+         address_.sin_family = AF_INET;
+         address_.sin_port = htons(static_cast<uint16_t>(port));
+         address_.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+ #else
+         (void)port;
+         throw std::runtime_error("UDP output is not supported on this platform");
+ #endif
+     }
+
+     ~UdpSink() {
+ #ifndef _WIN32
+         if (socket_ >= 0) {
+             ::close(socket_);
+         }
+ #endif
+     }
+
+     UdpSink(const UdpSink&) = delete;
+     UdpSink& operator=(const UdpSink&) = delete;
+
+     void send(const std::string& line) {
+ #ifndef _WIN32
+         std::string datagram = line + "\r\n";
+         ::sendto(socket_, datagram.data(), datagram.size(), 0,
+                  reinterpret_cast<const sockaddr*>(&address_), sizeof(address_));
+ #else
+         (void)line;
+ #endif
+     }
+
+ private:
+     int socket_;
+ #ifndef _WIN32
+     sockaddr_in address_;
+ #endif
+ };
+
+ } // anonymous namespace
+
+ int main(int argc, char* argv[]) {
+     TrafficConfig config;
+     size_t message_count = 10000;
+     bool tag_blocks = false;
+     std::string output_file;
+     int udp_port = 0;
+     double rate = 0.0;
+
+     try {
+         for (int i = 1; i < argc; ++i) {
+             std::string arg = argv[i];
+             auto value = [&]() -> std::string {
+                 if (i + 1 >= argc) {
+                     throw std::invalid_argument("Missing value after " + arg);
+                 }
+                 return argv[++i];
+             };
+
+             if (arg == "-h" || arg == "--help") {
+                 print_usage(argv[0]);
+                 return 0;
+             } else if (arg == "-n" || arg == "--messages") {
+                 message_count = std::stoul(value());
+             } else if (arg == "-v" || arg == "--vessels") {
+                 config.vessel_count = std::stoul(value());
+             } else if (arg == "-s" || arg == "--seed") {
+                 config.seed = static_cast<uint32_t>(std::stoul(value()));
+             } else if (arg == "-m" || arg == "--mix") {
+                 config.type_mix = parse_mix(value());
+             } else if (arg == "-r" || arg == "--receivers") {
+                 config.receiver_count = std::stoul(value());
+             } else if (arg == "--interleave") {
+                 config.max_interleave = std::stoul(value());
+             } else if (arg == "--duplicates") {
+                 config.duplicate_probability = std::stod(value());
+             } else if (arg == "--loss") {
+                 config.fragment_loss_probability = std::stod(value());
+             } else if (arg == "--reorder") {
+                 config.reorder_probability = std::stod(value());
+             } else if (arg == "--corrupt") {
+                 config.corrupt_probability = std::stod(value());
+             } else if (arg == "--tag-blocks") {
+                 tag_blocks = true;
+             } else if (arg == "-o" || arg == "--output") {
+                 output_file = value();
+             } else if (arg == "-u" || arg == "--udp") {
+                 udp_port = std::stoi(value());
+             } else if (arg == "--rate") {
+                 rate = std::stod(value());
+             } else {
+                 std::cerr << "Error: Unknown option " << arg << std::endl;
+                 print_usage(argv[0]);
+                 return 1;
+             }
+         }
+
+         TrafficGenerator generator(config);
+
+         std::ofstream file;
+         if (!output_file.empty()) {
+             file.open(output_file);
+             if (!file) {
+                 std::cerr << "Error: Could not open file " << output_file << std::endl;
+                 return 1;
+             }
+         }
+         std::ostream& out = output_file.empty() ? std::cout : file;
+
+         std::unique_ptr<UdpSink> udp;
+         if (udp_port > 0) {
+             udp = std::make_unique<UdpSink>(udp_port);
+         }
+
+         auto start = std::chrono::steady_clock::now();
+         size_t sent = 0;
+         std::vector<GeneratedSentence> batch;
+
+         auto emit = [&](const GeneratedSentence& sentence) {
+             if (rate > 0.0) {
+                 std::this_thread::sleep_until(start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                     std::chrono::duration<double>(sent / rate)));
+             }
+             std::string line = tag_blocks ? sentence.with_tag_block() : sentence.sentence;
+             if (udp) {
+                 udp->send(line);
+             } else {
+                 out << line << "\n";
+             }
+             ++sent;
+         };
+
+         for (size_t n = 0; n < message_count; ++n) {
+             batch.clear();
+             generator.next(batch);
+             for (const auto& sentence : batch) {
+                 emit(sentence);
+             }
+         }
+         batch.clear();
+         generator.flush(batch);
+         for (const auto& sentence : batch) {
+             emit(sentence);
+         }
+         out.flush();
+
+         const TrafficStatistics& stats = generator.get_statistics();
+         std::cerr << "Messages: " << stats.messages
+                   << ", sentences: " << stats.sentences
+                   << ", duplicates: " << stats.duplicates
+                   << ", lost fragments: " << stats.lost_fragments
+                   << ", reordered: " << stats.reordered_messages
+                   << ", corrupted: " << stats.corrupted << std::endl;
+     } catch (const std::exception& e) {
+         std::cerr << "Error: " << e.what() << std::endl;
+         return 1;
+     }
+
+     return 0;
+ }